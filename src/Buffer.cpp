@@ -12,7 +12,19 @@ Buffer::Buffer(
 {
 	const auto vk_device= window_vulkan.GetVulkanDevice();
 
-	buffer_= vk_device.createBufferUnique(vk::BufferCreateInfo(vk::BufferCreateFlags(), size_, usage_flags));
+	// Share buffer between queue families if more than one is used (with async compute).
+	// This is simpler than performing ownership transfers.
+	const std::vector<uint32_t> queue_family_indices= window_vulkan.GetUsedQueueFamilyIndices();
+	if(queue_family_indices.size() > 1)
+		buffer_= vk_device.createBufferUnique(
+			vk::BufferCreateInfo(
+				vk::BufferCreateFlags(),
+				size_,
+				usage_flags,
+				vk::SharingMode::eConcurrent,
+				uint32_t(queue_family_indices.size()), queue_family_indices.data()));
+	else
+		buffer_= vk_device.createBufferUnique(vk::BufferCreateInfo(vk::BufferCreateFlags(), size_, usage_flags));
 
 	const vk::MemoryRequirements buffer_memory_requirements= vk_device.getBufferMemoryRequirements(*buffer_);
 
@@ -201,6 +201,7 @@ BuildPrismRenderer::~BuildPrismRenderer()
 void BuildPrismRenderer::PrepareFrame(TaskOrganizer& task_organizer)
 {
 	TaskOrganizer::TransferTaskParams task;
+	task.name= "build_prism_prepare";
 	task.input_buffers.push_back(world_processor_.GetPlayerStateBuffer());
 	task.output_buffers.push_back(uniform_buffer_.GetBuffer());
 
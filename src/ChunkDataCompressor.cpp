@@ -1,17 +1,43 @@
 #include "ChunkDataCompressor.hpp"
 #include "Assert.hpp"
 #include "Constants.hpp"
+#include "CpuFeatures.hpp"
 #include "Log.hpp"
 #include <snappy.h>
+#include <zdict.h>
+#include <zstd.h>
+#include <array>
 #include <cstring>
 
+#if defined(HEX_SSE2)
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
 namespace HexGPU
 {
 
 namespace
 {
 
-bool UncompressRawBlocksArray(const std::string& in, char* const out)
+constexpr uint32_t c_chunk_num_columns= c_chunk_width * c_chunk_width;
+
+// Bit mask of columns with non-zero data.
+constexpr uint32_t c_columns_mask_size= c_chunk_num_columns / 8;
+
+// Number of runs within a column is stored in a byte and zero number of runs has special meaning.
+static_assert(c_chunk_height < 256, "Column RLE requires column height less than 256");
+
+// Balanced compression level - saving happens in background, but should be fast enough.
+constexpr int c_zstd_compression_level= 3;
+
+// Dictionary size should be much less than total size of samples.
+constexpr size_t c_zstd_dictionary_size= 32 * 1024;
+
+bool UncompressRawBlocksArraySnappy(const std::string_view in, char* const out, const uint32_t out_size)
 {
 	size_t uncompressed_length= 0;
 	if(!snappy::GetUncompressedLength(in.data(), in.size(), &uncompressed_length))
@@ -20,9 +46,9 @@ bool UncompressRawBlocksArray(const std::string& in, char* const out)
 		return false;
 	}
 
-	if(uncompressed_length != c_chunk_volume)
+	if(uncompressed_length != out_size)
 	{
-		Log::Info("Unexpected uncompressed length, expected ", c_chunk_volume, " got ", uncompressed_length);
+		Log::Info("Unexpected uncompressed length, expected ", out_size, " got ", uncompressed_length);
 		return false;
 	}
 
@@ -35,31 +61,601 @@ bool UncompressRawBlocksArray(const std::string& in, char* const out)
 	return true;
 }
 
-std::string CompressRawBlocksArray(const char* const in, std::string& temp_buffer)
+void CompressRawBlocksArraySnappy(const char* const in, const uint32_t in_size, std::string& out)
 {
-	if(!snappy::Compress(in, c_chunk_volume, &temp_buffer))
+	if(!snappy::Compress(in, in_size, &out))
 		Log::Info("Failed to compress");
+}
+
+// Flat RLE format - sequence of runs.
+// Each run is a byte value followed by run length in LEB128 encoding.
+
+void CompressRawBlocksArrayFlatRLE(const char* const in, const uint32_t in_size, std::string& out)
+{
+	out.clear();
+
+	uint32_t i= 0;
+	while(i < in_size)
+	{
+		const char value= in[i];
+
+		// Runs are usually long, so, compare 8 bytes at once first.
+		const uint64_t value_pattern= uint64_t(uint8_t(value)) * 0x0101010101010101ull;
+		uint32_t run_end= i + 1;
+		while(run_end + 8 <= in_size)
+		{
+			uint64_t word;
+			std::memcpy(&word, in + run_end, sizeof(word));
+			if(word != value_pattern)
+				break;
+			run_end+= 8;
+		}
+		while(run_end < in_size && in[run_end] == value)
+			++run_end;
+
+		uint32_t run_length= run_end - i;
+		i= run_end;
+
+		out.push_back(value);
+		while(run_length >= 0x80)
+		{
+			out.push_back(char((run_length & 0x7F) | 0x80));
+			run_length>>= 7;
+		}
+		out.push_back(char(run_length));
+	}
+}
+
+bool UncompressRawBlocksArrayFlatRLE(const std::string_view in, char* const out, const uint32_t out_size)
+{
+	uint32_t out_offset= 0;
+	size_t pos= 0;
+	while(pos < in.size())
+	{
+		const char value= in[pos];
+		++pos;
+
+		uint32_t run_length= 0;
+		for(uint32_t shift= 0; ; shift+= 7)
+		{
+			if(pos >= in.size() || shift > 28)
+			{
+				Log::Info("Invalid RLE run length");
+				return false;
+			}
+
+			const uint8_t length_byte= uint8_t(in[pos]);
+			++pos;
+			run_length|= uint32_t(length_byte & 0x7F) << shift;
+			if((length_byte & 0x80) == 0)
+				break;
+		}
+
+		if(run_length > out_size - out_offset)
+		{
+			Log::Info("RLE data is too long");
+			return false;
+		}
 
-	// Create copy of the temp buffer.
-	// Reuse internal storage of the temp buffer for later usage.
-	return temp_buffer;
+		std::memset(out + out_offset, value, run_length);
+		out_offset+= run_length;
+	}
+
+	if(out_offset != out_size)
+	{
+		Log::Info("Unexpected uncompressed length, expected ", out_size, " got ", out_offset);
+		return false;
+	}
+
+	return true;
+}
+
+// Column RLE format - sequence of encoded columns.
+// Each column starts with number of runs in it. Runs are pairs of byte value and run length minus one.
+// Zero number of runs means that the column is equal to the previous column (zero column for the first column).
+// This format is also used for chunks in the regions cache, so, columns encoding and decoding are vectorized.
+
+static_assert(c_chunk_height % 64 == 0, "Column RLE requires column height multiple of 64");
+
+// Bit mask of column elements which start new runs.
+using ColumnRunStartsMask= std::array<uint64_t, c_chunk_height / 64>;
+
+// Number of runs and all runs with length 1.
+constexpr uint32_t c_column_rle_max_encoded_size= 1 + c_chunk_height * 2;
+
+constexpr char c_zero_column[c_chunk_height]{};
+
+uint32_t CountTrailingZeros(const uint64_t x)
+{
+	HEX_ASSERT(x != 0);
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long index= 0;
+	_BitScanForward64(&index, x);
+	return uint32_t(index);
+#else
+	return uint32_t(__builtin_ctzll(x));
+#endif
+}
+
+[[maybe_unused]] ColumnRunStartsMask GetColumnRunStartsScalar(const char* const column)
+{
+	ColumnRunStartsMask mask{};
+	mask[0]= 1;
+	for(uint32_t z= 1; z < c_chunk_height; ++z)
+	{
+		if(column[z] != column[z - 1])
+			mask[z / 64]|= uint64_t(1) << (z % 64);
+	}
+
+	return mask;
+}
+
+#if defined(HEX_SSE2)
+
+ColumnRunStartsMask GetColumnRunStartsSSE2(const char* const column)
+{
+	ColumnRunStartsMask mask{};
+	for(uint32_t z= 0; z < c_chunk_height; z+= 16)
+	{
+		const __m128i current= _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + z));
+		const __m128i previous=
+			z == 0
+				? _mm_slli_si128(current, 1)
+				: _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + z - 1));
+		const uint32_t not_equal_bits= ~uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(current, previous))) & 0xFFFFu;
+		mask[z / 64]|= uint64_t(not_equal_bits) << (z % 64);
+	}
+
+	// First element always starts a run.
+	mask[0]|= 1;
+	return mask;
+}
+
+#endif
+
+#if defined(HEX_AVX2)
+
+HEX_TARGET_AVX2 ColumnRunStartsMask GetColumnRunStartsAVX2(const char* const column)
+{
+	ColumnRunStartsMask mask{};
+	for(uint32_t z= 0; z < c_chunk_height; z+= 32)
+	{
+		const __m256i current= _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + z));
+		// Shift by one element across 128-bit lanes, zero is shifted into the first element.
+		const __m256i previous=
+			z == 0
+				? _mm256_alignr_epi8(current, _mm256_permute2x128_si256(current, current, 0x08), 15)
+				: _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + z - 1));
+		const uint32_t not_equal_bits= ~uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(current, previous)));
+		mask[z / 64]|= uint64_t(not_equal_bits) << (z % 64);
+	}
+
+	// First element always starts a run.
+	mask[0]|= 1;
+	return mask;
+}
+
+#endif
+
+using GetColumnRunStartsFunc= ColumnRunStartsMask(*)(const char* column);
+
+GetColumnRunStartsFunc SelectGetColumnRunStartsFunc()
+{
+#if defined(HEX_AVX2)
+	if(CpuSupportsAVX2())
+		return GetColumnRunStartsAVX2;
+#endif
+#if defined(HEX_SSE2)
+	return GetColumnRunStartsSSE2;
+#else
+	return GetColumnRunStartsScalar;
+#endif
+}
+
+// Returns number of written bytes.
+uint32_t WriteColumnRuns(const char* const column, const ColumnRunStartsMask& run_starts, char* const out)
+{
+	uint32_t num_runs= 0;
+	uint32_t run_start= 0;
+	for(uint32_t i= 0; i < run_starts.size(); ++i)
+	{
+		uint64_t bits= run_starts[i];
+		if(i == 0)
+			bits&= ~uint64_t(1); // Skip start of the first run.
+
+		while(bits != 0)
+		{
+			const uint32_t run_end= i * 64 + CountTrailingZeros(bits);
+			bits&= bits - 1;
+
+			out[1 + num_runs * 2 + 0]= column[run_start];
+			out[1 + num_runs * 2 + 1]= char(run_end - run_start - 1);
+			++num_runs;
+			run_start= run_end;
+		}
+	}
+
+	out[1 + num_runs * 2 + 0]= column[run_start];
+	out[1 + num_runs * 2 + 1]= char(c_chunk_height - run_start - 1);
+	++num_runs;
+
+	out[0]= char(num_runs);
+	return 1 + num_runs * 2;
+}
+
+// Input contains given number of runs.
+// Returns false if runs length isn't equal to the column height.
+[[maybe_unused]] bool ReadColumnRunsScalar(const char* const in, const uint32_t num_runs, char* const column)
+{
+	uint32_t z= 0;
+	for(uint32_t i= 0; i < num_runs; ++i)
+	{
+		const uint32_t run_length= uint32_t(uint8_t(in[i * 2 + 1])) + 1;
+		if(run_length > c_chunk_height - z)
+			return false;
+
+		std::memset(column + z, in[i * 2], run_length);
+		z+= run_length;
+	}
+
+	return z == c_chunk_height;
+}
+
+// Vectorized versions fill runs using whole vectors, possibly writing past run end.
+// Following runs overwrite these extra elements, extra elements of the last run are written into padding.
+
+#if defined(HEX_SSE2)
+
+bool ReadColumnRunsSSE2(const char* const in, const uint32_t num_runs, char* const column)
+{
+	alignas(16) char column_padded[c_chunk_height + 16];
+
+	uint32_t z= 0;
+	for(uint32_t i= 0; i < num_runs; ++i)
+	{
+		const uint32_t run_length= uint32_t(uint8_t(in[i * 2 + 1])) + 1;
+		if(run_length > c_chunk_height - z)
+			return false;
+
+		const __m128i value= _mm_set1_epi8(in[i * 2]);
+		for(uint32_t offset= 0; offset < run_length; offset+= 16)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(column_padded + z + offset), value);
+		z+= run_length;
+	}
+
+	if(z != c_chunk_height)
+		return false;
+
+	std::memcpy(column, column_padded, c_chunk_height);
+	return true;
+}
+
+#endif
+
+#if defined(HEX_AVX2)
+
+HEX_TARGET_AVX2 bool ReadColumnRunsAVX2(const char* const in, const uint32_t num_runs, char* const column)
+{
+	alignas(32) char column_padded[c_chunk_height + 32];
+
+	uint32_t z= 0;
+	for(uint32_t i= 0; i < num_runs; ++i)
+	{
+		const uint32_t run_length= uint32_t(uint8_t(in[i * 2 + 1])) + 1;
+		if(run_length > c_chunk_height - z)
+			return false;
+
+		const __m256i value= _mm256_set1_epi8(in[i * 2]);
+		for(uint32_t offset= 0; offset < run_length; offset+= 32)
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(column_padded + z + offset), value);
+		z+= run_length;
+	}
+
+	if(z != c_chunk_height)
+		return false;
+
+	std::memcpy(column, column_padded, c_chunk_height);
+	return true;
+}
+
+#endif
+
+using ReadColumnRunsFunc= bool(*)(const char* in, uint32_t num_runs, char* column);
+
+ReadColumnRunsFunc SelectReadColumnRunsFunc()
+{
+#if defined(HEX_AVX2)
+	if(CpuSupportsAVX2())
+		return ReadColumnRunsAVX2;
+#endif
+#if defined(HEX_SSE2)
+	return ReadColumnRunsSSE2;
+#else
+	return ReadColumnRunsScalar;
+#endif
+}
+
+void CompressRawBlocksArrayColumnRLE(const char* const in, const uint32_t in_size, std::string& out)
+{
+	HEX_ASSERT(in_size % c_chunk_height == 0);
+
+	static const GetColumnRunStartsFunc get_column_run_starts= SelectGetColumnRunStartsFunc();
+
+	out.clear();
+
+	const char* prev_column= c_zero_column;
+	for(uint32_t column_offset= 0; column_offset < in_size; column_offset+= c_chunk_height)
+	{
+		const char* const column= in + column_offset;
+
+		if(std::memcmp(column, prev_column, c_chunk_height) == 0)
+			out.push_back(0);
+		else
+		{
+			char column_encoded[c_column_rle_max_encoded_size];
+			const uint32_t column_encoded_size= WriteColumnRuns(column, get_column_run_starts(column), column_encoded);
+			out.append(column_encoded, column_encoded_size);
+		}
+
+		prev_column= column;
+	}
+}
+
+bool UncompressRawBlocksArrayColumnRLE(const std::string_view in, char* const out, const uint32_t out_size)
+{
+	if(out_size % c_chunk_height != 0)
+	{
+		Log::Info("Invalid size for column RLE data");
+		return false;
+	}
+
+	static const ReadColumnRunsFunc read_column_runs= SelectReadColumnRunsFunc();
+
+	size_t pos= 0;
+	for(uint32_t column_offset= 0; column_offset < out_size; column_offset+= c_chunk_height)
+	{
+		char* const column= out + column_offset;
+
+		if(pos >= in.size())
+		{
+			Log::Info("Column RLE data is too short");
+			return false;
+		}
+
+		const uint32_t num_runs= uint8_t(in[pos]);
+		++pos;
+
+		if(num_runs == 0)
+		{
+			std::memcpy(column, column_offset == 0 ? c_zero_column : column - c_chunk_height, c_chunk_height);
+			continue;
+		}
+
+		if(in.size() - pos < num_runs * 2)
+		{
+			Log::Info("Column RLE data is too short");
+			return false;
+		}
+
+		if(!read_column_runs(in.data() + pos, num_runs, column))
+		{
+			Log::Info("Column RLE data has invalid column length");
+			return false;
+		}
+		pos+= num_runs * 2;
+	}
+
+	if(pos != in.size())
+	{
+		Log::Info("Column RLE data is too long");
+		return false;
+	}
+
+	return true;
+}
+
+// Columns are checked using 8-byte words.
+static_assert(c_chunk_height % 8 == 0, "Column height should be multiple of 8");
+
+bool IsColumnZero(const char* const column)
+{
+	for(uint32_t z= 0; z < c_chunk_height; z+= 8)
+	{
+		uint64_t word;
+		std::memcpy(&word, column + z, sizeof(word));
+		if(word != 0)
+			return false;
+	}
+
+	return true;
 }
 
 } // namespace
 
+std::optional<ChunkCodec> StringToChunkCodec(const std::string_view s)
+{
+	for(uint32_t i= 0; i < c_num_chunk_codecs; ++i)
+	{
+		if(s == ChunkCodecToString(ChunkCodec(i)))
+			return ChunkCodec(i);
+	}
+
+	return std::nullopt;
+}
+
+std::string_view ChunkCodecToString(const ChunkCodec codec)
+{
+	switch(codec)
+	{
+	case ChunkCodec::Snappy:
+		return "snappy";
+	case ChunkCodec::FlatRLE:
+		return "flat_rle";
+	case ChunkCodec::ColumnRLE:
+		return "rle";
+	case ChunkCodec::Zstd:
+		return "zstd";
+	};
+
+	HEX_ASSERT(false);
+	return "";
+}
+
+std::shared_ptr<const ZstdDictionary> ZstdDictionary::Load(std::string data)
+{
+	const uint32_t id= ZDICT_getDictID(data.data(), data.size());
+	if(id == 0)
+	{
+		Log::Info("Invalid zstd dictionary");
+		return nullptr;
+	}
+
+	ZSTD_CDict* const compression_dictionary= ZSTD_createCDict(data.data(), data.size(), c_zstd_compression_level);
+	ZSTD_DDict* const decompression_dictionary= ZSTD_createDDict(data.data(), data.size());
+	if(compression_dictionary == nullptr || decompression_dictionary == nullptr)
+	{
+		Log::Info("Can't create zstd dictionary");
+		ZSTD_freeCDict(compression_dictionary);
+		ZSTD_freeDDict(decompression_dictionary);
+		return nullptr;
+	}
+
+	return std::shared_ptr<const ZstdDictionary>(
+		new ZstdDictionary(std::move(data), id, compression_dictionary, decompression_dictionary));
+}
+
+std::shared_ptr<const ZstdDictionary> ZstdDictionary::Train(const std::vector<std::string>& samples)
+{
+	std::string samples_concatenated;
+	std::vector<size_t> samples_sizes;
+	samples_sizes.reserve(samples.size());
+	for(const std::string& sample : samples)
+	{
+		samples_concatenated+= sample;
+		samples_sizes.push_back(sample.size());
+	}
+
+	std::string data(c_zstd_dictionary_size, '\0');
+	const size_t size=
+		ZDICT_trainFromBuffer(
+			data.data(),
+			data.size(),
+			samples_concatenated.data(),
+			samples_sizes.data(),
+			uint32_t(samples_sizes.size()));
+	if(ZDICT_isError(size))
+	{
+		Log::Info("Failed to train zstd dictionary: ", ZDICT_getErrorName(size));
+		return nullptr;
+	}
+
+	data.resize(size);
+	return Load(std::move(data));
+}
+
+ZstdDictionary::ZstdDictionary(
+	std::string data,
+	const uint32_t id,
+	ZSTD_CDict_s* const compression_dictionary,
+	ZSTD_DDict_s* const decompression_dictionary)
+	: data_(std::move(data))
+	, id_(id)
+	, compression_dictionary_(compression_dictionary)
+	, decompression_dictionary_(decompression_dictionary)
+{
+}
+
+ZstdDictionary::~ZstdDictionary()
+{
+	ZSTD_freeCDict(compression_dictionary_);
+	ZSTD_freeDDict(decompression_dictionary_);
+}
+
+const std::string& ZstdDictionary::GetData() const
+{
+	return data_;
+}
+
+uint32_t ZstdDictionary::GetId() const
+{
+	return id_;
+}
+
+ZSTD_CDict_s* ZstdDictionary::GetCompressionDictionary() const
+{
+	return compression_dictionary_;
+}
+
+ZSTD_DDict_s* ZstdDictionary::GetDecompressionDictionary() const
+{
+	return decompression_dictionary_;
+}
+
+ChunkDataCompressor::ChunkDataCompressor()
+{
+}
+
+ChunkDataCompressor::~ChunkDataCompressor()
+{
+	ZSTD_freeCCtx(zstd_compression_context_);
+	ZSTD_freeDCtx(zstd_decompression_context_);
+}
+
 ChunkDataCompresed ChunkDataCompressor::Compress(
+	const ChunkCodec codec,
 	const BlockType* const blocks_data,
-	const uint8_t* const blocks_auxiliar_data)
+	const uint8_t* const blocks_auxiliar_data,
+	const ZstdDictionary* const zstd_dictionary,
+	const AuxiliarDataLayout auxiliar_data_layout)
 {
 	ChunkDataCompresed out_data;
+	out_data.codec= codec;
+	out_data.auxiliar_data_layout= auxiliar_data_layout;
 
 	// Reuse temp buffer for compression, because "snappy" reserves a lot of memory inside it (more than uncompressed size)
 	// and we don't whant to return strings with too much memory reserved.
 	// Doing so we keep only this buffer with large storage and result buffers only of necessary size.
-	out_data.blocks=
-		CompressRawBlocksArray(reinterpret_cast<const char*>(blocks_data), temp_compress_buffer_);
-	out_data.auxiliar_data=
-		CompressRawBlocksArray(reinterpret_cast<const char*>(blocks_auxiliar_data), temp_compress_buffer_);
+	// Create copy of the temp buffer and reuse its internal storage for later usage.
+	CompressRawBlocksArray(codec, reinterpret_cast<const char*>(blocks_data), c_chunk_volume, temp_compress_buffer_, zstd_dictionary);
+	out_data.blocks= temp_compress_buffer_;
+
+	if(auxiliar_data_layout == AuxiliarDataLayout::Dense)
+	{
+		CompressRawBlocksArray(
+			codec,
+			reinterpret_cast<const char*>(blocks_auxiliar_data),
+			c_chunk_volume,
+			temp_compress_buffer_,
+			zstd_dictionary);
+		out_data.auxiliar_data= temp_compress_buffer_;
+		return out_data;
+	}
+
+	// Auxiliar data is used only by few block types, so, most columns contain only zeros.
+	// Store mask of non-zero columns and compress only these columns.
+	char columns_mask[c_columns_mask_size]{};
+	temp_columns_buffer_.clear();
+	for(uint32_t column= 0; column < c_chunk_num_columns; ++column)
+	{
+		const char* const column_data= reinterpret_cast<const char*>(blocks_auxiliar_data) + column * c_chunk_height;
+		if(!IsColumnZero(column_data))
+		{
+			columns_mask[column >> 3]|= char(1 << (column & 7));
+			temp_columns_buffer_.insert(temp_columns_buffer_.end(), column_data, column_data + c_chunk_height);
+		}
+	}
+
+	out_data.auxiliar_data.assign(columns_mask, sizeof(columns_mask));
+	if(!temp_columns_buffer_.empty())
+	{
+		CompressRawBlocksArray(
+			codec,
+			temp_columns_buffer_.data(),
+			uint32_t(temp_columns_buffer_.size()),
+			temp_compress_buffer_,
+			zstd_dictionary);
+		out_data.auxiliar_data+= temp_compress_buffer_;
+	}
 
 	return out_data;
 }
@@ -67,20 +663,212 @@ ChunkDataCompresed ChunkDataCompressor::Compress(
 bool ChunkDataCompressor::Decompress(
 	const ChunkDataCompresed& data_compressed,
 	BlockType* const blocks_data,
-	uint8_t* const blocks_auxiliar_data)
+	uint8_t* const blocks_auxiliar_data,
+	const ZstdDictionary* const zstd_dictionary)
+{
+	return
+		Decompress(
+			ChunkDataCompresedView{
+				data_compressed.codec,
+				data_compressed.auxiliar_data_layout,
+				data_compressed.blocks,
+				data_compressed.auxiliar_data},
+			blocks_data,
+			blocks_auxiliar_data,
+			zstd_dictionary);
+}
+
+bool ChunkDataCompressor::Decompress(
+	const ChunkDataCompresedView& data_compressed,
+	BlockType* const blocks_data,
+	uint8_t* const blocks_auxiliar_data,
+	const ZstdDictionary* const zstd_dictionary)
 {
-	if(!UncompressRawBlocksArray(data_compressed.blocks, reinterpret_cast<char*>(blocks_data)))
+	if(!UncompressRawBlocksArray(
+		data_compressed.codec,
+		data_compressed.blocks,
+		reinterpret_cast<char*>(blocks_data),
+		c_chunk_volume,
+		zstd_dictionary))
 	{
 		Log::Info("Can't decompress blocks data");
 		return false;
 	}
 
-	if(!UncompressRawBlocksArray(data_compressed.auxiliar_data, reinterpret_cast<char*>(blocks_auxiliar_data)))
+	switch(data_compressed.auxiliar_data_layout)
+	{
+	case AuxiliarDataLayout::Dense:
+		if(!UncompressRawBlocksArray(
+			data_compressed.codec,
+			data_compressed.auxiliar_data,
+			reinterpret_cast<char*>(blocks_auxiliar_data),
+			c_chunk_volume,
+			zstd_dictionary))
+		{
+			Log::Info("Can't decompress blocks auxiliar data");
+			return false;
+		}
+		return true;
+
+	case AuxiliarDataLayout::SparseColumns:
+		return DecompressSparseAuxiliarData(data_compressed, blocks_auxiliar_data, zstd_dictionary);
+	};
+
+	Log::Info("Unknown auxiliar data layout ", uint32_t(data_compressed.auxiliar_data_layout));
+	return false;
+}
+
+void ChunkDataCompressor::CompressRawBlocksArray(
+	const ChunkCodec codec,
+	const char* const in,
+	const uint32_t in_size,
+	std::string& out,
+	const ZstdDictionary* const zstd_dictionary)
+{
+	switch(codec)
+	{
+	case ChunkCodec::Snappy:
+		CompressRawBlocksArraySnappy(in, in_size, out);
+		return;
+	case ChunkCodec::FlatRLE:
+		CompressRawBlocksArrayFlatRLE(in, in_size, out);
+		return;
+	case ChunkCodec::ColumnRLE:
+		CompressRawBlocksArrayColumnRLE(in, in_size, out);
+		return;
+	case ChunkCodec::Zstd:
+		{
+			if(zstd_compression_context_ == nullptr)
+				zstd_compression_context_= ZSTD_createCCtx();
+
+			out.resize(ZSTD_compressBound(in_size));
+			const size_t size=
+				zstd_dictionary == nullptr
+					? ZSTD_compressCCtx(zstd_compression_context_, out.data(), out.size(), in, in_size, c_zstd_compression_level)
+					: ZSTD_compress_usingCDict(
+						zstd_compression_context_,
+						out.data(),
+						out.size(),
+						in,
+						in_size,
+						zstd_dictionary->GetCompressionDictionary());
+			if(ZSTD_isError(size))
+			{
+				Log::Info("Failed to compress: ", ZSTD_getErrorName(size));
+				out.clear();
+			}
+			else
+				out.resize(size);
+		}
+		return;
+	};
+
+	HEX_ASSERT(false);
+}
+
+bool ChunkDataCompressor::UncompressRawBlocksArray(
+	const ChunkCodec codec,
+	const std::string_view in,
+	char* const out,
+	const uint32_t out_size,
+	const ZstdDictionary* const zstd_dictionary)
+{
+	switch(codec)
+	{
+	case ChunkCodec::Snappy:
+		return UncompressRawBlocksArraySnappy(in, out, out_size);
+	case ChunkCodec::FlatRLE:
+		return UncompressRawBlocksArrayFlatRLE(in, out, out_size);
+	case ChunkCodec::ColumnRLE:
+		return UncompressRawBlocksArrayColumnRLE(in, out, out_size);
+	case ChunkCodec::Zstd:
+		{
+			// Data compressed without a dictionary has zero dictionary id.
+			const uint32_t dictionary_id= ZSTD_getDictID_fromFrame(in.data(), in.size());
+			if(dictionary_id != 0 && (zstd_dictionary == nullptr || zstd_dictionary->GetId() != dictionary_id))
+			{
+				Log::Info("No zstd dictionary with id ", dictionary_id);
+				return false;
+			}
+
+			if(zstd_decompression_context_ == nullptr)
+				zstd_decompression_context_= ZSTD_createDCtx();
+
+			const size_t size=
+				dictionary_id == 0
+					? ZSTD_decompressDCtx(zstd_decompression_context_, out, out_size, in.data(), in.size())
+					: ZSTD_decompress_usingDDict(
+						zstd_decompression_context_,
+						out,
+						out_size,
+						in.data(),
+						in.size(),
+						zstd_dictionary->GetDecompressionDictionary());
+			if(ZSTD_isError(size))
+			{
+				Log::Info("Uncompress failed: ", ZSTD_getErrorName(size));
+				return false;
+			}
+			if(size != out_size)
+			{
+				Log::Info("Unexpected uncompressed length, expected ", out_size, " got ", size);
+				return false;
+			}
+			return true;
+		}
+	};
+
+	Log::Info("Unknown chunk codec ", uint32_t(codec));
+	return false;
+}
+
+bool ChunkDataCompressor::DecompressSparseAuxiliarData(
+	const ChunkDataCompresedView& data_compressed,
+	uint8_t* const blocks_auxiliar_data,
+	const ZstdDictionary* const zstd_dictionary)
+{
+	const std::string_view auxiliar_data= data_compressed.auxiliar_data;
+	if(auxiliar_data.size() < c_columns_mask_size)
+	{
+		Log::Info("Invalid sparse auxiliar data size");
+		return false;
+	}
+
+	const char* const columns_mask= auxiliar_data.data();
+
+	uint32_t num_columns= 0;
+	for(uint32_t column= 0; column < c_chunk_num_columns; ++column)
+	{
+		if((columns_mask[column >> 3] & (1 << (column & 7))) != 0)
+			++num_columns;
+	}
+
+	std::memset(blocks_auxiliar_data, 0, c_chunk_volume);
+	if(num_columns == 0)
+		return true;
+
+	temp_columns_buffer_.resize(num_columns * c_chunk_height);
+	if(!UncompressRawBlocksArray(
+		data_compressed.codec,
+		auxiliar_data.substr(c_columns_mask_size),
+		temp_columns_buffer_.data(),
+		uint32_t(temp_columns_buffer_.size()),
+		zstd_dictionary))
 	{
 		Log::Info("Can't decompress blocks auxiliar data");
 		return false;
 	}
 
+	const char* packed_column= temp_columns_buffer_.data();
+	for(uint32_t column= 0; column < c_chunk_num_columns; ++column)
+	{
+		if((columns_mask[column >> 3] & (1 << (column & 7))) != 0)
+		{
+			std::memcpy(blocks_auxiliar_data + column * c_chunk_height, packed_column, c_chunk_height);
+			packed_column+= c_chunk_height;
+		}
+	}
+
 	return true;
 }
 
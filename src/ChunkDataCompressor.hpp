@@ -1,28 +1,165 @@
 #pragma once
 #include "BlockType.hpp"
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
+
+// Forward declarations of zstd types - do not include zstd headers here.
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
 
 namespace HexGPU
 {
 
+// Codec used for chunk data compression.
+// Values are stored in region files - do not change them.
+enum class ChunkCodec : uint32_t
+{
+	Snappy= 0,
+	// Run-length encoding of the whole array. Chunk data is stored with z as the fastest axis and consists mostly of long runs
+	// of the same value along z (stone, air, zero auxiliar data), so, this simple encoding works well.
+	FlatRLE= 1,
+	// Run-length encoding of each column separately. Runs never cross column borders, so, run length fits into a byte.
+	// Columns equal to previous columns are encoded via single byte.
+	ColumnRLE= 2,
+	// zstd, optionally with a dictionary trained on chunks data of the world.
+	Zstd= 3,
+};
+
+constexpr uint32_t c_num_chunk_codecs= 4;
+
+// Layout of chunk auxiliar data before compression.
+// Values are stored in region files - do not change them.
+enum class AuxiliarDataLayout : uint16_t
+{
+	// Whole chunk auxiliar data array is compressed.
+	Dense= 0,
+	// Mask of columns with non-zero data followed by compressed data of these columns.
+	// Most blocks have no auxiliar data, so, this is much more compact and faster to compress.
+	SparseColumns= 1,
+};
+
+constexpr uint32_t c_num_auxiliar_data_layouts= 2;
+
+std::optional<ChunkCodec> StringToChunkCodec(std::string_view s);
+std::string_view ChunkCodecToString(ChunkCodec codec);
+
 struct ChunkDataCompresed
 {
+	ChunkCodec codec= ChunkCodec::Snappy;
+	AuxiliarDataLayout auxiliar_data_layout= AuxiliarDataLayout::Dense;
 	std::string blocks;
 	std::string auxiliar_data;
 };
 
+// Non-owning reference to compressed chunk data.
+struct ChunkDataCompresedView
+{
+	ChunkCodec codec= ChunkCodec::Snappy;
+	AuxiliarDataLayout auxiliar_data_layout= AuxiliarDataLayout::Dense;
+	std::string_view blocks;
+	std::string_view auxiliar_data;
+};
+
+// Dictionary for zstd codec, trained on chunks data.
+// Immutable, so, may be shared between threads.
+class ZstdDictionary
+{
+public:
+	// Returns null if given data isn't a valid dictionary.
+	static std::shared_ptr<const ZstdDictionary> Load(std::string data);
+
+	// Train dictionary on given samples of uncompressed data. Returns null on failure.
+	static std::shared_ptr<const ZstdDictionary> Train(const std::vector<std::string>& samples);
+
+	~ZstdDictionary();
+
+	ZstdDictionary(const ZstdDictionary&)= delete;
+	ZstdDictionary& operator=(const ZstdDictionary&)= delete;
+
+	const std::string& GetData() const;
+	// Id is stored in compressed data, in order to find proper dictionary for decompression.
+	uint32_t GetId() const;
+
+	ZSTD_CDict_s* GetCompressionDictionary() const;
+	ZSTD_DDict_s* GetDecompressionDictionary() const;
+
+private:
+	ZstdDictionary(std::string data, uint32_t id, ZSTD_CDict_s* compression_dictionary, ZSTD_DDict_s* decompression_dictionary);
+
+private:
+	const std::string data_;
+	const uint32_t id_;
+	ZSTD_CDict_s* const compression_dictionary_;
+	ZSTD_DDict_s* const decompression_dictionary_;
+};
+
 class ChunkDataCompressor
 {
 public:
+	ChunkDataCompressor();
+	~ChunkDataCompressor();
+
+	ChunkDataCompressor(const ChunkDataCompressor&)= delete;
+	ChunkDataCompressor& operator=(const ChunkDataCompressor&)= delete;
+
 	// Input arrays are both of "c_chunk_volume" size.
-	ChunkDataCompresed Compress(const BlockType* blocks_data, const uint8_t* blocks_auxiliar_data);
+	// Zstd dictionary is optional and is used only for zstd codec.
+	// Dense auxiliar data layout is normally not needed - it's supported for comparison.
+	ChunkDataCompresed Compress(
+		ChunkCodec codec,
+		const BlockType* blocks_data,
+		const uint8_t* blocks_auxiliar_data,
+		const ZstdDictionary* zstd_dictionary= nullptr,
+		AuxiliarDataLayout auxiliar_data_layout= AuxiliarDataLayout::SparseColumns);
 
 	// Fills provided buffers of "c_chunk_volume" size.
+	// Zstd dictionary is required if data was compressed using it.
 	// Returns true on success.
-	bool Decompress(const ChunkDataCompresed& data_compressed, BlockType* blocks_data, uint8_t* blocks_auxiliar_data);
+	bool Decompress(
+		const ChunkDataCompresed& data_compressed,
+		BlockType* blocks_data,
+		uint8_t* blocks_auxiliar_data,
+		const ZstdDictionary* zstd_dictionary= nullptr);
+
+	// Same as above, but doesn't require owning the data - it may be read directly from the storage.
+	bool Decompress(
+		const ChunkDataCompresedView& data_compressed,
+		BlockType* blocks_data,
+		uint8_t* blocks_auxiliar_data,
+		const ZstdDictionary* zstd_dictionary= nullptr);
+
+private:
+	void CompressRawBlocksArray(
+		ChunkCodec codec,
+		const char* in,
+		uint32_t in_size,
+		std::string& out,
+		const ZstdDictionary* zstd_dictionary);
+
+	bool UncompressRawBlocksArray(
+		ChunkCodec codec,
+		std::string_view in,
+		char* out,
+		uint32_t out_size,
+		const ZstdDictionary* zstd_dictionary);
+
+	bool DecompressSparseAuxiliarData(
+		const ChunkDataCompresedView& data_compressed,
+		uint8_t* blocks_auxiliar_data,
+		const ZstdDictionary* zstd_dictionary);
 
 private:
 	std::string temp_compress_buffer_;
+	std::vector<char> temp_columns_buffer_;
+
+	// Created lazily.
+	ZSTD_CCtx_s* zstd_compression_context_= nullptr;
+	ZSTD_DCtx_s* zstd_decompression_context_= nullptr;
 };
 
 } // namespace HexGPU
@@ -0,0 +1,41 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+
+namespace HexGPU
+{
+
+// Chunks activity tracking logic for the CPU side.
+// GLSL code from "chunks_activity.glsl" is included directly, so, the logic is exactly the same as in shaders.
+namespace ChunksActivityCPU
+{
+
+// Minimal shims for GLSL types and functions used in the included code.
+using uint= uint32_t;
+
+struct ivec2
+{
+	int32_t x= 0;
+	int32_t y= 0;
+};
+
+using std::max;
+using std::min;
+
+// Provides "IsChunkActive" function with inputs which are uniforms and buffers in shaders.
+struct Checker
+{
+	ivec2 world_size_chunks;
+	uint current_tick= 0;
+	uint inactive_chunks_update_period= 1;
+	// Whole double-buffered flags buffer, like in shaders.
+	const uint32_t* chunks_changed_flags= nullptr;
+
+#define CHUNKS_ACTIVITY_CHECK
+#include "shaders/inc/chunks_activity.glsl"
+#undef CHUNKS_ACTIVITY_CHECK
+};
+
+} // namespace ChunksActivityCPU
+
+} // namespace HexGPU
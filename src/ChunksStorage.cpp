@@ -1,21 +1,83 @@
 #include "ChunksStorage.hpp"
+#include "Constants.hpp"
 #include "Log.hpp"
 #include "Math.hpp"
 #include <algorithm>
 #include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
 
 namespace HexGPU
 {
 
+namespace
+{
+
+// Loading is mostly IO-bound, so, there is no reason to use many threads.
+constexpr uint32_t c_num_io_threads= 2;
+
+// Limit amount of memory used by regions pending for saving.
+// If this limit is reached - wait for saving of oldest regions.
+constexpr size_t c_max_regions_saving_data_size= 64 * 1024 * 1024;
+
+// Number of chunks used for zstd dictionary training.
+constexpr size_t c_zstd_dictionary_num_samples= 256;
+
+// Training is slow, so, run it after all regions loading tasks.
+constexpr uint32_t c_zstd_dictionary_training_priority= ~0u;
+
+// Conversion of cached regions isn't urgent - run it after regions loading tasks.
+constexpr uint32_t c_cached_region_conversion_priority= ~0u - 1u;
+
+size_t ReadRegionsCacheMaxDataSize(Settings& settings)
+{
+	const int32_t size_mb= std::max(0, std::min(int32_t(settings.GetOrSetInt("g_regions_cache_size_mb", 256)), 16384));
+	settings.SetInt("g_regions_cache_size_mb", size_mb);
+
+	return size_t(size_mb) * 1024 * 1024;
+}
+
+} // namespace
+
 ChunksStorage::ChunksStorage(Settings& settings)
 	: world_dir_path_(settings.GetOrSetString("g_world_dir", "world"))
+	, regions_cache_max_data_size_(ReadRegionsCacheMaxDataSize(settings))
+	, zstd_dictionary_(LoadZstdDictionary(GetZstdDictionaryFilePath()))
+	, io_thread_pool_(c_num_io_threads)
+	, saving_thread_pool_(1)
 {
 }
 
 ChunksStorage::~ChunksStorage()
 {
-	for(const auto& region_pair : regions_map_)
-		SaveRegion(region_pair.second, GetRegionFilePath(region_pair.first));
+	// Cancel all loading tasks, which are not started yet.
+	for(const auto& task_pair : regions_loading_tasks_)
+		task_pair.second.state->store(BackgroundTaskState::Canceled);
+
+	// Save all remaining modified regions using the same queue in order to preserve saving order.
+	// Don't put them into the cache, since it isn't needed anymore and its conversion tasks are just a waste of time.
+	for(auto& region_pair : regions_map_)
+	{
+		Region& region= region_pair.second;
+		if(!IsRegionModified(region))
+			continue;
+
+		DetachRegionFromFile(region);
+		StartRegionSaving(region_pair.first, std::make_shared<Region>(std::move(region)));
+	}
+	regions_map_.clear();
+
+	// Cached regions aren't needed anymore - cancel their conversion.
+	for(const CachedRegion& cached_region : regions_cache_)
+	{
+		if(cached_region.conversion_state != nullptr)
+			cached_region.conversion_state->store(BackgroundTaskState::Canceled);
+	}
+
+	// Drain the saving queue.
+	for(const RegionSavingTask& task : regions_saving_tasks_)
+		task.future.wait();
 }
 
 void ChunksStorage::SetActiveArea(const ChunkCoord start, const std::array<uint32_t, 2> size)
@@ -33,94 +95,143 @@ void ChunksStorage::SetActiveArea(const ChunkCoord start, const std::array<uint3
 		max_coord[0] + int32_t(c_world_region_size[0]),
 		max_coord[1] + int32_t(c_world_region_size[1]) };
 
+	const auto is_inside=
+		[&](const RegionCoord& region_coord)
+		{
+			return
+				region_coord[0] >= min_coord_extended[0] && region_coord[0] <= max_coord_extended[0] &&
+				region_coord[1] >= min_coord_extended[1] && region_coord[1] <= max_coord_extended[1];
+		};
+
+	TakeFinishedRegionsSaving();
+	TakeConvertedCachedRegions();
+
 	// Free regions which are no longer inside active area.
 	for(auto it= regions_map_.begin(); it != regions_map_.end();)
 	{
 		const RegionCoord& region_coord= it->first;
 
-		const bool inside=
-			region_coord[0] >= min_coord_extended[0] && region_coord[0] <= max_coord_extended[0] &&
-			region_coord[1] >= min_coord_extended[1] && region_coord[1] <= max_coord_extended[1];
-
-		if(inside)
+		if(is_inside(region_coord))
 		{
 			// Keep this region and continue iteration.
 			++it;
 		}
 		else
 		{
-			// Save this region, erase it from regions container and continue iteration.
-			SaveRegion(it->second, GetRegionFilePath(region_coord));
+			// Evict this region, erase it from regions container and continue iteration.
+			EvictRegion(region_coord, std::move(it->second));
 			it= regions_map_.erase(it);
 		}
 	}
 
-	// If previous async regions loading result is already there - take it.
-	// But for now do not force to wait for loading.
-	TakeRegionsLoadingTaskResultIfReady();
+	// Cancel loading of regions which are no longer needed.
+	for(auto it= regions_loading_tasks_.begin(); it != regions_loading_tasks_.end();)
+	{
+		if(is_inside(it->first))
+			++it;
+		else
+		{
+			// If the task is already in progress, just ignore its result.
+			// Its future doesn't block in destructor.
+			BackgroundTaskState expected_state= BackgroundTaskState::Pending;
+			it->second.state->compare_exchange_strong(expected_state, BackgroundTaskState::Canceled);
+			it= regions_loading_tasks_.erase(it);
+		}
+	}
+
+	// If some regions are already loaded - take them.
+	// But do not force to wait for loading.
+	TakeLoadedRegions();
+
+	// Start loading of new regions.
+	// Use distance to the center of the active area as priority - load nearest regions first.
+	const int32_t center[2]
+	{
+		start[0] + int32_t(size[0] / 2),
+		start[1] + int32_t(size[1] / 2),
+	};
 
-	// Check if we need to load new regions.
-	std::vector<RegionCoord> regions_to_load;
 	for(int32_t y= min_coord_extended[1]; y <= max_coord_extended[1]; y+= int32_t(c_world_region_size[1]))
 	for(int32_t x= min_coord_extended[0]; x <= max_coord_extended[0]; x+= int32_t(c_world_region_size[0]))
 	{
 		const RegionCoord region_coord{x, y};
 
-		if(regions_map_.count(region_coord) == 0)
-			regions_to_load.push_back(region_coord);
-	}
-
-	if(regions_to_load.empty())
-		return; // Nothing to load.
+		if(regions_map_.count(region_coord) != 0)
+			continue;
 
-	EnsureRegionsLoadingTaskFinished(); // End previous task if it's still running.
+		const int32_t dx= x + int32_t(c_world_region_size[0] / 2) - center[0];
+		const int32_t dy= y + int32_t(c_world_region_size[1] / 2) - center[1];
+		const uint32_t priority= uint32_t(dx * dx + dy * dy);
 
-	// Check for regions again. Some of them may be loaded in previous step, in such case remove them from the list.
-	regions_to_load.erase(
-		std::remove_if(
-			regions_to_load.begin(), regions_to_load.end(),
-			[this](const RegionCoord region_coord)
+		if(const auto it= regions_loading_tasks_.find(region_coord); it != regions_loading_tasks_.end())
+		{
+			// Priority of a task in the thread pool queue can't be changed.
+			// So, if the area was moved, cancel pending task and submit it again with new priority.
+			// Canceled task remains in the queue, but it finishes immediately.
+			if(it->second.priority != priority)
 			{
-				return regions_map_.count(region_coord) != 0;
-			}),
-		regions_to_load.end());
-
-	if(regions_to_load.empty())
-		return; // Nothing to load.
-
-	// Can start the task.
-	HEX_ASSERT(!regions_loading_future_.valid());
-
-	// std::async seems to be a dumb wrapper over std::thread creation.
-	// For now it's fine.
-	// But it may be too expensive to create a new thread for each loading task.
-	// So, consider using some thread pool library in the future.
+				BackgroundTaskState expected_state= BackgroundTaskState::Pending;
+				if(it->second.state->compare_exchange_strong(expected_state, BackgroundTaskState::Canceled))
+				{
+					regions_loading_tasks_.erase(it);
+					StartRegionLoading(region_coord, priority);
+				}
+			}
+			continue;
+		}
 
-	regions_loading_future_= std::async(
-		std::launch::async, // Start execution immideately in a background thread.
-		[this, regions_to_load= std::move(regions_to_load)]
+		// Restore the region from memory if possible.
+		// This is also necessary if the region file isn't saved yet.
+		if(auto evicted_region= TakeEvictedRegion(region_coord))
 		{
-			LoadedRegionsList loaded_regions;
-			loaded_regions.reserve(regions_to_load.size());
-			for(const RegionCoord& region_coord : regions_to_load)
-				loaded_regions.emplace_back(region_coord, LoadOrCreateNewRegion(GetRegionFilePath(region_coord)));
+			regions_map_.emplace(region_coord, std::move(*evicted_region));
+			continue;
+		}
 
-			return std::make_shared<LoadedRegionsList>(std::move(loaded_regions));
-		});
+		StartRegionLoading(region_coord, priority);
+	}
 }
 
 void ChunksStorage::SetChunk(const ChunkCoord chunk_coord, ChunkDataCompresed data_compressed)
 {
+	if(data_compressed.codec == ChunkCodec::Zstd &&
+		zstd_dictionary_ == nullptr &&
+		!zstd_dictionary_training_task_.valid())
+	{
+		zstd_dictionary_samples_.push_back(data_compressed);
+		if(zstd_dictionary_samples_.size() >= c_zstd_dictionary_num_samples)
+		{
+			zstd_dictionary_training_task_=
+				io_thread_pool_.Submit(
+					[samples= std::move(zstd_dictionary_samples_), file_path= GetZstdDictionaryFilePath()]
+					{
+						return TrainZstdDictionary(samples, file_path);
+					},
+					c_zstd_dictionary_training_priority);
+			zstd_dictionary_samples_.clear();
+		}
+	}
+
 	GetChunkData(chunk_coord)= std::move(data_compressed);
 }
 
-const ChunkDataCompresed* ChunksStorage::GetChunk(const ChunkCoord chunk_coord)
+std::optional<ChunkDataCompresedView> ChunksStorage::GetChunk(const ChunkCoord chunk_coord)
 {
-	const ChunkDataCompresed& chunk_data= GetChunkData(chunk_coord);
-	if(!chunk_data.blocks.empty() && !chunk_data.auxiliar_data.empty())
-		return &chunk_data;
+	const RegionCoord region_coord= GetRegionCoordForChunk(chunk_coord);
+	return GetRegionChunk(EnsureRegionLoaded(region_coord), GetChunkIndexWithinRegion(chunk_coord, region_coord));
+}
 
-	return nullptr;
+std::shared_ptr<const ZstdDictionary> ChunksStorage::GetZstdDictionary()
+{
+	if(zstd_dictionary_training_task_.valid() &&
+		zstd_dictionary_training_task_.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready)
+	{
+		zstd_dictionary_= zstd_dictionary_training_task_.get();
+		if(zstd_dictionary_ != nullptr)
+			Log::Info("Use new zstd dictionary with id ", zstd_dictionary_->GetId());
+	}
+
+	return zstd_dictionary_;
 }
 
 ChunksStorage::RegionCoord ChunksStorage::GetRegionCoordForChunk(const ChunkCoord chunk_coord)
@@ -132,12 +243,114 @@ ChunksStorage::RegionCoord ChunksStorage::GetRegionCoordForChunk(const ChunkCoor
 	return res;
 }
 
+uint32_t ChunksStorage::GetChunkIndexWithinRegion(const ChunkCoord chunk_coord, const RegionCoord region_coord)
+{
+	const int32_t coord_within_region[]
+	{
+		chunk_coord[0] - region_coord[0],
+		chunk_coord[1] - region_coord[1],
+	};
+	HEX_ASSERT(coord_within_region[0] >= 0 && coord_within_region[0] < int32_t(c_world_region_size[0]));
+	HEX_ASSERT(coord_within_region[1] >= 0 && coord_within_region[1] < int32_t(c_world_region_size[1]));
+
+	return uint32_t(coord_within_region[0]) + uint32_t(coord_within_region[1]) * c_world_region_size[0];
+}
+
+std::optional<ChunkDataCompresedView> ChunksStorage::GetRegionChunk(const Region& region, const uint32_t chunk_index)
+{
+	HEX_ASSERT(chunk_index < c_world_region_area);
+
+	const ChunkDataCompresed& chunk_data= region.chunks[chunk_index];
+	if(!chunk_data.blocks.empty() && !chunk_data.auxiliar_data.empty())
+		return ChunkDataCompresedView{chunk_data.codec, chunk_data.auxiliar_data_layout, chunk_data.blocks, chunk_data.auxiliar_data};
+
+	if(region.mapped_file != nullptr)
+	{
+		// Offsets and sizes are already validated.
+		const RegionFile::ChunkHeader& chunk_header= region.mapped_file->header.chunks[chunk_index];
+		if(chunk_header.block_data_size != 0 && chunk_header.auxiliar_data_size != 0)
+		{
+			const char* const file_data= region.mapped_file->file->GetData();
+			return
+				ChunkDataCompresedView
+				{
+					ChunkCodec(chunk_header.codec),
+					AuxiliarDataLayout(chunk_header.auxiliar_data_layout),
+					std::string_view(file_data + chunk_header.block_data_offset, chunk_header.block_data_size),
+					std::string_view(file_data + chunk_header.auxiliar_data_offset, chunk_header.auxiliar_data_size),
+				};
+		}
+	}
+
+	return std::nullopt;
+}
+
+bool ChunksStorage::IsRegionModified(const Region& region)
+{
+	if(region.matches_file)
+		return false;
+
+	if(region.mapped_file == nullptr)
+	{
+		// Region has no file.
+		return true;
+	}
+
+	for(const ChunkDataCompresed& chunk_data : region.chunks)
+	{
+		if(!chunk_data.blocks.empty() && !chunk_data.auxiliar_data.empty())
+			return true;
+	}
+
+	return false;
+}
+
+void ChunksStorage::DetachRegionFromFile(Region& region)
+{
+	if(region.mapped_file == nullptr)
+		return;
+
+	for(uint32_t i= 0; i < c_world_region_area; ++i)
+	{
+		ChunkDataCompresed& chunk_data= region.chunks[i];
+		if(!chunk_data.blocks.empty() && !chunk_data.auxiliar_data.empty())
+			continue;
+
+		if(const auto chunk_data_view= GetRegionChunk(region, i))
+		{
+			chunk_data.codec= chunk_data_view->codec;
+			chunk_data.auxiliar_data_layout= chunk_data_view->auxiliar_data_layout;
+			chunk_data.blocks= chunk_data_view->blocks;
+			chunk_data.auxiliar_data= chunk_data_view->auxiliar_data;
+		}
+	}
+
+	region.mapped_file= nullptr;
+}
+
+size_t ChunksStorage::GetRegionDataSize(const Region& region)
+{
+	size_t res= sizeof(Region);
+	for(const ChunkDataCompresed& chunk_data : region.chunks)
+		res+= chunk_data.blocks.size() + chunk_data.auxiliar_data.size();
+
+	// Mapped file may be fully loaded into memory.
+	if(region.mapped_file != nullptr)
+		res+= region.mapped_file->file->GetSize();
+
+	return res;
+}
+
 bool ChunksStorage::SaveRegion(const Region& region, const std::string& file_name)
 {
-	std::ofstream file(file_name, std::ios::binary);
+	// Write a temporary file first and then replace the region file with it.
+	// This way the region file remains valid even if saving is interrupted.
+	const std::string temp_file_name= file_name + ".tmp";
+
+	std::ofstream file(temp_file_name, std::ios::binary);
 	if(!file.is_open())
 	{
-		Log::Warning("Can't open file \"", file_name, "\"");
+		Log::Warning("Can't open file \"", temp_file_name, "\"");
 		return false;
 	}
 
@@ -154,20 +367,21 @@ bool ChunksStorage::SaveRegion(const Region& region, const std::string& file_nam
 
 	for(uint32_t i= 0; i < c_world_region_area; ++i)
 	{
-		const ChunkDataCompresed& chunk_data= region.chunks[i];
-		if(!chunk_data.blocks.empty() && !chunk_data.auxiliar_data.empty())
+		if(const auto chunk_data= GetRegionChunk(region, i))
 		{
 			RegionFile::ChunkHeader& chunk_header= file_header.chunks[i];
+			chunk_header.codec= uint16_t(chunk_data->codec);
+			chunk_header.auxiliar_data_layout= uint16_t(chunk_data->auxiliar_data_layout);
 
 			chunk_header.block_data_offset= offset;
-			chunk_header.block_data_size= uint32_t(chunk_data.blocks.size());
-			file.write(chunk_data.blocks.data(), std::streamsize(chunk_data.blocks.size()));
-			offset+= uint32_t(chunk_data.blocks.size());
+			chunk_header.block_data_size= uint32_t(chunk_data->blocks.size());
+			file.write(chunk_data->blocks.data(), std::streamsize(chunk_data->blocks.size()));
+			offset+= uint32_t(chunk_data->blocks.size());
 
 			chunk_header.auxiliar_data_offset= offset;
-			chunk_header.auxiliar_data_size= uint32_t(chunk_data.auxiliar_data.size());
-			file.write(chunk_data.auxiliar_data.data(), std::streamsize(chunk_data.auxiliar_data.size()));
-			offset+= uint32_t(chunk_data.auxiliar_data.size());
+			chunk_header.auxiliar_data_size= uint32_t(chunk_data->auxiliar_data.size());
+			file.write(chunk_data->auxiliar_data.data(), std::streamsize(chunk_data->auxiliar_data.size()));
+			offset+= uint32_t(chunk_data->auxiliar_data.size());
 		}
 	}
 
@@ -175,10 +389,18 @@ bool ChunksStorage::SaveRegion(const Region& region, const std::string& file_nam
 	file.seekp(0);
 	file.write(reinterpret_cast<const char*>(&file_header), sizeof(file_header));
 
-	file.flush();
+	file.close();
 	if(file.fail())
 	{
-		Log::Warning("Failed to flush region file!");
+		Log::Warning("Failed to write region file!");
+		return false;
+	}
+
+	std::error_code error_code;
+	std::filesystem::rename(temp_file_name, file_name, error_code);
+	if(error_code)
+	{
+		Log::Warning("Can't rename file \"", temp_file_name, "\" into \"", file_name, "\": ", error_code.message());
 		return false;
 	}
 
@@ -187,15 +409,26 @@ bool ChunksStorage::SaveRegion(const Region& region, const std::string& file_nam
 
 std::optional<ChunksStorage::Region> ChunksStorage::LoadRegion(const std::string& file_name)
 {
-	std::ifstream file(file_name, std::ios::binary);
-	if(!file.is_open())
+	// Map the file instead of reading it.
+	// This way only data of chunks actually used is read from disk.
+	std::unique_ptr<MemoryMappedFile> file= MemoryMappedFile::Open(file_name);
+	if(file == nullptr)
 	{
 		// No file found.
 		return std::nullopt;
 	}
 
-	RegionFile::FileHeader file_header;
-	file.read(reinterpret_cast<char*>(&file_header), sizeof(file_header));
+	// Id and version are placed at the same offsets in all format versions.
+	if(file->GetSize() < sizeof(RegionFile::LegacyFileHeader))
+	{
+		Log::Warning("File \"", file_name, "\" is too small");
+		return std::nullopt;
+	}
+
+	const auto mapped_region_file= std::make_shared<MappedRegionFile>();
+	RegionFile::FileHeader& file_header= mapped_region_file->header;
+	std::memcpy(&file_header.id, file->GetData(), sizeof(file_header.id));
+	std::memcpy(&file_header.version, file->GetData() + sizeof(file_header.id), sizeof(file_header.version));
 
 	if(std::memcmp(file_header.id, RegionFile::c_expected_id, sizeof(RegionFile::c_expected_id)) != 0)
 	{
@@ -203,34 +436,74 @@ std::optional<ChunksStorage::Region> ChunksStorage::LoadRegion(const std::string
 		return std::nullopt;
 	}
 
-	if(file_header.version != RegionFile::c_expected_version)
+	if(file_header.version == RegionFile::c_expected_version ||
+		file_header.version == RegionFile::c_version_without_auxiliar_data_layout)
+	{
+		if(file->GetSize() < sizeof(RegionFile::FileHeader))
+		{
+			Log::Warning("File \"", file_name, "\" is too small");
+			return std::nullopt;
+		}
+
+		std::memcpy(&file_header, file->GetData(), sizeof(file_header));
+
+		if(file_header.version == RegionFile::c_version_without_auxiliar_data_layout)
+		{
+			for(RegionFile::ChunkHeader& chunk_header : file_header.chunks)
+				chunk_header.auxiliar_data_layout= uint16_t(AuxiliarDataLayout::Dense);
+		}
+	}
+	else if(file_header.version == RegionFile::c_version_without_codec)
+	{
+		RegionFile::LegacyFileHeader legacy_file_header;
+		std::memcpy(&legacy_file_header, file->GetData(), sizeof(legacy_file_header));
+
+		for(uint32_t i= 0; i < c_world_region_area; ++i)
+		{
+			const RegionFile::LegacyChunkHeader& legacy_chunk_header= legacy_file_header.chunks[i];
+			RegionFile::ChunkHeader& chunk_header= file_header.chunks[i];
+			chunk_header.block_data_offset= legacy_chunk_header.block_data_offset;
+			chunk_header.block_data_size= legacy_chunk_header.block_data_size;
+			chunk_header.auxiliar_data_offset= legacy_chunk_header.auxiliar_data_offset;
+			chunk_header.auxiliar_data_size= legacy_chunk_header.auxiliar_data_size;
+			chunk_header.codec= uint16_t(ChunkCodec::Snappy);
+			chunk_header.auxiliar_data_layout= uint16_t(AuxiliarDataLayout::Dense);
+		}
+	}
+	else
 	{
 		Log::Warning("Region file version mismatch, expected ", RegionFile::c_expected_version, ", got ", file_header.version);
 		return std::nullopt;
 	}
 
-	// TODO - check for more file errors.
-	// TODO - add some checksum in order to ensure file contents is valid?
-
-	ChunksStorage::Region result_region;
-
-	for(uint32_t i= 0; i < c_world_region_area; ++i)
+	// Ensure chunks data is within the file, since it's accessed directly via the mapping.
+	const uint64_t file_size= file->GetSize();
+	for(RegionFile::ChunkHeader& chunk_header : file_header.chunks)
 	{
-		const RegionFile::ChunkHeader& chunk_header= file_header.chunks[i];
-		if(chunk_header.block_data_size != 0 && chunk_header.auxiliar_data_size != 0)
+		if(uint64_t(chunk_header.block_data_offset) + uint64_t(chunk_header.block_data_size) > file_size ||
+			uint64_t(chunk_header.auxiliar_data_offset) + uint64_t(chunk_header.auxiliar_data_size) > file_size)
 		{
-			ChunkDataCompresed& chunk_data= result_region.chunks[i];
-
-			chunk_data.blocks.resize(chunk_header.block_data_size);
-			file.seekg(chunk_header.block_data_offset);
-			file.read(chunk_data.blocks.data(), chunk_header.block_data_size);
-
-			chunk_data.auxiliar_data.resize(chunk_header.auxiliar_data_size);
-			file.seekg(chunk_header.auxiliar_data_offset);
-			file.read(chunk_data.auxiliar_data.data(), chunk_header.auxiliar_data_size);
+			Log::Warning("Invalid chunk data range in file \"", file_name, "\"");
+			chunk_header= RegionFile::ChunkHeader();
+		}
+		if(chunk_header.codec >= c_num_chunk_codecs)
+		{
+			Log::Warning("Unknown chunk codec ", chunk_header.codec, " in file \"", file_name, "\"");
+			chunk_header= RegionFile::ChunkHeader();
+		}
+		if(chunk_header.auxiliar_data_layout >= c_num_auxiliar_data_layouts)
+		{
+			Log::Warning("Unknown auxiliar data layout ", chunk_header.auxiliar_data_layout, " in file \"", file_name, "\"");
+			chunk_header= RegionFile::ChunkHeader();
 		}
 	}
 
+	// TODO - add some checksum in order to ensure file contents is valid?
+
+	mapped_region_file->file= std::move(file);
+
+	ChunksStorage::Region result_region;
+	result_region.mapped_file= mapped_region_file;
 	return result_region;
 }
 
@@ -243,40 +516,83 @@ ChunksStorage::Region ChunksStorage::LoadOrCreateNewRegion(const std::string& fi
 	return Region();
 }
 
+ChunksStorage::Region ChunksStorage::ConvertRegionForCache(const Region& region, const ZstdDictionary* const zstd_dictionary)
+{
+	// Compressor isn't thread-safe, so, use separate compressor for each thread.
+	thread_local ChunkDataCompressor compressor;
+	thread_local std::vector<BlockType> blocks_data(c_chunk_volume);
+	thread_local std::vector<uint8_t> blocks_auxiliar_data(c_chunk_volume);
+
+	Region result;
+	result.matches_file= !IsRegionModified(region);
+
+	for(uint32_t i= 0; i < c_world_region_area; ++i)
+	{
+		const auto chunk_data_view= GetRegionChunk(region, i);
+		if(chunk_data_view == std::nullopt)
+			continue;
+
+		// Decompress directly from the source region, take a copy only if data is kept as is.
+		if(chunk_data_view->codec != ChunkCodec::ColumnRLE &&
+			compressor.Decompress(*chunk_data_view, blocks_data.data(), blocks_auxiliar_data.data(), zstd_dictionary))
+			result.chunks[i]= compressor.Compress(ChunkCodec::ColumnRLE, blocks_data.data(), blocks_auxiliar_data.data());
+		else
+		{
+			// Keep data as is if it's already converted or can't be decompressed.
+			result.chunks[i]=
+				ChunkDataCompresed
+				{
+					chunk_data_view->codec,
+					chunk_data_view->auxiliar_data_layout,
+					std::string(chunk_data_view->blocks),
+					std::string(chunk_data_view->auxiliar_data),
+				};
+		}
+	}
+
+	return result;
+}
+
 ChunkDataCompresed& ChunksStorage::GetChunkData(const ChunkCoord chunk_coord)
 {
 	const RegionCoord region_coord= GetRegionCoordForChunk(chunk_coord);
 	Region& region= EnsureRegionLoaded(region_coord);
 
-	const int32_t coord_within_region[]
-	{
-		chunk_coord[0] - region_coord[0],
-		chunk_coord[1] - region_coord[1],
-	};
-	HEX_ASSERT(coord_within_region[0] >= 0 && coord_within_region[0] < int32_t(c_world_region_size[0]));
-	HEX_ASSERT(coord_within_region[1] >= 0 && coord_within_region[1] < int32_t(c_world_region_size[1]));
+	// Chunk data is going to be changed.
+	region.matches_file= false;
 
-	const uint32_t chunk_index=
-		uint32_t(coord_within_region[0]) + uint32_t(coord_within_region[1]) * c_world_region_size[0];
-
-	return region.chunks[chunk_index];
+	return region.chunks[GetChunkIndexWithinRegion(chunk_coord, region_coord)];
 }
 
 ChunksStorage::Region& ChunksStorage::EnsureRegionLoaded(const RegionCoord region_coord)
 {
-	if(regions_map_.count(region_coord) == 0)
-	{
-		// If we have no such region and regions loading task is running - wait for finish.
-		// Normally this should not happen, because regions loading should be started in advance.
-		EnsureRegionsLoadingTaskFinished();
-	}
-
 	if(const auto it= regions_map_.find(region_coord); it != regions_map_.end())
 	{
 		// Already has this region.
 		return it->second;
 	}
 
+	// Normally this should not happen, because regions loading should be started in advance.
+	if(const auto it= regions_loading_tasks_.find(region_coord); it != regions_loading_tasks_.end())
+	{
+		BackgroundTaskState expected_state= BackgroundTaskState::Pending;
+		if(it->second.state->compare_exchange_strong(expected_state, BackgroundTaskState::Canceled))
+		{
+			// Loading isn't started yet - cancel the task and load the region below.
+			regions_loading_tasks_.erase(it);
+		}
+		else
+		{
+			// Loading is in progress - wait only for this region.
+			Region region= it->second.future.get();
+			regions_loading_tasks_.erase(it);
+			return regions_map_.emplace(region_coord, std::move(region)).first->second;
+		}
+	}
+
+	if(auto evicted_region= TakeEvictedRegion(region_coord))
+		return regions_map_.emplace(region_coord, std::move(*evicted_region)).first->second;
+
 	// Fallback - synchronously load the region or create new.
 	return regions_map_.emplace(region_coord, LoadOrCreateNewRegion(GetRegionFilePath(region_coord))).first->second;
 }
@@ -294,45 +610,278 @@ std::string ChunksStorage::GetRegionFilePath(const RegionCoord region_coord) con
 	return res;
 }
 
-void ChunksStorage::TakeRegionsLoadingTaskResultIfReady()
+void ChunksStorage::StartRegionLoading(const RegionCoord region_coord, const uint32_t priority)
 {
-	if(!regions_loading_future_.valid())
-		return;
+	HEX_ASSERT(regions_map_.count(region_coord) == 0);
+	HEX_ASSERT(regions_loading_tasks_.count(region_coord) == 0);
+
+	RegionLoadingTask task;
+	task.state= std::make_shared<std::atomic<BackgroundTaskState>>(BackgroundTaskState::Pending);
+	task.priority= priority;
+	task.future=
+		io_thread_pool_.Submit(
+			[state= task.state, file_path= GetRegionFilePath(region_coord)]
+			{
+				BackgroundTaskState expected_state= BackgroundTaskState::Pending;
+				if(!state->compare_exchange_strong(expected_state, BackgroundTaskState::InProgress))
+					return Region(); // Canceled.
 
-	const std::future_status status= regions_loading_future_.wait_for(std::chrono::milliseconds(0));
-	if(status != std::future_status::ready)
-		return;
+				return LoadOrCreateNewRegion(file_path);
+			},
+			priority);
 
-	PopulateRegionsMap(regions_loading_future_.get());
+	regions_loading_tasks_.emplace(region_coord, std::move(task));
+}
 
-	// Reset future to indicate it's unactive.
-	regions_loading_future_= RegionsLoadingFuture();
-	HEX_ASSERT(!regions_loading_future_.valid());
+void ChunksStorage::TakeLoadedRegions()
+{
+	for(auto it= regions_loading_tasks_.begin(); it != regions_loading_tasks_.end();)
+	{
+		if(it->second.future.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready)
+		{
+			HEX_ASSERT(regions_map_.count(it->first) == 0);
+			regions_map_.emplace(it->first, it->second.future.get());
+			it= regions_loading_tasks_.erase(it);
+		}
+		else
+			++it;
+	}
 }
 
-void ChunksStorage::EnsureRegionsLoadingTaskFinished()
+void ChunksStorage::EvictRegion(const RegionCoord region_coord, Region region)
 {
-	if(!regions_loading_future_.valid())
-		return;
+	// Save region only if its file isn't already up to date.
+	if(IsRegionModified(region))
+	{
+		// Saving replaces the region file, so, the region should not reference it anymore.
+		DetachRegionFromFile(region);
+
+		const auto region_ptr= std::make_shared<Region>(std::move(region));
+		StartRegionSaving(region_coord, region_ptr);
+		AddRegionToCache(region_coord, region_ptr);
+	}
+	else
+		AddRegionToCache(region_coord, std::make_shared<Region>(std::move(region)));
+}
+
+std::optional<ChunksStorage::Region> ChunksStorage::TakeEvictedRegion(const RegionCoord region_coord)
+{
+	// Cached region (if exists) is always the latest region state, since it's removed from the cache on restoring.
+	for(auto it= regions_cache_.begin(); it != regions_cache_.end(); ++it)
+	{
+		if(it->region_coord != region_coord)
+			continue;
+
+		std::optional<Region> result;
+		if(it->conversion_state != nullptr)
+		{
+			BackgroundTaskState expected_state= BackgroundTaskState::Pending;
+			if(!it->conversion_state->compare_exchange_strong(expected_state, BackgroundTaskState::Canceled))
+			{
+				// Conversion is in progress or finished - wait for it.
+				result= it->conversion_task.get();
+			}
+		}
+
+		if(result == std::nullopt)
+		{
+			if(it->region.use_count() == 1)
+			{
+				// Not used by a saving or conversion task anymore - can move it.
+				result= std::move(*it->region);
+			}
+			else
+				result= *it->region;
+		}
+
+		HEX_ASSERT(regions_cache_data_size_ >= it->data_size);
+		regions_cache_data_size_-= it->data_size;
+		regions_cache_.erase(it);
+
+		return result;
+	}
+
+	// Region may be already removed from the cache, but still pending for saving.
+	if(const Region* const region_pending_for_saving= GetRegionPendingForSaving(region_coord))
+		return *region_pending_for_saving;
+
+	return std::nullopt;
+}
+
+void ChunksStorage::StartRegionSaving(const RegionCoord region_coord, std::shared_ptr<const Region> region)
+{
+	HEX_ASSERT(region->mapped_file == nullptr);
 
-	regions_loading_future_.wait();
+	// Apply back-pressure - wait for oldest saving tasks if too much memory is used.
+	const size_t data_size= GetRegionDataSize(*region);
+	while(!regions_saving_tasks_.empty() &&
+		regions_saving_tasks_data_size_ + data_size > c_max_regions_saving_data_size)
+	{
+		regions_saving_tasks_.front().future.wait();
+		TakeFinishedRegionsSaving();
+	}
 
-	PopulateRegionsMap(regions_loading_future_.get());
+	RegionSavingTask task;
+	task.region_coord= region_coord;
+	task.region= std::move(region);
+	task.data_size= data_size;
+	task.future=
+		saving_thread_pool_.Submit(
+			[region= task.region, file_path= GetRegionFilePath(region_coord)]
+			{
+				return SaveRegion(*region, file_path);
+			});
 
-	// Reset future to indicate it's unactive.
-	regions_loading_future_= RegionsLoadingFuture();
-	HEX_ASSERT(!regions_loading_future_.valid());
+	regions_saving_tasks_data_size_+= data_size;
+	regions_saving_tasks_.push_back(std::move(task));
 }
 
-void ChunksStorage::PopulateRegionsMap(const LoadedRegionsListPtr loaded_regions)
+void ChunksStorage::TakeFinishedRegionsSaving()
 {
-	HEX_ASSERT(loaded_regions != nullptr);
+	// Saving tasks are executed in order, so, it's enough to check only first tasks.
+	while(!regions_saving_tasks_.empty() &&
+		regions_saving_tasks_.front().future.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready)
+	{
+		HEX_ASSERT(regions_saving_tasks_data_size_ >= regions_saving_tasks_.front().data_size);
+		regions_saving_tasks_data_size_-= regions_saving_tasks_.front().data_size;
+		regions_saving_tasks_.pop_front();
+	}
+}
 
-	for(auto& loaded_region : *loaded_regions)
+const ChunksStorage::Region* ChunksStorage::GetRegionPendingForSaving(const RegionCoord region_coord) const
+{
+	// Search from the end in order to find the latest region state.
+	for(auto it= regions_saving_tasks_.rbegin(); it != regions_saving_tasks_.rend(); ++it)
 	{
-		HEX_ASSERT(regions_map_.count(loaded_region.first) == 0);
-		regions_map_.emplace(loaded_region.first, std::move(loaded_region.second));
+		if(it->region_coord == region_coord)
+			return it->region.get();
 	}
+
+	return nullptr;
+}
+
+void ChunksStorage::AddRegionToCache(const RegionCoord region_coord, std::shared_ptr<Region> region)
+{
+	CachedRegion cached_region;
+	cached_region.region_coord= region_coord;
+	cached_region.data_size= GetRegionDataSize(*region);
+	cached_region.conversion_state= std::make_shared<std::atomic<BackgroundTaskState>>(BackgroundTaskState::Pending);
+	cached_region.conversion_task=
+		io_thread_pool_.Submit(
+			[state= cached_region.conversion_state, region, zstd_dictionary= GetZstdDictionary()]
+			{
+				BackgroundTaskState expected_state= BackgroundTaskState::Pending;
+				if(!state->compare_exchange_strong(expected_state, BackgroundTaskState::InProgress))
+					return Region(); // Canceled.
+
+				return ConvertRegionForCache(*region, zstd_dictionary.get());
+			},
+			c_cached_region_conversion_priority);
+	cached_region.region= std::move(region);
+
+	regions_cache_data_size_+= cached_region.data_size;
+	regions_cache_.push_back(std::move(cached_region));
+
+	// Update sizes of converted regions before checking the cache size.
+	TakeConvertedCachedRegions();
+
+	// Free least recently evicted regions if the cache is too large.
+	while(!regions_cache_.empty() && regions_cache_data_size_ > regions_cache_max_data_size_)
+	{
+		CachedRegion& oldest_cached_region= regions_cache_.front();
+		if(oldest_cached_region.conversion_state != nullptr)
+			oldest_cached_region.conversion_state->store(BackgroundTaskState::Canceled);
+
+		HEX_ASSERT(regions_cache_data_size_ >= oldest_cached_region.data_size);
+		regions_cache_data_size_-= oldest_cached_region.data_size;
+		regions_cache_.pop_front();
+	}
+}
+
+void ChunksStorage::TakeConvertedCachedRegions()
+{
+	for(CachedRegion& cached_region : regions_cache_)
+	{
+		if(cached_region.conversion_state == nullptr ||
+			cached_region.conversion_task.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready)
+			continue;
+
+		// Original region data is freed here, unless it's still used by a saving task.
+		cached_region.region= std::make_shared<Region>(cached_region.conversion_task.get());
+		cached_region.conversion_state= nullptr;
+
+		const size_t data_size= GetRegionDataSize(*cached_region.region);
+		HEX_ASSERT(regions_cache_data_size_ >= cached_region.data_size);
+		regions_cache_data_size_= regions_cache_data_size_ - cached_region.data_size + data_size;
+		cached_region.data_size= data_size;
+	}
+}
+
+std::string ChunksStorage::GetZstdDictionaryFilePath() const
+{
+	return world_dir_path_ + "/chunks_zstd_dictionary.bin";
+}
+
+std::shared_ptr<const ZstdDictionary> ChunksStorage::LoadZstdDictionary(const std::string& file_path)
+{
+	std::ifstream file(file_path, std::ios::binary);
+	if(!file.is_open())
+	{
+		// No dictionary yet.
+		return nullptr;
+	}
+
+	std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	std::shared_ptr<const ZstdDictionary> dictionary= ZstdDictionary::Load(std::move(data));
+	if(dictionary == nullptr)
+	{
+		Log::Warning("Can't load zstd dictionary from file \"", file_path, "\"");
+		return nullptr;
+	}
+
+	Log::Info("Loaded zstd dictionary with id ", dictionary->GetId());
+	return dictionary;
+}
+
+std::shared_ptr<const ZstdDictionary> ChunksStorage::TrainZstdDictionary(
+	const std::vector<ChunkDataCompresed>& samples,
+	const std::string& file_path)
+{
+	// Train only on blocks data - auxiliar data is much smaller and mostly sparse.
+	ChunkDataCompressor compressor;
+	std::vector<std::string> samples_uncompressed;
+	std::string blocks_data(c_chunk_volume, '\0');
+	std::string blocks_auxiliar_data(c_chunk_volume, '\0');
+	for(const ChunkDataCompresed& sample : samples)
+	{
+		if(compressor.Decompress(
+				sample,
+				reinterpret_cast<BlockType*>(blocks_data.data()),
+				reinterpret_cast<uint8_t*>(blocks_auxiliar_data.data())))
+			samples_uncompressed.push_back(blocks_data);
+	}
+
+	std::shared_ptr<const ZstdDictionary> dictionary= ZstdDictionary::Train(samples_uncompressed);
+	if(dictionary == nullptr)
+		return nullptr;
+
+	// Write a temporary file first, like for regions.
+	const std::string temp_file_path= file_path + ".tmp";
+	std::ofstream file(temp_file_path, std::ios::binary);
+	file.write(dictionary->GetData().data(), std::streamsize(dictionary->GetData().size()));
+	file.close();
+
+	std::error_code error_code;
+	if(!file.fail())
+		std::filesystem::rename(temp_file_path, file_path, error_code);
+	if(file.fail() || error_code)
+	{
+		// Chunks compressed with a dictionary which isn't saved can't be loaded later.
+		Log::Warning("Can't save zstd dictionary into file \"", file_path, "\"");
+		return nullptr;
+	}
+
+	return dictionary;
 }
 
 } // namespace HexGPU
@@ -1,11 +1,14 @@
 #pragma once
 #include "ChunkDataCompressor.hpp"
+#include "MemoryMappedFile.hpp"
 #include "Settings.hpp"
+#include "ThreadPool.hpp"
 #include "WorldSaveLoad.hpp"
 #include <array>
+#include <atomic>
+#include <deque>
 #include <optional>
 #include <unordered_map>
-#include <future>
 
 namespace HexGPU
 {
@@ -22,13 +25,19 @@ public:
 
 	// Set current area of the world.
 	// This may trigger regions loading and saving.
+	// Regions leaving the area are kept in memory cache for some time.
 	void SetActiveArea(ChunkCoord start, std::array<uint32_t, 2> size);
 
 	void SetChunk(ChunkCoord chunk_coord, ChunkDataCompresed data_compressed);
 
-	// Returns non-null if has data for given chunk.
-	// Result remains valid until next "SetActiveArea" call.
-	const ChunkDataCompresed* GetChunk(ChunkCoord chunk_coord);
+	// Returns non-empty result if has data for given chunk.
+	// Result remains valid until next "SetActiveArea" call or "SetChunk" call for this chunk.
+	std::optional<ChunkDataCompresedView> GetChunk(ChunkCoord chunk_coord);
+
+	// Dictionary for zstd codec, stored in the world directory. May be null.
+	// If the world has no dictionary, it's trained in background on first chunks compressed via zstd.
+	// Dictionary may be used for compression of new chunks and is required for decompression of chunks compressed with it.
+	std::shared_ptr<const ZstdDictionary> GetZstdDictionary();
 
 private:
 	// Global coordinates of the first chunk.
@@ -45,20 +54,79 @@ private:
 		}
 	};
 
+	struct MappedRegionFile
+	{
+		std::unique_ptr<MemoryMappedFile> file;
+		// Validated copy of the file header, converted to the current format version.
+		RegionFile::FileHeader header;
+	};
+
 	struct Region
 	{
+		// Data of chunks set after region loading.
+		// If data for a chunk is empty - data from the mapped region file is used.
 		ChunkDataCompresed chunks[c_world_region_area];
+
+		// May be null if there is no file for this region.
+		// Shared, since region may be copied.
+		std::shared_ptr<const MappedRegionFile> mapped_file;
+
+		// Set if chunks data was converted from the region file contents and wasn't changed since that.
+		bool matches_file= false;
+	};
+
+	// State of a region loading or conversion task.
+	enum class BackgroundTaskState : uint8_t
+	{
+		Pending,
+		InProgress,
+		Canceled,
+	};
+
+	struct RegionLoadingTask
+	{
+		// Shared between the main thread and a loading thread.
+		std::shared_ptr<std::atomic<BackgroundTaskState>> state;
+		std::future<Region> future;
+		// Priority used for submission into the thread pool.
+		uint32_t priority= 0;
+	};
+
+	struct RegionSavingTask
+	{
+		RegionCoord region_coord;
+		// Keep region data until saving is finished - in order to restore it without reading the file.
+		std::shared_ptr<const Region> region;
+		size_t data_size= 0;
+		std::future<bool> future;
 	};
 
-	using LoadedRegionsList= std::vector<std::pair<RegionCoord, Region>>;
-	using LoadedRegionsListPtr= std::shared_ptr<LoadedRegionsList>; // Use shared_ptr, because future::get returns copy, which is expensive
-	using RegionsLoadingFuture= std::future<LoadedRegionsListPtr>;
+	struct CachedRegion
+	{
+		RegionCoord region_coord;
+		// May be shared with a saving task.
+		// Replaced with the conversion result when it's finished.
+		std::shared_ptr<Region> region;
+		// Conversion of the region into the in-memory format, running in background.
+		// Shared between the main thread and a conversion thread.
+		std::shared_ptr<std::atomic<BackgroundTaskState>> conversion_state;
+		std::future<Region> conversion_task;
+		size_t data_size= 0;
+	};
 
 private:
 	static RegionCoord GetRegionCoordForChunk(ChunkCoord chunk_coord);
+	static uint32_t GetChunkIndexWithinRegion(ChunkCoord chunk_coord, RegionCoord region_coord);
+	static std::optional<ChunkDataCompresedView> GetRegionChunk(const Region& region, uint32_t chunk_index);
+	static bool IsRegionModified(const Region& region);
+	// Copies all chunks data from the mapped file into region itself and releases the mapping.
+	static void DetachRegionFromFile(Region& region);
+	static size_t GetRegionDataSize(const Region& region);
 	static bool SaveRegion(const Region& region, const std::string& file_name);
 	static std::optional<Region> LoadRegion(const std::string& file_name);
 	static Region LoadOrCreateNewRegion(const std::string& file_name);
+	// Converts all chunks of the region into the in-memory format and releases the mapped file.
+	static Region ConvertRegionForCache(const Region& region, const ZstdDictionary* zstd_dictionary);
 
 	// Finds region for given chunk and returns chunk data structure within this region.
 	ChunkDataCompresed& GetChunkData(ChunkCoord chunk_coord);
@@ -67,15 +135,57 @@ private:
 
 	std::string GetRegionFilePath(RegionCoord region_coord) const;
 
-	void TakeRegionsLoadingTaskResultIfReady();
-	void EnsureRegionsLoadingTaskFinished();
-	void PopulateRegionsMap(LoadedRegionsListPtr loaded_regions);
+	void StartRegionLoading(RegionCoord region_coord, uint32_t priority);
+	void TakeLoadedRegions();
+
+	// Saves region (if necessary) and puts it into the cache.
+	void EvictRegion(RegionCoord region_coord, Region region);
+	// Returns region if it's cached or pending for saving.
+	std::optional<Region> TakeEvictedRegion(RegionCoord region_coord);
+
+	void StartRegionSaving(RegionCoord region_coord, std::shared_ptr<const Region> region);
+	void TakeFinishedRegionsSaving();
+	// Returns null if this region isn't pending for saving.
+	const Region* GetRegionPendingForSaving(RegionCoord region_coord) const;
+
+	void AddRegionToCache(RegionCoord region_coord, std::shared_ptr<Region> region);
+	void TakeConvertedCachedRegions();
+
+	std::string GetZstdDictionaryFilePath() const;
+	static std::shared_ptr<const ZstdDictionary> LoadZstdDictionary(const std::string& file_path);
+	static std::shared_ptr<const ZstdDictionary> TrainZstdDictionary(
+		const std::vector<ChunkDataCompresed>& samples,
+		const std::string& file_path);
 
 private:
 	const std::string world_dir_path_;
+	const size_t regions_cache_max_data_size_;
 	std::unordered_map<ChunkCoord, Region, RegionCoordHasher> regions_map_;
 
-	RegionsLoadingFuture regions_loading_future_;
+	// Each region is loaded in a separate task, so that a slow region doesn't block others.
+	std::unordered_map<RegionCoord, RegionLoadingTask, RegionCoordHasher> regions_loading_tasks_;
+
+	// Regions evicted from the active area are saved in background.
+	// Tasks are listed in submission order.
+	std::deque<RegionSavingTask> regions_saving_tasks_;
+	size_t regions_saving_tasks_data_size_= 0;
+
+	// Regions evicted from the active area, from least to most recently evicted.
+	// Keep them in memory in order to avoid reading them from disk again if player returns back.
+	// Chunks of cached regions are converted into column RLE format, which is compact and fast to decompress.
+	std::deque<CachedRegion> regions_cache_;
+	size_t regions_cache_data_size_= 0;
+
+	std::shared_ptr<const ZstdDictionary> zstd_dictionary_;
+	// Chunks compressed via zstd without a dictionary, collected for dictionary training.
+	std::vector<ChunkDataCompresed> zstd_dictionary_samples_;
+	std::future<std::shared_ptr<const ZstdDictionary>> zstd_dictionary_training_task_;
+
+	// Long-lived pool for regions loading.
+	ThreadPool io_thread_pool_;
+
+	// Use single thread for saving, so that saving tasks for the same region are executed in order.
+	ThreadPool saving_thread_pool_;
 };
 
 } // namespace HexGPU
@@ -121,6 +121,7 @@ void CloudsTextureGenerator::PrepareFrame(TaskOrganizer& task_organizer)
 	generated_= true;
 
 	TaskOrganizer::ComputeTaskParams task;
+	task.name= "clouds_texture_gen";
 	task.output_images.push_back(GetImageInfo());
 
 	const auto task_func=
@@ -15,4 +15,20 @@ constexpr uint32_t c_chunk_height= 1 << c_chunk_height_log2;
 // In blocks.
 constexpr uint32_t c_chunk_volume= c_chunk_width * c_chunk_width * c_chunk_height;
 
+// If this changed, GLSL code must be changed too!
+
+constexpr int32_t c_fire_light_mask= 0x0F;
+constexpr int32_t c_sky_light_mask= 0xF0;
+constexpr int32_t c_sky_light_shift= 4;
+
+constexpr int32_t c_max_sky_light= 15;
+
+constexpr int32_t c_max_water_level= 255;
+
+constexpr int32_t c_max_foliage_factor= 6;
+
+constexpr int32_t c_initial_fire_power= 1;
+constexpr int32_t c_min_fire_power_for_fire_to_spread= 32;
+constexpr int32_t c_min_fire_power_for_blocks_burning= 64;
+
 } // namespace HexGPU
@@ -0,0 +1,43 @@
+#include "CpuFeatures.hpp"
+
+#if defined(HEX_AVX2) && defined(_MSC_VER) && !defined(__clang__)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace HexGPU
+{
+
+namespace
+{
+
+bool CheckAVX2Support()
+{
+#if !defined(HEX_AVX2)
+	return false;
+#elif defined(_MSC_VER) && !defined(__clang__)
+	int info[4]{};
+	__cpuid(info, 1);
+	// OS should support saving of AVX registers.
+	const bool os_uses_xsave= (info[2] & (1 << 27)) != 0;
+	const bool cpu_supports_avx= (info[2] & (1 << 28)) != 0;
+	if(!os_uses_xsave || !cpu_supports_avx || (_xgetbv(0) & 6) != 6)
+		return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	// This checks also OS support.
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+} // namespace
+
+bool CpuSupportsAVX2()
+{
+	static const bool supported= CheckAVX2Support();
+	return supported;
+}
+
+} // namespace HexGPU
@@ -0,0 +1,28 @@
+#pragma once
+
+// x86 SIMD support.
+// SSE2 is always available on x86-64, so, it's used directly.
+// AVX2 isn't enabled for the whole project (in order to run on older CPUs) - functions using it are compiled
+// with "HEX_TARGET_AVX2" attribute and are called only if "CpuSupportsAVX2" returns true.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HEX_SSE2
+#endif
+
+#if defined(HEX_SSE2)
+#define HEX_AVX2
+#if defined(_MSC_VER) && !defined(__clang__)
+// MSVC allows usage of any intrinsics without special options.
+#define HEX_TARGET_AVX2
+#else
+#define HEX_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace HexGPU
+{
+
+// Result is calculated once.
+bool CpuSupportsAVX2();
+
+} // namespace HexGPU
@@ -1,4 +1,6 @@
 #include "GPUAllocator.hpp"
+#include "Assert.hpp"
+#include "GPUAllocatorCPU.hpp"
 
 namespace HexGPU
 {
@@ -8,9 +10,8 @@ namespace
 
 uint32_t CalculateAllocatorDataSize(const uint32_t total_memory_units)
 {
-	const uint32_t num_blocks= (total_memory_units + 31) / 32; // Round-up.
-	// 1 uint for size and uints for blocks.
-	return uint32_t(sizeof(uint32_t)) + num_blocks * uint32_t(sizeof(uint32_t));
+	// Data layout is the same as in CPU allocator.
+	return uint32_t(GPUAllocatorCPU::MakeInitialData(total_memory_units).size() * sizeof(uint32_t));
 }
 
 } // namespace
@@ -47,14 +48,14 @@ void GPUAllocator::EnsureInitialized(TaskOrganizer& task_organizer)
 	initialized_= true;
 
 	TaskOrganizer::TransferTaskParams task;
+	task.name= "gpu_allocator_init";
 	task.output_buffers.push_back(allocator_data_buffer_.GetBuffer());
 
 	const auto task_func=
 		[this](const vk::CommandBuffer command_buffer)
 		{
-			std::vector<uint32_t> data;
-			data.resize(allocator_data_buffer_.GetSize() / sizeof(uint32_t), uint32_t(0)); // Fill with zeros - indicating free memory.
-			data[0]= total_memory_units_; // Set size.
+			const std::vector<uint32_t> data= GPUAllocatorCPU::MakeInitialData(total_memory_units_);
+			HEX_ASSERT(data.size() * sizeof(uint32_t) == allocator_data_buffer_.GetSize());
 
 			command_buffer.updateBuffer(allocator_data_buffer_.GetBuffer(), 0u, allocator_data_buffer_.GetSize(), data.data());
 		};
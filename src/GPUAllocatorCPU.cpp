@@ -0,0 +1,254 @@
+#include "GPUAllocatorCPU.hpp"
+#include "Assert.hpp"
+#include <algorithm>
+
+namespace HexGPU
+{
+
+namespace
+{
+
+// Analogues of GLSL functions.
+
+uint32_t BitCount(uint32_t x)
+{
+	x= x - ((x >> 1) & 0x55555555u);
+	x= (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+	x= (x + (x >> 4)) & 0x0F0F0F0Fu;
+	return (x * 0x01010101u) >> 24;
+}
+
+// Argument should be non-zero.
+uint32_t FindLSB(const uint32_t x)
+{
+	HEX_ASSERT(x != 0);
+
+	uint32_t result= 0;
+	while((x & (1u << result)) == 0)
+		++result;
+	return result;
+}
+
+uint32_t CalculateNumBlocks(const uint32_t total_memory_units)
+{
+	return (total_memory_units + 31) >> 5;
+}
+
+uint32_t CalculateNumSummaryWords(const uint32_t num_blocks)
+{
+	return (num_blocks + 31) >> 5;
+}
+
+uint32_t GetUnitsMask(const uint32_t size_units)
+{
+	// Contains number of one bits equal to size.
+	return size_units == 32 ? 0xFFFFFFFFu : ((1u << size_units) - 1u);
+}
+
+// Returns mask with bits set for each start position of continuous span of "size_units" zero bits.
+uint32_t FindFreeRanges(const uint32_t block_bits, const uint32_t size_units)
+{
+	// Shift free bits mask in order to combine it with itself.
+	// Doubling span length each step gives logarithmic complexity.
+	uint32_t result= ~block_bits;
+	uint32_t span_length= 1;
+	while(span_length < size_units && result != 0)
+	{
+		const uint32_t shift= std::min(span_length, size_units - span_length);
+		result&= result >> shift;
+		span_length+= shift;
+	}
+
+	return result;
+}
+
+} // namespace
+
+GPUAllocatorCPU::GPUAllocatorCPU(const uint32_t total_memory_units)
+	: total_memory_units_(total_memory_units)
+	, num_blocks_(CalculateNumBlocks(total_memory_units))
+	, data_(new std::atomic<uint32_t>[num_blocks_ + CalculateNumSummaryWords(num_blocks_)])
+{
+	const std::vector<uint32_t> initial_data= MakeInitialData(total_memory_units);
+	HEX_ASSERT(initial_data.size() == 1 + num_blocks_ + GetNumSummaryWords());
+
+	// Skip header.
+	for(size_t i= 1; i < initial_data.size(); ++i)
+		data_[i - 1].store(initial_data[i]);
+}
+
+uint32_t GPUAllocatorCPU::Allocate(const uint32_t size_units)
+{
+	if(size_units == 0)
+		return 0;
+	if(size_units > c_max_allocation_size_units)
+		return c_fail_result;
+
+	const uint32_t mask= GetUnitsMask(size_units);
+
+	const uint32_t num_summary_words= GetNumSummaryWords();
+	for(uint32_t summary_word_index= 0; summary_word_index < num_summary_words; ++summary_word_index)
+	{
+		uint32_t not_full_blocks_bits= ~data_[num_blocks_ + summary_word_index].load();
+		while(not_full_blocks_bits != 0)
+		{
+			const uint32_t bit= FindLSB(not_full_blocks_bits);
+			not_full_blocks_bits&= ~(1u << bit);
+
+			const uint32_t block_index= (summary_word_index << 5) + bit;
+			uint32_t block_bits= data_[block_index].load();
+			while(true)
+			{
+				// Use bit count to fast skip blocks with overall number of free units less than needed.
+				if(32 - BitCount(block_bits) < size_units)
+					break;
+
+				// We require continuous span of "size_units" size.
+				const uint32_t free_ranges= FindFreeRanges(block_bits, size_units);
+				if(free_ranges == 0)
+					break;
+
+				const uint32_t shift= FindLSB(free_ranges);
+				const uint32_t new_block_bits= block_bits | (mask << shift);
+
+				// Other thread may modify the same block concurrently.
+				// Mark units as used only if the block wasn't changed, else retry with actual bits.
+				// On failure "block_bits" is updated with actual value.
+				if(data_[block_index].compare_exchange_strong(block_bits, new_block_bits))
+				{
+					if(new_block_bits == 0xFFFFFFFFu)
+						MarkBlockFull(block_index);
+
+					return (block_index << 5) + shift;
+				}
+			}
+		}
+	}
+
+	// Found nothing.
+	return c_fail_result;
+}
+
+void GPUAllocatorCPU::Free(const uint32_t start_unit, const uint32_t size_units)
+{
+	if(size_units == 0)
+		return;
+
+	HEX_ASSERT(size_units <= c_max_allocation_size_units);
+	HEX_ASSERT(start_unit + size_units <= total_memory_units_);
+
+	const uint32_t mask= GetUnitsMask(size_units);
+
+	const uint32_t block_index= start_unit >> 5;
+	const uint32_t offset_within_block= start_unit & 31;
+
+	HEX_ASSERT(offset_within_block + size_units <= 32);
+
+	// Mark given units of this block as free.
+	data_[block_index].fetch_and(~(mask << offset_within_block));
+
+	// Block isn't full anymore.
+	data_[num_blocks_ + (block_index >> 5)].fetch_and(~(1u << (block_index & 31)));
+}
+
+GPUAllocatorCPU::Stats GPUAllocatorCPU::CalculateStats() const
+{
+	Stats stats;
+	stats.total_units= total_memory_units_;
+
+	for(uint32_t block_index= 0; block_index < num_blocks_; ++block_index)
+	{
+		const uint32_t block_bits= data_[block_index].load();
+
+		// Exclude padding units of the last block.
+		const uint32_t num_units_in_block= std::min(32u, total_memory_units_ - (block_index << 5));
+		const uint32_t padding_mask= num_units_in_block == 32 ? 0u : ~GetUnitsMask(num_units_in_block);
+		const uint32_t used_units_bits= block_bits & ~padding_mask;
+
+		stats.used_units+= BitCount(used_units_bits);
+		if(block_bits == 0xFFFFFFFFu)
+			++stats.num_full_blocks;
+		if(used_units_bits == 0)
+			++stats.num_empty_blocks;
+
+		uint32_t span_length= 0;
+		for(uint32_t i= 0; i <= 32; ++i)
+		{
+			if(i < 32 && (block_bits & (1u << i)) == 0)
+				++span_length;
+			else if(span_length > 0)
+			{
+				++stats.num_free_spans;
+				stats.largest_free_span= std::max(stats.largest_free_span, span_length);
+				span_length= 0;
+			}
+		}
+	}
+
+	return stats;
+}
+
+bool GPUAllocatorCPU::IsConsistent() const
+{
+	for(uint32_t block_index= 0; block_index < num_blocks_; ++block_index)
+	{
+		const bool block_is_full= data_[block_index].load() == 0xFFFFFFFFu;
+		const bool summary_bit_is_set= (data_[num_blocks_ + (block_index >> 5)].load() & (1u << (block_index & 31))) != 0;
+		if(block_is_full != summary_bit_is_set)
+			return false;
+	}
+
+	// Summary bits beyond the end should remain set.
+	for(uint32_t block_index= num_blocks_; block_index < (GetNumSummaryWords() << 5); ++block_index)
+	{
+		if((data_[num_blocks_ + (block_index >> 5)].load() & (1u << (block_index & 31))) == 0)
+			return false;
+	}
+
+	return true;
+}
+
+bool GPUAllocatorCPU::IsUnitUsed(const uint32_t unit) const
+{
+	HEX_ASSERT(unit < num_blocks_ * 32);
+	return (data_[unit >> 5].load() & (1u << (unit & 31))) != 0;
+}
+
+std::vector<uint32_t> GPUAllocatorCPU::MakeInitialData(const uint32_t total_memory_units)
+{
+	const uint32_t num_blocks= CalculateNumBlocks(total_memory_units);
+	const uint32_t num_summary_words= CalculateNumSummaryWords(num_blocks);
+
+	std::vector<uint32_t> data;
+	data.resize(1 + num_blocks + num_summary_words, uint32_t(0)); // Fill with zeros - indicating free memory.
+	data[0]= total_memory_units; // Set size.
+
+	// Mark units beyond the end as used.
+	if(total_memory_units % 32 != 0)
+		data[1 + num_blocks - 1]= ~GetUnitsMask(total_memory_units % 32);
+
+	// Mark blocks beyond the end as full.
+	if(num_blocks % 32 != 0)
+		data[1 + num_blocks + num_summary_words - 1]= ~GetUnitsMask(num_blocks % 32);
+
+	return data;
+}
+
+uint32_t GPUAllocatorCPU::GetNumSummaryWords() const
+{
+	return CalculateNumSummaryWords(num_blocks_);
+}
+
+void GPUAllocatorCPU::MarkBlockFull(const uint32_t block_index)
+{
+	std::atomic<uint32_t>& summary_word= data_[num_blocks_ + (block_index >> 5)];
+	const uint32_t summary_bit= 1u << (block_index & 31);
+	summary_word.fetch_or(summary_bit);
+
+	// Some units of this block may be freed concurrently before the summary bit was set.
+	// Reset the bit in such case, since full block is never checked again.
+	if(data_[block_index].load() != 0xFFFFFFFFu)
+		summary_word.fetch_and(~summary_bit);
+}
+
+} // namespace HexGPU
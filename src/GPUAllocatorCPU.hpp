@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace HexGPU
+{
+
+// CPU implementation of GPU allocator.
+// It mirrors logic of "allocator.glsl" and uses the same data layout as GPU allocator buffer.
+// If shader logic is changed, this code must be changed too!
+// Allocation and free are lock-free - they may be called from different threads concurrently.
+class GPUAllocatorCPU
+{
+public:
+	static constexpr uint32_t c_fail_result= 0xFFFFFFFF;
+	static constexpr uint32_t c_max_allocation_size_units= 32;
+
+	// Fragmentation statistics.
+	struct Stats
+	{
+		uint32_t total_units= 0;
+		uint32_t used_units= 0;
+		uint32_t num_full_blocks= 0;
+		uint32_t num_empty_blocks= 0;
+		// Spans of free units are counted within blocks, since allocations can't cross blocks.
+		uint32_t num_free_spans= 0;
+		uint32_t largest_free_span= 0;
+	};
+
+public:
+	explicit GPUAllocatorCPU(uint32_t total_memory_units);
+
+	// Returns index of unit or "c_fail_result".
+	// Size should be no more than "c_max_allocation_size_units".
+	uint32_t Allocate(uint32_t size_units);
+	void Free(uint32_t start_unit, uint32_t size_units);
+
+	// Functions below aren't thread-safe - they should not be called concurrently with allocations/frees.
+
+	Stats CalculateStats() const;
+
+	// Returns true if summary bits match blocks bits.
+	bool IsConsistent() const;
+
+	bool IsUnitUsed(uint32_t unit) const;
+
+	// Create data of GPU allocator buffer (including its header) for initial state of allocator.
+	static std::vector<uint32_t> MakeInitialData(uint32_t total_memory_units);
+
+private:
+	uint32_t GetNumSummaryWords() const;
+	void MarkBlockFull(uint32_t block_index);
+
+private:
+	const uint32_t total_memory_units_;
+	const uint32_t num_blocks_;
+	// Used units bits of blocks followed by summary bits, like in GPU buffer.
+	const std::unique_ptr<std::atomic<uint32_t>[]> data_;
+};
+
+} // namespace HexGPU
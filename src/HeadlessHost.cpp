@@ -0,0 +1,252 @@
+#include "HeadlessHost.hpp"
+#include "GlobalDescriptorPool.hpp"
+#include "Log.hpp"
+#include <algorithm>
+#include <iterator>
+#include <string_view>
+
+namespace HexGPU
+{
+
+namespace
+{
+
+// Use fixed time delta in order to make simulation reproducible.
+const float c_frame_time_delta_s= 1.0f / 30.0f;
+
+// Emulate a player, which flies forward and sometimes turns and builds/destroys blocks.
+// This causes world shifting and thus chunks downloading/uploading/generation.
+KeyboardState GetScriptedKeyboardState(const uint32_t frame)
+{
+	KeyboardState keyboard_state= c_key_mask_forward | c_key_mask_sprint;
+
+	if(frame % 256 < 32)
+		keyboard_state|= c_key_mask_rotate_left;
+
+	return keyboard_state;
+}
+
+MouseState GetScriptedMouseState(const uint32_t frame)
+{
+	if(frame % 64 == 0)
+		return c_mouse_mask_l_clicked;
+	if(frame % 64 == 32)
+		return c_mouse_mask_r_clicked;
+
+	return 0;
+}
+
+// GPU tasks of world geometry generation, performed in each frame.
+const std::string_view c_meshing_task_names[]
+{
+	"geometry_chunks_to_update_list_upload",
+	"geometry_size_calculation_prepare",
+	"geometry_scratch_reset",
+	"geometry_gen",
+	"geometry_allocation",
+	"geometry_copy",
+};
+
+float DurationToMs(const std::chrono::steady_clock::duration duration)
+{
+	return float(std::chrono::duration_cast<std::chrono::microseconds>(duration).count()) / 1000.0f;
+}
+
+} // namespace
+
+HeadlessHost::HeadlessHost(const uint32_t num_ticks)
+	: settings_("HexGPUHeadless.cfg")
+	, window_vulkan_(nullptr, settings_)
+	, task_organizer_(window_vulkan_, settings_)
+	, gpu_data_uploader_(window_vulkan_)
+	, global_descriptor_pool_(CreateGlobalDescriptorPool(window_vulkan_.GetVulkanDevice()))
+	, world_processor_(window_vulkan_, gpu_data_uploader_, *global_descriptor_pool_, settings_)
+	, num_ticks_(num_ticks)
+	, initial_tick_(world_processor_.GetCurrentTick())
+	, static_player_(settings_.GetOrSetInt("h_static_player", 0) != 0)
+	, init_time_(Clock::now())
+{
+	// Perform world update as fast as possible.
+	debug_params_.frame_rate_world_update= true;
+
+	if(window_vulkan_.HasAsyncCompute())
+		async_compute_task_organizer_.emplace(window_vulkan_, settings_, true);
+
+	// Always collect GPU timings in headless mode - it's mostly used for benchmarking.
+	task_organizer_.SetProfilingEnabled(true);
+	if(async_compute_task_organizer_ != std::nullopt)
+		async_compute_task_organizer_->SetProfilingEnabled(true);
+
+	if(settings_.GetOrSetInt("h_validate_world_blocks_update", 0) != 0)
+	{
+		world_processor_.EnableTickDataReadBack(window_vulkan_);
+		world_blocks_update_validator_.emplace();
+	}
+
+	if(settings_.GetOrSetInt("h_meshing_benchmark", 0) != 0)
+	{
+		world_geometry_generator_.emplace(window_vulkan_, world_processor_, *global_descriptor_pool_, settings_);
+		world_geometry_generator_->EnableAllChunksUpdateInEachFrame();
+		Log::Info("Meshing benchmark is enabled - geometry of all chunks is generated in each frame");
+	}
+
+	Log::Info("Headless mode. Simulate ", num_ticks_, " ticks");
+	if(static_player_)
+		Log::Info("Player is static - the world isn't shifted and isn't modified by the player");
+}
+
+HeadlessHost::~HeadlessHost()
+{
+	PrintStats();
+}
+
+bool HeadlessHost::Loop()
+{
+	if(world_processor_.GetCurrentTick() - initial_tick_ >= num_ticks_)
+		return false;
+
+	const Clock::time_point frame_start_time= Clock::now();
+
+	const vk::CommandBuffer command_buffer= window_vulkan_.BeginFrame();
+	task_organizer_.SetCommandBuffer(command_buffer);
+	if(async_compute_task_organizer_ != std::nullopt)
+	{
+		async_compute_task_organizer_->SetCommandBuffer(window_vulkan_.GetAsyncComputeCommandBuffer());
+
+		// Profiling results of the same earlier frame are read back for both queues.
+		const auto main_busy_time_ms= task_organizer_.GetLastProfiledFrameBusyTimeMs();
+		const auto async_compute_busy_time_ms= async_compute_task_organizer_->GetLastProfiledFrameBusyTimeMs();
+		if(main_busy_time_ms != std::nullopt && async_compute_busy_time_ms != std::nullopt)
+		{
+			++async_compute_stats_.num_frames;
+			async_compute_stats_.main_busy_time_ms+= *main_busy_time_ms;
+			async_compute_stats_.async_compute_busy_time_ms+= *async_compute_busy_time_ms;
+		}
+	}
+
+	// Recording time of previous frame is available only after switching to the next command buffer.
+	stages_duration_.commands_recording+= task_organizer_.GetLastFrameRecordingTime();
+	if(async_compute_task_organizer_ != std::nullopt)
+		stages_duration_.commands_recording+= async_compute_task_organizer_->GetLastFrameRecordingTime();
+
+	const Clock::time_point begin_frame_end_time= Clock::now();
+
+	world_processor_.Update(
+		task_organizer_,
+		async_compute_task_organizer_ != std::nullopt ? *async_compute_task_organizer_ : task_organizer_,
+		c_frame_time_delta_s,
+		static_player_ ? KeyboardState(0) : GetScriptedKeyboardState(num_frames_),
+		static_player_ ? MouseState(0) : GetScriptedMouseState(num_frames_),
+		{0.0f, 0.0f},
+		BlockType::Air,
+		1.0f,
+		debug_params_);
+
+	if(world_processor_.IsNewTickStartedInLastUpdate())
+		window_vulkan_.RequireAsyncComputeResults();
+
+	if(world_geometry_generator_ != std::nullopt)
+	{
+		world_geometry_generator_->Update(task_organizer_);
+		num_meshed_chunks_+= world_geometry_generator_->GetNumChunksUpdatedInLastFrame();
+	}
+
+	const Clock::time_point world_update_end_time= Clock::now();
+
+	window_vulkan_.EndFrame();
+
+	const Clock::time_point frame_end_time= Clock::now();
+
+	stages_duration_.begin_frame+= begin_frame_end_time - frame_start_time;
+	stages_duration_.world_update+= world_update_end_time - begin_frame_end_time;
+	stages_duration_.end_frame+= frame_end_time - world_update_end_time;
+	++num_frames_;
+
+	// Validate data of a tick when it's read back. This isn't counted in frame stages time, since it's pretty slow.
+	if(world_blocks_update_validator_ != std::nullopt)
+	{
+		if(const auto tick_data= world_processor_.TakeTickDataReadBack())
+			world_blocks_update_validator_->Validate(*tick_data);
+	}
+
+	return true;
+}
+
+void HeadlessHost::PrintStats() const
+{
+	const float total_time_s= DurationToMs(Clock::now() - init_time_) / 1000.0f;
+	const uint32_t num_ticks= world_processor_.GetCurrentTick() - initial_tick_;
+	const float frames_scale= 1.0f / float(std::max(num_frames_, 1u));
+
+	Log::Info("Simulated ", num_ticks, " ticks in ", num_frames_, " frames, ", total_time_s, " s");
+	Log::Info("Ticks per second: ", float(num_ticks) / std::max(total_time_s, 0.001f));
+	Log::Info("Frames per second: ", float(num_frames_) / std::max(total_time_s, 0.001f));
+	Log::Info("Average frame stages time:");
+	Log::Info("  begin frame (GPU wait): ", DurationToMs(stages_duration_.begin_frame) * frames_scale, " ms");
+	Log::Info("  world update: ", DurationToMs(stages_duration_.world_update) * frames_scale, " ms");
+	Log::Info("    commands recording: ", DurationToMs(stages_duration_.commands_recording) * frames_scale, " ms");
+	Log::Info("  end frame (submit): ", DurationToMs(stages_duration_.end_frame) * frames_scale, " ms");
+
+	const auto decompression_stats= world_processor_.GetChunksDecompressionStats();
+	Log::Info(
+		"Chunks decompressed: ", decompression_stats.num_completed,
+		", average time: ", decompression_stats.average_time_ns, " ns",
+		" (light: ", decompression_stats.average_light_time_ns, " ns)");
+
+	const auto barriers_stats= task_organizer_.GetLastFrameBarriersStats();
+	Log::Info(
+		"Last frame barriers: ", barriers_stats.num_pipeline_barriers, " commands (",
+		barriers_stats.num_execution_barriers, " execution only), ",
+		barriers_stats.num_buffer_barriers, " buffer, ",
+		barriers_stats.num_image_barriers, " image");
+
+	if(task_organizer_.IsProfilingEnabled())
+	{
+		Log::Info("GPU tasks time (min/avg/max):");
+		for(const TaskOrganizer::TaskTimeStats& task_stats : task_organizer_.GetTasksTimeStats())
+			Log::Info("  ", task_stats.name, ": ", task_stats.min_ms, "/", task_stats.avg_ms, "/", task_stats.max_ms, " ms");
+
+		task_organizer_.SaveTasksTimeStatsToCSV("HexGPUHeadless_gpu_profile.csv");
+
+		if(world_geometry_generator_ != std::nullopt)
+		{
+			// Geometry of all chunks is generated in each frame, so average GPU time of recent frames is representative.
+			// Count only tasks performed in each frame, not rare ones, like initial fill or world shift.
+			double meshing_time_ms= 0.0;
+			for(const TaskOrganizer::TaskTimeStats& task_stats : task_organizer_.GetTasksTimeStats())
+			{
+				if(std::find(std::begin(c_meshing_task_names), std::end(c_meshing_task_names), task_stats.name) != std::end(c_meshing_task_names))
+					meshing_time_ms+= double(task_stats.avg_ms);
+			}
+
+			const double chunks_per_frame= double(num_meshed_chunks_) / double(std::max(num_frames_, 1u));
+			Log::Info(
+				"Meshing: ", chunks_per_frame, " chunks per frame, ", meshing_time_ms, " ms GPU time per frame, ",
+				chunks_per_frame / std::max(meshing_time_ms, 0.001), " chunks/ms");
+		}
+	}
+
+	if(async_compute_task_organizer_ != std::nullopt)
+	{
+		if(async_compute_task_organizer_->IsProfilingEnabled())
+		{
+			Log::Info("Async compute GPU tasks time (min/avg/max):");
+			for(const TaskOrganizer::TaskTimeStats& task_stats : async_compute_task_organizer_->GetTasksTimeStats())
+				Log::Info("  ", task_stats.name, ": ", task_stats.min_ms, "/", task_stats.avg_ms, "/", task_stats.max_ms, " ms");
+
+			async_compute_task_organizer_->SaveTasksTimeStatsToCSV("HexGPUHeadless_gpu_profile_async_compute.csv");
+		}
+
+		if(async_compute_stats_.num_frames > 0)
+		{
+			const double scale= 1.0 / double(async_compute_stats_.num_frames);
+			Log::Info(
+				"Average GPU busy time per frame: main queue ", async_compute_stats_.main_busy_time_ms * scale, " ms, ",
+				"async compute queue ", async_compute_stats_.async_compute_busy_time_ms * scale, " ms");
+		}
+	}
+	else
+		Log::Info("Async compute isn't used");
+}
+
+} // namespace HexGPU
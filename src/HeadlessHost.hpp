@@ -0,0 +1,78 @@
+#pragma once
+#include "TicksCounter.hpp"
+#include "WorldBlocksUpdateValidator.hpp"
+#include "WorldGeometryGenerator.hpp"
+#include "WorldProcessor.hpp"
+#include <chrono>
+#include <optional>
+
+namespace HexGPU
+{
+
+// Host for running world simulation without a window, rendering and user input.
+// Player input is scripted. Useful for measuring world simulation performance.
+class HeadlessHost
+{
+public:
+	explicit HeadlessHost(uint32_t num_ticks);
+	~HeadlessHost();
+
+	// Returns false when given number of ticks is simulated.
+	bool Loop();
+
+private:
+	void PrintStats() const;
+
+private:
+	using Clock= std::chrono::steady_clock;
+
+	// Accumulated durations of frame stages.
+	struct StagesDuration
+	{
+		Clock::duration begin_frame{0}; // Includes waiting for the GPU.
+		Clock::duration world_update{0};
+		Clock::duration commands_recording{0}; // Part of world update, summed for both queues.
+		Clock::duration end_frame{0};
+	};
+
+	// Accumulated GPU busy time of each queue (summed time of profiled tasks).
+	// Overlapping isn't measured, since timestamps of different queues aren't comparable.
+	struct AsyncComputeStats
+	{
+		uint32_t num_frames= 0;
+		double main_busy_time_ms= 0.0;
+		double async_compute_busy_time_ms= 0.0;
+	};
+
+private:
+	Settings settings_;
+	WindowVulkan window_vulkan_;
+	TaskOrganizer task_organizer_;
+	// Exists only if async compute is available.
+	std::optional<TaskOrganizer> async_compute_task_organizer_;
+	GPUDataUploader gpu_data_uploader_;
+	const vk::UniqueDescriptorPool global_descriptor_pool_;
+	WorldProcessor world_processor_;
+
+	const uint32_t num_ticks_;
+	const uint32_t initial_tick_;
+	// If true, player doesn't move and doesn't build, so the world remains mostly static.
+	const bool static_player_;
+
+	// Exists only if validation is enabled.
+	std::optional<WorldBlocksUpdateValidator> world_blocks_update_validator_;
+
+	// Exists only if meshing benchmark is enabled. Generates geometry of all chunks in each frame.
+	std::optional<WorldGeometryGenerator> world_geometry_generator_;
+	uint64_t num_meshed_chunks_= 0;
+
+	const Clock::time_point init_time_;
+
+	uint32_t num_frames_= 0;
+	StagesDuration stages_duration_;
+	AsyncComputeStats async_compute_stats_;
+
+	DebugParams debug_params_;
+};
+
+} // namespace HexGPU
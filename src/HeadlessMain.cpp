@@ -0,0 +1,27 @@
+#include "Log.hpp"
+#include "HeadlessHost.hpp"
+#include <algorithm>
+#include <string>
+
+namespace HexGPU
+{
+
+extern "C" int main(const int argc, char* argv[])
+{
+	try
+	{
+		// Number of ticks to simulate may be specified as the first argument.
+		uint32_t num_ticks= 1024;
+		if(argc >= 2)
+			num_ticks= uint32_t(std::max(1, std::stoi(argv[1])));
+
+		HeadlessHost host(num_ticks);
+		while(host.Loop()){}
+	}
+	catch(const std::exception& ex)
+	{
+		Log::FatalError("Exception throwed: ", ex.what());
+	}
+}
+
+} // namespace HexGPU
@@ -98,20 +98,22 @@ std::array<float, 2> GetMouseMove(const std::vector<SDL_Event>& events, Settings
 Host::Host()
 	: settings_("HexGPU.cfg")
 	, system_window_(settings_)
-	, window_vulkan_(system_window_, settings_)
-	, task_organizer_(window_vulkan_)
+	, window_vulkan_(&system_window_, settings_)
+	, task_organizer_(window_vulkan_, settings_)
 	, gpu_data_uploader_(window_vulkan_)
 	, global_descriptor_pool_(CreateGlobalDescriptorPool(window_vulkan_.GetVulkanDevice()))
 	, im_gui_wrapper_(system_window_, window_vulkan_)
 	, world_render_pass_(window_vulkan_, settings_, *global_descriptor_pool_)
 	, world_processor_(window_vulkan_, gpu_data_uploader_, *global_descriptor_pool_, settings_)
-	, world_renderer_(window_vulkan_, world_render_pass_, gpu_data_uploader_, world_processor_, *global_descriptor_pool_)
+	, world_renderer_(window_vulkan_, world_render_pass_, gpu_data_uploader_, world_processor_, *global_descriptor_pool_, settings_)
 	, sky_renderer_(window_vulkan_, gpu_data_uploader_, world_render_pass_, world_processor_, *global_descriptor_pool_)
 	, build_prism_renderer_(window_vulkan_, world_render_pass_, world_processor_, *global_descriptor_pool_)
 	, init_time_(Clock::now())
 	, prev_tick_time_(init_time_)
 	, ticks_counter_(std::chrono::milliseconds(500))
 {
+	if(window_vulkan_.HasAsyncCompute())
+		async_compute_task_organizer_.emplace(window_vulkan_, settings_, true);
 }
 
 bool Host::Loop()
@@ -162,6 +164,7 @@ bool Host::Loop()
 	{
 		DrawDebugInfo();
 		DrawDebugParamsUI();
+		DrawGPUProfilingUI();
 	}
 
 	const bool mouse_enabled= settings_.GetOrSetInt("in_mouse_enabled", 1) != 0;
@@ -171,9 +174,12 @@ bool Host::Loop()
 
 	const vk::CommandBuffer command_buffer= window_vulkan_.BeginFrame();
 	task_organizer_.SetCommandBuffer(command_buffer);
+	if(async_compute_task_organizer_ != std::nullopt)
+		async_compute_task_organizer_->SetCommandBuffer(window_vulkan_.GetAsyncComputeCommandBuffer());
 
 	world_processor_.Update(
 		task_organizer_,
+		async_compute_task_organizer_ != std::nullopt ? *async_compute_task_organizer_ : task_organizer_,
 		dt_s_limited,
 		game_has_focus ? CreateKeyboardState(keys_state) : 0,
 		game_has_focus ? CreateMouseState(events) : 0,
@@ -182,6 +188,9 @@ bool Host::Loop()
 		CalculateAspect(world_render_pass_.GetFramebufferSize()),
 		debug_params_);
 
+	if(world_processor_.IsNewTickStartedInLastUpdate())
+		window_vulkan_.RequireAsyncComputeResults();
+
 	world_renderer_.PrepareFrame(task_organizer_);
 	build_prism_renderer_.PrepareFrame(task_organizer_);
 	sky_renderer_.PrepareFrame(task_organizer_);
@@ -189,6 +198,7 @@ bool Host::Loop()
 	// Draw into world render pass.
 	{
 		TaskOrganizer::GraphicsTaskParams task_params;
+		task_params.name= "world_render_pass";
 		world_renderer_.CollectFrameInputs(task_params);
 		sky_renderer_.CollectFrameInputs(task_params);
 		build_prism_renderer_.CollectFrameInputs(task_params);
@@ -218,6 +228,7 @@ bool Host::Loop()
 	// Draw into screen.
 	{
 		TaskOrganizer::GraphicsTaskParams task_params;
+		task_params.name= "screen_render_pass";
 		world_render_pass_.CollectFrameInputs(task_params);
 
 		task_params.render_pass= window_vulkan_.GetRenderPass();
@@ -386,7 +397,7 @@ void Host::DrawDebugInfo()
 	ImGui::SetNextWindowBgAlpha(0.25f);
 
 	ImGui::SetNextWindowSizeConstraints({200.0f, 64.0f}, {800.0f, 600.0f});
-	ImGui::SetNextWindowSize({300.0f, 200.0f});
+	ImGui::SetNextWindowSize({400.0f, 200.0f});
 	ImGui::SetNextWindowPos({0.0f, 0.0f}, ImGuiCond_Appearing);
 
 	ImGui::Begin(
@@ -402,6 +413,34 @@ void Host::DrawDebugInfo()
 	if(const auto player_state= world_processor_.GetLastKnownPlayerState())
 		ImGui::Text("Player pos: %4.2f, %4.2f, %4.2f", player_state->pos[0], player_state->pos[1], player_state->pos[2]);
 
+	const auto decompression_stats= world_processor_.GetChunksDecompressionStats();
+	ImGui::Text(
+		"Chunks decompression: %u queued, %u in progress, %llu completed",
+		decompression_stats.num_queued,
+		decompression_stats.num_in_progress,
+		static_cast<unsigned long long>(decompression_stats.num_completed));
+	ImGui::Text("Chunk decompression time: %llu ns", static_cast<unsigned long long>(decompression_stats.average_time_ns));
+	ImGui::Text("Chunk light precomputation time: %llu ns", static_cast<unsigned long long>(decompression_stats.average_light_time_ns));
+
+	const auto vertex_memory_stats= world_renderer_.GetVertexMemoryStats();
+	ImGui::Text(
+		"Vertex memory: %u/%u units used (%3.1f%%)",
+		vertex_memory_stats.used_units,
+		vertex_memory_stats.total_units,
+		100.0f * float(vertex_memory_stats.used_units) / float(std::max(vertex_memory_stats.total_units, 1u)));
+	ImGui::Text(
+		"Vertex memory: %u failed allocations, %u evicted chunks",
+		vertex_memory_stats.num_failed_allocations,
+		vertex_memory_stats.num_evicted_chunks);
+
+	const auto barriers_stats= task_organizer_.GetLastFrameBarriersStats();
+	ImGui::Text(
+		"Barriers: %u commands (%u execution only), %u buffer, %u image",
+		barriers_stats.num_pipeline_barriers,
+		barriers_stats.num_execution_barriers,
+		barriers_stats.num_buffer_barriers,
+		barriers_stats.num_image_barriers);
+
 	ImGui::End();
 }
 
@@ -421,4 +460,82 @@ void Host::DrawDebugParamsUI()
 	ImGui::End();
 }
 
+void Host::DrawGPUProfilingUI()
+{
+	ImGui::SetNextWindowBgAlpha(0.25f);
+	ImGui::SetNextWindowSize({450.0f, 400.0f}, ImGuiCond_Appearing);
+	ImGui::SetNextWindowPos({float(window_vulkan_.GetViewportSize().width) - 450.0f, 448.0f}, ImGuiCond_Appearing);
+	ImGui::Begin("HexGPU GPU profiling", nullptr);
+
+	if(!task_organizer_.IsProfilingSupported())
+	{
+		ImGui::Text("GPU profiling isn't supported");
+		ImGui::End();
+		return;
+	}
+
+	bool profiling_enabled= task_organizer_.IsProfilingEnabled();
+	if(ImGui::Checkbox("Enabled", &profiling_enabled))
+	{
+		task_organizer_.SetProfilingEnabled(profiling_enabled);
+		if(async_compute_task_organizer_ != std::nullopt)
+			async_compute_task_organizer_->SetProfilingEnabled(profiling_enabled);
+		settings_.SetInt("r_gpu_profiling", profiling_enabled ? 1 : 0);
+	}
+
+	if(ImGui::Button("Save CSV"))
+	{
+		task_organizer_.SaveTasksTimeStatsToCSV("HexGPU_gpu_profile.csv");
+		if(async_compute_task_organizer_ != std::nullopt)
+			async_compute_task_organizer_->SaveTasksTimeStatsToCSV("HexGPU_gpu_profile_async_compute.csv");
+	}
+
+	DrawTasksTimeStatsTable("Tasks", task_organizer_.GetTasksTimeStats());
+
+	if(async_compute_task_organizer_ != std::nullopt)
+	{
+		ImGui::Text("Async compute");
+
+		// Timestamps of different queues aren't comparable, so show only busy time of each queue.
+		const auto main_busy_time_ms= task_organizer_.GetLastProfiledFrameBusyTimeMs();
+		const auto async_compute_busy_time_ms= async_compute_task_organizer_->GetLastProfiledFrameBusyTimeMs();
+		if(main_busy_time_ms != std::nullopt && async_compute_busy_time_ms != std::nullopt)
+			ImGui::Text(
+				"Last frame busy time: main queue %6.3f ms, async compute queue %6.3f ms",
+				*main_busy_time_ms,
+				*async_compute_busy_time_ms);
+
+		DrawTasksTimeStatsTable("Async compute tasks", async_compute_task_organizer_->GetTasksTimeStats());
+	}
+
+	ImGui::End();
+}
+
+void Host::DrawTasksTimeStatsTable(const char* const table_id, const std::vector<TaskOrganizer::TaskTimeStats>& stats)
+{
+	if(ImGui::BeginTable(table_id, 4))
+	{
+		ImGui::TableSetupColumn("Task");
+		ImGui::TableSetupColumn("Min (ms)");
+		ImGui::TableSetupColumn("Avg (ms)");
+		ImGui::TableSetupColumn("Max (ms)");
+		ImGui::TableHeadersRow();
+
+		for(const TaskOrganizer::TaskTimeStats& task_stats : stats)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::Text("%s", task_stats.name.c_str());
+			ImGui::TableNextColumn();
+			ImGui::Text("%6.3f", task_stats.min_ms);
+			ImGui::TableNextColumn();
+			ImGui::Text("%6.3f", task_stats.avg_ms);
+			ImGui::TableNextColumn();
+			ImGui::Text("%6.3f", task_stats.max_ms);
+		}
+
+		ImGui::EndTable();
+	}
+}
+
 } // namespace HexGPU
@@ -5,6 +5,7 @@
 #include "TicksCounter.hpp"
 #include "WorldRenderer.hpp"
 #include <chrono>
+#include <optional>
 
 namespace HexGPU
 {
@@ -24,6 +25,8 @@ private:
 	void DrawCrosshair();
 	void DrawDebugInfo();
 	void DrawDebugParamsUI();
+	void DrawGPUProfilingUI();
+	void DrawTasksTimeStatsTable(const char* table_id, const std::vector<TaskOrganizer::TaskTimeStats>& stats);
 
 private:
 	using Clock= std::chrono::steady_clock;
@@ -33,6 +36,8 @@ private:
 	SystemWindow system_window_;
 	WindowVulkan window_vulkan_;
 	TaskOrganizer task_organizer_;
+	// Exists only if async compute is available.
+	std::optional<TaskOrganizer> async_compute_task_organizer_;
 	GPUDataUploader gpu_data_uploader_;
 	const vk::UniqueDescriptorPool global_descriptor_pool_;
 	ImGuiWrapper im_gui_wrapper_;
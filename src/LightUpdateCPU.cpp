@@ -0,0 +1,521 @@
+#include "LightUpdateCPU.hpp"
+#include "Assert.hpp"
+#include "BlockType.hpp"
+#include "Constants.hpp"
+#include "CpuFeatures.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cstring>
+#include <future>
+
+#if defined(HEX_SSE2)
+#include <immintrin.h>
+#endif
+
+namespace HexGPU
+{
+
+namespace
+{
+
+// These tables should match GLSL code!
+
+const bool c_block_is_optically_solid_table[size_t(BlockType::NumBlockTypes)]
+{
+	false, // Air
+	true , // SphericalBlock
+	true , // Stone
+	true , // Soil
+	true , // Wood
+	true , // Grass
+	true , // Brick
+	false, // Foliage
+	true , // FireStone
+	false, // Water
+	true , // Sand
+	false, // Fire
+	false, // GlassWhite
+	false, // GlassGrey
+	false, // GlassRed
+	false, // GlassYellow
+	false, // GlassGreen
+	false, // GlassCian
+	false, // GlassBlue
+	false, // GlassMagenta
+	true , // GrassYellow
+	false, // Snow
+};
+
+const uint8_t c_block_own_light_table[size_t(BlockType::NumBlockTypes)]
+{
+	 0, // Air
+	 0, // SphericalBlock
+	 0, // Stone
+	 0, // Soil
+	 0, // Wood
+	 0, // Grass
+	 0, // Brick
+	 0, // Foliage
+	15, // FireStone
+	 0, // Water
+	 0, // Sand
+	11, // Fire
+	 0, // GlassWhite
+	 0, // GlassGrey
+	 0, // GlassRed
+	 0, // GlassYellow
+	 0, // GlassGreen
+	 0, // GlassCian
+	 0, // GlassBlue
+	 0, // GlassMagenta
+	 0, // GrassYellow
+	 0, // Snow
+};
+
+constexpr int32_t c_chunk_width_i= int32_t(c_chunk_width);
+constexpr int32_t c_chunk_height_i= int32_t(c_chunk_height);
+
+constexpr uint8_t c_sky_light_max_packed= uint8_t(c_max_sky_light << c_sky_light_shift);
+
+int32_t ChunkBlockAddress(const int32_t x, const int32_t y, const int32_t z)
+{
+	return z + (y << c_chunk_height_log2) + (x << (c_chunk_width_log2 + c_chunk_height_log2));
+}
+
+int32_t GetColumnAddress(const int32_t x, const int32_t y, const int32_t world_size_x)
+{
+	const int32_t chunk_index= (x >> c_chunk_width_log2) + (y >> c_chunk_width_log2) * world_size_x;
+	return chunk_index * int32_t(c_chunk_volume) + ChunkBlockAddress(x & (c_chunk_width_i - 1), y & (c_chunk_width_i - 1), 0);
+}
+
+// Input data of single column, prepared for SIMD processing.
+// All arrays are indexed by z.
+struct ColumnInput
+{
+	const uint8_t* block_types= nullptr;
+	// Light of adjacent blocks in all 8 directions (with clamping at world borders).
+	const uint8_t* adjacent_light[8]{};
+	// Masks - 0xFF or 0x00.
+	alignas(32) uint8_t solid_mask[c_chunk_height];
+	alignas(32) uint8_t own_light[c_chunk_height];
+	alignas(32) uint8_t light_up[c_chunk_height];
+	alignas(32) uint8_t light_down[c_chunk_height];
+};
+
+// Scalar version, which is closest to the shader code.
+[[maybe_unused]] void UpdateColumnLightScalar(const ColumnInput& in, uint8_t* const out)
+{
+	for(int32_t z= 0; z < c_chunk_height_i; ++z)
+	{
+		if(in.solid_mask[z] != 0)
+		{
+			out[z]= in.own_light[z];
+			continue;
+		}
+
+		int32_t max_adjacent_fire_light= 0;
+		int32_t max_adjacent_sky_light= 0;
+		for(const uint8_t* const adjacent_light : in.adjacent_light)
+		{
+			max_adjacent_fire_light= std::max(max_adjacent_fire_light, adjacent_light[z] & c_fire_light_mask);
+			max_adjacent_sky_light= std::max(max_adjacent_sky_light, adjacent_light[z] >> c_sky_light_shift);
+		}
+
+		const int32_t result_fire_light= std::max(int32_t(in.own_light[z]), std::max(max_adjacent_fire_light - 1, 0));
+
+		int32_t result_sky_light= 0;
+		if(z == c_chunk_height_i - 1)
+			result_sky_light= c_sky_light_max_packed;
+		else if((in.light_up[z] >> c_sky_light_shift) == c_max_sky_light && in.block_types[z] == uint8_t(BlockType::Air))
+			result_sky_light= c_sky_light_max_packed;
+		else
+			result_sky_light= std::max(max_adjacent_sky_light - 1, 0) << c_sky_light_shift;
+
+		out[z]= uint8_t(result_fire_light | result_sky_light);
+	}
+}
+
+// SIMD versions. They produce the same result as scalar version.
+// Light packing is used to avoid shifts: maximum of sky light values is calculated for high nibbles directly
+// and decrement of sky light is performed via saturating subtraction of 0x10.
+
+static_assert(c_chunk_height % 32 == 0, "Column should consist of whole number of SIMD vectors!");
+
+// Highest non-solid blocks recieve maximum sky light.
+[[maybe_unused]] void SetTopBlockSkyLight(const ColumnInput& in, uint8_t* const out)
+{
+	if(in.solid_mask[c_chunk_height - 1] == 0)
+		out[c_chunk_height - 1]= uint8_t((out[c_chunk_height - 1] & c_fire_light_mask) | c_sky_light_max_packed);
+}
+
+#if defined(HEX_SSE2)
+
+void UpdateColumnLightSSE2(const ColumnInput& in, uint8_t* const out)
+{
+	const __m128i fire_light_mask= _mm_set1_epi8(char(c_fire_light_mask));
+	const __m128i sky_light_mask= _mm_set1_epi8(char(c_sky_light_mask));
+	const __m128i fire_light_one= _mm_set1_epi8(1);
+	const __m128i sky_light_one= _mm_set1_epi8(char(1 << c_sky_light_shift));
+	const __m128i sky_light_max= _mm_set1_epi8(char(c_sky_light_max_packed));
+	const __m128i air= _mm_set1_epi8(char(BlockType::Air));
+
+	for(uint32_t z= 0; z < c_chunk_height; z+= 16)
+	{
+		__m128i max_fire_light= _mm_setzero_si128();
+		__m128i max_sky_light= _mm_setzero_si128();
+		for(const uint8_t* const adjacent_light : in.adjacent_light)
+		{
+			const __m128i l= _mm_loadu_si128(reinterpret_cast<const __m128i*>(adjacent_light + z));
+			max_fire_light= _mm_max_epu8(max_fire_light, _mm_and_si128(l, fire_light_mask));
+			max_sky_light= _mm_max_epu8(max_sky_light, _mm_and_si128(l, sky_light_mask));
+		}
+
+		const __m128i own_light= _mm_loadu_si128(reinterpret_cast<const __m128i*>(in.own_light + z));
+		const __m128i fire_light= _mm_max_epu8(own_light, _mm_subs_epu8(max_fire_light, fire_light_one));
+
+		const __m128i propagated_sky_light= _mm_subs_epu8(max_sky_light, sky_light_one);
+
+		const __m128i light_up= _mm_loadu_si128(reinterpret_cast<const __m128i*>(in.light_up + z));
+		const __m128i up_has_max_sky_light= _mm_cmpeq_epi8(_mm_and_si128(light_up, sky_light_mask), sky_light_max);
+		const __m128i block_types= _mm_loadu_si128(reinterpret_cast<const __m128i*>(in.block_types + z));
+		const __m128i is_air= _mm_cmpeq_epi8(block_types, air);
+		const __m128i direct_sky_light= _mm_and_si128(up_has_max_sky_light, is_air);
+
+		const __m128i sky_light=
+			_mm_or_si128(
+				_mm_and_si128(direct_sky_light, sky_light_max),
+				_mm_andnot_si128(direct_sky_light, propagated_sky_light));
+
+		const __m128i solid_mask= _mm_loadu_si128(reinterpret_cast<const __m128i*>(in.solid_mask + z));
+		const __m128i result=
+			_mm_or_si128(
+				_mm_and_si128(solid_mask, own_light),
+				_mm_andnot_si128(solid_mask, _mm_or_si128(fire_light, sky_light)));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + z), result);
+	}
+
+	SetTopBlockSkyLight(in, out);
+}
+
+#endif
+
+#if defined(HEX_AVX2)
+
+HEX_TARGET_AVX2 void UpdateColumnLightAVX2(const ColumnInput& in, uint8_t* const out)
+{
+	const __m256i fire_light_mask= _mm256_set1_epi8(char(c_fire_light_mask));
+	const __m256i sky_light_mask= _mm256_set1_epi8(char(c_sky_light_mask));
+	const __m256i fire_light_one= _mm256_set1_epi8(1);
+	const __m256i sky_light_one= _mm256_set1_epi8(char(1 << c_sky_light_shift));
+	const __m256i sky_light_max= _mm256_set1_epi8(char(c_sky_light_max_packed));
+	const __m256i air= _mm256_set1_epi8(char(BlockType::Air));
+
+	for(uint32_t z= 0; z < c_chunk_height; z+= 32)
+	{
+		__m256i max_fire_light= _mm256_setzero_si256();
+		__m256i max_sky_light= _mm256_setzero_si256();
+		for(const uint8_t* const adjacent_light : in.adjacent_light)
+		{
+			const __m256i l= _mm256_loadu_si256(reinterpret_cast<const __m256i*>(adjacent_light + z));
+			max_fire_light= _mm256_max_epu8(max_fire_light, _mm256_and_si256(l, fire_light_mask));
+			max_sky_light= _mm256_max_epu8(max_sky_light, _mm256_and_si256(l, sky_light_mask));
+		}
+
+		const __m256i own_light= _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in.own_light + z));
+		const __m256i fire_light= _mm256_max_epu8(own_light, _mm256_subs_epu8(max_fire_light, fire_light_one));
+
+		const __m256i propagated_sky_light= _mm256_subs_epu8(max_sky_light, sky_light_one);
+
+		const __m256i light_up= _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in.light_up + z));
+		const __m256i up_has_max_sky_light= _mm256_cmpeq_epi8(_mm256_and_si256(light_up, sky_light_mask), sky_light_max);
+		const __m256i block_types= _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in.block_types + z));
+		const __m256i is_air= _mm256_cmpeq_epi8(block_types, air);
+		const __m256i direct_sky_light= _mm256_and_si256(up_has_max_sky_light, is_air);
+
+		const __m256i sky_light=
+			_mm256_or_si256(
+				_mm256_and_si256(direct_sky_light, sky_light_max),
+				_mm256_andnot_si256(direct_sky_light, propagated_sky_light));
+
+		const __m256i solid_mask= _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in.solid_mask + z));
+		const __m256i result=
+			_mm256_or_si256(
+				_mm256_and_si256(solid_mask, own_light),
+				_mm256_andnot_si256(solid_mask, _mm256_or_si256(fire_light, sky_light)));
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + z), result);
+	}
+
+	SetTopBlockSkyLight(in, out);
+}
+
+#endif
+
+using UpdateColumnLightFunc= void(*)(const ColumnInput& in, uint8_t* out);
+
+UpdateColumnLightFunc GetUpdateColumnLightFunc(const LightUpdateCPUKernel kernel)
+{
+	switch(kernel)
+	{
+	case LightUpdateCPUKernel::Auto:
+		{
+			static const UpdateColumnLightFunc func= GetUpdateColumnLightFunc(GetSupportedLightUpdateCPUKernels().back());
+			return func;
+		}
+	case LightUpdateCPUKernel::Scalar:
+		return UpdateColumnLightScalar;
+	case LightUpdateCPUKernel::SSE2:
+#if defined(HEX_SSE2)
+		return UpdateColumnLightSSE2;
+#else
+		break;
+#endif
+	case LightUpdateCPUKernel::AVX2:
+#if defined(HEX_AVX2)
+		if(CpuSupportsAVX2())
+			return UpdateColumnLightAVX2;
+#endif
+		break;
+	}
+
+	HEX_ASSERT(false); // Unsupported kernel.
+	return GetUpdateColumnLightFunc(LightUpdateCPUKernel::Auto);
+}
+
+// Perform steps until light stops changing or steps limit is reached.
+// Light data is both input and output. Returns number of steps performed.
+template<typename StepFunc>
+uint32_t PropagateLight(uint8_t* const light_data, const size_t size, const uint32_t max_steps, const StepFunc& step_func)
+{
+	// Use double buffering, like the GPU does.
+	std::vector<uint8_t> temp_light(size);
+
+	uint8_t* src= light_data;
+	uint8_t* dst= temp_light.data();
+
+	uint32_t num_steps= 0;
+	while(num_steps < max_steps)
+	{
+		step_func(static_cast<const uint8_t*>(src), dst);
+		++num_steps;
+
+		const bool changed= std::memcmp(src, dst, size) != 0;
+		std::swap(src, dst);
+
+		if(!changed)
+			break;
+	}
+
+	if(src != light_data)
+		std::memcpy(light_data, src, size);
+
+	return num_steps;
+}
+
+std::vector<ChunkPositionCPU> GetAllChunks(const std::array<uint32_t, 2> world_size_chunks)
+{
+	std::vector<ChunkPositionCPU> chunks;
+	chunks.reserve(world_size_chunks[0] * world_size_chunks[1]);
+	for(uint32_t y= 0; y < world_size_chunks[1]; ++y)
+	for(uint32_t x= 0; x < world_size_chunks[0]; ++x)
+		chunks.push_back({x, y});
+
+	return chunks;
+}
+
+} // namespace
+
+std::vector<LightUpdateCPUKernel> GetSupportedLightUpdateCPUKernels()
+{
+	std::vector<LightUpdateCPUKernel> kernels;
+	kernels.push_back(LightUpdateCPUKernel::Scalar);
+#if defined(HEX_SSE2)
+	kernels.push_back(LightUpdateCPUKernel::SSE2);
+#endif
+#if defined(HEX_AVX2)
+	if(CpuSupportsAVX2())
+		kernels.push_back(LightUpdateCPUKernel::AVX2);
+#endif
+
+	return kernels;
+}
+
+const char* LightUpdateCPUKernelToString(const LightUpdateCPUKernel kernel)
+{
+	switch(kernel)
+	{
+	case LightUpdateCPUKernel::Auto: return "auto";
+	case LightUpdateCPUKernel::Scalar: return "scalar";
+	case LightUpdateCPUKernel::SSE2: return "SSE2";
+	case LightUpdateCPUKernel::AVX2: return "AVX2";
+	};
+
+	return "invalid";
+}
+
+void UpdateChunkLightCPU(
+	const LightUpdateCPUParams& params,
+	const LightUpdateCPUData& data,
+	const ChunkPositionCPU out_chunk_position)
+{
+	const int32_t world_size_x= int32_t(params.world_size_chunks[0]);
+	const int32_t world_size_y= int32_t(params.world_size_chunks[1]);
+
+	const int32_t in_chunk_position[2]
+	{
+		int32_t(out_chunk_position[0]) + params.in_chunk_shift[0],
+		int32_t(out_chunk_position[1]) + params.in_chunk_shift[1],
+	};
+	HEX_ASSERT(in_chunk_position[0] >= 0 && in_chunk_position[0] < world_size_x);
+	HEX_ASSERT(in_chunk_position[1] >= 0 && in_chunk_position[1] < world_size_y);
+	HEX_ASSERT(out_chunk_position[0] < params.world_size_chunks[0]);
+	HEX_ASSERT(out_chunk_position[1] < params.world_size_chunks[1]);
+
+	const int32_t max_x= world_size_x * c_chunk_width_i - 1;
+	const int32_t max_y= world_size_y * c_chunk_width_i - 1;
+
+	const int32_t out_chunk_index= int32_t(out_chunk_position[0] + out_chunk_position[1] * params.world_size_chunks[0]);
+
+	const UpdateColumnLightFunc update_column_light= GetUpdateColumnLightFunc(params.kernel);
+
+	ColumnInput column;
+
+	for(int32_t x= 0; x < c_chunk_width_i; ++x)
+	for(int32_t y= 0; y < c_chunk_width_i; ++y)
+	{
+		const int32_t block_x= (in_chunk_position[0] << c_chunk_width_log2) + x;
+		const int32_t block_y= (in_chunk_position[1] << c_chunk_width_log2) + y;
+
+		const int32_t side_y_base= block_y + ((block_x + 1) & 1);
+		const int32_t east_x_clamped= std::min(block_x + 1, max_x);
+		const int32_t west_x_clamped= std::max(block_x - 1, 0);
+
+		const int32_t column_address= GetColumnAddress(block_x, block_y, world_size_x);
+		const uint8_t* const column_light= data.input_light + column_address;
+
+		column.block_types= data.chunks_data + column_address;
+
+		// Up and down light arrays are shifted column light arrays with clamping.
+		std::memcpy(column.light_up, column_light + 1, c_chunk_height - 1);
+		column.light_up[c_chunk_height - 1]= column_light[c_chunk_height - 1];
+		std::memcpy(column.light_down + 1, column_light, c_chunk_height - 1);
+		column.light_down[0]= column_light[0];
+
+		column.adjacent_light[0]= column.light_up;
+		column.adjacent_light[1]= column.light_down;
+		column.adjacent_light[2]= data.input_light + GetColumnAddress(block_x, std::min(block_y + 1, max_y), world_size_x);
+		column.adjacent_light[3]= data.input_light + GetColumnAddress(block_x, std::max(block_y - 1, 0), world_size_x);
+		column.adjacent_light[4]= data.input_light + GetColumnAddress(east_x_clamped, std::max(0, std::min(side_y_base - 0, max_y)), world_size_x);
+		column.adjacent_light[5]= data.input_light + GetColumnAddress(east_x_clamped, std::max(0, std::min(side_y_base - 1, max_y)), world_size_x);
+		column.adjacent_light[6]= data.input_light + GetColumnAddress(west_x_clamped, std::max(0, std::min(side_y_base - 0, max_y)), world_size_x);
+		column.adjacent_light[7]= data.input_light + GetColumnAddress(west_x_clamped, std::max(0, std::min(side_y_base - 1, max_y)), world_size_x);
+
+		for(int32_t z= 0; z < c_chunk_height_i; ++z)
+		{
+			const uint8_t block_type= column.block_types[z];
+			const bool block_type_is_valid= block_type < uint8_t(BlockType::NumBlockTypes);
+			column.solid_mask[z]= block_type_is_valid && c_block_is_optically_solid_table[block_type] ? 0xFF : 0x00;
+			column.own_light[z]= block_type_is_valid ? c_block_own_light_table[block_type] : 0;
+		}
+
+		update_column_light(column, data.output_light + out_chunk_index * int32_t(c_chunk_volume) + ChunkBlockAddress(x, y, 0));
+	}
+}
+
+void UpdateChunksLightCPU(
+	const LightUpdateCPUParams& params,
+	const LightUpdateCPUData& data,
+	const std::vector<ChunkPositionCPU>& out_chunk_positions,
+	ThreadPool& thread_pool)
+{
+	// Each task writes only data of its own chunk, so no synchronization is needed.
+	std::vector<std::future<void>> tasks;
+	tasks.reserve(out_chunk_positions.size());
+	for(const ChunkPositionCPU& out_chunk_position : out_chunk_positions)
+		tasks.push_back(
+			thread_pool.Submit(
+				[&params, &data, out_chunk_position]
+				{
+					UpdateChunkLightCPU(params, data, out_chunk_position);
+				}));
+
+	for(std::future<void>& task : tasks)
+		task.get();
+}
+
+void InitialFillChunkLightCPU(
+	const std::array<uint32_t, 2> world_size_chunks,
+	const uint8_t* const chunks_data,
+	uint8_t* const light_data,
+	const ChunkPositionCPU chunk_position)
+{
+	const uint32_t chunk_data_offset= (chunk_position[0] + chunk_position[1] * world_size_chunks[0]) * c_chunk_volume;
+
+	for(int32_t x= 0; x < c_chunk_width_i; ++x)
+	for(int32_t y= 0; y < c_chunk_width_i; ++y)
+	{
+		const uint32_t column_offset= chunk_data_offset + uint32_t(ChunkBlockAddress(x, y, 0));
+
+		// Propagate maximum sky light value down, until non-air block is reached.
+		// Fill remaining column blocks with zeros.
+		int32_t z= c_chunk_height_i - 1;
+		for(; z >= 0 && chunks_data[column_offset + uint32_t(z)] == uint8_t(BlockType::Air); --z)
+			light_data[column_offset + uint32_t(z)]= c_sky_light_max_packed;
+		for(; z >= 0; --z)
+			light_data[column_offset + uint32_t(z)]= 0;
+	}
+}
+
+void CalculateIsolatedChunkLightCPU(const uint8_t* const chunk_data, uint8_t* const light_data)
+{
+	// Process the chunk as a world of single chunk.
+	// Clamping of coordinates at world borders makes border blocks to use only their own light or light of actual neighbors.
+	LightUpdateCPUParams params;
+	params.world_size_chunks= {1, 1};
+
+	InitialFillChunkLightCPU(params.world_size_chunks, chunk_data, light_data, {0, 0});
+
+	// Light propagation path can't be longer than maximum light value, so this number of steps is enough for convergence.
+	PropagateLight(
+		light_data,
+		c_chunk_volume,
+		uint32_t(c_max_sky_light + 1),
+		[&](const uint8_t* const input_light, uint8_t* const output_light)
+		{
+			LightUpdateCPUData data;
+			data.chunks_data= chunk_data;
+			data.input_light= input_light;
+			data.output_light= output_light;
+			UpdateChunkLightCPU(params, data, {0, 0});
+		});
+}
+
+uint32_t PropagateWorldLightCPU(
+	const std::array<uint32_t, 2> world_size_chunks,
+	const uint8_t* const chunks_data,
+	uint8_t* const light_data,
+	const uint32_t max_steps,
+	ThreadPool& thread_pool)
+{
+	const std::vector<ChunkPositionCPU> chunks= GetAllChunks(world_size_chunks);
+
+	LightUpdateCPUParams params;
+	params.world_size_chunks= world_size_chunks;
+
+	return
+		PropagateLight(
+			light_data,
+			chunks.size() * c_chunk_volume,
+			max_steps,
+			[&](const uint8_t* const input_light, uint8_t* const output_light)
+			{
+				LightUpdateCPUData data;
+				data.chunks_data= chunks_data;
+				data.input_light= input_light;
+				data.output_light= output_light;
+				UpdateChunksLightCPU(params, data, chunks, thread_pool);
+			});
+}
+
+} // namespace HexGPU
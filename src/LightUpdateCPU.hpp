@@ -0,0 +1,82 @@
+#pragma once
+#include "WorldBlocksUpdateCPU.hpp"
+
+namespace HexGPU
+{
+
+// CPU implementation of light update.
+// Single step mirrors logic of "light_update" shader and should produce bit-exact results.
+// If shader logic is changed, this code must be changed too!
+// Uses the same flat chunks data layout as GPU buffers.
+// Processes whole columns (z is contiguous in chunk data) using SIMD instructions if they are available.
+// SSE2 is used on all x86-64 targets, AVX2 - if the CPU supports it (this is checked at runtime).
+
+// Implementation of columns processing. All kernels produce identical results.
+enum class LightUpdateCPUKernel : uint8_t
+{
+	// The fastest kernel, supported by the CPU.
+	Auto,
+	Scalar,
+	SSE2,
+	AVX2,
+};
+
+// Returns kernels supported by the target architecture and the CPU, from the slowest to the fastest. "Auto" isn't included.
+std::vector<LightUpdateCPUKernel> GetSupportedLightUpdateCPUKernels();
+
+const char* LightUpdateCPUKernelToString(LightUpdateCPUKernel kernel);
+
+struct LightUpdateCPUParams
+{
+	std::array<uint32_t, 2> world_size_chunks{};
+	// Relative shift of input chunks (in case of world shift).
+	std::array<int32_t, 2> in_chunk_shift{};
+	// Should be one of supported kernels.
+	LightUpdateCPUKernel kernel= LightUpdateCPUKernel::Auto;
+};
+
+// Data for whole world. Each buffer has size of world volume.
+// Input and output light buffers should not overlap.
+struct LightUpdateCPUData
+{
+	const uint8_t* chunks_data= nullptr;
+	const uint8_t* input_light= nullptr;
+	uint8_t* output_light= nullptr;
+};
+
+// Perform single light propagation step for given output chunk.
+void UpdateChunkLightCPU(
+	const LightUpdateCPUParams& params,
+	const LightUpdateCPUData& data,
+	ChunkPositionCPU out_chunk_position);
+
+// Update given chunks in parallel - one thread pool task per chunk.
+void UpdateChunksLightCPU(
+	const LightUpdateCPUParams& params,
+	const LightUpdateCPUData& data,
+	const std::vector<ChunkPositionCPU>& out_chunk_positions,
+	ThreadPool& thread_pool);
+
+// Fill light of given chunk with only direct sky light, like "initial_light_fill" shader does.
+void InitialFillChunkLightCPU(
+	std::array<uint32_t, 2> world_size_chunks,
+	const uint8_t* chunks_data,
+	uint8_t* light_data,
+	ChunkPositionCPU chunk_position);
+
+// Calculate converged light of a single chunk, starting with initial fill.
+// The chunk is processed in isolation - light of adjacent chunks isn't taken into account.
+// So, the result is never greater than actual light and may only increase later, via regular light update.
+// Runs entirely in the calling thread.
+void CalculateIsolatedChunkLightCPU(const uint8_t* chunk_data, uint8_t* light_data);
+
+// Perform light propagation steps for whole world until light stops changing.
+// Light data is both input and output. Returns number of steps performed.
+uint32_t PropagateWorldLightCPU(
+	std::array<uint32_t, 2> world_size_chunks,
+	const uint8_t* chunks_data,
+	uint8_t* light_data,
+	uint32_t max_steps,
+	ThreadPool& thread_pool);
+
+} // namespace HexGPU
@@ -0,0 +1,101 @@
+#include "MemoryMappedFile.hpp"
+#include "Assert.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace HexGPU
+{
+
+std::unique_ptr<MemoryMappedFile> MemoryMappedFile::Open(const std::string& file_name)
+{
+#ifdef _WIN32
+	// Allow deletion (including replacement via rename) of the file while it's open.
+	const HANDLE file=
+		CreateFileA(
+			file_name.c_str(),
+			GENERIC_READ,
+			FILE_SHARE_READ | FILE_SHARE_DELETE,
+			nullptr,
+			OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL,
+			nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+		return nullptr;
+
+	LARGE_INTEGER file_size;
+	if(!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0)
+	{
+		CloseHandle(file);
+		return nullptr;
+	}
+
+	const HANDLE mapping= CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	// The mapping keeps the file open, so, file handle isn't needed anymore.
+	CloseHandle(file);
+	if(mapping == nullptr)
+		return nullptr;
+
+	const void* const data= MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	// The view keeps the mapping object alive.
+	CloseHandle(mapping);
+	if(data == nullptr)
+		return nullptr;
+
+	return std::unique_ptr<MemoryMappedFile>(new MemoryMappedFile(data, size_t(file_size.QuadPart)));
+#else
+	const int file= open(file_name.c_str(), O_RDONLY);
+	if(file == -1)
+		return nullptr;
+
+	struct stat file_stat{};
+	if(fstat(file, &file_stat) != 0 || file_stat.st_size <= 0)
+	{
+		close(file);
+		return nullptr;
+	}
+
+	const size_t file_size= size_t(file_stat.st_size);
+	void* const data= mmap(nullptr, file_size, PROT_READ, MAP_SHARED, file, 0);
+	// The mapping keeps the file open, so, file descriptor isn't needed anymore.
+	close(file);
+	if(data == MAP_FAILED)
+		return nullptr;
+
+	return std::unique_ptr<MemoryMappedFile>(new MemoryMappedFile(data, file_size));
+#endif
+}
+
+MemoryMappedFile::MemoryMappedFile(const void* const data, const size_t size)
+	: data_(data), size_(size)
+{
+	HEX_ASSERT(data_ != nullptr);
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+#ifdef _WIN32
+	UnmapViewOfFile(data_);
+#else
+	munmap(const_cast<void*>(data_), size_);
+#endif
+}
+
+const char* MemoryMappedFile::GetData() const
+{
+	return static_cast<const char*>(data_);
+}
+
+size_t MemoryMappedFile::GetSize() const
+{
+	return size_;
+}
+
+} // namespace HexGPU
@@ -0,0 +1,32 @@
+#pragma once
+#include <memory>
+#include <string>
+
+namespace HexGPU
+{
+
+// Read-only memory mapping of a whole file.
+// File pages are loaded lazily by the OS on first access.
+class MemoryMappedFile
+{
+public:
+	// Returns null if file doesn't exist, is empty or can't be mapped.
+	static std::unique_ptr<MemoryMappedFile> Open(const std::string& file_name);
+
+	~MemoryMappedFile();
+
+	MemoryMappedFile(const MemoryMappedFile&)= delete;
+	MemoryMappedFile& operator=(const MemoryMappedFile&)= delete;
+
+	const char* GetData() const;
+	size_t GetSize() const;
+
+private:
+	MemoryMappedFile(const void* data, size_t size);
+
+private:
+	const void* const data_;
+	const size_t size_;
+};
+
+} // namespace HexGPU
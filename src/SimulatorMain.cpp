@@ -0,0 +1,224 @@
+#include "ChunkDataCompressor.hpp"
+#include "ChunksStorage.hpp"
+#include "Constants.hpp"
+#include "LightUpdateCPU.hpp"
+#include "Log.hpp"
+#include "Settings.hpp"
+#include "ThreadPool.hpp"
+#include "WorldBlocksUpdateCPU.hpp"
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+namespace HexGPU
+{
+
+namespace
+{
+
+// Offline world simulation on the CPU - for pre-aging of saved world areas (grass growth, water flow, etc.) without a GPU.
+// Only chunks existing in the world are simulated, since world generation is possible only on the GPU.
+// Chunks at the area border are simulated like chunks at the border of the active area in the game,
+// so, simulate an area a bit larger than needed.
+
+struct WorldData
+{
+	std::vector<uint8_t> blocks;
+	std::vector<uint8_t> auxiliar_data;
+	std::vector<uint8_t> light;
+};
+
+bool LoadChunks(
+	ChunksStorage& chunks_storage,
+	const ChunksStorage::ChunkCoord area_start,
+	const std::array<uint32_t, 2> area_size,
+	WorldData& world_data)
+{
+	const std::shared_ptr<const ZstdDictionary> zstd_dictionary= chunks_storage.GetZstdDictionary();
+
+	ChunkDataCompressor compressor;
+	for(uint32_t y= 0; y < area_size[1]; ++y)
+	for(uint32_t x= 0; x < area_size[0]; ++x)
+	{
+		const ChunksStorage::ChunkCoord chunk_coord{area_start[0] + int32_t(x), area_start[1] + int32_t(y)};
+
+		const std::optional<ChunkDataCompresedView> chunk_data_compressed= chunks_storage.GetChunk(chunk_coord);
+		if(chunk_data_compressed == std::nullopt)
+		{
+			Log::Warning("Chunk ", chunk_coord[0], ",", chunk_coord[1], " doesn't exist in the world");
+			return false;
+		}
+
+		const size_t offset= (x + y * area_size[0]) * c_chunk_volume;
+		const bool ok=
+			compressor.Decompress(
+				*chunk_data_compressed,
+				reinterpret_cast<BlockType*>(world_data.blocks.data() + offset),
+				world_data.auxiliar_data.data() + offset,
+				zstd_dictionary.get());
+		if(!ok)
+		{
+			Log::Warning("Can't decompress chunk ", chunk_coord[0], ",", chunk_coord[1]);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void SaveChunks(
+	ChunksStorage& chunks_storage,
+	const ChunkCodec codec,
+	const ChunksStorage::ChunkCoord area_start,
+	const std::array<uint32_t, 2> area_size,
+	const WorldData& world_data)
+{
+	const std::shared_ptr<const ZstdDictionary> zstd_dictionary= chunks_storage.GetZstdDictionary();
+
+	ChunkDataCompressor compressor;
+	for(uint32_t y= 0; y < area_size[1]; ++y)
+	for(uint32_t x= 0; x < area_size[0]; ++x)
+	{
+		const size_t offset= (x + y * area_size[0]) * c_chunk_volume;
+		chunks_storage.SetChunk(
+			{area_start[0] + int32_t(x), area_start[1] + int32_t(y)},
+			compressor.Compress(
+				codec,
+				reinterpret_cast<const BlockType*>(world_data.blocks.data() + offset),
+				world_data.auxiliar_data.data() + offset,
+				zstd_dictionary.get()));
+	}
+}
+
+// Simulate ticks the same way the GPU does this - blocks and light of the next tick are calculated based on data of the current tick.
+// Global state is fixed - day without drought and snow.
+void Simulate(const std::array<uint32_t, 2> world_size, const uint32_t num_ticks, WorldData& world_data, ThreadPool& thread_pool)
+{
+	const size_t world_volume= world_size[0] * world_size[1] * c_chunk_volume;
+
+	// Start with stable light, like after loading of chunks with light precomputation.
+	for(uint32_t y= 0; y < world_size[1]; ++y)
+	for(uint32_t x= 0; x < world_size[0]; ++x)
+		InitialFillChunkLightCPU(world_size, world_data.blocks.data(), world_data.light.data(), {x, y});
+	const uint32_t num_light_steps=
+		PropagateWorldLightCPU(world_size, world_data.blocks.data(), world_data.light.data(), c_chunk_height * 2, thread_pool);
+	Log::Info("Initial light calculated in ", num_light_steps, " steps");
+
+	std::vector<ChunkPositionCPU> chunk_positions;
+	for(uint32_t y= 0; y < world_size[1]; ++y)
+	for(uint32_t x= 0; x < world_size[0]; ++x)
+		chunk_positions.push_back({x, y});
+
+	WorldData next_world_data;
+	next_world_data.blocks.resize(world_volume);
+	next_world_data.auxiliar_data.resize(world_volume);
+	next_world_data.light.resize(world_volume);
+
+	WorldBlocksUpdateCPUParams blocks_update_params;
+	blocks_update_params.world_size_chunks= world_size;
+	blocks_update_params.sky_light_mask= -1;
+	blocks_update_params.sky_light_based_wetness_mask= -1;
+	blocks_update_params.snow_z_level= int32_t(c_chunk_height);
+
+	LightUpdateCPUParams light_update_params;
+	light_update_params.world_size_chunks= world_size;
+
+	const auto start_time= std::chrono::steady_clock::now();
+
+	for(uint32_t tick= 0; tick < num_ticks; ++tick)
+	{
+		blocks_update_params.current_tick= tick;
+
+		WorldBlocksUpdateCPUData blocks_update_data;
+		blocks_update_data.chunks_input_data= world_data.blocks.data();
+		blocks_update_data.chunks_auxiliar_input_data= world_data.auxiliar_data.data();
+		blocks_update_data.light_data= world_data.light.data();
+		blocks_update_data.chunks_output_data= next_world_data.blocks.data();
+		blocks_update_data.chunks_auxiliar_output_data= next_world_data.auxiliar_data.data();
+
+		LightUpdateCPUData light_update_data;
+		light_update_data.chunks_data= world_data.blocks.data();
+		light_update_data.input_light= world_data.light.data();
+		light_update_data.output_light= next_world_data.light.data();
+
+		UpdateChunksBlocksCPU(blocks_update_params, blocks_update_data, chunk_positions, thread_pool);
+		UpdateChunksLightCPU(light_update_params, light_update_data, chunk_positions, thread_pool);
+
+		std::swap(world_data, next_world_data);
+
+		if((tick + 1) % 256 == 0)
+			Log::Info("Tick ", tick + 1, "/", num_ticks);
+	}
+
+	const double time_s= std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+	Log::Info("Simulated ", num_ticks, " ticks in ", time_s, " s, ", double(num_ticks) / time_s, " ticks per second");
+}
+
+void PrintUsage()
+{
+	Log::Info("Usage: HexGPUSimulator <start_chunk_x> <start_chunk_y> <size_x> <size_y> [num_ticks]");
+}
+
+} // namespace
+
+extern "C" int main(const int argc, char* argv[])
+{
+	try
+	{
+		if(argc < 5)
+		{
+			PrintUsage();
+			return -1;
+		}
+
+		const ChunksStorage::ChunkCoord area_start{std::stoi(argv[1]), std::stoi(argv[2])};
+		const std::array<uint32_t, 2> area_size{uint32_t(std::max(1, std::stoi(argv[3]))), uint32_t(std::max(1, std::stoi(argv[4])))};
+
+		uint32_t num_ticks= 1024;
+		if(argc >= 6)
+			num_ticks= uint32_t(std::max(1, std::stoi(argv[5])));
+
+		// Simulator uses separate settings file, but the same world settings as the game.
+		Settings settings("HexGPUSimulator.cfg");
+
+		const std::string_view codec_name= settings.GetOrSetString("g_chunk_codec", ChunkCodecToString(ChunkCodec::Snappy));
+		const std::optional<ChunkCodec> codec= StringToChunkCodec(codec_name);
+		if(codec == std::nullopt)
+		{
+			Log::Warning("Unknown chunk codec \"", codec_name, "\"");
+			return -1;
+		}
+
+		const size_t world_volume= area_size[0] * area_size[1] * c_chunk_volume;
+
+		WorldData world_data;
+		world_data.blocks.resize(world_volume);
+		world_data.auxiliar_data.resize(world_volume);
+		world_data.light.resize(world_volume);
+
+		ThreadPool thread_pool(uint32_t(std::max(0, int32_t(settings.GetOrSetInt("g_worker_threads", 0)))));
+
+		// Storage saves all regions in its destructor.
+		ChunksStorage chunks_storage(settings);
+		chunks_storage.SetActiveArea(area_start, area_size);
+
+		Log::Info(
+			"Simulate area of ", area_size[0], "x", area_size[1], " chunks starting at ", area_start[0], ",", area_start[1],
+			" for ", num_ticks, " ticks");
+
+		if(!LoadChunks(chunks_storage, area_start, area_size, world_data))
+			return -1;
+
+		Simulate(area_size, num_ticks, world_data, thread_pool);
+
+		SaveChunks(chunks_storage, *codec, area_start, area_size, world_data);
+	}
+	catch(const std::exception& ex)
+	{
+		Log::FatalError("Exception throwed: ", ex.what());
+	}
+
+	return 0;
+}
+
+} // namespace HexGPU
@@ -522,6 +522,7 @@ void SkyRenderer::PrepareFrame(TaskOrganizer& task_organizer)
 	clouds_texture_generator_.PrepareFrame(task_organizer);
 
 	TaskOrganizer::TransferTaskParams task;
+	task.name= "sky_prepare";
 	task.input_buffers.push_back(world_processor_.GetPlayerStateBuffer());
 	task.input_buffers.push_back(world_processor_.GetWorldGlobalStateBuffer());
 	task.output_buffers.push_back(uniform_buffer_.GetBuffer());
@@ -0,0 +1,503 @@
+#include "TaskBarriersTracker.hpp"
+#include "Assert.hpp"
+#include <algorithm>
+
+namespace HexGPU
+{
+
+bool TaskBarriersTracker::BarriersBatch::IsEmpty() const
+{
+	return buffer_barriers.empty() && image_barriers.empty() && !require_execution_barrier;
+}
+
+TaskBarriersTracker::TaskBarriersTracker(const uint32_t queue_family_index)
+	: queue_family_index_(queue_family_index)
+{
+}
+
+TaskBarriersTracker::BarriersBatch TaskBarriersTracker::AddTask(const TaskUsages& usages)
+{
+	// Calculate all barriers before updating state, since the same range may be both read and written by the task.
+	BarriersBatch barriers;
+
+	for(const auto& buffer_usage : usages.buffers)
+	{
+		if(IsReadBufferUsage(buffer_usage.second))
+			AddBufferReadSync(barriers, buffer_usage.first, buffer_usage.second);
+		else
+			AddBufferWriteSync(barriers, buffer_usage.first, buffer_usage.second);
+	}
+
+	for(const auto& image_usage : usages.images)
+		AddImageSync(barriers, image_usage.first, image_usage.second);
+
+	for(const auto& buffer_usage : usages.buffers)
+	{
+		if(IsReadBufferUsage(buffer_usage.second))
+			UpdateBufferReadUsage(buffer_usage.first, buffer_usage.second);
+		else
+			UpdateBufferWriteUsage(buffer_usage.first, buffer_usage.second);
+	}
+
+	for(const auto& image_usage : usages.images)
+		last_image_usage_[image_usage.first.image]= image_usage.second;
+
+	return barriers;
+}
+
+void TaskBarriersTracker::MergeTasksBarriers(
+	const std::vector<TaskUsages>& tasks_usages,
+	std::vector<BarriersBatch>& tasks_barriers)
+{
+	HEX_ASSERT(tasks_usages.size() == tasks_barriers.size());
+
+	for(size_t i= 1; i < tasks_barriers.size(); ++i)
+	{
+		BarriersBatch& barriers= tasks_barriers[i];
+		if(barriers.IsEmpty())
+			continue;
+
+		// Search backwards for a barrier to merge with.
+		// Stop at first conflicting task - it may be a producer or a consumer this barrier synchronizes with.
+		for(size_t j= i; j > 0; --j)
+		{
+			const size_t prev_task_index= j - 1;
+			if(TasksConflict(tasks_usages[prev_task_index], tasks_usages[i]))
+				break;
+
+			BarriersBatch& prev_barriers= tasks_barriers[prev_task_index];
+			if(prev_barriers.IsEmpty())
+				continue;
+
+			if((barriers.src_pipeline_stage_flags & ~prev_barriers.src_pipeline_stage_flags) ||
+				(barriers.dst_pipeline_stage_flags & ~prev_barriers.dst_pipeline_stage_flags))
+				continue; // Can't merge with this barrier, but still can move past it.
+
+			MergeBarriers(prev_barriers, barriers);
+			barriers= BarriersBatch();
+			break;
+		}
+	}
+}
+
+void TaskBarriersTracker::AddBufferReadSync(BarriersBatch& barriers, const BufferRange& range, const BufferUsage usage) const
+{
+	HEX_ASSERT(IsReadBufferUsage(usage));
+
+	// Barrier is needed only if results of the last write into some part of this range aren't yet made visible for this kind of reads.
+	BufferSyncInfo src_sync_info;
+	bool barrier_needed= false;
+	ForEachBufferStatePart(
+		range,
+		[&](const BufferState& state)
+		{
+			if(state.last_write_usage == std::nullopt || (state.synced_read_usages & GetBufferUsageBit(usage)) != 0)
+				return;
+
+			const auto write_sync_info= GetBufferSrcSyncInfo(*state.last_write_usage);
+			HEX_ASSERT(write_sync_info != std::nullopt);
+			src_sync_info.access_flags|= write_sync_info->access_flags;
+			src_sync_info.pipeline_stage_flags|= write_sync_info->pipeline_stage_flags;
+			barrier_needed= true;
+		});
+
+	if(!barrier_needed)
+		return;
+
+	const auto dst_sync_info= GetBufferDstSyncInfo(usage);
+	HEX_ASSERT(dst_sync_info != std::nullopt);
+
+	AddBufferBarrier(barriers, range, src_sync_info, *dst_sync_info);
+}
+
+void TaskBarriersTracker::AddBufferWriteSync(BarriersBatch& barriers, const BufferRange& range, const BufferUsage usage) const
+{
+	HEX_ASSERT(!IsReadBufferUsage(usage));
+
+	vk::PipelineStageFlags read_pipeline_stage_flags;
+	BufferSyncInfo src_sync_info;
+	bool memory_barrier_needed= false;
+	ForEachBufferStatePart(
+		range,
+		[&](const BufferState& state)
+		{
+			if(state.read_pipeline_stage_flags)
+			{
+				// Write after read - execution barrier is enough.
+				// Previous write (if any) was already synchronized with these reads.
+				read_pipeline_stage_flags|= state.read_pipeline_stage_flags;
+			}
+			else if(state.last_write_usage != std::nullopt)
+			{
+				// Write after write - memory barrier is needed in order to preserve writes order.
+				const auto write_sync_info= GetBufferSrcSyncInfo(*state.last_write_usage);
+				HEX_ASSERT(write_sync_info != std::nullopt);
+				src_sync_info.access_flags|= write_sync_info->access_flags;
+				src_sync_info.pipeline_stage_flags|= write_sync_info->pipeline_stage_flags;
+				memory_barrier_needed= true;
+			}
+		});
+
+	if(read_pipeline_stage_flags)
+	{
+		barriers.require_execution_barrier= true;
+		barriers.src_pipeline_stage_flags|= read_pipeline_stage_flags;
+		barriers.dst_pipeline_stage_flags|= GetPipelineStageForBufferUsage(usage);
+	}
+
+	if(memory_barrier_needed)
+	{
+		// For write usages source sync info is the same as destination sync info.
+		const auto dst_sync_info= GetBufferSrcSyncInfo(usage);
+		HEX_ASSERT(dst_sync_info != std::nullopt);
+
+		AddBufferBarrier(barriers, range, src_sync_info, *dst_sync_info);
+	}
+}
+
+void TaskBarriersTracker::AddBufferBarrier(
+	BarriersBatch& barriers,
+	const BufferRange& range,
+	const BufferSyncInfo& src_sync_info,
+	const BufferSyncInfo& dst_sync_info) const
+{
+	BarriersBatch range_barriers;
+	range_barriers.buffer_barriers.emplace_back(
+		src_sync_info.access_flags, dst_sync_info.access_flags,
+		queue_family_index_, queue_family_index_,
+		range.buffer,
+		range.offset, range.size);
+	range_barriers.src_pipeline_stage_flags= src_sync_info.pipeline_stage_flags;
+	range_barriers.dst_pipeline_stage_flags= dst_sync_info.pipeline_stage_flags;
+
+	MergeBarriers(barriers, range_barriers);
+}
+
+void TaskBarriersTracker::AddImageSync(BarriersBatch& barriers, const ImageInfo& image_info, const ImageUsage usage) const
+{
+	if(GetLastImageUsage(image_info.image) == usage)
+		return;
+
+	const ImageSyncInfo src_sync_info= GetSyncInfoForLastImageUsage(image_info.image);
+	ImageSyncInfo dst_sync_info= GetSyncInfoForImageUsage(usage);
+	if(usage == ImageUsage::GraphicsSrc)
+	{
+		// Do not allow to execute vertex shader before image isn't ready, since image reads are possible already in vertex shader.
+		dst_sync_info.pipeline_stage_flags= vk::PipelineStageFlagBits::eVertexShader;
+	}
+
+	barriers.image_barriers.emplace_back(
+		src_sync_info.access_flags, dst_sync_info.access_flags,
+		src_sync_info.layout, dst_sync_info.layout,
+		queue_family_index_, queue_family_index_,
+		image_info.image,
+		vk::ImageSubresourceRange(image_info.asppect_flags, 0u, image_info.num_mips, 0u, image_info.num_layers));
+
+	barriers.src_pipeline_stage_flags|= src_sync_info.pipeline_stage_flags;
+	barriers.dst_pipeline_stage_flags|= dst_sync_info.pipeline_stage_flags;
+}
+
+void TaskBarriersTracker::UpdateBufferReadUsage(const BufferRange& range, const BufferUsage usage)
+{
+	ModifyBufferState(
+		range,
+		[&](BufferState& state)
+		{
+			state.synced_read_usages|= GetBufferUsageBit(usage);
+			state.read_pipeline_stage_flags|= GetPipelineStageForBufferUsage(usage);
+		});
+}
+
+void TaskBarriersTracker::UpdateBufferWriteUsage(const BufferRange& range, const BufferUsage usage)
+{
+	ModifyBufferState(
+		range,
+		[&](BufferState& state)
+		{
+			state.last_write_usage= usage;
+			state.synced_read_usages= 0;
+			state.read_pipeline_stage_flags= vk::PipelineStageFlags();
+		});
+}
+
+template<typename Func>
+void TaskBarriersTracker::ForEachBufferStatePart(const BufferRange& range, const Func& func) const
+{
+	const auto map_it= buffers_state_.find(range.buffer);
+	if(map_it == buffers_state_.end())
+		return;
+
+	const BufferStateMap& state_map= map_it->second;
+	const vk::DeviceSize end= GetBufferRangeEnd(range);
+
+	// Find part containing range start.
+	auto it= state_map.upper_bound(range.offset);
+	HEX_ASSERT(it != state_map.begin());
+	--it;
+
+	for(; it != state_map.end() && it->first < end; ++it)
+		func(it->second);
+}
+
+template<typename Func>
+void TaskBarriersTracker::ModifyBufferState(const BufferRange& range, const Func& func)
+{
+	const vk::DeviceSize end= GetBufferRangeEnd(range);
+	if(range.offset >= end)
+		return;
+
+	BufferStateMap& state_map= buffers_state_[range.buffer];
+	if(state_map.empty())
+		state_map.emplace(0, BufferState()); // Initially whole buffer has default state.
+
+	const auto split=
+		[&](const vk::DeviceSize offset)
+		{
+			auto it= state_map.upper_bound(offset);
+			HEX_ASSERT(it != state_map.begin());
+			const auto prev_it= std::prev(it);
+			if(prev_it->first != offset)
+				state_map.emplace_hint(it, offset, prev_it->second);
+		};
+
+	split(range.offset);
+	if(end != VK_WHOLE_SIZE)
+		split(end);
+
+	for(auto it= state_map.find(range.offset); it != state_map.end() && it->first < end; ++it)
+		func(it->second);
+
+	// Merge parts with equal state within modified range and at its borders.
+	auto it= state_map.find(range.offset);
+	if(it != state_map.begin())
+		--it;
+	while(true)
+	{
+		const auto next_it= std::next(it);
+		if(next_it == state_map.end() || next_it->first > end)
+			break;
+
+		if(next_it->second == it->second)
+			state_map.erase(next_it);
+		else
+			it= next_it;
+	}
+}
+
+std::optional<TaskBarriersTracker::ImageUsage> TaskBarriersTracker::GetLastImageUsage(const vk::Image image) const
+{
+	const auto it= last_image_usage_.find(image);
+	if(it == last_image_usage_.end())
+		return std::nullopt;
+	return it->second;
+}
+
+TaskBarriersTracker::ImageSyncInfo TaskBarriersTracker::GetSyncInfoForLastImageUsage(const vk::Image image) const
+{
+	if(const auto usage= GetLastImageUsage(image))
+		return GetSyncInfoForImageUsage(*usage);
+	return {vk::AccessFlags(), vk::PipelineStageFlagBits::eBottomOfPipe, vk::ImageLayout::eUndefined};
+}
+
+vk::DeviceSize TaskBarriersTracker::GetBufferRangeEnd(const BufferRange& range)
+{
+	return range.size == VK_WHOLE_SIZE ? VK_WHOLE_SIZE : range.offset + range.size;
+}
+
+bool TaskBarriersTracker::BufferRangesOverlap(const BufferRange& l, const BufferRange& r)
+{
+	return l.buffer == r.buffer && l.offset < GetBufferRangeEnd(r) && r.offset < GetBufferRangeEnd(l);
+}
+
+bool TaskBarriersTracker::TasksConflict(const TaskUsages& l, const TaskUsages& r)
+{
+	for(const auto& l_buffer_usage : l.buffers)
+	for(const auto& r_buffer_usage : r.buffers)
+	{
+		// Reads of the same range don't conflict.
+		if(IsReadBufferUsage(l_buffer_usage.second) && IsReadBufferUsage(r_buffer_usage.second))
+			continue;
+		if(BufferRangesOverlap(l_buffer_usage.first, r_buffer_usage.first))
+			return true;
+	}
+
+	// Any usage of the same image is a conflict, since even reads may require layout transition.
+	for(const auto& l_image_usage : l.images)
+	for(const auto& r_image_usage : r.images)
+	{
+		if(l_image_usage.first.image == r_image_usage.first.image)
+			return true;
+	}
+
+	return false;
+}
+
+void TaskBarriersTracker::MergeBarriers(BarriersBatch& dst, const BarriersBatch& src)
+{
+	dst.src_pipeline_stage_flags|= src.src_pipeline_stage_flags;
+	dst.dst_pipeline_stage_flags|= src.dst_pipeline_stage_flags;
+	dst.require_execution_barrier|= src.require_execution_barrier;
+
+	// Merge barriers for the same buffer (it may be used in several ways or in several ranges).
+	// Use bounding range for the merged barrier.
+	for(const vk::BufferMemoryBarrier& src_barrier : src.buffer_barriers)
+	{
+		bool merged= false;
+		for(vk::BufferMemoryBarrier& barrier : dst.buffer_barriers)
+		{
+			if(barrier.buffer == src_barrier.buffer)
+			{
+				barrier.srcAccessMask|= src_barrier.srcAccessMask;
+				barrier.dstAccessMask|= src_barrier.dstAccessMask;
+
+				const vk::DeviceSize begin= std::min(barrier.offset, src_barrier.offset);
+				const vk::DeviceSize end=
+					std::max(
+						GetBufferRangeEnd(BufferRange(barrier.buffer, barrier.offset, barrier.size)),
+						GetBufferRangeEnd(BufferRange(src_barrier.buffer, src_barrier.offset, src_barrier.size)));
+				barrier.offset= begin;
+				barrier.size= end == VK_WHOLE_SIZE ? VK_WHOLE_SIZE : end - begin;
+				merged= true;
+				break;
+			}
+		}
+
+		if(!merged)
+			dst.buffer_barriers.push_back(src_barrier);
+	}
+
+	dst.image_barriers.insert(dst.image_barriers.end(), src.image_barriers.begin(), src.image_barriers.end());
+}
+
+std::optional<TaskBarriersTracker::BufferSyncInfo> TaskBarriersTracker::GetBufferSrcSyncInfo(const BufferUsage usage)
+{
+	switch(usage)
+	{
+	// Require no synchronization if previous usage is constant.
+	case BufferUsage::IndirectDrawSrc:
+	case BufferUsage::IndexSrc:
+	case BufferUsage::VertexSrc:
+	case BufferUsage::UniformSrc:
+	case BufferUsage::ComputeShaderSrc:
+	case BufferUsage::TransferSrc:
+		return std::nullopt;
+
+	case BufferUsage::ComputeShaderDst:
+		return BufferSyncInfo{vk::AccessFlagBits::eShaderWrite, vk::PipelineStageFlagBits::eComputeShader};
+
+	case BufferUsage::TransferDst:
+		return BufferSyncInfo{vk::AccessFlagBits::eTransferWrite, vk::PipelineStageFlagBits::eTransfer};
+	};
+	HEX_ASSERT(false);
+	return std::nullopt;
+}
+
+std::optional<TaskBarriersTracker::BufferSyncInfo> TaskBarriersTracker::GetBufferDstSyncInfo(const BufferUsage usage)
+{
+	// TODO - check if this is correct.
+	switch(usage)
+	{
+	case BufferUsage::IndirectDrawSrc:
+		return BufferSyncInfo{vk::AccessFlagBits::eIndirectCommandRead, vk::PipelineStageFlagBits::eDrawIndirect};
+
+	case BufferUsage::IndexSrc:
+		return BufferSyncInfo{vk::AccessFlagBits::eIndexRead, vk::PipelineStageFlagBits::eVertexInput};
+
+	case BufferUsage::VertexSrc:
+		return BufferSyncInfo{vk::AccessFlagBits::eVertexAttributeRead, vk::PipelineStageFlagBits::eVertexInput};
+
+	case BufferUsage::UniformSrc:
+		// Uniforms may be accessed in vertex shader and later.
+		return BufferSyncInfo{vk::AccessFlagBits::eUniformRead, vk::PipelineStageFlagBits::eVertexShader};
+
+	case BufferUsage::ComputeShaderSrc:
+		return BufferSyncInfo{vk::AccessFlagBits::eShaderRead, vk::PipelineStageFlagBits::eComputeShader};
+
+	case BufferUsage::TransferSrc:
+		return BufferSyncInfo{vk::AccessFlagBits::eTransferRead, vk::PipelineStageFlagBits::eTransfer};
+
+	// Require no synchronization if this is a destination buffer.
+	case BufferUsage::ComputeShaderDst:
+	case BufferUsage::TransferDst:
+		return std::nullopt;
+	};
+	HEX_ASSERT(false);
+	return std::nullopt;
+}
+
+bool TaskBarriersTracker::IsReadBufferUsage(const BufferUsage usage)
+{
+	switch(usage)
+	{
+	case BufferUsage::IndirectDrawSrc:
+	case BufferUsage::IndexSrc:
+	case BufferUsage::VertexSrc:
+	case BufferUsage::UniformSrc:
+	case BufferUsage::ComputeShaderSrc:
+	case BufferUsage::TransferSrc:
+		return true;
+
+	case BufferUsage::ComputeShaderDst:
+	case BufferUsage::TransferDst:
+		return false;
+	};
+
+	HEX_ASSERT(false);
+	return false;
+}
+
+uint32_t TaskBarriersTracker::GetBufferUsageBit(const BufferUsage usage)
+{
+	return 1u << uint32_t(usage);
+}
+
+vk::PipelineStageFlags TaskBarriersTracker::GetPipelineStageForBufferUsage(const BufferUsage usage)
+{
+	// TODO - check if this is correct.
+	switch(usage)
+	{
+	case BufferUsage::IndirectDrawSrc:
+		return vk::PipelineStageFlagBits::eDrawIndirect;
+	case BufferUsage::IndexSrc:
+		return vk::PipelineStageFlagBits::eVertexInput;
+	case BufferUsage::VertexSrc:
+		return vk::PipelineStageFlagBits::eVertexInput;
+	case BufferUsage::UniformSrc:
+		// TODO - list other kinds of shaders?
+		return vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eGeometryShader | vk::PipelineStageFlagBits::eFragmentShader;
+	case BufferUsage::ComputeShaderSrc:
+	case BufferUsage::ComputeShaderDst:
+		return vk::PipelineStageFlagBits::eComputeShader;
+	case BufferUsage::TransferSrc:
+	case BufferUsage::TransferDst:
+		return vk::PipelineStageFlagBits::eTransfer;
+	};
+
+	HEX_ASSERT(false);
+	return vk::PipelineStageFlags();
+}
+
+TaskBarriersTracker::ImageSyncInfo TaskBarriersTracker::GetSyncInfoForImageUsage(const ImageUsage usage)
+{
+	switch(usage)
+	{
+	case ImageUsage::GraphicsSrc:
+		// TODO - list other kinds of shaders?
+		return {vk::AccessFlagBits::eShaderRead, vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eGeometryShader | vk::PipelineStageFlagBits::eFragmentShader, vk::ImageLayout::eShaderReadOnlyOptimal};
+	case ImageUsage::TransferDst:
+		return {vk::AccessFlagBits::eTransferWrite, vk::PipelineStageFlagBits::eTransfer, vk::ImageLayout::eTransferDstOptimal};
+	case ImageUsage::TransferSrc:
+		return {vk::AccessFlagBits::eTransferRead, vk::PipelineStageFlagBits::eTransfer, vk::ImageLayout::eTransferSrcOptimal};
+	case ImageUsage::ComputeDst:
+		return {vk::AccessFlagBits::eShaderWrite, vk::PipelineStageFlagBits::eComputeShader, vk::ImageLayout::eGeneral};
+	case ImageUsage::ColorAttachment:
+		return {vk::AccessFlagBits::eColorAttachmentWrite, vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::ImageLayout::eColorAttachmentOptimal};
+	case ImageUsage::DepthAttachment:
+		return {vk::AccessFlagBits::eDepthStencilAttachmentWrite, vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests, vk::ImageLayout::eDepthStencilAttachmentOptimal};
+	};
+
+	HEX_ASSERT(false);
+	return {};
+}
+
+} // namespace HexGPU
@@ -0,0 +1,179 @@
+#pragma once
+#include "HexGPUVulkan.hpp"
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace HexGPU
+{
+
+/*
+	Tracker of buffers and images usage by tasks, which calculates barriers needed before each task.
+	It only calculates barriers and doesn't record any commands, so it doesn't need a Vulkan device.
+	See TaskOrganizer for the synchronization rules.
+*/
+class TaskBarriersTracker
+{
+public:
+	struct ImageInfo
+	{
+		vk::Image image;
+		vk::ImageAspectFlags asppect_flags;
+		uint32_t num_mips= 0;
+		uint32_t num_layers= 0;
+	};
+
+	// Part of a buffer, used by a task.
+	// Specifying exact ranges allows to avoid synchronization between tasks accessing different parts of the same buffer.
+	struct BufferRange
+	{
+		// Implicit conversion from buffer - for whole buffer range.
+		BufferRange(vk::Buffer in_buffer, vk::DeviceSize in_offset= 0, vk::DeviceSize in_size= VK_WHOLE_SIZE)
+			: buffer(in_buffer), offset(in_offset), size(in_size)
+		{}
+
+		vk::Buffer buffer;
+		vk::DeviceSize offset= 0;
+		vk::DeviceSize size= VK_WHOLE_SIZE;
+	};
+
+	enum struct BufferUsage : uint8_t
+	{
+		IndirectDrawSrc,
+		IndexSrc,
+		VertexSrc,
+		UniformSrc,
+		ComputeShaderSrc,
+		ComputeShaderDst,
+		TransferDst,
+		TransferSrc,
+	};
+
+	enum class ImageUsage : uint8_t
+	{
+		GraphicsSrc,
+		TransferDst,
+		TransferSrc,
+		ComputeDst,
+		ColorAttachment,
+		DepthAttachment,
+	};
+
+	// All resources accessed by a task.
+	struct TaskUsages
+	{
+		std::vector<std::pair<BufferRange, BufferUsage>> buffers;
+		std::vector<std::pair<ImageInfo, ImageUsage>> images;
+	};
+
+	// Barriers collected for a task. All of them are issued via single command.
+	struct BarriersBatch
+	{
+		std::vector<vk::BufferMemoryBarrier> buffer_barriers;
+		std::vector<vk::ImageMemoryBarrier> image_barriers;
+		vk::PipelineStageFlags src_pipeline_stage_flags;
+		vk::PipelineStageFlags dst_pipeline_stage_flags;
+		// Set if only execution dependency is needed (for write after read).
+		bool require_execution_barrier= false;
+
+		bool IsEmpty() const;
+	};
+
+public:
+	// Queue family index is used for barriers.
+	explicit TaskBarriersTracker(uint32_t queue_family_index);
+
+	// Calculate barriers needed before a task with given usages and remember these usages for following tasks.
+	BarriersBatch AddTask(const TaskUsages& usages);
+
+	// Move barriers of tasks (given in execution order) into barriers of earlier tasks, where it's possible.
+	// Barriers of a task may be moved only past tasks not conflicting with it (which don't write what this task accesses and don't access what this task writes).
+	// Barriers are merged only if the earlier barrier already waits for the same pipeline stages, so that merging doesn't introduce extra stalls.
+	// Moved barriers become empty.
+	static void MergeTasksBarriers(const std::vector<TaskUsages>& tasks_usages, std::vector<BarriersBatch>& tasks_barriers);
+
+private:
+	struct BufferSyncInfo
+	{
+		vk::AccessFlags access_flags;
+		vk::PipelineStageFlags pipeline_stage_flags;
+	};
+
+	struct BufferState
+	{
+		// Empty if this buffer wasn't written yet.
+		std::optional<BufferUsage> last_write_usage;
+		// Bit mask of read usages since last write, for which results of this write are already visible.
+		uint32_t synced_read_usages= 0;
+		// Stages of reads since last write. Next write should wait for them.
+		vk::PipelineStageFlags read_pipeline_stage_flags;
+
+		bool operator==(const BufferState& other) const
+		{
+			return
+				last_write_usage == other.last_write_usage &&
+				synced_read_usages == other.synced_read_usages &&
+				read_pipeline_stage_flags == other.read_pipeline_stage_flags;
+		}
+	};
+
+	// State of buffer parts - map of part start offset to state.
+	// Each part ends at start of the next part, last part ends at the buffer end.
+	// Adjacent parts with equal state are merged.
+	using BufferStateMap= std::map<vk::DeviceSize, BufferState>;
+
+	struct ImageSyncInfo
+	{
+		vk::AccessFlags access_flags;
+		vk::PipelineStageFlags pipeline_stage_flags;
+		vk::ImageLayout layout= vk::ImageLayout::eUndefined;
+	};
+
+private:
+	// Add barriers (if necessary) for given usage in the task.
+	void AddBufferReadSync(BarriersBatch& barriers, const BufferRange& range, BufferUsage usage) const;
+	void AddBufferWriteSync(BarriersBatch& barriers, const BufferRange& range, BufferUsage usage) const;
+	void AddBufferBarrier(
+		BarriersBatch& barriers,
+		const BufferRange& range,
+		const BufferSyncInfo& src_sync_info,
+		const BufferSyncInfo& dst_sync_info) const;
+	void AddImageSync(BarriersBatch& barriers, const ImageInfo& image_info, ImageUsage usage) const;
+
+	void UpdateBufferReadUsage(const BufferRange& range, BufferUsage usage);
+	void UpdateBufferWriteUsage(const BufferRange& range, BufferUsage usage);
+
+	// Calls given function for each part of buffer state, overlapping given range.
+	template<typename Func>
+	void ForEachBufferStatePart(const BufferRange& range, const Func& func) const;
+	// Modifies state of given range, splitting/merging parts if necessary.
+	template<typename Func>
+	void ModifyBufferState(const BufferRange& range, const Func& func);
+
+	std::optional<ImageUsage> GetLastImageUsage(vk::Image image) const;
+	ImageSyncInfo GetSyncInfoForLastImageUsage(vk::Image image) const;
+
+	static vk::DeviceSize GetBufferRangeEnd(const BufferRange& range);
+	static bool BufferRangesOverlap(const BufferRange& l, const BufferRange& r);
+	static bool TasksConflict(const TaskUsages& l, const TaskUsages& r);
+	static void MergeBarriers(BarriersBatch& dst, const BarriersBatch& src);
+
+	static std::optional<BufferSyncInfo> GetBufferSrcSyncInfo(BufferUsage usage);
+	static std::optional<BufferSyncInfo> GetBufferDstSyncInfo(BufferUsage usage);
+	static bool IsReadBufferUsage(BufferUsage usage);
+	static uint32_t GetBufferUsageBit(BufferUsage usage);
+	static vk::PipelineStageFlags GetPipelineStageForBufferUsage(BufferUsage usage);
+
+	static ImageSyncInfo GetSyncInfoForImageUsage(ImageUsage usage);
+
+private:
+	const uint32_t queue_family_index_;
+
+	// Remember buffer usages in order to setup barriers properly.
+	std::unordered_map<VkBuffer, BufferStateMap> buffers_state_;
+	std::unordered_map<VkImage, ImageUsage> last_image_usage_;
+};
+
+} // namespace HexGPU
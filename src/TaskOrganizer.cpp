@@ -1,632 +1,462 @@
 #include "TaskOrganizer.hpp"
 #include "Assert.hpp"
+#include "Log.hpp"
+#include <algorithm>
+#include <fstream>
 
 namespace HexGPU
 {
 
-TaskOrganizer::TaskOrganizer(WindowVulkan& window_vulkan)
-	: queue_family_index_(window_vulkan.GetQueueFamilyIndex())
+namespace
 {
-}
 
-void TaskOrganizer::SetCommandBuffer(vk::CommandBuffer command_buffer)
-{
-	command_buffer_= command_buffer;
-}
+// Two queries for each task.
+constexpr uint32_t c_max_profiled_tasks_per_frame= 128;
+constexpr uint32_t c_profiling_queries_per_frame= c_max_profiled_tasks_per_frame * 2;
 
-void TaskOrganizer::ExecuteTask(const ComputeTaskParams& params, const TaskFunc& func)
+// Number of frames for rolling statistics.
+constexpr size_t c_profiling_num_samples= 128;
+
+uint32_t GetTimestampValidBits(WindowVulkan& window_vulkan, const uint32_t queue_family_index)
 {
-	std::vector<vk::BufferMemoryBarrier> buffer_barriers;
-	std::vector<vk::ImageMemoryBarrier> image_barriers;
-	vk::PipelineStageFlags src_pipeline_stage_flags;
-	vk::PipelineStageFlags dst_pipeline_stage_flags;
-	bool require_barrier_for_write_after_read_sync= false;
+	const std::vector<vk::QueueFamilyProperties> queue_family_properties=
+		window_vulkan.GetPhysicalDevice().getQueueFamilyProperties();
 
-	if(const auto dst_sync_info= GetBufferDstSyncInfo(BufferUsage::ComputeShaderSrc))
-	{
-		for(const vk::Buffer buffer : params.input_storage_buffers)
-		{
-			if(const auto src_sync_info= GetBufferSrcSyncInfoForLastUsage(buffer))
-			{
-				buffer_barriers.emplace_back(
-					src_sync_info->access_flags, dst_sync_info->access_flags,
-					queue_family_index_, queue_family_index_,
-					buffer,
-					0, VK_WHOLE_SIZE);
-				src_pipeline_stage_flags|= src_sync_info->pipeline_stage_flags;
-				dst_pipeline_stage_flags|= dst_sync_info->pipeline_stage_flags;
-			}
-		}
+	return queue_family_properties[queue_family_index].timestampValidBits;
+}
 
-		for(const vk::Buffer buffer : params.input_output_storage_buffers)
-		{
-			if(const auto src_sync_info= GetBufferSrcSyncInfoForLastUsage(buffer))
-			{
-				buffer_barriers.emplace_back(
-					src_sync_info->access_flags, dst_sync_info->access_flags,
-					queue_family_index_, queue_family_index_,
-					buffer,
-					0, VK_WHOLE_SIZE);
-				src_pipeline_stage_flags|= src_sync_info->pipeline_stage_flags;
-				dst_pipeline_stage_flags|= dst_sync_info->pipeline_stage_flags;
-			}
-			if(const auto last_usage= GetLastBufferUsage(buffer))
-			{
-				if(IsReadBufferUsage(*last_usage))
-				{
-					require_barrier_for_write_after_read_sync= true;
-					src_pipeline_stage_flags|= GetPipelineStageForBufferUsage(*last_usage);
-					dst_pipeline_stage_flags|= vk::PipelineStageFlagBits::eComputeShader;
-				}
-			}
-		}
-	}
+} // namespace
 
-	for(const vk::Buffer buffer : params.output_storage_buffers)
-	{
-		if(const auto last_usage= GetLastBufferUsage(buffer))
-		{
-			if(IsReadBufferUsage(*last_usage))
-			{
-				require_barrier_for_write_after_read_sync= true;
-				src_pipeline_stage_flags|= GetPipelineStageForBufferUsage(*last_usage);
-				dst_pipeline_stage_flags|= vk::PipelineStageFlagBits::eComputeShader;
-			}
-		}
-	}
+TaskOrganizer::TaskOrganizer(WindowVulkan& window_vulkan, Settings& settings, const bool async_compute)
+	: vk_device_(window_vulkan.GetVulkanDevice())
+	, queue_family_index_(async_compute ? window_vulkan.GetAsyncComputeQueueFamilyIndex() : window_vulkan.GetQueueFamilyIndex())
+	, timestamp_valid_bits_(GetTimestampValidBits(window_vulkan, queue_family_index_))
+	, timestamp_period_ns_(window_vulkan.GetPhysicalDevice().getProperties().limits.timestampPeriod)
+	, profiling_enabled_(settings.GetOrSetInt("r_gpu_profiling", 0) != 0)
+	, barriers_tracker_(queue_family_index_)
+{
+	HEX_ASSERT(!async_compute || window_vulkan.HasAsyncCompute());
 
-	for(const ImageInfo& image_info : params.output_images)
+	if(timestamp_valid_bits_ == 0)
 	{
-		if(GetLastImageUsage(image_info.image) != ImageUsage::ComputeDst)
-		{
-			const auto sync_info= GetSyncInfoForLastImageUsage(image_info.image);
-			image_barriers.emplace_back(
-				sync_info.access_flags, vk::AccessFlagBits::eShaderWrite,
-				sync_info.layout, vk::ImageLayout::eGeneral,
-				queue_family_index_, queue_family_index_,
-				image_info.image,
-				vk::ImageSubresourceRange(image_info.asppect_flags, 0u, image_info.num_mips, 0u, image_info.num_layers));
-
-			src_pipeline_stage_flags|= sync_info.pipeline_stage_flags;
-			dst_pipeline_stage_flags|= vk::PipelineStageFlagBits::eComputeShader;
-		}
+		Log::Info("Timestamp queries aren't supported, GPU profiling isn't possible");
+		profiling_enabled_= false;
+		return;
 	}
 
-	if(!buffer_barriers.empty() || !image_barriers.empty() || require_barrier_for_write_after_read_sync)
-		command_buffer_.pipelineBarrier(
-			src_pipeline_stage_flags,
-			dst_pipeline_stage_flags,
-			vk::DependencyFlags(),
-			{},
-			buffer_barriers,
-			image_barriers);
-
-	func(command_buffer_);
-
-	UpdateLastBuffersUsage(params.input_storage_buffers, BufferUsage::ComputeShaderSrc);
-	UpdateLastBuffersUsage(params.output_storage_buffers, BufferUsage::ComputeShaderDst);
-	UpdateLastBuffersUsage(params.input_output_storage_buffers, BufferUsage::ComputeShaderDst);
-
-	for(const ImageInfo& image_info : params.output_images)
-		UpdateLastImageUsage(image_info.image, ImageUsage::ComputeDst);
+	profiling_frames_data_.resize(window_vulkan.GetNumCommandBuffers());
+	for(ProfilingFrameData& frame_data : profiling_frames_data_)
+		frame_data.query_pool=
+			vk_device_.createQueryPoolUnique(
+				vk::QueryPoolCreateInfo(
+					vk::QueryPoolCreateFlags(),
+					vk::QueryType::eTimestamp,
+					c_profiling_queries_per_frame));
 }
 
-void TaskOrganizer::ExecuteTask(const GraphicsTaskParams& params, const TaskFunc& func)
+void TaskOrganizer::SetCommandBuffer(vk::CommandBuffer command_buffer)
 {
-	std::vector<vk::BufferMemoryBarrier> buffer_barriers;
-	std::vector<vk::ImageMemoryBarrier> image_barriers;
-	vk::PipelineStageFlags src_pipeline_stage_flags;
-	vk::PipelineStageFlags dst_pipeline_stage_flags;
+	HEX_ASSERT(!deferred_recording_);
 
-	if(const auto dst_sync_info= GetBufferDstSyncInfo(BufferUsage::IndirectDrawSrc))
-	{
-		for(const vk::Buffer buffer : params.indirect_draw_buffers)
-		{
-			if(const auto src_sync_info= GetBufferSrcSyncInfoForLastUsage(buffer))
-			{
-				buffer_barriers.emplace_back(
-					src_sync_info->access_flags, dst_sync_info->access_flags,
-					queue_family_index_, queue_family_index_,
-					buffer,
-					0, VK_WHOLE_SIZE);
-				src_pipeline_stage_flags|= src_sync_info->pipeline_stage_flags;
-				dst_pipeline_stage_flags|= dst_sync_info->pipeline_stage_flags;
-			}
-		}
-	}
+	command_buffer_= command_buffer;
 
-	if(const auto dst_sync_info= GetBufferDstSyncInfo(BufferUsage::IndexSrc))
-	{
-		for(const vk::Buffer buffer : params.index_buffers)
-		{
-			if(const auto src_sync_info= GetBufferSrcSyncInfoForLastUsage(buffer))
-			{
-				buffer_barriers.emplace_back(
-					src_sync_info->access_flags, dst_sync_info->access_flags,
-					queue_family_index_, queue_family_index_,
-					buffer,
-					0, VK_WHOLE_SIZE);
-				src_pipeline_stage_flags|= src_sync_info->pipeline_stage_flags;
-				dst_pipeline_stage_flags|= dst_sync_info->pipeline_stage_flags;
-			}
-		}
-	}
+	last_frame_barriers_stats_= current_frame_barriers_stats_;
+	current_frame_barriers_stats_= BarriersStats();
 
-	if(const auto dst_sync_info= GetBufferDstSyncInfo(BufferUsage::VertexSrc))
-	{
-		for(const vk::Buffer buffer : params.vertex_buffers)
-		{
-			if(const auto src_sync_info= GetBufferSrcSyncInfoForLastUsage(buffer))
-			{
-				buffer_barriers.emplace_back(
-					src_sync_info->access_flags, dst_sync_info->access_flags,
-					queue_family_index_, queue_family_index_,
-					buffer,
-					0, VK_WHOLE_SIZE);
-				src_pipeline_stage_flags|= src_sync_info->pipeline_stage_flags;
-				dst_pipeline_stage_flags|= dst_sync_info->pipeline_stage_flags;
-			}
-		}
-	}
+	last_frame_recording_time_= current_frame_recording_time_;
+	current_frame_recording_time_= std::chrono::steady_clock::duration(0);
 
-	if(const auto dst_sync_info= GetBufferDstSyncInfo(BufferUsage::UniformSrc))
-	{
-		for(const vk::Buffer buffer : params.uniform_buffers)
-		{
-			if(const auto src_sync_info= GetBufferSrcSyncInfoForLastUsage(buffer))
-			{
-				buffer_barriers.emplace_back(
-					src_sync_info->access_flags, dst_sync_info->access_flags,
-					queue_family_index_, queue_family_index_,
-					buffer,
-					0, VK_WHOLE_SIZE);
-				src_pipeline_stage_flags|= src_sync_info->pipeline_stage_flags;
-				dst_pipeline_stage_flags|= dst_sync_info->pipeline_stage_flags;
-			}
-		}
-	}
+	if(profiling_frames_data_.empty())
+		return;
 
-	for(const ImageInfo image_info : params.input_images)
-	{
-		if(GetLastImageUsage(image_info.image) != ImageUsage::GraphicsSrc)
-		{
-			const auto sync_info= GetSyncInfoForLastImageUsage(image_info.image);
-			image_barriers.emplace_back(
-				sync_info.access_flags, vk::AccessFlagBits::eShaderRead,
-				sync_info.layout, vk::ImageLayout::eShaderReadOnlyOptimal,
-				queue_family_index_, queue_family_index_,
-				image_info.image,
-				vk::ImageSubresourceRange(image_info.asppect_flags, 0u, image_info.num_mips, 0u, image_info.num_layers));
-
-			src_pipeline_stage_flags|= sync_info.pipeline_stage_flags;
-			// Do not allow to execute vertex shader before image isn't ready, since image reads are possible already in vertex shader.
-			dst_pipeline_stage_flags|= vk::PipelineStageFlagBits::eVertexShader;
-		}
-	}
+	// Frames data is reused in the same order as command buffers.
+	// So, previous usage of this frame data is finished and results are available.
+	ProfilingFrameData& frame_data= profiling_frames_data_[profiling_frame_number_ % profiling_frames_data_.size()];
+	++profiling_frame_number_;
 
-	for(const ImageInfo image_info : params.output_color_images)
-	{
-		if(GetLastImageUsage(image_info.image) != ImageUsage::ColorAttachment)
-		{
-			const auto sync_info= GetSyncInfoForLastImageUsage(image_info.image);
-			image_barriers.emplace_back(
-				sync_info.access_flags, vk::AccessFlagBits::eColorAttachmentWrite,
-				sync_info.layout, vk::ImageLayout::eColorAttachmentOptimal,
-				queue_family_index_, queue_family_index_,
-				image_info.image,
-				vk::ImageSubresourceRange(image_info.asppect_flags, 0u, image_info.num_mips, 0u, image_info.num_layers));
-
-			src_pipeline_stage_flags|= sync_info.pipeline_stage_flags;
-			dst_pipeline_stage_flags|= vk::PipelineStageFlagBits::eColorAttachmentOutput;
-		}
-	}
+	last_profiled_frame_busy_time_ms_= std::nullopt;
+	if(!frame_data.task_names.empty())
+		ReadBackProfilingResults(frame_data);
+	frame_data.task_names.clear();
 
-	for(const ImageInfo image_info : params.output_depth_images)
+	if(profiling_enabled_)
 	{
-		if(GetLastImageUsage(image_info.image) != ImageUsage::DepthAttachment)
-		{
-			const auto sync_info= GetSyncInfoForLastImageUsage(image_info.image);
-			image_barriers.emplace_back(
-				sync_info.access_flags, vk::AccessFlagBits::eDepthStencilAttachmentWrite,
-				sync_info.layout, vk::ImageLayout::eDepthStencilAttachmentOptimal,
-				queue_family_index_, queue_family_index_,
-				image_info.image,
-				vk::ImageSubresourceRange(image_info.asppect_flags, 0u, image_info.num_mips, 0u, image_info.num_layers));
-
-			src_pipeline_stage_flags|= sync_info.pipeline_stage_flags;
-			dst_pipeline_stage_flags|= vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests;
-		}
+		command_buffer_.resetQueryPool(*frame_data.query_pool, 0, c_profiling_queries_per_frame);
+		current_profiling_frame_data_= &frame_data;
 	}
+	else
+		current_profiling_frame_data_= nullptr;
+}
 
-	if(!buffer_barriers.empty() || !image_barriers.empty())
-		command_buffer_.pipelineBarrier(
-			src_pipeline_stage_flags,
-			dst_pipeline_stage_flags,
-			vk::DependencyFlags(),
-			{},
-			buffer_barriers,
-			image_barriers);
-
-	command_buffer_.beginRenderPass(
-		vk::RenderPassBeginInfo(
-			params.render_pass,
-			params.framebuffer,
-			vk::Rect2D(vk::Offset2D(0, 0), params.viewport_size),
-			uint32_t(params.clear_values.size()), params.clear_values.data()),
-		vk::SubpassContents::eInline);
-
-	func(command_buffer_);
+bool TaskOrganizer::IsProfilingSupported() const
+{
+	return !profiling_frames_data_.empty();
+}
 
-	command_buffer_.endRenderPass();
+bool TaskOrganizer::IsProfilingEnabled() const
+{
+	return profiling_enabled_;
+}
 
-	UpdateLastBuffersUsage(params.indirect_draw_buffers, BufferUsage::IndirectDrawSrc);
-	UpdateLastBuffersUsage(params.index_buffers, BufferUsage::IndexSrc);
-	UpdateLastBuffersUsage(params.vertex_buffers, BufferUsage::VertexSrc);
-	UpdateLastBuffersUsage(params.uniform_buffers, BufferUsage::UniformSrc);
+void TaskOrganizer::SetProfilingEnabled(const bool enabled)
+{
+	profiling_enabled_= enabled && IsProfilingSupported();
+}
 
-	for(const ImageInfo& image_info : params.input_images)
-		UpdateLastImageUsage(image_info.image, ImageUsage::GraphicsSrc);
+std::optional<double> TaskOrganizer::GetLastProfiledFrameBusyTimeMs() const
+{
+	return last_profiled_frame_busy_time_ms_;
+}
 
-	for(const ImageInfo& image_info : params.output_color_images)
-		UpdateLastImageUsage(image_info.image, ImageUsage::ColorAttachment);
+TaskOrganizer::BarriersStats TaskOrganizer::GetLastFrameBarriersStats() const
+{
+	return last_frame_barriers_stats_;
+}
 
-	for(const ImageInfo& image_info : params.output_depth_images)
-		UpdateLastImageUsage(image_info.image, ImageUsage::DepthAttachment);
+std::chrono::steady_clock::duration TaskOrganizer::GetLastFrameRecordingTime() const
+{
+	return last_frame_recording_time_;
 }
 
-void TaskOrganizer::ExecuteTask(const TransferTaskParams& params, const TaskFunc& func)
+std::vector<TaskOrganizer::TaskTimeStats> TaskOrganizer::GetTasksTimeStats() const
 {
-	std::vector<vk::BufferMemoryBarrier> buffer_barriers;
-	std::vector<vk::ImageMemoryBarrier> image_barriers;
-	vk::PipelineStageFlags src_pipeline_stage_flags;
-	vk::PipelineStageFlags dst_pipeline_stage_flags;
-	bool require_barrier_for_write_after_read_sync= false;
+	std::vector<TaskTimeStats> result;
+	result.reserve(tasks_time_samples_.size());
 
-	if(const auto dst_sync_info= GetBufferDstSyncInfo(BufferUsage::TransferSrc))
+	for(const auto& samples_pair : tasks_time_samples_)
 	{
-		for(const vk::Buffer buffer : params.input_buffers)
-		{
-			if(const auto src_sync_info= GetBufferSrcSyncInfoForLastUsage(buffer))
-			{
-				buffer_barriers.emplace_back(
-					src_sync_info->access_flags, dst_sync_info->access_flags,
-					queue_family_index_, queue_family_index_,
-					buffer,
-					0, VK_WHOLE_SIZE);
-				src_pipeline_stage_flags|= src_sync_info->pipeline_stage_flags;
-				dst_pipeline_stage_flags|= dst_sync_info->pipeline_stage_flags;
-			}
-		}
-	}
+		const std::deque<float>& samples= samples_pair.second;
+		if(samples.empty())
+			continue;
 
-	for(const vk::Buffer buffer : params.output_buffers)
-	{
-		if(const auto last_usage= GetLastBufferUsage(buffer))
-		{
-			if(IsReadBufferUsage(*last_usage))
-			{
-				require_barrier_for_write_after_read_sync= true;
-				src_pipeline_stage_flags|= GetPipelineStageForBufferUsage(*last_usage);
-				dst_pipeline_stage_flags|= vk::PipelineStageFlagBits::eTransfer;
-			}
-		}
+		TaskTimeStats stats;
+		stats.name= samples_pair.first;
+		stats.min_ms= *std::min_element(samples.begin(), samples.end());
+		stats.max_ms= *std::max_element(samples.begin(), samples.end());
+
+		float sum= 0.0f;
+		for(const float sample : samples)
+			sum+= sample;
+		stats.avg_ms= sum / float(samples.size());
+
+		result.push_back(std::move(stats));
 	}
 
-	for(const ImageInfo image_info : params.input_images)
+	return result;
+}
+
+bool TaskOrganizer::SaveTasksTimeStatsToCSV(const std::string& file_name) const
+{
+	std::ofstream file(file_name);
+	if(!file.is_open())
 	{
-		if(GetLastImageUsage(image_info.image) != ImageUsage::TransferSrc)
-		{
-			const auto sync_info= GetSyncInfoForLastImageUsage(image_info.image);
-			image_barriers.emplace_back(
-				sync_info.access_flags, vk::AccessFlagBits::eTransferRead,
-				sync_info.layout, vk::ImageLayout::eTransferSrcOptimal,
-				queue_family_index_, queue_family_index_,
-				image_info.image,
-				vk::ImageSubresourceRange(image_info.asppect_flags, 0u, image_info.num_mips, 0u, image_info.num_layers));
-
-			src_pipeline_stage_flags|= sync_info.pipeline_stage_flags;
-			dst_pipeline_stage_flags|= vk::PipelineStageFlagBits::eTransfer;
-		}
+		Log::Warning("Can't open file \"", file_name, "\"");
+		return false;
 	}
 
-	for(const ImageInfo& image_info : params.output_images)
+	file << "task,min_ms,avg_ms,max_ms\n";
+	for(const TaskTimeStats& stats : GetTasksTimeStats())
+		file << stats.name << "," << stats.min_ms << "," << stats.avg_ms << "," << stats.max_ms << "\n";
+
+	return bool(file);
+}
+
+void TaskOrganizer::ExecuteTask(const ComputeTaskParams& params, const TaskFunc& func)
+{
+	TaskUsages usages;
+	AddBuffersUsage(usages, params.input_storage_buffers, BufferUsage::ComputeShaderSrc);
+	for(const BufferRange& range : params.input_output_storage_buffers)
 	{
-		if(GetLastImageUsage(image_info.image) != ImageUsage::TransferDst)
-		{
-			const auto sync_info= GetSyncInfoForLastImageUsage(image_info.image);
-			image_barriers.emplace_back(
-				sync_info.access_flags, vk::AccessFlagBits::eTransferWrite,
-				sync_info.layout, vk::ImageLayout::eTransferDstOptimal,
-				queue_family_index_, queue_family_index_,
-				image_info.image,
-				vk::ImageSubresourceRange(image_info.asppect_flags, 0u, image_info.num_mips, 0u, image_info.num_layers));
-
-			src_pipeline_stage_flags|= sync_info.pipeline_stage_flags;
-			dst_pipeline_stage_flags|= vk::PipelineStageFlagBits::eTransfer;
-		}
+		usages.buffers.emplace_back(range, BufferUsage::ComputeShaderSrc);
+		usages.buffers.emplace_back(range, BufferUsage::ComputeShaderDst);
 	}
+	AddBuffersUsage(usages, params.output_storage_buffers, BufferUsage::ComputeShaderDst);
+	AddImagesUsage(usages, params.output_images, ImageUsage::ComputeDst);
 
-	if(!buffer_barriers.empty() || !image_barriers.empty() || require_barrier_for_write_after_read_sync)
-		command_buffer_.pipelineBarrier(
-			src_pipeline_stage_flags,
-			dst_pipeline_stage_flags,
-			vk::DependencyFlags(),
-			{},
-			buffer_barriers,
-			image_barriers);
+	AddTask(params.name, usages, func);
+}
 
-	func(command_buffer_);
+void TaskOrganizer::ExecuteTask(const GraphicsTaskParams& params, const TaskFunc& func)
+{
+	TaskUsages usages;
+	AddBuffersUsage(usages, params.indirect_draw_buffers, BufferUsage::IndirectDrawSrc);
+	AddBuffersUsage(usages, params.index_buffers, BufferUsage::IndexSrc);
+	AddBuffersUsage(usages, params.vertex_buffers, BufferUsage::VertexSrc);
+	AddBuffersUsage(usages, params.uniform_buffers, BufferUsage::UniformSrc);
+	AddImagesUsage(usages, params.input_images, ImageUsage::GraphicsSrc);
+	AddImagesUsage(usages, params.output_color_images, ImageUsage::ColorAttachment);
+	AddImagesUsage(usages, params.output_depth_images, ImageUsage::DepthAttachment);
+
+	// Write timestamps outside the render pass in order to include its begin/end operations.
+	AddTask(
+		params.name,
+		usages,
+		[
+			func,
+			render_pass= params.render_pass,
+			framebuffer= params.framebuffer,
+			viewport_size= params.viewport_size,
+			clear_values= params.clear_values
+		]
+		(const vk::CommandBuffer command_buffer)
+		{
+			command_buffer.beginRenderPass(
+				vk::RenderPassBeginInfo(
+					render_pass,
+					framebuffer,
+					vk::Rect2D(vk::Offset2D(0, 0), viewport_size),
+					uint32_t(clear_values.size()), clear_values.data()),
+				vk::SubpassContents::eInline);
+
+			func(command_buffer);
+
+			command_buffer.endRenderPass();
+		});
+}
 
-	UpdateLastBuffersUsage(params.input_buffers, BufferUsage::TransferSrc);
-	UpdateLastBuffersUsage(params.output_buffers, BufferUsage::TransferDst);
+void TaskOrganizer::ExecuteTask(const TransferTaskParams& params, const TaskFunc& func)
+{
+	TaskUsages usages;
+	AddBuffersUsage(usages, params.input_buffers, BufferUsage::TransferSrc);
+	AddBuffersUsage(usages, params.output_buffers, BufferUsage::TransferDst);
+	AddImagesUsage(usages, params.input_images, ImageUsage::TransferSrc);
+	AddImagesUsage(usages, params.output_images, ImageUsage::TransferDst);
 
-	for(const ImageInfo& image_info : params.input_images)
-		UpdateLastImageUsage(image_info.image, ImageUsage::TransferSrc);
-	for(const ImageInfo& image_info : params.output_images)
-		UpdateLastImageUsage(image_info.image, ImageUsage::TransferDst);
+	AddTask(params.name, usages, func);
 }
 
 void TaskOrganizer::GenerateImageMips(const ImageInfo& image_info, const vk::Extent2D image_size)
 {
 	// First transfer the whole image to TransferSrcOptimal layout.
-	if(GetLastImageUsage(image_info.image) != ImageUsage::TransferSrc)
-	{
-		const auto sync_info= GetSyncInfoForLastImageUsage(image_info.image);
-		const vk::ImageMemoryBarrier image_barrier(
-			sync_info.access_flags, vk::AccessFlagBits::eTransferRead,
-			sync_info.layout, vk::ImageLayout::eTransferSrcOptimal,
-			queue_family_index_, queue_family_index_,
-			image_info.image,
-			vk::ImageSubresourceRange(image_info.asppect_flags, 0u, image_info.num_mips, 0u, image_info.num_layers));
-
-		command_buffer_.pipelineBarrier(
-			sync_info.pipeline_stage_flags,
-			 vk::PipelineStageFlagBits::eTransfer,
-			vk::DependencyFlags(),
-			0u, nullptr,
-			0u, nullptr,
-			1u, &image_barrier);
-	}
-
-	// Pefrom blitting for mip chain.
-	for(uint32_t i= 1; i < image_info.num_mips; ++i)
-	{
-		// Transfer destination mip to TransferDstOptimal layout.
+	// At the end of the mip chain generation all image mips are in TransferSrc layout too.
+	TaskUsages usages;
+	usages.images.emplace_back(image_info, ImageUsage::TransferSrc);
+
+	AddTask(
+		"",
+		usages,
+		[this, image_info, image_size](const vk::CommandBuffer command_buffer)
 		{
-			const vk::ImageMemoryBarrier image_barrier(
-				vk::AccessFlagBits(), vk::AccessFlagBits::eTransferWrite,
-				vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
-				queue_family_index_, queue_family_index_,
-				image_info.image,
-				vk::ImageSubresourceRange(image_info.asppect_flags, i, 1, 0u, image_info.num_layers));
-
-			command_buffer_.pipelineBarrier(
-				vk::PipelineStageFlagBits::eBottomOfPipe,
-				vk::PipelineStageFlagBits::eTransfer,
-				vk::DependencyFlags(),
-				0u, nullptr,
-				0u, nullptr,
-				1u, &image_barrier);
-		}
-
-		// Perform blitting with linear interpolation.
-		// This effectively avegages pixels in 2x2 block.
-
-		const vk::ImageBlit image_blit(
-			vk::ImageSubresourceLayers(image_info.asppect_flags, i - 1, 0u, image_info.num_layers),
+			// Pefrom blitting for mip chain.
+			for(uint32_t i= 1; i < image_info.num_mips; ++i)
 			{
-				vk::Offset3D(0, 0, 0),
-				vk::Offset3D(image_size.width >> (i - 1), image_size.height >> (i - 1), 1),
-			},
-			vk::ImageSubresourceLayers(image_info.asppect_flags, i, 0u, image_info.num_layers),
-			{
-				vk::Offset3D(0, 0, 0),
-				vk::Offset3D(image_size.width >> i, image_size.height >> i, 1),
-			});
-
-		command_buffer_.blitImage(
-			image_info.image,
-			vk::ImageLayout::eTransferSrcOptimal,
-			image_info.image,
-			vk::ImageLayout::eTransferDstOptimal,
-			1u, &image_blit,
-			vk::Filter::eLinear);
-
-		// Transfer this mip to TransferSrcOptimal layout.
-		{
-			const vk::ImageMemoryBarrier image_barrier(
-				vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eTransferRead,
-				vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eTransferSrcOptimal,
-				queue_family_index_, queue_family_index_,
-				image_info.image,
-				vk::ImageSubresourceRange(image_info.asppect_flags, i, 1, 0u, image_info.num_layers));
-
-			command_buffer_.pipelineBarrier(
-				vk::PipelineStageFlagBits::eTransfer,
-				vk::PipelineStageFlagBits::eTransfer,
-				vk::DependencyFlags(),
-				0u, nullptr,
-				0u, nullptr,
-				1u, &image_barrier);
-		}
-	}
+				// Transfer destination mip to TransferDstOptimal layout.
+				{
+					BarriersBatch barriers;
+					barriers.image_barriers.emplace_back(
+						vk::AccessFlagBits(), vk::AccessFlagBits::eTransferWrite,
+						vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
+						queue_family_index_, queue_family_index_,
+						image_info.image,
+						vk::ImageSubresourceRange(image_info.asppect_flags, i, 1, 0u, image_info.num_layers));
+					barriers.src_pipeline_stage_flags= vk::PipelineStageFlagBits::eBottomOfPipe;
+					barriers.dst_pipeline_stage_flags= vk::PipelineStageFlagBits::eTransfer;
+
+					FlushBarriers(barriers);
+				}
 
-	// At the end of the mip chain generation all image mips should be in TransferSrc layout.
-	// Mark this as image TransferSrc usage.
-	UpdateLastImageUsage(image_info.image, ImageUsage::TransferSrc);
+				// Perform blitting with linear interpolation.
+				// This effectively avegages pixels in 2x2 block.
+
+				const vk::ImageBlit image_blit(
+					vk::ImageSubresourceLayers(image_info.asppect_flags, i - 1, 0u, image_info.num_layers),
+					{
+						vk::Offset3D(0, 0, 0),
+						vk::Offset3D(image_size.width >> (i - 1), image_size.height >> (i - 1), 1),
+					},
+					vk::ImageSubresourceLayers(image_info.asppect_flags, i, 0u, image_info.num_layers),
+					{
+						vk::Offset3D(0, 0, 0),
+						vk::Offset3D(image_size.width >> i, image_size.height >> i, 1),
+					});
+
+				command_buffer.blitImage(
+					image_info.image,
+					vk::ImageLayout::eTransferSrcOptimal,
+					image_info.image,
+					vk::ImageLayout::eTransferDstOptimal,
+					1u, &image_blit,
+					vk::Filter::eLinear);
+
+				// Transfer this mip to TransferSrcOptimal layout.
+				{
+					BarriersBatch barriers;
+					barriers.image_barriers.emplace_back(
+						vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eTransferRead,
+						vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eTransferSrcOptimal,
+						queue_family_index_, queue_family_index_,
+						image_info.image,
+						vk::ImageSubresourceRange(image_info.asppect_flags, i, 1, 0u, image_info.num_layers));
+					barriers.src_pipeline_stage_flags= vk::PipelineStageFlagBits::eTransfer;
+					barriers.dst_pipeline_stage_flags= vk::PipelineStageFlagBits::eTransfer;
+
+					FlushBarriers(barriers);
+				}
+			}
+		});
 }
 
-void TaskOrganizer::UpdateLastBuffersUsage(const std::vector<vk::Buffer> buffers, const BufferUsage usage)
+void TaskOrganizer::BeginDeferredRecording()
 {
-	for(const vk::Buffer buffer : buffers)
-		UpdateLastBufferUsage(buffer, usage);
+	HEX_ASSERT(!deferred_recording_);
+	deferred_recording_= true;
 }
 
-void TaskOrganizer::UpdateLastBufferUsage(const vk::Buffer buffer, const BufferUsage usage)
+void TaskOrganizer::EndDeferredRecording()
 {
-	last_buffer_usage_[buffer]= usage;
-}
+	HEX_ASSERT(deferred_recording_);
+	deferred_recording_= false;
 
-std::optional<TaskOrganizer::BufferUsage> TaskOrganizer::GetLastBufferUsage(const vk::Buffer buffer) const
-{
-	const auto it= last_buffer_usage_.find(buffer);
-	if(it == last_buffer_usage_.end())
-		return std::nullopt;
-	return it->second;
-}
+	TaskBarriersTracker::MergeTasksBarriers(deferred_tasks_usages_, deferred_tasks_barriers_);
 
-void TaskOrganizer::UpdateLastImageUsage(const vk::Image image, const ImageUsage usage)
-{
-	last_image_usage_[image]= usage;
+	for(size_t i= 0; i < deferred_tasks_.size(); ++i)
+		RecordTask(deferred_tasks_[i].name, deferred_tasks_barriers_[i], deferred_tasks_[i].func);
+
+	deferred_tasks_.clear();
+	deferred_tasks_usages_.clear();
+	deferred_tasks_barriers_.clear();
 }
 
-std::optional<TaskOrganizer::ImageUsage> TaskOrganizer::GetLastImageUsage(const vk::Image image) const
+bool TaskOrganizer::BeginTaskProfiling(const std::string_view name)
 {
-	const auto it= last_image_usage_.find(image);
-	if(it == last_image_usage_.end())
-		return std::nullopt;
-	return it->second;
+	if(current_profiling_frame_data_ == nullptr || name.empty())
+		return false;
+
+	if(current_profiling_frame_data_->task_names.size() >= c_max_profiled_tasks_per_frame)
+		return false;
+
+	// Use bottom of pipe stage in order to measure time between end of previous commands and end of this task commands.
+	const uint32_t query_index= uint32_t(current_profiling_frame_data_->task_names.size()) * 2;
+	command_buffer_.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, *current_profiling_frame_data_->query_pool, query_index);
+
+	current_profiling_frame_data_->task_names.push_back(name);
+	return true;
 }
 
-std::optional<TaskOrganizer::BufferSyncInfo> TaskOrganizer::GetBufferSrcSyncInfoForLastUsage(const vk::Buffer buffer) const
+void TaskOrganizer::EndTaskProfiling()
 {
-	if(const auto last_usage= GetLastBufferUsage(buffer))
-		return GetBufferSrcSyncInfo(*last_usage);
+	HEX_ASSERT(current_profiling_frame_data_ != nullptr);
+	HEX_ASSERT(!current_profiling_frame_data_->task_names.empty());
 
-	return std::nullopt;
+	const uint32_t query_index= uint32_t(current_profiling_frame_data_->task_names.size()) * 2 - 1;
+	command_buffer_.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, *current_profiling_frame_data_->query_pool, query_index);
 }
 
-std::optional<TaskOrganizer::BufferSyncInfo> TaskOrganizer::GetBufferSrcSyncInfo(const BufferUsage usage)
+void TaskOrganizer::ReadBackProfilingResults(ProfilingFrameData& frame_data)
 {
-	switch(usage)
+	const uint32_t num_queries= uint32_t(frame_data.task_names.size()) * 2;
+
+	std::vector<uint64_t> timestamps(num_queries, 0);
+	const vk::Result result=
+		vk_device_.getQueryPoolResults(
+			*frame_data.query_pool,
+			0u, num_queries,
+			timestamps.size() * sizeof(uint64_t), timestamps.data(),
+			sizeof(uint64_t),
+			vk::QueryResultFlagBits::e64);
+
+	if(result != vk::Result::eSuccess)
+		return; // Results aren't available for some reason.
+
+	const uint64_t timestamp_mask= timestamp_valid_bits_ >= 64 ? ~uint64_t(0) : ((uint64_t(1) << timestamp_valid_bits_) - 1);
+
+	const double timestamp_period_ms= double(timestamp_period_ns_) / 1.0e6;
+
+	// Sum time of tasks with the same name.
+	std::map<std::string_view, float> frame_tasks_time;
+	double frame_busy_time_ms= 0.0;
+	for(size_t i= 0; i < frame_data.task_names.size(); ++i)
 	{
-	// Require no synchronization if previous usage is constant.
-	case BufferUsage::IndirectDrawSrc:
-	case BufferUsage::IndexSrc:
-	case BufferUsage::VertexSrc:
-	case BufferUsage::UniformSrc:
-	case BufferUsage::ComputeShaderSrc:
-	case BufferUsage::TransferSrc:
-		return std::nullopt;
-
-	case BufferUsage::ComputeShaderDst:
-		return BufferSyncInfo{vk::AccessFlagBits::eShaderWrite, vk::PipelineStageFlagBits::eComputeShader};
-
-	case BufferUsage::TransferDst:
-		return BufferSyncInfo{vk::AccessFlagBits::eTransferWrite, vk::PipelineStageFlagBits::eTransfer};
-	};
-	HEX_ASSERT(false);
-	return std::nullopt;
+		const uint64_t start= timestamps[i * 2] & timestamp_mask;
+		const uint64_t end= timestamps[i * 2 + 1] & timestamp_mask;
+		const uint64_t delta= (end - start) & timestamp_mask;
+
+		const double time_ms= double(delta) * timestamp_period_ms;
+		frame_tasks_time[frame_data.task_names[i]]+= float(time_ms);
+		frame_busy_time_ms+= time_ms;
+	}
+
+	last_profiled_frame_busy_time_ms_= frame_busy_time_ms;
+
+	for(const auto& task_time_pair : frame_tasks_time)
+	{
+		auto it= tasks_time_samples_.find(task_time_pair.first);
+		if(it == tasks_time_samples_.end())
+			it= tasks_time_samples_.emplace(std::string(task_time_pair.first), std::deque<float>()).first;
+
+		std::deque<float>& samples= it->second;
+		samples.push_back(task_time_pair.second);
+		if(samples.size() > c_profiling_num_samples)
+			samples.pop_front();
+	}
 }
 
-std::optional<TaskOrganizer::BufferSyncInfo> TaskOrganizer::GetBufferDstSyncInfo(const BufferUsage usage)
+void TaskOrganizer::AddTask(const std::string_view name, const TaskUsages& usages, TaskFunc func)
 {
-	// TODO - check if this is correct.
-	switch(usage)
+	BarriersBatch barriers= barriers_tracker_.AddTask(usages);
+
+	if(deferred_recording_)
 	{
-	case BufferUsage::IndirectDrawSrc:
-		return BufferSyncInfo{vk::AccessFlagBits::eIndirectCommandRead, vk::PipelineStageFlagBits::eDrawIndirect};
+		deferred_tasks_.push_back(DeferredTask{name, std::move(func)});
+		deferred_tasks_usages_.push_back(usages);
+		deferred_tasks_barriers_.push_back(std::move(barriers));
+	}
+	else
+		RecordTask(name, barriers, func);
+}
 
-	case BufferUsage::IndexSrc:
-		return BufferSyncInfo{vk::AccessFlagBits::eIndexRead, vk::PipelineStageFlagBits::eVertexInput};
+void TaskOrganizer::RecordTask(const std::string_view name, const BarriersBatch& barriers, const TaskFunc& func)
+{
+	const auto start_time= std::chrono::steady_clock::now();
 
-	case BufferUsage::VertexSrc:
-		return BufferSyncInfo{vk::AccessFlagBits::eVertexAttributeRead, vk::PipelineStageFlagBits::eVertexInput};
+	FlushBarriers(barriers);
 
-	case BufferUsage::UniformSrc:
-		// Uniforms may be accessed in vertex shader and later.
-		return BufferSyncInfo{vk::AccessFlagBits::eUniformRead, vk::PipelineStageFlagBits::eVertexShader};
+	const bool profiling= BeginTaskProfiling(name);
 
-	case BufferUsage::ComputeShaderSrc:
-		return BufferSyncInfo{vk::AccessFlagBits::eShaderRead, vk::PipelineStageFlagBits::eComputeShader};
+	func(command_buffer_);
 
-	case BufferUsage::TransferSrc:
-		return BufferSyncInfo{vk::AccessFlagBits::eTransferRead, vk::PipelineStageFlagBits::eTransfer};
+	if(profiling)
+		EndTaskProfiling();
 
-	// Require no synchronization if this is a destination buffer.
-	case BufferUsage::ComputeShaderDst:
-	case BufferUsage::TransferDst:
-		return std::nullopt;
-	};
-	HEX_ASSERT(false);
-	return std::nullopt;
+	current_frame_recording_time_+= std::chrono::steady_clock::now() - start_time;
 }
 
-bool TaskOrganizer::IsReadBufferUsage(const BufferUsage usage)
+void TaskOrganizer::FlushBarriers(const BarriersBatch& barriers)
 {
-	switch(usage)
-	{
-	case BufferUsage::IndirectDrawSrc:
-	case BufferUsage::IndexSrc:
-	case BufferUsage::VertexSrc:
-	case BufferUsage::UniformSrc:
-	case BufferUsage::ComputeShaderSrc:
-	case BufferUsage::TransferSrc:
-		return true;
-
-	case BufferUsage::ComputeShaderDst:
-	case BufferUsage::TransferDst:
-		return false;
-	};
-
-	HEX_ASSERT(false);
-	return false;
+	if(barriers.IsEmpty())
+		return;
+
+	command_buffer_.pipelineBarrier(
+		barriers.src_pipeline_stage_flags,
+		barriers.dst_pipeline_stage_flags,
+		vk::DependencyFlags(),
+		{},
+		barriers.buffer_barriers,
+		barriers.image_barriers);
+
+	++current_frame_barriers_stats_.num_pipeline_barriers;
+	current_frame_barriers_stats_.num_buffer_barriers+= uint32_t(barriers.buffer_barriers.size());
+	current_frame_barriers_stats_.num_image_barriers+= uint32_t(barriers.image_barriers.size());
+	if(barriers.buffer_barriers.empty() && barriers.image_barriers.empty())
+		++current_frame_barriers_stats_.num_execution_barriers;
 }
 
-vk::PipelineStageFlags TaskOrganizer::GetPipelineStageForBufferUsage(const BufferUsage usage)
+void TaskOrganizer::AddBuffersUsage(TaskUsages& usages, const std::vector<BufferRange>& ranges, const BufferUsage usage)
 {
-	// TODO - check if this is correct.
-	switch(usage)
-	{
-	case BufferUsage::IndirectDrawSrc:
-		return vk::PipelineStageFlagBits::eDrawIndirect;
-	case BufferUsage::IndexSrc:
-		return vk::PipelineStageFlagBits::eVertexInput;
-	case BufferUsage::VertexSrc:
-		return vk::PipelineStageFlagBits::eVertexInput;
-	case BufferUsage::UniformSrc:
-		// TODO - list other kinds of shaders?
-		return vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eGeometryShader | vk::PipelineStageFlagBits::eFragmentShader;
-	case BufferUsage::ComputeShaderSrc:
-	case BufferUsage::ComputeShaderDst:
-		return vk::PipelineStageFlagBits::eComputeShader;
-	case BufferUsage::TransferSrc:
-	case BufferUsage::TransferDst:
-		return vk::PipelineStageFlagBits::eTransfer;
-	};
-
-	HEX_ASSERT(false);
-	return vk::PipelineStageFlags();
+	for(const BufferRange& range : ranges)
+		usages.buffers.emplace_back(range, usage);
 }
 
-TaskOrganizer::ImageSyncInfo TaskOrganizer::GetSyncInfoForLastImageUsage(const vk::Image image)
+void TaskOrganizer::AddBuffersUsage(TaskUsages& usages, const std::vector<vk::Buffer>& buffers, const BufferUsage usage)
 {
-	if(const auto usage= GetLastImageUsage(image))
-		return GetSyncInfoForImageUsage(*usage);
-	return {vk::AccessFlags(), vk::PipelineStageFlagBits::eBottomOfPipe, vk::ImageLayout::eUndefined};
+	for(const vk::Buffer buffer : buffers)
+		usages.buffers.emplace_back(BufferRange(buffer), usage);
 }
 
-TaskOrganizer::ImageSyncInfo TaskOrganizer::GetSyncInfoForImageUsage(const ImageUsage usage)
+void TaskOrganizer::AddImagesUsage(TaskUsages& usages, const std::vector<ImageInfo>& images, const ImageUsage usage)
 {
-	switch(usage)
-	{
-	case ImageUsage::GraphicsSrc:
-		// TODO - list other kinds of shaders?
-		return {vk::AccessFlagBits::eShaderRead, vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eGeometryShader | vk::PipelineStageFlagBits::eFragmentShader, vk::ImageLayout::eShaderReadOnlyOptimal};
-	case ImageUsage::TransferDst:
-		return {vk::AccessFlagBits::eTransferWrite, vk::PipelineStageFlagBits::eTransfer, vk::ImageLayout::eTransferDstOptimal};
-	case ImageUsage::TransferSrc:
-		return {vk::AccessFlagBits::eTransferRead, vk::PipelineStageFlagBits::eTransfer, vk::ImageLayout::eTransferSrcOptimal};
-	case ImageUsage::ComputeDst:
-		return {vk::AccessFlagBits::eShaderWrite, vk::PipelineStageFlagBits::eComputeShader, vk::ImageLayout::eGeneral};
-	case ImageUsage::ColorAttachment:
-		return {vk::AccessFlagBits::eColorAttachmentWrite, vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::ImageLayout::eColorAttachmentOptimal};
-	case ImageUsage::DepthAttachment:
-		return {vk::AccessFlagBits::eDepthStencilAttachmentWrite, vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests, vk::ImageLayout::eDepthStencilAttachmentOptimal};
-	};
-
-	HEX_ASSERT(false);
-	return {};
+	for(const ImageInfo& image_info : images)
+		usages.images.emplace_back(image_info, usage);
 }
 
 } // namespace HexGPU
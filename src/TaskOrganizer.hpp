@@ -1,8 +1,12 @@
 #pragma once
+#include "TaskBarriersTracker.hpp"
 #include "WindowVulkan.hpp"
+#include <chrono>
+#include <deque>
 #include <functional>
+#include <map>
 #include <optional>
-#include <unordered_map>
+#include <string_view>
 
 namespace HexGPU
 {
@@ -13,15 +17,28 @@ namespace HexGPU
 	Each task has inputs and outputs - buffers and images.
 	If a buffer is used as input in one task, a barrier may be added before it in order to ensure,
 	that previous tasks which use this buffer are finished (if necessary).
+	Barriers are added only for real hazards - read after write (once for each kind of read), write after read and write after write.
+	Usage is tracked for buffer ranges, so tasks accessing different parts of the same buffer aren't synchronized.
+	All barriers of a task are merged into single barrier command.
 	The same is performed for images too.
 	Also this class manages image layout transitions.
 	So, it's almost not needed to use manual pipeline barriers.
+	Barriers are calculated by TaskBarriersTracker, this class only records them.
+
+	In deferred recording mode tasks are recorded only at the end of a group of tasks.
+	This allows to merge barrier of a task with a barrier of some earlier task, if tasks between don't depend on it.
 
 	Graphics tasks also starn/end render passes.
 
+	Separate instance of this class should be used for async compute queue.
+	Synchronization between queues isn't tracked and should be performed externally.
+
 	It's imprortant not to forget to specify all inputs/outputs in order to ensure proper synchronization.
 	So, when modifying tasks code make sure new inputs/outputs are properly added.
 
+	Optionally tasks execution time on the GPU may be measured.
+	Each named task is bracketed with timestamp queries, results are read back when the command buffer of the frame is reused.
+
 	TODO - improve this class:
 	* Add output images in render passes
 	* Add output images in compute tasks
@@ -30,29 +47,29 @@ namespace HexGPU
 class TaskOrganizer
 {
 public:
-	struct ImageInfo
-	{
-		vk::Image image;
-		vk::ImageAspectFlags asppect_flags;
-		uint32_t num_mips= 0;
-		uint32_t num_layers= 0;
-	};
+	using ImageInfo= TaskBarriersTracker::ImageInfo;
+	using BufferRange= TaskBarriersTracker::BufferRange;
 
 	using TaskFunc= std::function<void(vk::CommandBuffer command_buffer)>;
 
 	// Task type for a batch of compute shader dispatches.
 	struct ComputeTaskParams
 	{
-		std::vector<vk::Buffer> input_storage_buffers;
-		std::vector<vk::Buffer> output_storage_buffers;
+		// Name for profiling. Should point to a static string.
+		std::string_view name;
+		std::vector<BufferRange> input_storage_buffers;
+		std::vector<BufferRange> output_storage_buffers;
 		// Buffers which are both input and output. Do not list them in input and/or output lists!
-		std::vector<vk::Buffer> input_output_storage_buffers;
+		std::vector<BufferRange> input_output_storage_buffers;
 		std::vector<ImageInfo> output_images;
 	};
 
 	// Task type for a batch of draw commands within single render pass.
 	struct GraphicsTaskParams
 	{
+		// Name for profiling. Should point to a static string.
+		std::string_view name;
+
 		// Input graphics buffers.
 		std::vector<vk::Buffer> indirect_draw_buffers;
 		std::vector<vk::Buffer> index_buffers;
@@ -73,18 +90,61 @@ public:
 	// Task type for transfer commands - buffer to buffer, buffer to image, image to buffer, image to image copies, buffer updates.
 	struct TransferTaskParams
 	{
-		std::vector<vk::Buffer> input_buffers;
-		std::vector<vk::Buffer> output_buffers;
+		// Name for profiling. Should point to a static string.
+		std::string_view name;
+		std::vector<BufferRange> input_buffers;
+		std::vector<BufferRange> output_buffers;
 		std::vector<ImageInfo> input_images;
 		std::vector<ImageInfo> output_images;
 	};
 
+	// Rolling statistics of GPU execution time of tasks with given name (summed within a frame).
+	struct TaskTimeStats
+	{
+		std::string name;
+		float min_ms= 0.0f;
+		float avg_ms= 0.0f;
+		float max_ms= 0.0f;
+	};
+
+	// Synchronization statistics of a frame.
+	struct BarriersStats
+	{
+		// Number of pipeline barrier commands.
+		uint32_t num_pipeline_barriers= 0;
+		uint32_t num_buffer_barriers= 0;
+		uint32_t num_image_barriers= 0;
+		// Number of pipeline barrier commands without memory barriers.
+		uint32_t num_execution_barriers= 0;
+	};
+
 public:
-	explicit TaskOrganizer(WindowVulkan& window_vulkan);
+	// If async compute flag is set, commands are recorded for async compute queue, rather than for the main queue.
+	TaskOrganizer(WindowVulkan& window_vulkan, Settings& settings, bool async_compute= false);
 
 	// Set current command buffer. Initially there is no buffer.
+	// Should be called once per frame, after previous execution of this command buffer is finished.
 	void SetCommandBuffer(vk::CommandBuffer command_buffer);
 
+	// Profiling may be unsupported by the device queue.
+	bool IsProfilingSupported() const;
+	bool IsProfilingEnabled() const;
+	// Takes effect starting with the next frame.
+	void SetProfilingEnabled(bool enabled);
+
+	// Result is sorted by task name. Statistics are a couple of frames outdated.
+	std::vector<TaskTimeStats> GetTasksTimeStats() const;
+	// Returns false on failure.
+	bool SaveTasksTimeStatsToCSV(const std::string& file_name) const;
+	// Returns summed GPU time of all profiled tasks of the frame read back in the last SetCommandBuffer call.
+	// Timestamps of different queues aren't comparable, so only busy time of each queue may be compared, not exact time spans.
+	std::optional<double> GetLastProfiledFrameBusyTimeMs() const;
+
+	// Returns statistics for previous frame (previous command buffer).
+	BarriersStats GetLastFrameBarriersStats() const;
+	// Returns CPU time spent on recording of tasks (including barriers) of previous frame.
+	std::chrono::steady_clock::duration GetLastFrameRecordingTime() const;
+
 	// Execute tasks of different kind.
 	void ExecuteTask(const ComputeTaskParams& params, const TaskFunc& func);
 	void ExecuteTask(const GraphicsTaskParams& params, const TaskFunc& func);
@@ -94,69 +154,81 @@ public:
 	// Image should be created with TransferDst and TransferSrc flags.
 	void GenerateImageMips(const ImageInfo& image_info, vk::Extent2D image_size);
 
+	// Tasks executed between these calls are recorded into the command buffer only in EndDeferredRecording,
+	// when barriers of all of them are known, so that barriers of different tasks may be merged together.
+	// Task functions are stored until EndDeferredRecording, so, they shouldn't reference data destroyed before it.
+	void BeginDeferredRecording();
+	void EndDeferredRecording();
+
 private:
-	enum struct BufferUsage : uint8_t
-	{
-		IndirectDrawSrc,
-		IndexSrc,
-		VertexSrc,
-		UniformSrc,
-		ComputeShaderSrc,
-		ComputeShaderDst,
-		TransferDst,
-		TransferSrc,
-	};
+	using BufferUsage= TaskBarriersTracker::BufferUsage;
+	using ImageUsage= TaskBarriersTracker::ImageUsage;
+	using TaskUsages= TaskBarriersTracker::TaskUsages;
+	using BarriersBatch= TaskBarriersTracker::BarriersBatch;
 
-	struct BufferSyncInfo
+	// Task recorded in deferred mode.
+	struct DeferredTask
 	{
-		vk::AccessFlags access_flags;
-		vk::PipelineStageFlags pipeline_stage_flags;
+		std::string_view name;
+		TaskFunc func;
 	};
 
-	enum class ImageUsage : uint8_t
+	// Profiling data for a frame. Frames are circulary reused, like command buffers.
+	struct ProfilingFrameData
 	{
-		GraphicsSrc,
-		TransferDst,
-		TransferSrc,
-		ComputeDst,
-		ColorAttachment,
-		DepthAttachment,
+		vk::UniqueQueryPool query_pool;
+		// Two queries (start and end) for each task.
+		std::vector<std::string_view> task_names;
 	};
 
-	struct ImageSyncInfo
-	{
-		vk::AccessFlags access_flags;
-		vk::PipelineStageFlags pipeline_stage_flags;
-		vk::ImageLayout layout= vk::ImageLayout::eUndefined;
-	};
+private:
+	// Returns true if timestamp is written. In such case EndTaskProfiling should be called after task commands.
+	bool BeginTaskProfiling(std::string_view name);
+	void EndTaskProfiling();
+	void ReadBackProfilingResults(ProfilingFrameData& frame_data);
+
+	// Calculate barriers for a task and record it (or store it in deferred mode).
+	void AddTask(std::string_view name, const TaskUsages& usages, TaskFunc func);
+	void RecordTask(std::string_view name, const BarriersBatch& barriers, const TaskFunc& func);
+	void FlushBarriers(const BarriersBatch& barriers);
+
+	static void AddBuffersUsage(TaskUsages& usages, const std::vector<BufferRange>& ranges, BufferUsage usage);
+	static void AddBuffersUsage(TaskUsages& usages, const std::vector<vk::Buffer>& buffers, BufferUsage usage);
+	static void AddImagesUsage(TaskUsages& usages, const std::vector<ImageInfo>& images, ImageUsage usage);
 
 private:
-	void UpdateLastBuffersUsage(const std::vector<vk::Buffer> buffers, BufferUsage usage);
-	void UpdateLastBufferUsage(vk::Buffer buffer, BufferUsage usage);
-	std::optional<BufferUsage> GetLastBufferUsage(vk::Buffer buffer) const;
+	const vk::Device vk_device_;
+	const uint32_t queue_family_index_;
 
-	void UpdateLastImageUsage(vk::Image image, ImageUsage usage);
-	std::optional<ImageUsage> GetLastImageUsage(vk::Image image) const;
+	vk::CommandBuffer command_buffer_;
 
-	std::optional<BufferSyncInfo> GetBufferSrcSyncInfoForLastUsage(vk::Buffer buffer) const;
+	// Zero if timestamps aren't supported.
+	const uint32_t timestamp_valid_bits_;
+	const float timestamp_period_ns_;
 
-	static std::optional<BufferSyncInfo> GetBufferSrcSyncInfo(BufferUsage usage);
-	static std::optional<BufferSyncInfo> GetBufferDstSyncInfo(BufferUsage usage);
-	static bool IsReadBufferUsage(BufferUsage usage);
-	static vk::PipelineStageFlags GetPipelineStageForBufferUsage(BufferUsage usage);
+	// Empty if profiling isn't supported.
+	std::vector<ProfilingFrameData> profiling_frames_data_;
+	size_t profiling_frame_number_= 0;
+	// Null if profiling is disabled for current frame.
+	ProfilingFrameData* current_profiling_frame_data_= nullptr;
+	bool profiling_enabled_= false;
+	std::optional<double> last_profiled_frame_busy_time_ms_;
 
-	ImageSyncInfo GetSyncInfoForLastImageUsage(vk::Image image);
+	// Last frames execution time samples for each task name.
+	std::map<std::string, std::deque<float>, std::less<>> tasks_time_samples_;
 
-	static ImageSyncInfo GetSyncInfoForImageUsage(ImageUsage usage);
+	BarriersStats current_frame_barriers_stats_;
+	BarriersStats last_frame_barriers_stats_;
 
-private:
-	const uint32_t queue_family_index_;
+	std::chrono::steady_clock::duration current_frame_recording_time_{0};
+	std::chrono::steady_clock::duration last_frame_recording_time_{0};
 
-	vk::CommandBuffer command_buffer_;
+	TaskBarriersTracker barriers_tracker_;
 
-	// Remember buffer usages in order to setup barriers properly.
-	std::unordered_map<VkBuffer, BufferUsage> last_buffer_usage_;
-	std::unordered_map<VkImage, ImageUsage> last_image_usage_;
+	bool deferred_recording_= false;
+	std::vector<DeferredTask> deferred_tasks_;
+	std::vector<TaskUsages> deferred_tasks_usages_;
+	std::vector<BarriersBatch> deferred_tasks_barriers_;
 };
 
 } // namespace HexGPU
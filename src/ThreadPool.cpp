@@ -0,0 +1,82 @@
+#include "ThreadPool.hpp"
+#include "Assert.hpp"
+#include <algorithm>
+
+namespace HexGPU
+{
+
+ThreadPool::ThreadPool(uint32_t num_threads)
+{
+	if(num_threads == 0)
+	{
+		// Leave one core for the main thread.
+		// hardware_concurrency may return 0 if it can't determine number of cores.
+		num_threads= std::max(1u, std::thread::hardware_concurrency()) - 1u;
+		num_threads= std::max(1u, std::min(num_threads, 16u));
+	}
+
+	threads_.reserve(num_threads);
+	for(uint32_t i= 0; i < num_threads; ++i)
+		threads_.emplace_back([this]{ WorkerThreadFunc(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+		quit_requested_= true;
+	}
+	condition_variable_.notify_all();
+
+	for(std::thread& thread : threads_)
+		thread.join();
+
+	HEX_ASSERT(tasks_queue_.empty());
+}
+
+uint32_t ThreadPool::GetNumThreads() const
+{
+	return uint32_t(threads_.size());
+}
+
+void ThreadPool::AddTask(Task task, const uint32_t priority)
+{
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+		HEX_ASSERT(!quit_requested_);
+
+		QueuedTask queued_task;
+		queued_task.priority= priority;
+		queued_task.sequence_number= next_sequence_number_;
+		queued_task.task= std::move(task);
+		++next_sequence_number_;
+
+		tasks_queue_.push_back(std::move(queued_task));
+		std::push_heap(tasks_queue_.begin(), tasks_queue_.end(), QueuedTaskCompare());
+	}
+	condition_variable_.notify_one();
+}
+
+void ThreadPool::WorkerThreadFunc()
+{
+	while(true)
+	{
+		Task task;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_variable_.wait(lock, [this]{ return quit_requested_ || !tasks_queue_.empty(); });
+
+			// Finish all remaining tasks even if quit is requested.
+			if(tasks_queue_.empty())
+				return;
+
+			std::pop_heap(tasks_queue_.begin(), tasks_queue_.end(), QueuedTaskCompare());
+			task= std::move(tasks_queue_.back().task);
+			tasks_queue_.pop_back();
+		}
+
+		task();
+	}
+}
+
+} // namespace HexGPU
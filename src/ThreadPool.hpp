@@ -0,0 +1,84 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace HexGPU
+{
+
+// Simple pool of worker threads with shared tasks queue.
+// Tasks with lower priority value are started first.
+// Tasks with the same priority are started in submission order (but may finish in any order).
+// Submission is thread-safe, but normally it's performed only from the main thread.
+class ThreadPool
+{
+public:
+	// If number of threads is zero - choose it based on number of available CPU cores.
+	explicit ThreadPool(uint32_t num_threads= 0);
+
+	// Finishes all pending tasks before destruction.
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&)= delete;
+	ThreadPool& operator=(const ThreadPool&)= delete;
+
+	uint32_t GetNumThreads() const;
+
+	// Returns future for given function result.
+	template<class Func>
+	auto Submit(Func func, uint32_t priority= 0) -> std::future<decltype(func())>;
+
+private:
+	using Task= std::function<void()>;
+
+	struct QueuedTask
+	{
+		uint32_t priority= 0;
+		uint64_t sequence_number= 0;
+		Task task;
+	};
+
+	struct QueuedTaskCompare
+	{
+		// Comparator for heap functions - top element is task with lowest priority value and lowest sequence number.
+		bool operator()(const QueuedTask& l, const QueuedTask& r) const
+		{
+			if(l.priority != r.priority)
+				return l.priority > r.priority;
+			return l.sequence_number > r.sequence_number;
+		}
+	};
+
+private:
+	void AddTask(Task task, uint32_t priority);
+	void WorkerThreadFunc();
+
+private:
+	std::mutex mutex_;
+	std::condition_variable condition_variable_;
+	std::vector<QueuedTask> tasks_queue_; // Heap.
+	uint64_t next_sequence_number_= 0;
+	bool quit_requested_= false;
+
+	std::vector<std::thread> threads_;
+};
+
+template<class Func>
+auto ThreadPool::Submit(Func func, const uint32_t priority) -> std::future<decltype(func())>
+{
+	using ResultType= decltype(func());
+
+	// Use shared_ptr, since std::function requires copyable functors, but packaged_task is move-only.
+	const auto task= std::make_shared<std::packaged_task<ResultType()>>(std::move(func));
+	std::future<ResultType> future= task->get_future();
+
+	AddTask([task]{ (*task)(); }, priority);
+
+	return future;
+}
+
+} // namespace HexGPU
@@ -18,6 +18,7 @@ vk::PhysicalDeviceFeatures GetRequiredDeviceFeatures()
 
 	vk::PhysicalDeviceFeatures features;
 	features.multiDrawIndirect= true;
+	features.drawIndirectFirstInstance= true;
 	features.geometryShader= true;
 	return features;
 }
@@ -56,7 +57,7 @@ VkBool32 VulkanDebugReportCallback(
 
 } // namespace
 
-WindowVulkan::WindowVulkan(const SystemWindow& system_window, Settings& settings)
+WindowVulkan::WindowVulkan(const SystemWindow* const system_window, Settings& settings)
 {
 	#ifdef DEBUG
 	const bool use_debug_extensions_and_layers= true;
@@ -65,17 +66,21 @@ WindowVulkan::WindowVulkan(const SystemWindow& system_window, Settings& settings
 	#endif
 
 	const bool vsync= settings.GetOrSetInt("r_vsync", 1) != 0;
+	const bool async_compute= settings.GetOrSetInt("r_async_compute", 0) != 0;
 
-	// Get vulkan extensiion, needed by SDL.
+	// Get vulkan extensiion, needed by SDL. No extensions are needed in headless mode.
 	unsigned int extension_names_count= 0;
-	if( !SDL_Vulkan_GetInstanceExtensions(system_window.GetSDLWindow(), &extension_names_count, nullptr) )
-		Log::FatalError("Could not get Vulkan instance extensions");
-
 	std::vector<const char*> extensions_list;
-	extensions_list.resize(extension_names_count, nullptr);
+	if(system_window != nullptr)
+	{
+		if( !SDL_Vulkan_GetInstanceExtensions(system_window->GetSDLWindow(), &extension_names_count, nullptr) )
+			Log::FatalError("Could not get Vulkan instance extensions");
 
-	if( !SDL_Vulkan_GetInstanceExtensions(system_window.GetSDLWindow(), &extension_names_count, extensions_list.data()) )
-		Log::FatalError("Could not get Vulkan instance extensions");
+		extensions_list.resize(extension_names_count, nullptr);
+
+		if( !SDL_Vulkan_GetInstanceExtensions(system_window->GetSDLWindow(), &extension_names_count, extensions_list.data()) )
+			Log::FatalError("Could not get Vulkan instance extensions");
+	}
 
 	if(use_debug_extensions_and_layers)
 	{
@@ -139,16 +144,21 @@ WindowVulkan::WindowVulkan(const SystemWindow& system_window, Settings& settings
 	}
 
 	// Create surface.
-	VkSurfaceKHR tmp_surface;
-	if(!SDL_Vulkan_CreateSurface(system_window.GetSDLWindow(), *instance_, &tmp_surface))
-		Log::FatalError("Could not create Vulkan surface");
+	if(system_window != nullptr)
+	{
+		VkSurfaceKHR tmp_surface;
+		if(!SDL_Vulkan_CreateSurface(system_window->GetSDLWindow(), *instance_, &tmp_surface))
+			Log::FatalError("Could not create Vulkan surface");
 #ifdef VK_API_VERSION_1_3
-	surface_= vk::UniqueSurfaceKHR(tmp_surface, vk::ObjectDestroy<vk::Instance, VULKAN_HPP_DEFAULT_DISPATCHER_TYPE>(*instance_));
+		surface_= vk::UniqueSurfaceKHR(tmp_surface, vk::ObjectDestroy<vk::Instance, VULKAN_HPP_DEFAULT_DISPATCHER_TYPE>(*instance_));
 #else
-	surface_= vk::UniqueSurfaceKHR(tmp_surface, vk::ObjectDestroy<vk::Instance>(*instance_));
+		surface_= vk::UniqueSurfaceKHR(tmp_surface, vk::ObjectDestroy<vk::Instance>(*instance_));
 #endif
 
-	SDL_Vulkan_GetDrawableSize(system_window.GetSDLWindow(), reinterpret_cast<int*>(&viewport_size_.width), reinterpret_cast<int*>(&viewport_size_.height));
+		SDL_Vulkan_GetDrawableSize(system_window->GetSDLWindow(), reinterpret_cast<int*>(&viewport_size_.width), reinterpret_cast<int*>(&viewport_size_.height));
+	}
+	else
+		Log::Info("Headless mode - no surface is created");
 
 	// Create physical device. Prefer usage of discrete GPU.
 	const std::vector<vk::PhysicalDevice> physical_devices= instance_->enumeratePhysicalDevices();
@@ -202,10 +212,12 @@ WindowVulkan::WindowVulkan(const SystemWindow& system_window, Settings& settings
 	const std::vector<vk::QueueFamilyProperties> queue_family_properties= physical_device.getQueueFamilyProperties();
 	uint32_t queue_family_index= ~0u;
 	// Use for now the queue with both graphics and compute capabilities - for code simplicity.
-	const vk::Flags<vk::QueueFlagBits> required_queue_family_flags= vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute;
+	// In headless mode only compute capabilities are needed.
+	const vk::Flags<vk::QueueFlagBits> required_queue_family_flags=
+		surface_ ? (vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute) : vk::QueueFlagBits::eCompute;
 	for(uint32_t i= 0u; i < queue_family_properties.size(); ++i)
 	{
-		const VkBool32 supported= physical_device.getSurfaceSupportKHR(i, *surface_);
+		const VkBool32 supported= surface_ ? physical_device.getSurfaceSupportKHR(i, *surface_) : VK_TRUE;
 		if(supported != 0 &&
 			queue_family_properties[i].queueCount > 0 &&
 			(queue_family_properties[i].queueFlags & required_queue_family_flags) == required_queue_family_flags)
@@ -222,21 +234,51 @@ WindowVulkan::WindowVulkan(const SystemWindow& system_window, Settings& settings
 
 	queue_family_index_= queue_family_index;
 
+	// Select queue family for async compute - with compute, but without graphics capabilities.
+	// Such queue family normally corresponds to separate hardware queue, which may work in parallel with the main queue.
+	if(async_compute)
+	{
+		for(uint32_t i= 0u; i < queue_family_properties.size(); ++i)
+		{
+			if(i != queue_family_index &&
+				queue_family_properties[i].queueCount > 0 &&
+				(queue_family_properties[i].queueFlags & vk::QueueFlagBits::eCompute) &&
+				!(queue_family_properties[i].queueFlags & vk::QueueFlagBits::eGraphics))
+			{
+				async_compute_queue_family_index_= i;
+				break;
+			}
+		}
+
+		if(async_compute_queue_family_index_ == ~0u)
+			Log::Info("No dedicated compute queue family, async compute is disabled");
+		else
+			Log::Info("Async compute queue familiy index: ", async_compute_queue_family_index_);
+	}
+
 	const float queue_priority= 1.0f;
-	const vk::DeviceQueueCreateInfo device_queue_create_info(
+	std::vector<vk::DeviceQueueCreateInfo> device_queue_create_infos;
+	device_queue_create_infos.emplace_back(
 		vk::DeviceQueueCreateFlags(),
 		queue_family_index,
 		1u, &queue_priority);
+	if(async_compute_queue_family_index_ != ~0u)
+		device_queue_create_infos.emplace_back(
+			vk::DeviceQueueCreateFlags(),
+			async_compute_queue_family_index_,
+			1u, &queue_priority);
 
 	const char* const device_extension_names[]{ VK_KHR_SWAPCHAIN_EXTENSION_NAME };
 
-	const vk::PhysicalDeviceFeatures physical_device_features= GetRequiredDeviceFeatures();
+	// Graphics features aren't needed in headless mode. This allows using software implementations with limited features.
+	const vk::PhysicalDeviceFeatures physical_device_features=
+		surface_ ? GetRequiredDeviceFeatures() : vk::PhysicalDeviceFeatures();
 
 	const vk::DeviceCreateInfo device_create_info(
 		vk::DeviceCreateFlags(),
-		1u, &device_queue_create_info,
+		uint32_t(device_queue_create_infos.size()), device_queue_create_infos.data(),
 		0u, nullptr,
-		uint32_t(std::size(device_extension_names)), device_extension_names,
+		surface_ ? uint32_t(std::size(device_extension_names)) : 0u, device_extension_names,
 		&physical_device_features);
 
 	// Create physical device.
@@ -253,108 +295,114 @@ WindowVulkan::WindowVulkan(const SystemWindow& system_window, Settings& settings
 	Log::Info("Vulkan logical device created");
 
 	queue_= vk_device_->getQueue(queue_family_index, 0u);
+	if(async_compute_queue_family_index_ != ~0u)
+		async_compute_queue_= vk_device_->getQueue(async_compute_queue_family_index_, 0u);
 
-	// Select surface format. Prefer usage of normalized rbga32.
-	const std::vector<vk::SurfaceFormatKHR> surface_formats= physical_device.getSurfaceFormatsKHR(*surface_);
-	vk::SurfaceFormatKHR surface_format= surface_formats.back();
-	for(const vk::SurfaceFormatKHR& surface_format_variant : surface_formats)
+	// Create swapchain and screen render pass. They aren't needed in headless mode.
+	if(surface_)
 	{
-		if( surface_format_variant.format == vk::Format::eR8G8B8A8Unorm ||
-			surface_format_variant.format == vk::Format::eB8G8R8A8Unorm)
+		// Select surface format. Prefer usage of normalized rbga32.
+		const std::vector<vk::SurfaceFormatKHR> surface_formats= physical_device.getSurfaceFormatsKHR(*surface_);
+		vk::SurfaceFormatKHR surface_format= surface_formats.back();
+		for(const vk::SurfaceFormatKHR& surface_format_variant : surface_formats)
 		{
-			surface_format= surface_format_variant;
-			break;
+			if( surface_format_variant.format == vk::Format::eR8G8B8A8Unorm ||
+				surface_format_variant.format == vk::Format::eB8G8R8A8Unorm)
+			{
+				surface_format= surface_format_variant;
+				break;
+			}
 		}
-	}
-	Log::Info("Swapchan surface format: ", vk::to_string(surface_format.format), " ", vk::to_string(surface_format.colorSpace));
+		Log::Info("Swapchan surface format: ", vk::to_string(surface_format.format), " ", vk::to_string(surface_format.colorSpace));
 
-	// Select present mode. Prefer usage of tripple buffering, than double buffering.
-	const std::vector<vk::PresentModeKHR> present_modes= physical_device.getSurfacePresentModesKHR(*surface_);
-	vk::PresentModeKHR present_mode= present_modes.front();
-	if(vsync)
-	{
-		if(std::find(present_modes.begin(), present_modes.end(), vk::PresentModeKHR::eFifo) != present_modes.end())
-			present_mode= vk::PresentModeKHR::eFifo;
-	}
-	else
-	{
-		if(std::find(present_modes.begin(), present_modes.end(), vk::PresentModeKHR::eMailbox) != present_modes.end())
-			present_mode= vk::PresentModeKHR::eMailbox;
-	}
-	Log::Info("Present mode: ", vk::to_string(present_mode));
-
-	const vk::SurfaceCapabilitiesKHR surface_capabilities= physical_device.getSurfaceCapabilitiesKHR(*surface_);
-
-	swapchain_= vk_device_->createSwapchainKHRUnique(
-		vk::SwapchainCreateInfoKHR(
-			vk::SwapchainCreateFlagsKHR(),
-			*surface_,
-			surface_capabilities.minImageCount,
+		// Select present mode. Prefer usage of tripple buffering, than double buffering.
+		const std::vector<vk::PresentModeKHR> present_modes= physical_device.getSurfacePresentModesKHR(*surface_);
+		vk::PresentModeKHR present_mode= present_modes.front();
+		if(vsync)
+		{
+			if(std::find(present_modes.begin(), present_modes.end(), vk::PresentModeKHR::eFifo) != present_modes.end())
+				present_mode= vk::PresentModeKHR::eFifo;
+		}
+		else
+		{
+			if(std::find(present_modes.begin(), present_modes.end(), vk::PresentModeKHR::eMailbox) != present_modes.end())
+				present_mode= vk::PresentModeKHR::eMailbox;
+		}
+		Log::Info("Present mode: ", vk::to_string(present_mode));
+
+		const vk::SurfaceCapabilitiesKHR surface_capabilities= physical_device.getSurfaceCapabilitiesKHR(*surface_);
+
+		swapchain_= vk_device_->createSwapchainKHRUnique(
+			vk::SwapchainCreateInfoKHR(
+				vk::SwapchainCreateFlagsKHR(),
+				*surface_,
+				surface_capabilities.minImageCount,
+				surface_format.format,
+				surface_format.colorSpace,
+				surface_capabilities.maxImageExtent,
+				1u,
+				vk::ImageUsageFlagBits::eColorAttachment,
+				vk::SharingMode::eExclusive,
+				1u, &queue_family_index,
+				vk::SurfaceTransformFlagBitsKHR::eIdentity,
+				vk::CompositeAlphaFlagBitsKHR::eOpaque,
+				present_mode));
+
+		// Create render pass and framebuffers for drawing into screen.
+
+		const vk::AttachmentDescription attachment_description(
+			vk::AttachmentDescriptionFlags(),
 			surface_format.format,
-			surface_format.colorSpace,
-			surface_capabilities.maxImageExtent,
-			1u,
-			vk::ImageUsageFlagBits::eColorAttachment,
-			vk::SharingMode::eExclusive,
-			1u, &queue_family_index,
-			vk::SurfaceTransformFlagBitsKHR::eIdentity,
-			vk::CompositeAlphaFlagBitsKHR::eOpaque,
-			present_mode));
-
-	// Create render pass and framebuffers for drawing into screen.
-
-	const vk::AttachmentDescription attachment_description(
-		vk::AttachmentDescriptionFlags(),
-		surface_format.format,
-		vk::SampleCountFlagBits::e1,
-		vk::AttachmentLoadOp::eDontCare,
-		vk::AttachmentStoreOp::eStore,
-		vk::AttachmentLoadOp::eDontCare,
-		vk::AttachmentStoreOp::eDontCare,
-		vk::ImageLayout::eUndefined,
-		vk::ImageLayout::ePresentSrcKHR
-	);
-
-	const vk::AttachmentReference attachment_reference_color(0u, vk::ImageLayout::eColorAttachmentOptimal);
-
-	const vk::SubpassDescription subpass_description(
-		vk::SubpassDescriptionFlags(),
-		vk::PipelineBindPoint::eGraphics,
-		0u, nullptr,
-		1u, &attachment_reference_color,
-		nullptr,
-		nullptr);
-
-	render_pass_=
-		vk_device_->createRenderPassUnique(
-			vk::RenderPassCreateInfo(
-				vk::RenderPassCreateFlags(),
-				1u, &attachment_description,
-				1u, &subpass_description));
-
-	const std::vector<vk::Image> swapchain_images= vk_device_->getSwapchainImagesKHR(*swapchain_);
-	framebuffers_.resize(swapchain_images.size());
-	for(size_t i= 0u; i < framebuffers_.size(); ++i)
-	{
-		framebuffers_[i].image= swapchain_images[i];
-
-		framebuffers_[i].image_view=
-			vk_device_->createImageViewUnique(
-				vk::ImageViewCreateInfo(
-					vk::ImageViewCreateFlags(),
-					framebuffers_[i].image,
-					vk::ImageViewType::e2D,
-					surface_format.format,
-					vk::ComponentMapping(),
-					vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0u, 1u, 0u, 1u)));
-
-		framebuffers_[i].framebuffer=
-			vk_device_->createFramebufferUnique(
-				vk::FramebufferCreateInfo(
-					vk::FramebufferCreateFlags(),
-					*render_pass_,
-					1u, &*framebuffers_[i].image_view,
-					viewport_size_.width, viewport_size_.height, 1u));
+			vk::SampleCountFlagBits::e1,
+			vk::AttachmentLoadOp::eDontCare,
+			vk::AttachmentStoreOp::eStore,
+			vk::AttachmentLoadOp::eDontCare,
+			vk::AttachmentStoreOp::eDontCare,
+			vk::ImageLayout::eUndefined,
+			vk::ImageLayout::ePresentSrcKHR
+		);
+
+		const vk::AttachmentReference attachment_reference_color(0u, vk::ImageLayout::eColorAttachmentOptimal);
+
+		const vk::SubpassDescription subpass_description(
+			vk::SubpassDescriptionFlags(),
+			vk::PipelineBindPoint::eGraphics,
+			0u, nullptr,
+			1u, &attachment_reference_color,
+			nullptr,
+			nullptr);
+
+		render_pass_=
+			vk_device_->createRenderPassUnique(
+				vk::RenderPassCreateInfo(
+					vk::RenderPassCreateFlags(),
+					1u, &attachment_description,
+					1u, &subpass_description));
+
+		const std::vector<vk::Image> swapchain_images= vk_device_->getSwapchainImagesKHR(*swapchain_);
+		framebuffers_.resize(swapchain_images.size());
+		for(size_t i= 0u; i < framebuffers_.size(); ++i)
+		{
+			framebuffers_[i].image= swapchain_images[i];
+
+			framebuffers_[i].image_view=
+				vk_device_->createImageViewUnique(
+					vk::ImageViewCreateInfo(
+						vk::ImageViewCreateFlags(),
+						framebuffers_[i].image,
+						vk::ImageViewType::e2D,
+						surface_format.format,
+						vk::ComponentMapping(),
+						vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0u, 1u, 0u, 1u)));
+
+			framebuffers_[i].framebuffer=
+				vk_device_->createFramebufferUnique(
+					vk::FramebufferCreateInfo(
+						vk::FramebufferCreateFlags(),
+						*render_pass_,
+						1u, &*framebuffers_[i].image_view,
+						viewport_size_.width, viewport_size_.height, 1u));
+		}
 	}
 
 	// Create command pull.
@@ -363,6 +411,12 @@ WindowVulkan::WindowVulkan(const SystemWindow& system_window, Settings& settings
 			vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
 			queue_family_index));
 
+	if(async_compute_queue_)
+		async_compute_command_pool_= vk_device_->createCommandPoolUnique(
+			vk::CommandPoolCreateInfo(
+				vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+				async_compute_queue_family_index_));
+
 	// Create command buffers and it's synchronization primitives.
 	// Use double buffering for command buffers.
 	// 2 is enough - one is executing on the GPU now, the other is prepared by the CPU.
@@ -380,6 +434,21 @@ WindowVulkan::WindowVulkan(const SystemWindow& system_window, Settings& settings
 		frame_data.image_available_semaphore= vk_device_->createSemaphoreUnique(vk::SemaphoreCreateInfo());
 		frame_data.rendering_finished_semaphore= vk_device_->createSemaphoreUnique(vk::SemaphoreCreateInfo());
 		frame_data.submit_fence= vk_device_->createFenceUnique(vk::FenceCreateInfo(vk::FenceCreateFlagBits::eSignaled));
+
+		if(async_compute_queue_)
+		{
+			frame_data.async_compute_command_buffer=
+				std::move(
+				vk_device_->allocateCommandBuffersUnique(
+					vk::CommandBufferAllocateInfo(
+						*async_compute_command_pool_,
+						vk::CommandBufferLevel::ePrimary,
+						1u)).front());
+
+			frame_data.async_compute_finished_semaphore= vk_device_->createSemaphoreUnique(vk::SemaphoreCreateInfo());
+			frame_data.main_queue_finished_semaphore= vk_device_->createSemaphoreUnique(vk::SemaphoreCreateInfo());
+			frame_data.async_compute_submit_fence= vk_device_->createFenceUnique(vk::FenceCreateInfo(vk::FenceCreateFlagBits::eSignaled));
+		}
 	}
 }
 
@@ -398,6 +467,11 @@ WindowVulkan::~WindowVulkan()
 	}
 }
 
+bool WindowVulkan::IsHeadless() const
+{
+	return !swapchain_;
+}
+
 vk::CommandBuffer WindowVulkan::BeginFrame()
 {
 	current_frame_command_buffer_= &command_buffers_[frame_count_ % command_buffers_.size()];
@@ -410,6 +484,21 @@ vk::CommandBuffer WindowVulkan::BeginFrame()
 
 	vk_device_->resetFences(1u, &*current_frame_command_buffer_->submit_fence);
 
+	if(async_compute_queue_)
+	{
+		vk_device_->waitForFences(
+			1u, &*current_frame_command_buffer_->async_compute_submit_fence,
+			VK_TRUE,
+			std::numeric_limits<uint64_t>::max());
+
+		vk_device_->resetFences(1u, &*current_frame_command_buffer_->async_compute_submit_fence);
+
+		current_frame_command_buffer_->async_compute_command_buffer->begin(
+			vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+	}
+
+	async_compute_results_required_= false;
+
 	const vk::CommandBuffer command_buffer= *current_frame_command_buffer_->command_buffer;
 	command_buffer.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
 	return command_buffer;
@@ -417,6 +506,9 @@ vk::CommandBuffer WindowVulkan::BeginFrame()
 
 void WindowVulkan::EndFrame(const DrawFunction& draw_function)
 {
+	// Submit async compute commands as early as possible.
+	const vk::Semaphore async_compute_finished_semaphore= SubmitAsyncCompute();
+
 	const vk::CommandBuffer command_buffer= *current_frame_command_buffer_->command_buffer;
 
 	// Get next swapchain image.
@@ -433,14 +525,33 @@ void WindowVulkan::EndFrame(const DrawFunction& draw_function)
 	command_buffer.end();
 
 	// Submit command buffer.
-	const vk::PipelineStageFlags wait_dst_stage_mask= vk::PipelineStageFlagBits::eColorAttachmentOutput;
+	std::vector<vk::Semaphore> wait_semaphores;
+	std::vector<vk::PipelineStageFlags> wait_dst_stage_masks;
+	std::vector<vk::Semaphore> signal_semaphores;
+
+	wait_semaphores.push_back(*current_frame_command_buffer_->image_available_semaphore);
+	wait_dst_stage_masks.push_back(vk::PipelineStageFlagBits::eColorAttachmentOutput);
+	signal_semaphores.push_back(*current_frame_command_buffer_->rendering_finished_semaphore);
+
+	if(async_compute_finished_semaphore)
+	{
+		wait_semaphores.push_back(async_compute_finished_semaphore);
+		// Bottom of pipe stage means that no main commands wait for async compute.
+		wait_dst_stage_masks.push_back(
+			async_compute_results_required_ ? vk::PipelineStageFlagBits::eAllCommands : vk::PipelineStageFlagBits::eBottomOfPipe);
+		signal_semaphores.push_back(*current_frame_command_buffer_->main_queue_finished_semaphore);
+	}
+
 	const vk::SubmitInfo submit_info(
-		1u, &*current_frame_command_buffer_->image_available_semaphore,
-		&wait_dst_stage_mask,
+		uint32_t(wait_semaphores.size()), wait_semaphores.data(),
+		wait_dst_stage_masks.data(),
 		1u, &command_buffer,
-		1u, &*current_frame_command_buffer_->rendering_finished_semaphore);
+		uint32_t(signal_semaphores.size()), signal_semaphores.data());
 	queue_.submit(submit_info, *current_frame_command_buffer_->submit_fence);
 
+	if(async_compute_finished_semaphore)
+		main_queue_finished_semaphore_to_wait_= *current_frame_command_buffer_->main_queue_finished_semaphore;
+
 	// Present queue.
 	queue_.presentKHR(
 		vk::PresentInfoKHR(
@@ -450,6 +561,96 @@ void WindowVulkan::EndFrame(const DrawFunction& draw_function)
 			nullptr));
 }
 
+void WindowVulkan::EndFrame()
+{
+	const vk::Semaphore async_compute_finished_semaphore= SubmitAsyncCompute();
+
+	const vk::CommandBuffer command_buffer= *current_frame_command_buffer_->command_buffer;
+
+	// End command buffer.
+	command_buffer.end();
+
+	// Submit command buffer. There is no need to wait for swapchain image or to signal rendering finish.
+	if(async_compute_finished_semaphore)
+	{
+		// Bottom of pipe stage means that no main commands wait for async compute.
+		const vk::PipelineStageFlags wait_dst_stage_mask=
+			async_compute_results_required_ ? vk::PipelineStageFlagBits::eAllCommands : vk::PipelineStageFlagBits::eBottomOfPipe;
+		const vk::SubmitInfo submit_info(
+			1u, &async_compute_finished_semaphore,
+			&wait_dst_stage_mask,
+			1u, &command_buffer,
+			1u, &*current_frame_command_buffer_->main_queue_finished_semaphore);
+		queue_.submit(submit_info, *current_frame_command_buffer_->submit_fence);
+
+		main_queue_finished_semaphore_to_wait_= *current_frame_command_buffer_->main_queue_finished_semaphore;
+	}
+	else
+	{
+		const vk::SubmitInfo submit_info(
+			0u, nullptr,
+			nullptr,
+			1u, &command_buffer,
+			0u, nullptr);
+		queue_.submit(submit_info, *current_frame_command_buffer_->submit_fence);
+	}
+}
+
+bool WindowVulkan::HasAsyncCompute() const
+{
+	return bool(async_compute_queue_);
+}
+
+uint32_t WindowVulkan::GetAsyncComputeQueueFamilyIndex() const
+{
+	return async_compute_queue_family_index_;
+}
+
+vk::CommandBuffer WindowVulkan::GetAsyncComputeCommandBuffer() const
+{
+	if(current_frame_command_buffer_ == nullptr || !current_frame_command_buffer_->async_compute_command_buffer)
+		return nullptr;
+	return *current_frame_command_buffer_->async_compute_command_buffer;
+}
+
+void WindowVulkan::RequireAsyncComputeResults()
+{
+	async_compute_results_required_= true;
+}
+
+std::vector<uint32_t> WindowVulkan::GetUsedQueueFamilyIndices() const
+{
+	std::vector<uint32_t> result;
+	result.push_back(queue_family_index_);
+	if(async_compute_queue_)
+		result.push_back(async_compute_queue_family_index_);
+	return result;
+}
+
+vk::Semaphore WindowVulkan::SubmitAsyncCompute()
+{
+	if(!async_compute_queue_)
+		return nullptr;
+
+	const vk::CommandBuffer command_buffer= *current_frame_command_buffer_->async_compute_command_buffer;
+	command_buffer.end();
+
+	// Wait for all main commands of the previous frame.
+	// This is needed, because async compute commands may overwrite data used by main commands.
+	const vk::PipelineStageFlags wait_dst_stage_mask= vk::PipelineStageFlagBits::eAllCommands;
+	const vk::SubmitInfo submit_info(
+		main_queue_finished_semaphore_to_wait_ ? 1u : 0u, &main_queue_finished_semaphore_to_wait_,
+		&wait_dst_stage_mask,
+		1u, &command_buffer,
+		1u, &*current_frame_command_buffer_->async_compute_finished_semaphore);
+	async_compute_queue_.submit(submit_info, *current_frame_command_buffer_->async_compute_submit_fence);
+
+	// Each binary semaphore signal should be waited only once.
+	main_queue_finished_semaphore_to_wait_= nullptr;
+
+	return *current_frame_command_buffer_->async_compute_finished_semaphore;
+}
+
 vk::Instance WindowVulkan::GetVulkanInstance() const
 {
 	return *instance_;
@@ -12,11 +12,30 @@ public:
 	using DrawFunction= std::function<void(vk::Framebuffer framebuffer)>;
 
 public:
-	WindowVulkan(const SystemWindow& system_window, Settings& settings);
+	// If system window is null, headless mode is used.
+	// In this mode no surface and swapchain are created and only compute and transfer operations are allowed.
+	WindowVulkan(const SystemWindow* system_window, Settings& settings);
 	~WindowVulkan();
 
+	bool IsHeadless() const;
+
 	vk::CommandBuffer BeginFrame();
 	void EndFrame(const DrawFunction& draw_function);
+	// End frame without drawing into screen. Used in headless mode.
+	void EndFrame();
+
+	// Async compute queue is used only if it's enabled in settings and the device has dedicated compute queue family.
+	// Commands of async compute command buffer are submitted before the main command buffer of the same frame
+	// and wait for main commands of the previous frame.
+	// Main commands don't wait for async compute commands of the same frame, unless RequireAsyncComputeResults is called.
+	bool HasAsyncCompute() const;
+	uint32_t GetAsyncComputeQueueFamilyIndex() const;
+	// Valid between BeginFrame and EndFrame. Null if there is no async compute.
+	vk::CommandBuffer GetAsyncComputeCommandBuffer() const;
+	// Call this if main commands of current frame use results of async compute commands of the same frame.
+	void RequireAsyncComputeResults();
+	// Returns indices of all used queue families. Resources used in different queues should be shared between them.
+	std::vector<uint32_t> GetUsedQueueFamilyIndices() const;
 
 	vk::Instance GetVulkanInstance() const;
 	vk::PhysicalDevice GetPhysicalDevice() const;
@@ -25,7 +44,7 @@ public:
 	uint32_t GetQueueFamilyIndex() const;
 	vk::Queue GetQueue() const;
 	vk::CommandPool GetCommandPool() const;
-	vk::RenderPass GetRenderPass() const; // Render pass for rendering directly into screen.
+	vk::RenderPass GetRenderPass() const; // Render pass for rendering directly into screen. Null in headless mode.
 	vk::PhysicalDeviceMemoryProperties GetMemoryProperties() const;
 
 	// Command buffers are circulary reused.
@@ -35,6 +54,10 @@ public:
 
 	uint32_t GetFramebufferImageCount() const;
 
+private:
+	// Submits async compute commands (if any) and returns semaphore for main commands to wait.
+	vk::Semaphore SubmitAsyncCompute();
+
 private:
 	struct CommandBufferData
 	{
@@ -42,6 +65,12 @@ private:
 		vk::UniqueSemaphore image_available_semaphore;
 		vk::UniqueSemaphore rendering_finished_semaphore;
 		vk::UniqueFence submit_fence;
+
+		// Null if there is no async compute.
+		vk::UniqueCommandBuffer async_compute_command_buffer;
+		vk::UniqueSemaphore async_compute_finished_semaphore;
+		vk::UniqueSemaphore main_queue_finished_semaphore;
+		vk::UniqueFence async_compute_submit_fence;
 	};
 
 	struct SwapchainFramebufferData
@@ -62,16 +91,23 @@ private:
 	vk::Extent2D viewport_size_;
 	vk::PhysicalDeviceMemoryProperties memory_properties_;
 	vk::PhysicalDevice physical_device_;
+	vk::Queue async_compute_queue_= nullptr;
+	uint32_t async_compute_queue_family_index_= ~0u;
 	vk::UniqueSwapchainKHR swapchain_;
 
 	vk::UniqueRenderPass render_pass_;
 	std::vector<SwapchainFramebufferData> framebuffers_; // one framebuffer for each swapchain image.
 
 	vk::UniqueCommandPool command_pool_;
+	vk::UniqueCommandPool async_compute_command_pool_;
 
 	std::vector<CommandBufferData> command_buffers_;
 	const CommandBufferData* current_frame_command_buffer_= nullptr;
 	size_t frame_count_= 0u;
+
+	bool async_compute_results_required_= false;
+	// Semaphore signaled by main commands of previous frame, which next async compute commands should wait for.
+	vk::Semaphore main_queue_finished_semaphore_to_wait_= nullptr;
 };
 
 } // namespace HexGPU
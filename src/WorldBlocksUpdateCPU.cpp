@@ -0,0 +1,918 @@
+#include "WorldBlocksUpdateCPU.hpp"
+#include "Assert.hpp"
+#include "BlockType.hpp"
+#include "Constants.hpp"
+#include "CpuFeatures.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <iterator>
+
+#if defined(HEX_SSE2)
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace HexGPU
+{
+
+namespace
+{
+
+// This should match GLSL code!
+const uint8_t c_block_flammability_table[size_t(BlockType::NumBlockTypes)]
+{
+	0, // Air
+	0, // SphericalBlock
+	0, // Stone
+	0, // Soil
+	1, // Wood
+	0, // Grass
+	0, // Brick
+	1, // Foliage
+	0, // FireStone
+	0, // Water
+	0, // Sand
+	0, // Fire
+	0, // GlassWhite
+	0, // GlassGrey
+	0, // GlassRed
+	0, // GlassYellow
+	0, // GlassGreen
+	0, // GlassCian
+	0, // GlassBlue
+	0, // GlassMagenta
+	1, // GrassYellow
+	0, // Snow
+};
+
+const int32_t c_min_wetness_for_grass_to_exist= 3;
+const int32_t c_max_fire_light_for_snow_to_exist= 7;
+
+constexpr uint8_t c_air= uint8_t(BlockType::Air);
+constexpr uint8_t c_spherical_block= uint8_t(BlockType::SphericalBlock);
+constexpr uint8_t c_soil= uint8_t(BlockType::Soil);
+constexpr uint8_t c_wood= uint8_t(BlockType::Wood);
+constexpr uint8_t c_grass= uint8_t(BlockType::Grass);
+constexpr uint8_t c_foliage= uint8_t(BlockType::Foliage);
+constexpr uint8_t c_water= uint8_t(BlockType::Water);
+constexpr uint8_t c_sand= uint8_t(BlockType::Sand);
+constexpr uint8_t c_fire= uint8_t(BlockType::Fire);
+constexpr uint8_t c_grass_yellow= uint8_t(BlockType::GrassYellow);
+constexpr uint8_t c_snow= uint8_t(BlockType::Snow);
+
+constexpr int32_t c_chunk_width_i= int32_t(c_chunk_width);
+constexpr int32_t c_chunk_height_i= int32_t(c_chunk_height);
+
+// Same as "hex_Noise3" in GLSL code.
+// Use unsigned arithmetic in order to get the same overflow behavior as in GLSL.
+int32_t Noise3(const int32_t x, const int32_t y, const int32_t z, const int32_t seed)
+{
+	uint32_t n= (
+		1619u * uint32_t(x) +
+		31337u * uint32_t(y) +
+		6971u * uint32_t(z) +
+		1013u * uint32_t(seed) )
+		& 0x7FFFFFFFu;
+
+	n= ( n >> 13 ) ^ n;
+	return int32_t(( ( n * ( n * n * 60493u + 19990303u ) + 1376312589u ) & 0x7FFFFFFFu ) >> 15);
+}
+
+int32_t ChunkBlockAddress(const int32_t x, const int32_t y, const int32_t z)
+{
+	return z + (y << c_chunk_height_log2) + (x << (c_chunk_width_log2 + c_chunk_height_log2));
+}
+
+int32_t GetBlockFullAddress(const int32_t x, const int32_t y, const int32_t z, const int32_t world_size_x)
+{
+	const int32_t chunk_x= x >> c_chunk_width_log2;
+	const int32_t chunk_y= y >> c_chunk_width_log2;
+	const int32_t local_x= x & (c_chunk_width_i - 1);
+	const int32_t local_y= y & (c_chunk_width_i - 1);
+
+	const int32_t chunk_index= chunk_x + chunk_y * world_size_x;
+	return chunk_index * int32_t(c_chunk_volume) + ChunkBlockAddress(local_x, local_y, z);
+}
+
+bool CanPlaceSnowOnThisBlock(const uint8_t block_type)
+{
+	return
+		block_type != c_air &&
+		block_type != c_fire &&
+		block_type != c_water &&
+		block_type != c_snow;
+}
+
+struct BlockState
+{
+	uint8_t type;
+	uint8_t auxiliar_data;
+};
+
+// Data of a column, shared by all blocks in it.
+// Calculating it once per column and not per block is the main advantage of CPU code layout.
+struct ColumnContext
+{
+	const WorldBlocksUpdateCPUParams* params= nullptr;
+	const WorldBlocksUpdateCPUData* data= nullptr;
+
+	int32_t world_volume= 0;
+
+	int32_t block_x= 0;
+	int32_t block_y= 0;
+	int32_t max_coord[2]{};
+
+	int32_t column_address= 0;
+	int32_t adjacent_columns[6]{};
+	bool adjacent_column_is_in_active_area[6]{};
+	bool is_in_active_area= false;
+
+	bool is_block_falling_tick= false;
+	bool is_water_side_flow_tick= false;
+
+	// GPU code may read one block outside of the column (at z= -1).
+	// Emulate robust buffer access - return zero for addresses outside the buffer.
+	uint8_t GetBlockType(const int32_t address) const
+	{
+		return address >= 0 && address < world_volume ? data->chunks_input_data[address] : uint8_t(0);
+	}
+
+	int32_t GetAuxiliarData(const int32_t address) const
+	{
+		return address >= 0 && address < world_volume ? int32_t(data->chunks_auxiliar_input_data[address]) : 0;
+	}
+
+	int32_t GetLight(const int32_t address) const
+	{
+		return address >= 0 && address < world_volume ? int32_t(data->light_data[address]) : 0;
+	}
+
+	int32_t GetFlammability(const int32_t address) const
+	{
+		const uint8_t block_type= GetBlockType(address);
+		return block_type < std::size(c_block_flammability_table) ? int32_t(c_block_flammability_table[block_type]) : 0;
+	}
+
+	// Check if water block at given address can flow down.
+	bool WaterCanFlowDown(const int32_t z, const int32_t block_address) const
+	{
+		if(z <= 0)
+			return false;
+
+		const int32_t block_below_address= block_address - 1;
+		const uint8_t block_below_type= GetBlockType(block_below_address);
+		return
+			block_below_type == c_air ||
+			(block_below_type == c_water && GetAuxiliarData(block_below_address) < c_max_water_level);
+	}
+};
+
+// Should exactly match "TransformBlock" function in "world_blocks_update" shader!
+BlockState TransformBlock(const ColumnContext& c, const int32_t z)
+{
+	const WorldBlocksUpdateCPUParams& params= *c.params;
+
+	const int32_t z_up_clamped= std::min(z + 1, c_chunk_height_i - 1);
+
+	const int32_t column_address= c.column_address;
+	const uint8_t block_type= c.GetBlockType(column_address + z);
+
+	const int32_t block_rand= Noise3(c.block_x, c.block_y, z, int32_t(params.current_tick));
+
+	if(block_type == c_air)
+	{
+		if(c.is_block_falling_tick && z < c_chunk_height_i - 1)
+		{
+			const uint8_t block_above_type= c.GetBlockType(column_address + z + 1);
+			if(block_above_type == c_sand)
+				return {c_sand, 0};
+			if(block_above_type == c_water)
+				return {c_water, uint8_t(c.GetAuxiliarData(column_address + z + 1))};
+		}
+
+		int32_t flow_in= 0;
+		int32_t total_fire_power_nearby= 0;
+		int32_t total_flammability_nearby= 0;
+
+		for(uint32_t i= 0; i < 6; ++i)
+		{
+			const int32_t adjacent_block_address= c.adjacent_columns[i] + z;
+			const uint8_t adjacent_block_type= c.GetBlockType(adjacent_block_address);
+
+			total_flammability_nearby+= c.GetFlammability(adjacent_block_address);
+
+			if(adjacent_block_type == c_water && c.adjacent_column_is_in_active_area[i])
+			{
+				if(c.WaterCanFlowDown(z, adjacent_block_address))
+					continue;
+
+				flow_in+= c.GetAuxiliarData(adjacent_block_address) >> 3;
+			}
+			if(adjacent_block_type == c_fire)
+				total_fire_power_nearby+= c.GetAuxiliarData(adjacent_block_address);
+		}
+		if(z < c_chunk_height_i - 1)
+		{
+			const int32_t adjacent_block_address= column_address + z + 1;
+			total_flammability_nearby+= c.GetFlammability(adjacent_block_address);
+			if(c.GetBlockType(adjacent_block_address) == c_fire)
+				total_fire_power_nearby+= c.GetAuxiliarData(adjacent_block_address);
+		}
+		if(z > 0)
+		{
+			const int32_t adjacent_block_address= column_address + z - 1;
+			total_flammability_nearby+= c.GetFlammability(adjacent_block_address);
+			if(c.GetBlockType(adjacent_block_address) == c_fire)
+				total_fire_power_nearby+= c.GetAuxiliarData(adjacent_block_address);
+		}
+
+		if(c.is_water_side_flow_tick)
+		{
+			if(flow_in != 0)
+				return {c_water, uint8_t(flow_in)};
+			else
+				return {c_air, 0};
+		}
+
+		if(total_flammability_nearby > 0 && (block_rand & 15) == 0)
+		{
+			if(total_fire_power_nearby >= c_min_fire_power_for_fire_to_spread)
+				return {c_fire, uint8_t(c_initial_fire_power)};
+
+			const bool block_below_is_air= z > 0 && c.GetBlockType(column_address + z - 1) == c_air;
+			const bool block_above_is_air= z < c_chunk_height_i - 1 && c.GetBlockType(column_address + z + 1) == c_air;
+
+			for(uint32_t i= 0; i < 6; ++i)
+			{
+				const int32_t adjacent_block_address= c.adjacent_columns[i] + z;
+				const bool adjacent_block_is_air= c.GetBlockType(adjacent_block_address) == c_air;
+
+				if((adjacent_block_is_air || block_below_is_air) &&
+					z > 0 && c.GetBlockType(adjacent_block_address - 1) == c_fire)
+					total_fire_power_nearby+= c.GetAuxiliarData(adjacent_block_address - 1);
+
+				if((adjacent_block_is_air || block_above_is_air) &&
+					z < c_chunk_height_i - 1 && c.GetBlockType(adjacent_block_address + 1) == c_fire)
+					total_fire_power_nearby+= c.GetAuxiliarData(adjacent_block_address + 1);
+			}
+
+			if(total_fire_power_nearby >= c_min_fire_power_for_fire_to_spread)
+				return {c_fire, uint8_t(c_initial_fire_power)};
+		}
+
+		if(z >= params.snow_z_level &&
+			(block_rand & 15) == 0 &&
+			CanPlaceSnowOnThisBlock(c.GetBlockType(column_address + z - 1)))
+		{
+			const int32_t light_packed= c.GetLight(column_address + z_up_clamped);
+			const int32_t sky_light= light_packed >> c_sky_light_shift;
+			const int32_t fire_light= light_packed & c_fire_light_mask;
+
+			if(sky_light == c_max_sky_light && fire_light <= c_max_fire_light_for_snow_to_exist)
+				return {c_snow, 0};
+		}
+	}
+	else if(block_type == c_sand)
+	{
+		if(c.is_block_falling_tick && z > 0)
+		{
+			const uint8_t block_below_type= c.GetBlockType(column_address + z - 1);
+			if(block_below_type == c_air || block_below_type == c_snow)
+				return {c_air, 0};
+		}
+	}
+	else if(block_type == c_water)
+	{
+		const int32_t water_level= c.GetAuxiliarData(column_address + z);
+
+		if(c.is_block_falling_tick)
+		{
+			int32_t flow_in= 0;
+			int32_t flow_out= 0;
+
+			if(z > 0)
+			{
+				const uint8_t block_below_type= c.GetBlockType(column_address + z - 1);
+				if(block_below_type == c_air)
+					flow_out= water_level;
+				else if(block_below_type == c_water)
+					flow_out= std::min(water_level, c_max_water_level - c.GetAuxiliarData(column_address + z - 1));
+			}
+			if(z < c_chunk_height_i - 1)
+			{
+				if(c.GetBlockType(column_address + z + 1) == c_water)
+					flow_in= std::min(c.GetAuxiliarData(column_address + z + 1), c_max_water_level - water_level);
+			}
+
+			const int32_t new_water_level= water_level + flow_in - flow_out;
+			if(new_water_level == 0)
+				return {c_air, 0};
+			else
+				return {c_water, uint8_t(new_water_level)};
+		}
+		else if(c.is_water_side_flow_tick && c.is_in_active_area)
+		{
+			int32_t flow_in= 0;
+			int32_t flow_out= 0;
+
+			for(uint32_t i= 0; i < 6; ++i)
+			{
+				if(!c.adjacent_column_is_in_active_area[i])
+					continue;
+
+				const int32_t adjacent_block_address= c.adjacent_columns[i] + z;
+
+				const uint8_t adjacent_block_type= c.GetBlockType(adjacent_block_address);
+				if(adjacent_block_type == c_air)
+					flow_out+= water_level >> 3;
+				else if(adjacent_block_type == c_water)
+				{
+					const int32_t level_diff= water_level - c.GetAuxiliarData(adjacent_block_address);
+					if(level_diff >= 8)
+						flow_out+= level_diff >> 3;
+					else if(level_diff <= -8 && !c.WaterCanFlowDown(z, adjacent_block_address))
+						flow_in+= (-level_diff) >> 3;
+				}
+			}
+
+			bool can_flow_down= false;
+			uint8_t block_below_type= c_spherical_block;
+			if(z > 0)
+			{
+				block_below_type= c.GetBlockType(column_address + z - 1);
+				can_flow_down= c.WaterCanFlowDown(z, column_address + z);
+			}
+
+			if(can_flow_down)
+				flow_out= 0;
+
+			if(water_level < 8 && flow_in == 0 && flow_out == 0 &&
+				block_below_type != c_air &&
+				block_below_type != c_water &&
+				(block_rand & 15) == 0)
+				return {c_air, 0};
+
+			return {c_water, uint8_t(water_level + flow_in - flow_out)};
+		}
+	}
+	else if(block_type == c_soil)
+	{
+		if((block_rand & 15) == 0 &&
+			z >= 1 &&
+			z < c_chunk_height_i - 3 &&
+			c.GetBlockType(column_address + z_up_clamped) == c_air)
+		{
+			const int32_t light_packed= c.GetLight(column_address + z_up_clamped);
+			const int32_t fire_light= light_packed & c_fire_light_mask;
+			const int32_t sky_light= (light_packed >> c_sky_light_shift) & params.sky_light_mask;
+			const int32_t total_light= fire_light + sky_light;
+			const int32_t c_min_light_to_graw= 2;
+			if(total_light >= c_min_light_to_graw)
+			{
+				int32_t wetness= (light_packed >> c_sky_light_shift) & params.sky_light_based_wetness_mask;
+
+				int32_t num_adjacent_grass_blocks= 0;
+				for(uint32_t i= 0; i < 6; ++i)
+				{
+					const int32_t adjacent_column= c.adjacent_columns[i];
+					const uint8_t z_minus_one_block_type= c.GetBlockType(adjacent_column + z - 1);
+					const uint8_t z_plus_zero_block_type= c.GetBlockType(adjacent_column + z + 0);
+					const uint8_t z_plus_one_block_type = c.GetBlockType(adjacent_column + z + 1);
+					const uint8_t z_plus_two_block_type = c.GetBlockType(adjacent_column + z + 2);
+
+					if( z_minus_one_block_type == c_grass &&
+						z_plus_zero_block_type == c_air &&
+						z_plus_one_block_type  == c_air)
+						++num_adjacent_grass_blocks;
+					if( z_plus_zero_block_type == c_grass &&
+						z_plus_one_block_type  == c_air)
+						++num_adjacent_grass_blocks;
+					if( z_plus_one_block_type == c_grass &&
+						z_plus_two_block_type == c_air &&
+						c.GetBlockType(column_address + z + 2) == c_air)
+						++num_adjacent_grass_blocks;
+
+					if(z_plus_zero_block_type == c_water || z_minus_one_block_type == c_water)
+						wetness= c_min_wetness_for_grass_to_exist;
+				}
+
+				if(wetness >= c_min_wetness_for_grass_to_exist &&
+					num_adjacent_grass_blocks * block_rand >= 65536 / 2)
+					return {c_grass, 0};
+			}
+		}
+	}
+	else if(block_type == c_grass)
+	{
+		const uint8_t block_above_type= c.GetBlockType(column_address + z_up_clamped);
+		if(!(
+			block_above_type == c_air ||
+			block_above_type == c_snow ||
+			block_above_type == c_foliage ||
+			block_above_type == c_fire))
+			return {c_soil, 0};
+
+		int32_t wetness= (c.GetLight(column_address + z_up_clamped) >> c_sky_light_shift) & params.sky_light_based_wetness_mask;
+
+		if(wetness < c_min_wetness_for_grass_to_exist)
+		{
+			for(uint32_t i= 0; i < 6; ++i)
+			{
+				const int32_t adjacent_block_address= c.adjacent_columns[i] + z;
+				if(c.GetBlockType(adjacent_block_address) == c_water)
+					wetness= c_min_wetness_for_grass_to_exist;
+				if(z > 0 && c.GetBlockType(adjacent_block_address - 1) == c_water)
+					wetness= c_min_wetness_for_grass_to_exist;
+			}
+
+			if(wetness < c_min_wetness_for_grass_to_exist && (block_rand & 15) == 0)
+				return {c_grass_yellow, 0};
+		}
+	}
+	else if(block_type == c_grass_yellow)
+	{
+		const uint8_t block_above_type= c.GetBlockType(column_address + z_up_clamped);
+		if(!(
+			block_above_type == c_air ||
+			block_above_type == c_snow ||
+			block_above_type == c_foliage ||
+			block_above_type == c_fire))
+			return {c_soil, 0};
+
+		int32_t wetness= (c.GetLight(column_address + z_up_clamped) >> c_sky_light_shift) & params.sky_light_based_wetness_mask;
+
+		int32_t total_fire_power_nearby= 0;
+		for(uint32_t i= 0; i < 6; ++i)
+		{
+			const int32_t adjacent_block_address= c.adjacent_columns[i] + z;
+
+			if(c.GetBlockType(adjacent_block_address) == c_water)
+				wetness= c_min_wetness_for_grass_to_exist;
+			if(z > 0 && c.GetBlockType(adjacent_block_address - 1) == c_water)
+				wetness= c_min_wetness_for_grass_to_exist;
+
+			if(z < c_chunk_height_i - 1 && c.GetBlockType(adjacent_block_address + 1) == c_fire)
+				total_fire_power_nearby+= c.GetAuxiliarData(adjacent_block_address + 1);
+		}
+
+		if(block_above_type == c_fire)
+			total_fire_power_nearby+= c.GetAuxiliarData(column_address + z_up_clamped);
+
+		if(total_fire_power_nearby >= c_min_fire_power_for_blocks_burning * 2 && (block_rand & 15) == 0)
+			return {c_soil, 0};
+
+		if(wetness >= c_min_wetness_for_grass_to_exist && (block_rand & 15) == 0)
+			return {c_grass, 0};
+	}
+	else if(block_type == c_foliage)
+	{
+		int32_t max_adjacent_foliage_factor= 0;
+		int32_t total_fire_power_nearby= 0;
+
+		const auto process_adjacent_block=
+			[&](const int32_t adjacent_block_address)
+			{
+				const uint8_t adjacent_block_type= c.GetBlockType(adjacent_block_address);
+				if(adjacent_block_type == c_wood)
+					max_adjacent_foliage_factor= c_max_foliage_factor;
+				else if(adjacent_block_type == c_foliage)
+					max_adjacent_foliage_factor= std::max(max_adjacent_foliage_factor, c.GetAuxiliarData(adjacent_block_address));
+				else if(adjacent_block_type == c_fire)
+					total_fire_power_nearby+= c.GetAuxiliarData(adjacent_block_address);
+			};
+
+		for(uint32_t i= 0; i < 6; ++i)
+			process_adjacent_block(c.adjacent_columns[i] + z);
+		if(z < c_chunk_height_i - 1)
+			process_adjacent_block(column_address + z + 1);
+		if(z > 0)
+			process_adjacent_block(column_address + z - 1);
+
+		int32_t this_block_foliage_factor= std::max(0, max_adjacent_foliage_factor - 1);
+
+		const int32_t border_size= c_max_foliage_factor + 2;
+		if( c.block_x <= border_size || c.block_x >= c.max_coord[0] - border_size ||
+			c.block_y <= border_size || c.block_y >= c.max_coord[1] - border_size)
+			this_block_foliage_factor= c_max_foliage_factor;
+
+		if(this_block_foliage_factor == 0 && (block_rand & 31) == 0)
+			return {c_air, 0};
+
+		if(total_fire_power_nearby >= c_min_fire_power_for_blocks_burning && (block_rand & 15) == 0)
+			return {c_fire, uint8_t(c_initial_fire_power)};
+
+		return {block_type, uint8_t(this_block_foliage_factor)};
+	}
+	else if(block_type == c_wood)
+	{
+		int32_t total_fire_power_nearby= 0;
+		for(uint32_t i= 0; i < 6; ++i)
+		{
+			const int32_t adjacent_block_address= c.adjacent_columns[i] + z;
+			if(c.GetBlockType(adjacent_block_address) == c_fire)
+				total_fire_power_nearby+= c.GetAuxiliarData(adjacent_block_address);
+		}
+		if(z < c_chunk_height_i - 1 && c.GetBlockType(column_address + z + 1) == c_fire)
+			total_fire_power_nearby+= c.GetAuxiliarData(column_address + z + 1);
+		if(z > 0 && c.GetBlockType(column_address + z - 1) == c_fire)
+			total_fire_power_nearby+= c.GetAuxiliarData(column_address + z - 1);
+
+		if(total_fire_power_nearby >= c_min_fire_power_for_blocks_burning && (block_rand & 63) == 0)
+			return {c_fire, uint8_t(c_initial_fire_power)};
+	}
+	else if(block_type == c_fire)
+	{
+		int32_t total_flammability_nearby= 0;
+
+		bool extinguish= false;
+		for(uint32_t i= 0; i < 6; ++i)
+		{
+			const int32_t adjacent_block_address= c.adjacent_columns[i] + z;
+			total_flammability_nearby+= c.GetFlammability(adjacent_block_address);
+			if(c.GetBlockType(adjacent_block_address) == c_water && !c.WaterCanFlowDown(z, adjacent_block_address))
+				extinguish= true;
+		}
+		if(z < c_chunk_height_i - 1)
+		{
+			const int32_t adjacent_block_address= column_address + z + 1;
+			total_flammability_nearby+= c.GetFlammability(adjacent_block_address);
+			const uint8_t adjacent_block_type= c.GetBlockType(adjacent_block_address);
+			if(adjacent_block_type == c_water || adjacent_block_type == c_sand)
+				extinguish= true;
+		}
+		if(z > 0)
+			total_flammability_nearby+= c.GetFlammability(column_address + z - 1);
+
+		if(total_flammability_nearby == 0 || extinguish)
+			return {c_air, 0};
+
+		const int32_t fire_power= std::min(c.GetAuxiliarData(column_address + z) + total_flammability_nearby, 255);
+		return {c_fire, uint8_t(fire_power)};
+	}
+	else if(block_type == c_snow)
+	{
+		if(c.is_block_falling_tick &&
+			z < c_chunk_height_i - 1 && c.GetBlockType(column_address + z_up_clamped) == c_sand)
+			return {c_sand, 0};
+
+		const int32_t light_packed= c.GetLight(column_address + z_up_clamped);
+		const int32_t sky_light= light_packed >> c_sky_light_shift;
+
+		const bool can_exist= sky_light == c_max_sky_light && z >= params.snow_z_level;
+		if(!can_exist && (block_rand & 15) == 0)
+			return {c_air, 0};
+
+		if(!CanPlaceSnowOnThisBlock(c.GetBlockType(column_address + z - 1)))
+			return {c_air, 0};
+
+		const int32_t fire_light= light_packed & c_fire_light_mask;
+		if(fire_light > c_max_fire_light_for_snow_to_exist)
+			return {c_air, 0};
+	}
+
+	return {block_type, uint8_t(c.GetAuxiliarData(column_address + z))};
+}
+
+// Static blocks search.
+// Most blocks of the world are never changed by the update - stone, glass and other blocks of types without any logic
+// and air blocks surrounded by air. Such blocks are found via SIMD scan of whole columns,
+// so that "TransformBlock" is called only for remaining blocks.
+
+static_assert(c_chunk_height % 64 == 0, "Column masks require column height multiple of 64");
+
+// Bit mask of column elements.
+using ColumnMask= std::array<uint64_t, c_chunk_height / 64>;
+
+// All block types with logic in "TransformBlock". Blocks of all other types are never changed.
+constexpr uint8_t c_changeable_block_types[]
+{
+	c_air, c_soil, c_wood, c_grass, c_foliage, c_water, c_sand, c_fire, c_grass_yellow, c_snow,
+};
+
+struct ColumnBlocksMasks
+{
+	ColumnMask air;
+	// Blocks of types without logic.
+	ColumnMask unchangeable;
+	// Air in all adjacent columns at the same z.
+	ColumnMask adjacent_air;
+};
+
+using AdjacentColumnsData= std::array<const uint8_t*, 6>;
+
+uint32_t CountTrailingZeros(const uint64_t x)
+{
+	HEX_ASSERT(x != 0);
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long index= 0;
+	_BitScanForward64(&index, x);
+	return uint32_t(index);
+#else
+	return uint32_t(__builtin_ctzll(x));
+#endif
+}
+
+[[maybe_unused]] ColumnBlocksMasks GetColumnBlocksMasksScalar(
+	const uint8_t* const column,
+	const AdjacentColumnsData& adjacent_columns)
+{
+	ColumnBlocksMasks masks{};
+	for(uint32_t z= 0; z < c_chunk_height; ++z)
+	{
+		const uint64_t bit= uint64_t(1) << (z % 64);
+
+		const uint8_t block_type= column[z];
+		if(block_type == c_air)
+			masks.air[z / 64]|= bit;
+		if(std::find(std::begin(c_changeable_block_types), std::end(c_changeable_block_types), block_type) ==
+			std::end(c_changeable_block_types))
+			masks.unchangeable[z / 64]|= bit;
+
+		bool adjacent_air= true;
+		for(const uint8_t* const adjacent_column : adjacent_columns)
+			adjacent_air&= adjacent_column[z] == c_air;
+		if(adjacent_air)
+			masks.adjacent_air[z / 64]|= bit;
+	}
+
+	return masks;
+}
+
+#if defined(HEX_SSE2)
+
+ColumnBlocksMasks GetColumnBlocksMasksSSE2(const uint8_t* const column, const AdjacentColumnsData& adjacent_columns)
+{
+	const __m128i air= _mm_set1_epi8(char(c_air));
+
+	ColumnBlocksMasks masks{};
+	for(uint32_t z= 0; z < c_chunk_height; z+= 16)
+	{
+		const __m128i blocks= _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + z));
+
+		__m128i changeable= _mm_setzero_si128();
+		for(const uint8_t block_type : c_changeable_block_types)
+			changeable= _mm_or_si128(changeable, _mm_cmpeq_epi8(blocks, _mm_set1_epi8(char(block_type))));
+
+		__m128i adjacent_air= _mm_set1_epi8(-1);
+		for(const uint8_t* const adjacent_column : adjacent_columns)
+			adjacent_air=
+				_mm_and_si128(
+					adjacent_air,
+					_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(adjacent_column + z)), air));
+
+		masks.air[z / 64]|= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(blocks, air)))) << (z % 64);
+		masks.unchangeable[z / 64]|= uint64_t(~uint32_t(_mm_movemask_epi8(changeable)) & 0xFFFFu) << (z % 64);
+		masks.adjacent_air[z / 64]|= uint64_t(uint32_t(_mm_movemask_epi8(adjacent_air))) << (z % 64);
+	}
+
+	return masks;
+}
+
+#endif
+
+#if defined(HEX_AVX2)
+
+HEX_TARGET_AVX2 ColumnBlocksMasks GetColumnBlocksMasksAVX2(
+	const uint8_t* const column,
+	const AdjacentColumnsData& adjacent_columns)
+{
+	const __m256i air= _mm256_set1_epi8(char(c_air));
+
+	ColumnBlocksMasks masks{};
+	for(uint32_t z= 0; z < c_chunk_height; z+= 32)
+	{
+		const __m256i blocks= _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + z));
+
+		__m256i changeable= _mm256_setzero_si256();
+		for(const uint8_t block_type : c_changeable_block_types)
+			changeable= _mm256_or_si256(changeable, _mm256_cmpeq_epi8(blocks, _mm256_set1_epi8(char(block_type))));
+
+		__m256i adjacent_air= _mm256_set1_epi8(-1);
+		for(const uint8_t* const adjacent_column : adjacent_columns)
+			adjacent_air=
+				_mm256_and_si256(
+					adjacent_air,
+					_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(adjacent_column + z)), air));
+
+		masks.air[z / 64]|= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(blocks, air)))) << (z % 64);
+		masks.unchangeable[z / 64]|= uint64_t(~uint32_t(_mm256_movemask_epi8(changeable))) << (z % 64);
+		masks.adjacent_air[z / 64]|= uint64_t(uint32_t(_mm256_movemask_epi8(adjacent_air))) << (z % 64);
+	}
+
+	return masks;
+}
+
+#endif
+
+using GetColumnBlocksMasksFunc= ColumnBlocksMasks(*)(const uint8_t* column, const AdjacentColumnsData& adjacent_columns);
+
+GetColumnBlocksMasksFunc SelectGetColumnBlocksMasksFunc()
+{
+#if defined(HEX_AVX2)
+	if(CpuSupportsAVX2())
+		return GetColumnBlocksMasksAVX2;
+#endif
+#if defined(HEX_SSE2)
+	return GetColumnBlocksMasksSSE2;
+#else
+	return GetColumnBlocksMasksScalar;
+#endif
+}
+
+// Air blocks with air above, below and in all adjacent columns.
+// Such blocks keep their auxiliar data in block falling ticks and lose it in water side flow ticks.
+// Blocks at the column top and bottom are never static air, since "TransformBlock" reads blocks outside the column for them.
+ColumnMask GetStaticAirMask(const ColumnBlocksMasks& masks)
+{
+	ColumnMask mask{};
+	for(size_t i= 0; i < mask.size(); ++i)
+	{
+		const uint64_t air_below= (masks.air[i] << 1) | (i > 0 ? masks.air[i - 1] >> 63 : 0);
+		const uint64_t air_above= (masks.air[i] >> 1) | (i + 1 < mask.size() ? masks.air[i + 1] << 63 : 0);
+		mask[i]= masks.air[i] & masks.adjacent_air[i] & air_below & air_above;
+	}
+
+	return mask;
+}
+
+} // namespace
+
+bool UpdateChunkBlocksCPU(
+	const WorldBlocksUpdateCPUParams& params,
+	const WorldBlocksUpdateCPUData& data,
+	const ChunkPositionCPU out_chunk_position)
+{
+	const int32_t world_size_x= int32_t(params.world_size_chunks[0]);
+	const int32_t world_size_y= int32_t(params.world_size_chunks[1]);
+
+	const int32_t in_chunk_position[2]
+	{
+		int32_t(out_chunk_position[0]) + params.in_chunk_shift[0],
+		int32_t(out_chunk_position[1]) + params.in_chunk_shift[1],
+	};
+	HEX_ASSERT(in_chunk_position[0] >= 0 && in_chunk_position[0] < world_size_x);
+	HEX_ASSERT(in_chunk_position[1] >= 0 && in_chunk_position[1] < world_size_y);
+	HEX_ASSERT(out_chunk_position[0] < params.world_size_chunks[0]);
+	HEX_ASSERT(out_chunk_position[1] < params.world_size_chunks[1]);
+
+	ColumnContext c;
+	c.params= &params;
+	c.data= &data;
+	c.world_volume= world_size_x * world_size_y * int32_t(c_chunk_volume);
+	c.max_coord[0]= world_size_x * c_chunk_width_i - 1;
+	c.max_coord[1]= world_size_y * c_chunk_width_i - 1;
+	c.is_block_falling_tick= (params.current_tick & 1) == 0;
+	c.is_water_side_flow_tick= (params.current_tick & 1) == 1;
+
+	const int32_t out_chunk_index= int32_t(out_chunk_position[0] + out_chunk_position[1] * params.world_size_chunks[0]);
+	const int32_t in_chunk_index= in_chunk_position[0] + in_chunk_position[1] * world_size_x;
+
+	static const GetColumnBlocksMasksFunc get_column_blocks_masks= SelectGetColumnBlocksMasksFunc();
+
+	bool modified= false;
+
+	for(int32_t x= 0; x < c_chunk_width_i; ++x)
+	for(int32_t y= 0; y < c_chunk_width_i; ++y)
+	{
+		const int32_t block_x= (in_chunk_position[0] << c_chunk_width_log2) + x;
+		const int32_t block_y= (in_chunk_position[1] << c_chunk_width_log2) + y;
+		const int32_t max_x= c.max_coord[0];
+		const int32_t max_y= c.max_coord[1];
+
+		const int32_t side_y_base= block_y + ((block_x + 1) & 1);
+		const int32_t east_x_clamped= std::min(block_x + 1, max_x);
+		const int32_t west_x_clamped= std::max(block_x - 1, 0);
+
+		c.block_x= block_x;
+		c.block_y= block_y;
+		c.column_address= GetBlockFullAddress(block_x, block_y, 0, world_size_x);
+
+		// north, south, north-east, south-east, north-west, south-west.
+		c.adjacent_columns[0]= GetBlockFullAddress(block_x, std::min(block_y + 1, max_y), 0, world_size_x);
+		c.adjacent_columns[1]= GetBlockFullAddress(block_x, std::max(block_y - 1, 0), 0, world_size_x);
+		c.adjacent_columns[2]= GetBlockFullAddress(east_x_clamped, std::max(0, std::min(side_y_base - 0, max_y)), 0, world_size_x);
+		c.adjacent_columns[3]= GetBlockFullAddress(east_x_clamped, std::max(0, std::min(side_y_base - 1, max_y)), 0, world_size_x);
+		c.adjacent_columns[4]= GetBlockFullAddress(west_x_clamped, std::max(0, std::min(side_y_base - 0, max_y)), 0, world_size_x);
+		c.adjacent_columns[5]= GetBlockFullAddress(west_x_clamped, std::max(0, std::min(side_y_base - 1, max_y)), 0, world_size_x);
+
+		c.is_in_active_area=
+			block_x > 0 && block_x < max_x &&
+			block_y > 0 && block_y < max_y;
+
+		const bool side_east_is_active= block_x + 1 < max_x;
+		const bool side_west_is_active= block_x - 1 > 0;
+		const bool side_north_is_active= side_y_base > 0 && side_y_base < max_y;
+		const bool side_south_is_active= side_y_base - 1 > 0 && side_y_base - 1 < max_y;
+
+		c.adjacent_column_is_in_active_area[0]= block_y + 1 < max_y;
+		c.adjacent_column_is_in_active_area[1]= block_y - 1 > 0;
+		c.adjacent_column_is_in_active_area[2]= side_east_is_active && side_north_is_active;
+		c.adjacent_column_is_in_active_area[3]= side_east_is_active && side_south_is_active;
+		c.adjacent_column_is_in_active_area[4]= side_west_is_active && side_north_is_active;
+		c.adjacent_column_is_in_active_area[5]= side_west_is_active && side_south_is_active;
+
+		const int32_t in_column_address= in_chunk_index * int32_t(c_chunk_volume) + ChunkBlockAddress(x, y, 0);
+		const int32_t out_column_address= out_chunk_index * int32_t(c_chunk_volume) + ChunkBlockAddress(x, y, 0);
+
+		const auto process_block=
+			[&](const int32_t z)
+			{
+				const BlockState new_block_state= TransformBlock(c, z);
+
+				data.chunks_output_data[out_column_address + z]= new_block_state.type;
+				data.chunks_auxiliar_output_data[out_column_address + z]= new_block_state.auxiliar_data;
+
+				modified|=
+					new_block_state.type != data.chunks_input_data[in_column_address + z] ||
+					new_block_state.auxiliar_data != data.chunks_auxiliar_input_data[in_column_address + z];
+			};
+
+		if(!params.skip_static_blocks)
+		{
+			for(int32_t z= 0; z < c_chunk_height_i; ++z)
+				process_block(z);
+			continue;
+		}
+
+		AdjacentColumnsData adjacent_columns_data{};
+		for(uint32_t i= 0; i < 6; ++i)
+			adjacent_columns_data[i]= data.chunks_input_data + c.adjacent_columns[i];
+
+		const ColumnBlocksMasks masks= get_column_blocks_masks(data.chunks_input_data + in_column_address, adjacent_columns_data);
+		const ColumnMask static_air_mask= GetStaticAirMask(masks);
+
+		// Static blocks remain the same - copy the whole column and process only remaining blocks.
+		std::memcpy(data.chunks_output_data + out_column_address, data.chunks_input_data + in_column_address, c_chunk_height);
+		std::memcpy(
+			data.chunks_auxiliar_output_data + out_column_address,
+			data.chunks_auxiliar_input_data + in_column_address,
+			c_chunk_height);
+
+		for(uint32_t i= 0; i < static_air_mask.size(); ++i)
+		{
+			if(c.is_water_side_flow_tick)
+			{
+				for(uint64_t bits= static_air_mask[i]; bits != 0; bits&= bits - 1)
+				{
+					const int32_t z= int32_t(i * 64 + CountTrailingZeros(bits));
+					uint8_t& auxiliar_data= data.chunks_auxiliar_output_data[out_column_address + z];
+					modified|= auxiliar_data != 0;
+					auxiliar_data= 0;
+				}
+			}
+
+			for(uint64_t bits= ~(static_air_mask[i] | masks.unchangeable[i]); bits != 0; bits&= bits - 1)
+				process_block(int32_t(i * 64 + CountTrailingZeros(bits)));
+		}
+	}
+
+	return modified;
+}
+
+std::vector<bool> UpdateChunksBlocksCPU(
+	const WorldBlocksUpdateCPUParams& params,
+	const WorldBlocksUpdateCPUData& data,
+	const std::vector<ChunkPositionCPU>& out_chunk_positions,
+	ThreadPool& thread_pool)
+{
+	// Each task writes only data of its own chunk, so no synchronization is needed.
+	std::vector<std::future<bool>> tasks;
+	tasks.reserve(out_chunk_positions.size());
+	for(const ChunkPositionCPU& out_chunk_position : out_chunk_positions)
+		tasks.push_back(
+			thread_pool.Submit(
+				[&params, &data, out_chunk_position]
+				{
+					return UpdateChunkBlocksCPU(params, data, out_chunk_position);
+				}));
+
+	std::vector<bool> modified_flags;
+	modified_flags.reserve(tasks.size());
+	for(std::future<bool>& task : tasks)
+		modified_flags.push_back(task.get());
+
+	return modified_flags;
+}
+
+std::vector<bool> UpdateWorldBlocksCPU(
+	const WorldBlocksUpdateCPUParams& params,
+	const WorldBlocksUpdateCPUData& data,
+	ThreadPool& thread_pool)
+{
+	HEX_ASSERT(params.in_chunk_shift[0] == 0 && params.in_chunk_shift[1] == 0);
+
+	std::vector<ChunkPositionCPU> out_chunk_positions;
+	out_chunk_positions.reserve(params.world_size_chunks[0] * params.world_size_chunks[1]);
+	for(uint32_t y= 0; y < params.world_size_chunks[1]; ++y)
+	for(uint32_t x= 0; x < params.world_size_chunks[0]; ++x)
+		out_chunk_positions.push_back({x, y});
+
+	return UpdateChunksBlocksCPU(params, data, out_chunk_positions, thread_pool);
+}
+
+} // namespace HexGPU
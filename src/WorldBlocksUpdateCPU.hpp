@@ -0,0 +1,68 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace HexGPU
+{
+
+class ThreadPool;
+
+// CPU implementation of world blocks update.
+// It mirrors logic of "world_blocks_update" shader and should produce bit-exact results.
+// If shader logic is changed, this code must be changed too!
+// Uses the same flat chunks data layout as GPU buffers.
+// May be used for validation of the shader and for offline world simulation without a GPU.
+
+struct WorldBlocksUpdateCPUParams
+{
+	std::array<uint32_t, 2> world_size_chunks{};
+	// Relative shift of input chunks (in case of world shift).
+	std::array<int32_t, 2> in_chunk_shift{};
+	uint32_t current_tick= 0;
+
+	// Values from world global state.
+	int32_t sky_light_mask= 0;
+	int32_t sky_light_based_wetness_mask= 0;
+	int32_t snow_z_level= 0;
+
+	// Skip full processing of blocks which can't change in this tick (found via vectorized scan of columns).
+	// Results are identical, disable this only in order to check this optimization.
+	bool skip_static_blocks= true;
+};
+
+// Data for whole world. Each buffer has size of world volume.
+// Input and output buffers should not overlap.
+struct WorldBlocksUpdateCPUData
+{
+	const uint8_t* chunks_input_data= nullptr;
+	const uint8_t* chunks_auxiliar_input_data= nullptr;
+	const uint8_t* light_data= nullptr;
+	uint8_t* chunks_output_data= nullptr;
+	uint8_t* chunks_auxiliar_output_data= nullptr;
+};
+
+using ChunkPositionCPU= std::array<uint32_t, 2>;
+
+// Update blocks of single output chunk. Returns true if any block of it was changed.
+bool UpdateChunkBlocksCPU(
+	const WorldBlocksUpdateCPUParams& params,
+	const WorldBlocksUpdateCPUData& data,
+	ChunkPositionCPU out_chunk_position);
+
+// Update given chunks in parallel - one thread pool task per chunk.
+// Returns modified flag for each chunk.
+std::vector<bool> UpdateChunksBlocksCPU(
+	const WorldBlocksUpdateCPUParams& params,
+	const WorldBlocksUpdateCPUData& data,
+	const std::vector<ChunkPositionCPU>& out_chunk_positions,
+	ThreadPool& thread_pool);
+
+// Update all chunks of the world (which is possible only without world shift).
+// Returns modified flag for each chunk.
+std::vector<bool> UpdateWorldBlocksCPU(
+	const WorldBlocksUpdateCPUParams& params,
+	const WorldBlocksUpdateCPUData& data,
+	ThreadPool& thread_pool);
+
+} // namespace HexGPU
@@ -0,0 +1,222 @@
+#include "WorldBlocksUpdateValidator.hpp"
+#include "BlockType.hpp"
+#include "ChunksActivityCPU.hpp"
+#include "Constants.hpp"
+#include "LightUpdateCPU.hpp"
+#include "Log.hpp"
+#include "WorldBlocksUpdateCPU.hpp"
+#include <chrono>
+#include <cstring>
+#include <iterator>
+
+namespace HexGPU
+{
+
+WorldBlocksUpdateValidator::WorldBlocksUpdateValidator()
+{
+	Log::Info("World blocks update validation is enabled");
+}
+
+uint32_t WorldBlocksUpdateValidator::Validate(const WorldBlocksUpdateValidationData& data)
+{
+	const std::array<uint32_t, 2> world_size= data.world_size_chunks;
+	const size_t world_volume= c_chunk_volume * world_size[0] * world_size[1];
+
+	WorldBlocksUpdateCPUParams params;
+	params.world_size_chunks= world_size;
+	params.in_chunk_shift= data.relative_world_shift;
+	params.current_tick= data.tick;
+	params.sky_light_mask= data.sky_light_mask;
+	params.sky_light_based_wetness_mask= data.sky_light_based_wetness_mask;
+	params.snow_z_level= data.snow_z_level;
+
+	std::vector<uint8_t> chunks_output_data(world_volume, 0);
+	std::vector<uint8_t> chunks_auxiliar_output_data(world_volume, 0);
+
+	WorldBlocksUpdateCPUData cpu_data;
+	cpu_data.chunks_input_data= data.input_blocks;
+	cpu_data.chunks_auxiliar_input_data= data.input_auxiliar_data;
+	cpu_data.light_data= data.input_light;
+	cpu_data.chunks_output_data= chunks_output_data.data();
+	cpu_data.chunks_auxiliar_output_data= chunks_auxiliar_output_data.data();
+
+	ChunksActivityCPU::Checker chunks_activity_checker;
+	chunks_activity_checker.world_size_chunks= {int32_t(world_size[0]), int32_t(world_size[1])};
+	chunks_activity_checker.current_tick= data.tick;
+	chunks_activity_checker.inactive_chunks_update_period= data.inactive_chunks_update_period;
+	chunks_activity_checker.chunks_changed_flags= data.chunks_changed_flags;
+
+	// Validate only chunks which were updated (not generated or uploaded) in this tick.
+	// For chunks skipped as inactive just check that their data wasn't changed.
+	std::vector<ChunkPositionCPU> chunks_to_validate;
+	std::vector<ChunkPositionCPU> light_chunks_to_validate;
+	std::vector<bool> chunks_light_validated(world_size[0] * world_size[1], false);
+	uint32_t num_inactive_chunks= 0;
+	uint32_t num_changed_inactive_chunks= 0;
+	for(uint32_t y= 0; y < world_size[1]; ++y)
+	for(uint32_t x= 0; x < world_size[0]; ++x)
+	{
+		const uint32_t chunk_index= x + y * world_size[0];
+		if(!data.chunks_updated[chunk_index])
+			continue;
+
+		if(chunks_activity_checker.IsChunkActive({int32_t(x), int32_t(y)}))
+		{
+			chunks_to_validate.push_back({x, y});
+			light_chunks_to_validate.push_back({x, y});
+			chunks_light_validated[chunk_index]= true;
+			continue;
+		}
+
+		++num_inactive_chunks;
+
+		// Blocks of inactive chunks are updated too if simulation params were changed.
+		if(data.simulation_params_changed)
+			chunks_to_validate.push_back({x, y});
+
+		// There is no world shift in ticks with inactive chunks.
+		const size_t offset= chunk_index * c_chunk_volume;
+		const std::pair<const uint8_t*, const uint8_t*> input_output_pairs[]
+		{
+			{data.input_light, data.output_light},
+			{data.input_blocks, data.output_blocks},
+			{data.input_auxiliar_data, data.output_auxiliar_data},
+		};
+		const size_t num_pairs_to_check= data.simulation_params_changed ? 1 : std::size(input_output_pairs);
+		for(size_t i= 0; i < num_pairs_to_check; ++i)
+		{
+			const auto& input_output_pair= input_output_pairs[i];
+			if(std::memcmp(input_output_pair.first + offset, input_output_pair.second + offset, c_chunk_volume) != 0)
+			{
+				Log::Warning("Inactive chunk ", x, ",", y, " has different data in source and destination buffers");
+				++num_changed_inactive_chunks;
+				break;
+			}
+		}
+	}
+
+	UpdateChunksBlocksCPU(params, cpu_data, chunks_to_validate, thread_pool_);
+
+	LightUpdateCPUParams light_params;
+	light_params.world_size_chunks= world_size;
+	light_params.in_chunk_shift= data.relative_world_shift;
+
+	// Validate all light update kernels, supported by this CPU.
+	const std::vector<LightUpdateCPUKernel> light_update_kernels= GetSupportedLightUpdateCPUKernels();
+	std::vector<std::vector<uint8_t>> output_lights(light_update_kernels.size(), std::vector<uint8_t>(world_volume, 0));
+	std::vector<double> light_update_times_s(light_update_kernels.size(), 0.0);
+
+	for(size_t i= 0; i < light_update_kernels.size(); ++i)
+	{
+		light_params.kernel= light_update_kernels[i];
+
+		LightUpdateCPUData light_data;
+		light_data.chunks_data= data.input_blocks;
+		light_data.input_light= data.input_light;
+		light_data.output_light= output_lights[i].data();
+
+		const auto light_update_start_time= std::chrono::steady_clock::now();
+		UpdateChunksLightCPU(light_params, light_data, light_chunks_to_validate, thread_pool_);
+		const auto light_update_end_time= std::chrono::steady_clock::now();
+
+		light_update_times_s[i]= std::chrono::duration<double>(light_update_end_time - light_update_start_time).count();
+	}
+
+	uint32_t num_mismatched_chunks= 0;
+	for(const ChunkPositionCPU& chunk_position : chunks_to_validate)
+	{
+		const size_t offset= (chunk_position[0] + chunk_position[1] * world_size[0]) * c_chunk_volume;
+
+		uint32_t num_mismatched_blocks= 0;
+		for(uint32_t i= 0; i < c_chunk_volume; ++i)
+		{
+			if( chunks_output_data[offset + i] == data.output_blocks[offset + i] &&
+				chunks_auxiliar_output_data[offset + i] == data.output_auxiliar_data[offset + i])
+				continue;
+
+			if(num_mismatched_blocks == 0)
+				Log::Warning(
+					"World blocks update mismatch in chunk ", chunk_position[0], ",", chunk_position[1],
+					" at block ", i, ": GPU ",
+					BlockTypeToString(BlockType(data.output_blocks[offset + i])), "/", int32_t(data.output_auxiliar_data[offset + i]),
+					", CPU ",
+					BlockTypeToString(BlockType(chunks_output_data[offset + i])), "/", int32_t(chunks_auxiliar_output_data[offset + i]));
+			++num_mismatched_blocks;
+		}
+
+		uint32_t num_mismatched_light_values= 0;
+		for(size_t kernel_index= 0; kernel_index < light_update_kernels.size(); ++kernel_index)
+		{
+			// Light of inactive chunks is checked above.
+			if(!chunks_light_validated[chunk_position[0] + chunk_position[1] * world_size[0]])
+				continue;
+
+			const std::vector<uint8_t>& output_light= output_lights[kernel_index];
+
+			uint32_t num_kernel_mismatched_light_values= 0;
+			for(uint32_t i= 0; i < c_chunk_volume; ++i)
+			{
+				if(output_light[offset + i] == data.output_light[offset + i])
+					continue;
+
+				if(num_kernel_mismatched_light_values == 0)
+					Log::Warning(
+						"Light update mismatch in chunk ", chunk_position[0], ",", chunk_position[1],
+						" at block ", i, ": GPU ", int32_t(data.output_light[offset + i]),
+						", CPU (", LightUpdateCPUKernelToString(light_update_kernels[kernel_index]), ") ", int32_t(output_light[offset + i]));
+				++num_kernel_mismatched_light_values;
+			}
+
+			num_mismatched_light_values+= num_kernel_mismatched_light_values;
+		}
+
+		if(num_mismatched_blocks > 0 || num_mismatched_light_values > 0)
+		{
+			Log::Warning(
+				"Chunk ", chunk_position[0], ",", chunk_position[1], " has ",
+				num_mismatched_blocks, " mismatched blocks and ", num_mismatched_light_values, " mismatched light values");
+			++num_mismatched_chunks;
+		}
+	}
+
+	Log::Info(
+		"World blocks update validation of tick ", data.tick, ": ",
+		chunks_to_validate.size(), " chunks checked, ", num_mismatched_chunks, " mismatched, ",
+		num_inactive_chunks, " inactive chunks skipped, ", num_changed_inactive_chunks, " of them changed");
+
+	for(size_t i= 0; i < light_update_kernels.size(); ++i)
+	{
+		if(light_update_times_s[i] > 0.0)
+			Log::Info(
+				"CPU light update (", LightUpdateCPUKernelToString(light_update_kernels[i]), "): ",
+				uint64_t(double(light_chunks_to_validate.size() * c_chunk_volume) / light_update_times_s[i] / 1.0e6), " Mcells/s");
+	}
+
+	// Measure how many steps (ticks) are needed for the light of the whole world to converge
+	// and how long it takes on the CPU. Do this only for input data of ticks after chunks uploading, since this is pretty slow.
+	const bool measure_light_convergence= measure_light_convergence_;
+	measure_light_convergence_= data.chunks_uploaded;
+
+	if(measure_light_convergence)
+	{
+		std::vector<uint8_t> converged_light(data.input_light, data.input_light + world_volume);
+
+		const auto start_time= std::chrono::steady_clock::now();
+		const uint32_t num_steps=
+			PropagateWorldLightCPU(
+				world_size,
+				data.input_blocks,
+				converged_light.data(),
+				c_chunk_height * 2,
+				thread_pool_);
+		const auto end_time= std::chrono::steady_clock::now();
+
+		Log::Info(
+			"CPU light propagation of the whole world: ", num_steps, " steps until light is stable, ",
+			std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count(), " ms");
+	}
+
+	return num_mismatched_chunks;
+}
+
+} // namespace HexGPU
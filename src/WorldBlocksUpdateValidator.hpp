@@ -0,0 +1,59 @@
+#pragma once
+#include "ThreadPool.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace HexGPU
+{
+
+// Input and output of world blocks and light update of a finished tick, read back from the GPU.
+// Chunks data buffers have size of the world volume and the same layout as GPU buffers.
+struct WorldBlocksUpdateValidationData
+{
+	std::array<uint32_t, 2> world_size_chunks{};
+	uint32_t tick= 0;
+	// Relative shift of input chunks (in case of world shift).
+	std::array<int32_t, 2> relative_world_shift{};
+	uint32_t inactive_chunks_update_period= 1;
+
+	// Values from world global state.
+	int32_t sky_light_mask= 0;
+	int32_t sky_light_based_wetness_mask= 0;
+	int32_t snow_z_level= 0;
+	// If set, world blocks update is performed for all chunks, but light update is still skipped for inactive chunks.
+	bool simulation_params_changed= false;
+
+	// For each chunk - true if it was updated (not generated or uploaded) in this tick.
+	std::vector<bool> chunks_updated;
+	bool chunks_uploaded= false;
+
+	const uint8_t* input_blocks= nullptr;
+	const uint8_t* input_auxiliar_data= nullptr;
+	const uint8_t* input_light= nullptr;
+	const uint8_t* output_blocks= nullptr;
+	const uint8_t* output_auxiliar_data= nullptr;
+	const uint8_t* output_light= nullptr;
+
+	// Whole double-buffered chunks changed flags buffer. See "chunks_activity.glsl".
+	const uint32_t* chunks_changed_flags= nullptr;
+};
+
+// Compares results of the GPU world blocks and light update with the CPU reference implementation.
+// Light update is validated for all CPU kernels supported by this CPU.
+// Used only for debugging, since it's pretty slow.
+class WorldBlocksUpdateValidator
+{
+public:
+	WorldBlocksUpdateValidator();
+
+	// Logs mismatches and statistics. Returns number of mismatched chunks.
+	uint32_t Validate(const WorldBlocksUpdateValidationData& data);
+
+private:
+	ThreadPool thread_pool_;
+	// Set if chunks were uploaded in the last validated tick, so the next tick input is worth checking for light convergence.
+	bool measure_light_convergence_= true;
+};
+
+} // namespace HexGPU
@@ -1,9 +1,12 @@
 #include "WorldGeometryGenerator.hpp"
 #include "Constants.hpp"
 #include "GlobalDescriptorPool.hpp"
+#include "Log.hpp"
 #include "Math.hpp"
 #include "ShaderList.hpp"
 #include "VulkanUtils.hpp"
+#include <algorithm>
+#include <cstring>
 
 namespace HexGPU
 {
@@ -22,25 +25,40 @@ namespace GeometrySizeCalculatePrepareShaderBindings
 	const ShaderBindingIndex chunk_draw_info_buffer= 0;
 }
 
-namespace GeometrySizeCalculateShaderBindings
+namespace GeometryAllocateShaderBindings
 {
-	const ShaderBindingIndex chunk_data_buffer= 0;
-	const ShaderBindingIndex chunk_draw_info_buffer= 1;
+	const ShaderBindingIndex chunk_draw_info_buffer= 0;
+	const ShaderBindingIndex geometry_allocation_stats_buffer= 1;
+	const ShaderBindingIndex allocator_data_buffer= GPUAllocator::c_allocator_buffer_binding;
 }
 
-namespace GeometryAllocateShaderBindings
+namespace GeometryEvictShaderBindings
 {
 	const ShaderBindingIndex chunk_draw_info_buffer= 0;
+	const ShaderBindingIndex geometry_allocation_stats_buffer= 1;
 	const ShaderBindingIndex allocator_data_buffer= GPUAllocator::c_allocator_buffer_binding;
 }
 
 namespace GeometryGenShaderBindings
 {
-	const ShaderBindingIndex vertices_buffer= 0;
+	const ShaderBindingIndex scratch_quads_buffer= 0;
 	const ShaderBindingIndex chunk_data_buffer= 1;
 	const ShaderBindingIndex chunk_light_buffer= 2;
 	const ShaderBindingIndex chunk_draw_info_buffer= 3;
 	const ShaderBindingIndex chunk_auxiliar_data_buffer= 4;
+	const ShaderBindingIndex chunks_to_update_list_buffer= 5;
+	const ShaderBindingIndex scratch_quad_kinds_buffer= 6;
+	const ShaderBindingIndex scratch_num_quads_buffer= 7;
+}
+
+namespace GeometryCopyShaderBindings
+{
+	const ShaderBindingIndex vertices_buffer= 0;
+	const ShaderBindingIndex scratch_quads_buffer= 1;
+	const ShaderBindingIndex scratch_quad_kinds_buffer= 2;
+	const ShaderBindingIndex scratch_num_quads_buffer= 3;
+	const ShaderBindingIndex chunk_draw_info_buffer= 4;
+	const ShaderBindingIndex chunks_to_update_list_buffer= 5;
 }
 
 struct ChunkDrawInfoShiftUniforms
@@ -49,13 +67,12 @@ struct ChunkDrawInfoShiftUniforms
 	int32_t chunks_shift[2]{};
 };
 
-// Size limit of this struct is 128 bytes.
-// 128 bytes is guaranted maximum size of push constants uniform block.
-struct ChunkPositionUniforms
+// Uniforms for geometry generation and geometry copy.
+// Chunks positions are taken from chunks to update list buffer.
+struct GeometryGenUniforms
 {
 	int32_t world_size_chunks[2]{};
-	int32_t chunk_position[2]{}; // Position relative current loaded region.
-	int32_t chunk_global_position[2]{}; // Global position.
+	uint32_t chunks_list_offset= 0; // Index of the first chunk of the batch in chunks to update list.
 };
 
 struct GeometrySizeCalculatePrepareUniforms
@@ -74,24 +91,83 @@ struct GeometryAllocateUniforms
 // This struct should be not bigger than minimum PushUniforms size.
 static_assert(sizeof(GeometryAllocateUniforms) == 128, "Invalid size!");
 
+// This constant should match workgroup size in geometry allocation shader!
+constexpr uint32_t c_geometry_allocate_workgroup_size= 64;
+static_assert(c_max_chunks_to_allocate <= c_geometry_allocate_workgroup_size, "Wrong workgroup size!");
+
+constexpr uint32_t c_max_chunks_to_evict= 62;
+
+struct GeometryEvictUniforms
+{
+	uint32_t num_chunks_to_evict= 0;
+	uint16_t chunks_to_evict_list[c_max_chunks_to_evict]{};
+};
+
+// This struct should be not bigger than minimum PushUniforms size.
+static_assert(sizeof(GeometryEvictUniforms) == 128, "Invalid size!");
+
+// This constant should match workgroup size in geometry eviction shader!
+constexpr uint32_t c_geometry_evict_workgroup_size= 64;
+static_assert(c_max_chunks_to_evict <= c_geometry_evict_workgroup_size, "Wrong workgroup size!");
+
+// Evict no more than this number of chunks at once, in order to avoid freeing too much memory.
+constexpr uint32_t c_max_chunks_to_evict_per_frame= 8;
+static_assert(c_max_chunks_to_evict_per_frame <= c_max_chunks_to_evict, "Too many chunks to evict!");
+
+// This constant should match workgroup size in geometry generation shader!
+constexpr uint32_t c_geometry_gen_workgroup_size[]{4, 4, 8};
+static_assert(c_chunk_width % c_geometry_gen_workgroup_size[0] == 0, "Wrong workgroup size!");
+static_assert(c_chunk_width % c_geometry_gen_workgroup_size[1] == 0, "Wrong workgroup size!");
+static_assert(c_chunk_height % c_geometry_gen_workgroup_size[2] == 0, "Wrong workgroup size!");
+
+// This constant should match workgroup size in geometry copy shader!
+constexpr uint32_t c_geometry_copy_workgroup_size= 64;
+
 // This should match the same constant in GLSL code!
 const uint32_t c_allocation_unut_size_quads= 512;
 
+// Capacity of scratch memory of a single chunk - maximum possible allocation size.
+// This should match the same constant in GLSL code!
+constexpr uint32_t c_geometry_scratch_chunk_capacity_quads= 32 * c_allocation_unut_size_quads;
+static_assert(c_geometry_scratch_chunk_capacity_quads % c_geometry_copy_workgroup_size == 0, "Wrong workgroup size!");
+
+// Geometry of chunks is generated in batches of this size, since scratch memory is needed for each chunk of a batch.
+// Scratch quads memory of a batch is 16 MB (32 chunks * 16384 quads * 4 vertices * 8 bytes). It's much less than vertex buffer size.
+constexpr uint32_t c_max_chunks_in_geometry_gen_batch= 32;
+// Allocate memory for all chunks of a batch via single allocation dispatch.
+static_assert(c_max_chunks_in_geometry_gen_batch <= c_max_chunks_to_allocate, "Batch is too large!");
+
 // Assuming that amount of total required vertex memory is proportional to total number of chunks,
 // multiplied by some factor.
 // Assuming that in worst cases (complex geometry) and taking allocator fragmentation into account
 // we need to have enough space for so much vertices.
-const uint32_t c_max_average_quads_per_chunk= 6144;
+// If actual geometry doesn't fit, geometry of far chunks is evicted.
+const uint32_t c_default_vertex_memory_quads_per_chunk= 6144;
+
+uint32_t GetVertexMemoryQuadsPerChunk(Settings& settings)
+{
+	// Allow at least enough memory for single unit per chunk.
+	const int32_t max_quads_per_chunk= int32_t(c_geometry_scratch_chunk_capacity_quads);
+	const int32_t min_quads_per_chunk= int32_t(c_allocation_unut_size_quads);
+	return uint32_t(
+		std::max(
+			min_quads_per_chunk,
+			std::min(
+				int32_t(settings.GetOrSetInt("g_vertex_memory_quads_per_chunk", int32_t(c_default_vertex_memory_quads_per_chunk))),
+				max_quads_per_chunk)));
+}
 
-uint32_t GetTotalVertexBufferQuads(const WorldSizeChunks& world_size)
+uint32_t GetTotalVertexBufferQuads(const WorldSizeChunks& world_size, const uint32_t quads_per_chunk)
 {
-	return c_max_average_quads_per_chunk * world_size[0] * world_size[1];
+	return quads_per_chunk * world_size[0] * world_size[1];
 }
 
-uint32_t GetTotalVertexBufferUnits(const WorldSizeChunks& world_size)
+uint32_t GetTotalVertexBufferUnits(const WorldSizeChunks& world_size, const uint32_t quads_per_chunk)
 {
 	// Number of allocation units is based on number of quads with rounding upwards.
-	return (GetTotalVertexBufferQuads(world_size) + (c_allocation_unut_size_quads - 1)) / c_allocation_unut_size_quads;
+	return
+		(GetTotalVertexBufferQuads(world_size, quads_per_chunk) + (c_allocation_unut_size_quads - 1)) /
+		c_allocation_unut_size_quads;
 }
 
 ComputePipeline CreateChunkDrawInfoShiftPipeline(const vk::Device vk_device)
@@ -177,23 +253,30 @@ ComputePipeline CreateGeometrySizeCalculatePreparePipeline(const vk::Device vk_d
 	return pipeline;
 }
 
-ComputePipeline CreateGeometrySizeCalculatePipeline(const vk::Device vk_device)
+ComputePipeline CreateGeometryAllocatePipeline(const vk::Device vk_device)
 {
 	ComputePipeline pipeline;
 
-	pipeline.shader= CreateShader(vk_device, ShaderNames::geometry_size_calculate_comp);
+	pipeline.shader= CreateShader(vk_device, ShaderNames::geometry_allocate_comp);
 
 	const vk::DescriptorSetLayoutBinding descriptor_set_layout_bindings[]
 	{
 		{
-			GeometrySizeCalculateShaderBindings::chunk_data_buffer,
+			GeometryAllocateShaderBindings::chunk_draw_info_buffer,
+			vk::DescriptorType::eStorageBuffer,
+			1u,
+			vk::ShaderStageFlagBits::eCompute,
+			nullptr,
+		},
+		{
+			GeometryAllocateShaderBindings::geometry_allocation_stats_buffer,
 			vk::DescriptorType::eStorageBuffer,
 			1u,
 			vk::ShaderStageFlagBits::eCompute,
 			nullptr,
 		},
 		{
-			GeometrySizeCalculateShaderBindings::chunk_draw_info_buffer,
+			GeometryAllocateShaderBindings::allocator_data_buffer,
 			vk::DescriptorType::eStorageBuffer,
 			1u,
 			vk::ShaderStageFlagBits::eCompute,
@@ -209,7 +292,7 @@ ComputePipeline CreateGeometrySizeCalculatePipeline(const vk::Device vk_device)
 	const vk::PushConstantRange push_constant_range(
 		vk::ShaderStageFlagBits::eCompute,
 		0u,
-		sizeof(ChunkPositionUniforms));
+		sizeof(GeometryAllocateUniforms));
 
 	pipeline.pipeline_layout= vk_device.createPipelineLayoutUnique(
 		vk::PipelineLayoutCreateInfo(
@@ -222,23 +305,30 @@ ComputePipeline CreateGeometrySizeCalculatePipeline(const vk::Device vk_device)
 	return pipeline;
 }
 
-ComputePipeline CreateGeometryAllocatePipeline(const vk::Device vk_device)
+ComputePipeline CreateGeometryEvictPipeline(const vk::Device vk_device)
 {
 	ComputePipeline pipeline;
 
-	pipeline.shader= CreateShader(vk_device, ShaderNames::geometry_allocate_comp);
+	pipeline.shader= CreateShader(vk_device, ShaderNames::geometry_evict_comp);
 
 	const vk::DescriptorSetLayoutBinding descriptor_set_layout_bindings[]
 	{
 		{
-			GeometryAllocateShaderBindings::chunk_draw_info_buffer,
+			GeometryEvictShaderBindings::chunk_draw_info_buffer,
 			vk::DescriptorType::eStorageBuffer,
 			1u,
 			vk::ShaderStageFlagBits::eCompute,
 			nullptr,
 		},
 		{
-			GeometryAllocateShaderBindings::allocator_data_buffer,
+			GeometryEvictShaderBindings::geometry_allocation_stats_buffer,
+			vk::DescriptorType::eStorageBuffer,
+			1u,
+			vk::ShaderStageFlagBits::eCompute,
+			nullptr,
+		},
+		{
+			GeometryEvictShaderBindings::allocator_data_buffer,
 			vk::DescriptorType::eStorageBuffer,
 			1u,
 			vk::ShaderStageFlagBits::eCompute,
@@ -254,7 +344,7 @@ ComputePipeline CreateGeometryAllocatePipeline(const vk::Device vk_device)
 	const vk::PushConstantRange push_constant_range(
 		vk::ShaderStageFlagBits::eCompute,
 		0u,
-		sizeof(GeometryAllocateUniforms));
+		sizeof(GeometryEvictUniforms));
 
 	pipeline.pipeline_layout= vk_device.createPipelineLayoutUnique(
 		vk::PipelineLayoutCreateInfo(
@@ -276,7 +366,7 @@ ComputePipeline CreateGeometryGenPipeline(const vk::Device vk_device)
 	const vk::DescriptorSetLayoutBinding descriptor_set_layout_bindings[]
 	{
 		{
-			GeometryGenShaderBindings::vertices_buffer,
+			GeometryGenShaderBindings::scratch_quads_buffer,
 			vk::DescriptorType::eStorageBuffer,
 			1u,
 			vk::ShaderStageFlagBits::eCompute,
@@ -310,6 +400,100 @@ ComputePipeline CreateGeometryGenPipeline(const vk::Device vk_device)
 			vk::ShaderStageFlagBits::eCompute,
 			nullptr,
 		},
+		{
+			GeometryGenShaderBindings::chunks_to_update_list_buffer,
+			vk::DescriptorType::eStorageBuffer,
+			1u,
+			vk::ShaderStageFlagBits::eCompute,
+			nullptr,
+		},
+		{
+			GeometryGenShaderBindings::scratch_quad_kinds_buffer,
+			vk::DescriptorType::eStorageBuffer,
+			1u,
+			vk::ShaderStageFlagBits::eCompute,
+			nullptr,
+		},
+		{
+			GeometryGenShaderBindings::scratch_num_quads_buffer,
+			vk::DescriptorType::eStorageBuffer,
+			1u,
+			vk::ShaderStageFlagBits::eCompute,
+			nullptr,
+		},
+	};
+
+	pipeline.descriptor_set_layout= vk_device.createDescriptorSetLayoutUnique(
+		vk::DescriptorSetLayoutCreateInfo(
+			vk::DescriptorSetLayoutCreateFlags(),
+			uint32_t(std::size(descriptor_set_layout_bindings)), descriptor_set_layout_bindings));
+
+	const vk::PushConstantRange push_constant_range(
+		vk::ShaderStageFlagBits::eCompute,
+		0u,
+		sizeof(GeometryGenUniforms));
+
+	pipeline.pipeline_layout= vk_device.createPipelineLayoutUnique(
+		vk::PipelineLayoutCreateInfo(
+			vk::PipelineLayoutCreateFlags(),
+			1u, &*pipeline.descriptor_set_layout,
+			1u, &push_constant_range));
+
+	pipeline.pipeline= CreateComputePipeline(vk_device, *pipeline.shader, *pipeline.pipeline_layout);
+
+	return pipeline;
+}
+
+ComputePipeline CreateGeometryCopyPipeline(const vk::Device vk_device)
+{
+	ComputePipeline pipeline;
+
+	pipeline.shader= CreateShader(vk_device, ShaderNames::geometry_copy_comp);
+
+	const vk::DescriptorSetLayoutBinding descriptor_set_layout_bindings[]
+	{
+		{
+			GeometryCopyShaderBindings::vertices_buffer,
+			vk::DescriptorType::eStorageBuffer,
+			1u,
+			vk::ShaderStageFlagBits::eCompute,
+			nullptr,
+		},
+		{
+			GeometryCopyShaderBindings::scratch_quads_buffer,
+			vk::DescriptorType::eStorageBuffer,
+			1u,
+			vk::ShaderStageFlagBits::eCompute,
+			nullptr,
+		},
+		{
+			GeometryCopyShaderBindings::scratch_quad_kinds_buffer,
+			vk::DescriptorType::eStorageBuffer,
+			1u,
+			vk::ShaderStageFlagBits::eCompute,
+			nullptr,
+		},
+		{
+			GeometryCopyShaderBindings::scratch_num_quads_buffer,
+			vk::DescriptorType::eStorageBuffer,
+			1u,
+			vk::ShaderStageFlagBits::eCompute,
+			nullptr,
+		},
+		{
+			GeometryCopyShaderBindings::chunk_draw_info_buffer,
+			vk::DescriptorType::eStorageBuffer,
+			1u,
+			vk::ShaderStageFlagBits::eCompute,
+			nullptr,
+		},
+		{
+			GeometryCopyShaderBindings::chunks_to_update_list_buffer,
+			vk::DescriptorType::eStorageBuffer,
+			1u,
+			vk::ShaderStageFlagBits::eCompute,
+			nullptr,
+		},
 	};
 
 	pipeline.descriptor_set_layout= vk_device.createDescriptorSetLayoutUnique(
@@ -320,7 +504,7 @@ ComputePipeline CreateGeometryGenPipeline(const vk::Device vk_device)
 	const vk::PushConstantRange push_constant_range(
 		vk::ShaderStageFlagBits::eCompute,
 		0u,
-		sizeof(ChunkPositionUniforms));
+		sizeof(GeometryGenUniforms));
 
 	pipeline.pipeline_layout= vk_device.createPipelineLayoutUnique(
 		vk::PipelineLayoutCreateInfo(
@@ -338,10 +522,12 @@ ComputePipeline CreateGeometryGenPipeline(const vk::Device vk_device)
 WorldGeometryGenerator::WorldGeometryGenerator(
 	WindowVulkan& window_vulkan,
 	const WorldProcessor& world_processor,
-	const vk::DescriptorPool global_descriptor_pool)
+	const vk::DescriptorPool global_descriptor_pool,
+	Settings& settings)
 	: vk_device_(window_vulkan.GetVulkanDevice())
 	, world_processor_(world_processor)
 	, world_size_(world_processor.GetWorldSize())
+	, vertex_memory_quads_per_chunk_(GetVertexMemoryQuadsPerChunk(settings))
 	, chunk_draw_info_buffer_(
 		window_vulkan,
 		world_size_[0] * world_size_[1] * uint32_t(sizeof(ChunkDrawInfo)),
@@ -352,9 +538,36 @@ WorldGeometryGenerator::WorldGeometryGenerator(
 		vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferSrc)
 	, vertex_buffer_(
 		window_vulkan,
-		GetTotalVertexBufferQuads(world_size_) * uint32_t(sizeof(QuadVertices)),
+		GetTotalVertexBufferQuads(world_size_, vertex_memory_quads_per_chunk_) * uint32_t(sizeof(QuadVertices)),
 		vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst)
-	, vertex_memory_allocator_(window_vulkan, GetTotalVertexBufferUnits(world_size_))
+	, chunks_to_update_list_buffer_(
+		window_vulkan,
+		sizeof(ChunkToUpdate) * world_size_[0] * world_size_[1],
+		vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst)
+	, geometry_scratch_quads_buffer_(
+		window_vulkan,
+		c_max_chunks_in_geometry_gen_batch * c_geometry_scratch_chunk_capacity_quads * uint32_t(sizeof(QuadVertices)),
+		vk::BufferUsageFlagBits::eStorageBuffer)
+	, geometry_scratch_quad_kinds_buffer_(
+		window_vulkan,
+		c_max_chunks_in_geometry_gen_batch * c_geometry_scratch_chunk_capacity_quads * uint32_t(sizeof(uint8_t)),
+		vk::BufferUsageFlagBits::eStorageBuffer)
+	, geometry_scratch_num_quads_buffer_(
+		window_vulkan,
+		c_max_chunks_in_geometry_gen_batch * uint32_t(sizeof(uint32_t)),
+		vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst)
+	, vertex_memory_allocator_(window_vulkan, GetTotalVertexBufferUnits(world_size_, vertex_memory_quads_per_chunk_))
+	, geometry_allocation_stats_buffer_(
+		window_vulkan,
+		sizeof(GeometryAllocationStats),
+		vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst)
+	, geometry_allocation_stats_read_back_buffer_num_frames_(uint32_t(window_vulkan.GetNumCommandBuffers()))
+	, geometry_allocation_stats_read_back_buffer_(
+		window_vulkan,
+		sizeof(GeometryAllocationStats) * geometry_allocation_stats_read_back_buffer_num_frames_,
+		vk::BufferUsageFlagBits::eTransferDst,
+		vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent)
+	, geometry_allocation_stats_read_back_buffer_mapped_(geometry_allocation_stats_read_back_buffer_.Map(vk_device_))
 	, chunk_draw_info_shift_pipeline_(CreateChunkDrawInfoShiftPipeline(vk_device_))
 	, chunk_draw_info_shift_descriptor_set_(
 		CreateDescriptorSet(vk_device_, global_descriptor_pool, *chunk_draw_info_shift_pipeline_.descriptor_set_layout))
@@ -364,16 +577,6 @@ WorldGeometryGenerator::WorldGeometryGenerator(
 			vk_device_,
 			global_descriptor_pool,
 			*geometry_size_calculate_prepare_pipeline_.descriptor_set_layout))
-	, geometry_size_calculate_pipeline_(CreateGeometrySizeCalculatePipeline(vk_device_))
-	, geometry_size_calculate_descriptor_sets_{
-		CreateDescriptorSet(
-			vk_device_,
-			global_descriptor_pool,
-			*geometry_size_calculate_pipeline_.descriptor_set_layout),
-		CreateDescriptorSet(
-			vk_device_,
-			global_descriptor_pool,
-			*geometry_size_calculate_pipeline_.descriptor_set_layout)}
 	, geometry_allocate_pipeline_(CreateGeometryAllocatePipeline(vk_device_))
 	, geometry_allocate_descriptor_set_(
 		CreateDescriptorSet(vk_device_, global_descriptor_pool, *geometry_allocate_pipeline_.descriptor_set_layout))
@@ -381,8 +584,21 @@ WorldGeometryGenerator::WorldGeometryGenerator(
 	, geometry_gen_descriptor_sets_{
 		CreateDescriptorSet(vk_device_, global_descriptor_pool, *geometry_gen_pipeline_.descriptor_set_layout),
 		CreateDescriptorSet(vk_device_, global_descriptor_pool, *geometry_gen_pipeline_.descriptor_set_layout)}
+	, geometry_copy_pipeline_(CreateGeometryCopyPipeline(vk_device_))
+	, geometry_copy_descriptor_set_(
+		CreateDescriptorSet(vk_device_, global_descriptor_pool, *geometry_copy_pipeline_.descriptor_set_layout))
+	, geometry_evict_pipeline_(CreateGeometryEvictPipeline(vk_device_))
+	, geometry_evict_descriptor_set_(
+		CreateDescriptorSet(vk_device_, global_descriptor_pool, *geometry_evict_pipeline_.descriptor_set_layout))
 	, world_offset_(world_processor.GetWorldOffset())
+	, chunks_evicted_(world_size_[0] * world_size_[1], false)
 {
+	HEX_ASSERT(geometry_allocation_stats_read_back_buffer_num_frames_ > 0);
+
+	Log::Info(
+		"Vertex memory: ", vertex_memory_quads_per_chunk_, " quads per chunk, ",
+		vertex_buffer_.GetSize() / (1024 * 1024), " MB (", sizeof(WorldVertex), " bytes per vertex)");
+
 	// Update descriptor set.
 	{
 		const vk::DescriptorBufferInfo descriptor_chunk_draw_info_input_buffer_info(
@@ -444,62 +660,58 @@ WorldGeometryGenerator::WorldGeometryGenerator(
 			{});
 	}
 
-	// Update descriptor sets.
-	for(uint32_t i= 0; i < 2; ++i)
+	// Update descriptor set.
 	{
-		const vk::DescriptorBufferInfo descriptor_chunk_data_buffer_info(
-			world_processor_.GetChunkDataBuffer(i),
-			0u,
-			world_processor_.GetChunkDataBufferSize());
-
 		const vk::DescriptorBufferInfo descriptor_chunk_draw_info_buffer_info(
 			chunk_draw_info_buffer_.GetBuffer(),
 			0u,
 			chunk_draw_info_buffer_.GetSize());
 
+		const vk::DescriptorBufferInfo descriptor_allocator_data_buffer_info(
+			vertex_memory_allocator_.GetAllocatorDataBuffer(),
+			0u,
+			vertex_memory_allocator_.GetAllocatorDataBufferSize());
+
+		const vk::DescriptorBufferInfo descriptor_geometry_allocation_stats_buffer_info(
+			geometry_allocation_stats_buffer_.GetBuffer(),
+			0u,
+			geometry_allocation_stats_buffer_.GetSize());
+
 		vk_device_.updateDescriptorSets(
 			{
 				{
-					geometry_size_calculate_descriptor_sets_[i],
-					GeometrySizeCalculateShaderBindings::chunk_data_buffer,
+					geometry_allocate_descriptor_set_,
+					GeometryAllocateShaderBindings::chunk_draw_info_buffer,
 					0u,
 					1u,
 					vk::DescriptorType::eStorageBuffer,
 					nullptr,
-					&descriptor_chunk_data_buffer_info,
+					&descriptor_chunk_draw_info_buffer_info,
 					nullptr
 				},
 				{
-					geometry_size_calculate_descriptor_sets_[i],
-					GeometrySizeCalculateShaderBindings::chunk_draw_info_buffer,
+					geometry_allocate_descriptor_set_,
+					GeometryAllocateShaderBindings::geometry_allocation_stats_buffer,
 					0u,
 					1u,
 					vk::DescriptorType::eStorageBuffer,
 					nullptr,
-					&descriptor_chunk_draw_info_buffer_info,
+					&descriptor_geometry_allocation_stats_buffer_info,
 					nullptr
 				},
-			},
-			{});
-	}
-
-	// Update descriptor set.
-	{
-		const vk::DescriptorBufferInfo descriptor_chunk_draw_info_buffer_info(
-			chunk_draw_info_buffer_.GetBuffer(),
-			0u,
-			chunk_draw_info_buffer_.GetSize());
-
-		const vk::DescriptorBufferInfo descriptor_allocator_data_buffer_info(
-			vertex_memory_allocator_.GetAllocatorDataBuffer(),
-			0u,
-			vertex_memory_allocator_.GetAllocatorDataBufferSize());
-
-		vk_device_.updateDescriptorSets(
-			{
 				{
 					geometry_allocate_descriptor_set_,
-					GeometryAllocateShaderBindings::chunk_draw_info_buffer,
+					GeometryAllocateShaderBindings::allocator_data_buffer,
+					0u,
+					1u,
+					vk::DescriptorType::eStorageBuffer,
+					nullptr,
+					&descriptor_allocator_data_buffer_info,
+					nullptr
+				},
+				{
+					geometry_evict_descriptor_set_,
+					GeometryEvictShaderBindings::chunk_draw_info_buffer,
 					0u,
 					1u,
 					vk::DescriptorType::eStorageBuffer,
@@ -508,8 +720,18 @@ WorldGeometryGenerator::WorldGeometryGenerator(
 					nullptr
 				},
 				{
-					geometry_allocate_descriptor_set_,
-					GeometryAllocateShaderBindings::allocator_data_buffer,
+					geometry_evict_descriptor_set_,
+					GeometryEvictShaderBindings::geometry_allocation_stats_buffer,
+					0u,
+					1u,
+					vk::DescriptorType::eStorageBuffer,
+					nullptr,
+					&descriptor_geometry_allocation_stats_buffer_info,
+					nullptr
+				},
+				{
+					geometry_evict_descriptor_set_,
+					GeometryEvictShaderBindings::allocator_data_buffer,
 					0u,
 					1u,
 					vk::DescriptorType::eStorageBuffer,
@@ -524,10 +746,10 @@ WorldGeometryGenerator::WorldGeometryGenerator(
 	// Update descriptor sets.
 	for(uint32_t i= 0; i < 2; ++i)
 	{
-		const vk::DescriptorBufferInfo descriptor_vertex_buffer_info(
-			vertex_buffer_.GetBuffer(),
+		const vk::DescriptorBufferInfo descriptor_scratch_quads_buffer_info(
+			geometry_scratch_quads_buffer_.GetBuffer(),
 			0u,
-			vertex_buffer_.GetSize());
+			geometry_scratch_quads_buffer_.GetSize());
 
 		const vk::DescriptorBufferInfo descriptor_chunk_data_buffer_info(
 			world_processor_.GetChunkDataBuffer(i),
@@ -549,16 +771,31 @@ WorldGeometryGenerator::WorldGeometryGenerator(
 			0u,
 			world_processor_.GetChunkAuxiliarDataBufferSize());
 
+		const vk::DescriptorBufferInfo descriptor_chunks_to_update_list_buffer_info(
+			chunks_to_update_list_buffer_.GetBuffer(),
+			0u,
+			chunks_to_update_list_buffer_.GetSize());
+
+		const vk::DescriptorBufferInfo descriptor_scratch_quad_kinds_buffer_info(
+			geometry_scratch_quad_kinds_buffer_.GetBuffer(),
+			0u,
+			geometry_scratch_quad_kinds_buffer_.GetSize());
+
+		const vk::DescriptorBufferInfo descriptor_scratch_num_quads_buffer_info(
+			geometry_scratch_num_quads_buffer_.GetBuffer(),
+			0u,
+			geometry_scratch_num_quads_buffer_.GetSize());
+
 		vk_device_.updateDescriptorSets(
 			{
 				{
 					geometry_gen_descriptor_sets_[i],
-					GeometryGenShaderBindings::vertices_buffer,
+					GeometryGenShaderBindings::scratch_quads_buffer,
 					0u,
 					1u,
 					vk::DescriptorType::eStorageBuffer,
 					nullptr,
-					&descriptor_vertex_buffer_info,
+					&descriptor_scratch_quads_buffer_info,
 					nullptr
 				},
 				{
@@ -601,23 +838,154 @@ WorldGeometryGenerator::WorldGeometryGenerator(
 					&descriptor_chunk_auxiliar_data_buffer_info,
 					nullptr
 				},
+				{
+					geometry_gen_descriptor_sets_[i],
+					GeometryGenShaderBindings::chunks_to_update_list_buffer,
+					0u,
+					1u,
+					vk::DescriptorType::eStorageBuffer,
+					nullptr,
+					&descriptor_chunks_to_update_list_buffer_info,
+					nullptr
+				},
+				{
+					geometry_gen_descriptor_sets_[i],
+					GeometryGenShaderBindings::scratch_quad_kinds_buffer,
+					0u,
+					1u,
+					vk::DescriptorType::eStorageBuffer,
+					nullptr,
+					&descriptor_scratch_quad_kinds_buffer_info,
+					nullptr
+				},
+				{
+					geometry_gen_descriptor_sets_[i],
+					GeometryGenShaderBindings::scratch_num_quads_buffer,
+					0u,
+					1u,
+					vk::DescriptorType::eStorageBuffer,
+					nullptr,
+					&descriptor_scratch_num_quads_buffer_info,
+					nullptr
+				},
 			},
 			{});
 	}
-}
 
-WorldGeometryGenerator::~WorldGeometryGenerator()
-{
-	// Sync before destruction.
-	vk_device_.waitIdle();
-}
+	// Update descriptor set.
+	{
+		const vk::DescriptorBufferInfo descriptor_vertex_buffer_info(
+			vertex_buffer_.GetBuffer(),
+			0u,
+			vertex_buffer_.GetSize());
 
-void WorldGeometryGenerator::Update(TaskOrganizer& task_organizer)
-{
-	vertex_memory_allocator_.EnsureInitialized(task_organizer);
-	InitialFillBuffers(task_organizer);
+		const vk::DescriptorBufferInfo descriptor_scratch_quads_buffer_info(
+			geometry_scratch_quads_buffer_.GetBuffer(),
+			0u,
+			geometry_scratch_quads_buffer_.GetSize());
 
-	const WorldOffsetChunks new_world_offset= world_processor_.GetWorldOffset();
+		const vk::DescriptorBufferInfo descriptor_scratch_quad_kinds_buffer_info(
+			geometry_scratch_quad_kinds_buffer_.GetBuffer(),
+			0u,
+			geometry_scratch_quad_kinds_buffer_.GetSize());
+
+		const vk::DescriptorBufferInfo descriptor_scratch_num_quads_buffer_info(
+			geometry_scratch_num_quads_buffer_.GetBuffer(),
+			0u,
+			geometry_scratch_num_quads_buffer_.GetSize());
+
+		const vk::DescriptorBufferInfo descriptor_chunk_draw_info_buffer_info(
+			chunk_draw_info_buffer_.GetBuffer(),
+			0u,
+			chunk_draw_info_buffer_.GetSize());
+
+		const vk::DescriptorBufferInfo descriptor_chunks_to_update_list_buffer_info(
+			chunks_to_update_list_buffer_.GetBuffer(),
+			0u,
+			chunks_to_update_list_buffer_.GetSize());
+
+		vk_device_.updateDescriptorSets(
+			{
+				{
+					geometry_copy_descriptor_set_,
+					GeometryCopyShaderBindings::vertices_buffer,
+					0u,
+					1u,
+					vk::DescriptorType::eStorageBuffer,
+					nullptr,
+					&descriptor_vertex_buffer_info,
+					nullptr
+				},
+				{
+					geometry_copy_descriptor_set_,
+					GeometryCopyShaderBindings::scratch_quads_buffer,
+					0u,
+					1u,
+					vk::DescriptorType::eStorageBuffer,
+					nullptr,
+					&descriptor_scratch_quads_buffer_info,
+					nullptr
+				},
+				{
+					geometry_copy_descriptor_set_,
+					GeometryCopyShaderBindings::scratch_quad_kinds_buffer,
+					0u,
+					1u,
+					vk::DescriptorType::eStorageBuffer,
+					nullptr,
+					&descriptor_scratch_quad_kinds_buffer_info,
+					nullptr
+				},
+				{
+					geometry_copy_descriptor_set_,
+					GeometryCopyShaderBindings::scratch_num_quads_buffer,
+					0u,
+					1u,
+					vk::DescriptorType::eStorageBuffer,
+					nullptr,
+					&descriptor_scratch_num_quads_buffer_info,
+					nullptr
+				},
+				{
+					geometry_copy_descriptor_set_,
+					GeometryCopyShaderBindings::chunk_draw_info_buffer,
+					0u,
+					1u,
+					vk::DescriptorType::eStorageBuffer,
+					nullptr,
+					&descriptor_chunk_draw_info_buffer_info,
+					nullptr
+				},
+				{
+					geometry_copy_descriptor_set_,
+					GeometryCopyShaderBindings::chunks_to_update_list_buffer,
+					0u,
+					1u,
+					vk::DescriptorType::eStorageBuffer,
+					nullptr,
+					&descriptor_chunks_to_update_list_buffer_info,
+					nullptr
+				},
+			},
+			{});
+	}
+}
+
+WorldGeometryGenerator::~WorldGeometryGenerator()
+{
+	// Sync before destruction.
+	vk_device_.waitIdle();
+
+	geometry_allocation_stats_read_back_buffer_.Unmap(vk_device_);
+}
+
+void WorldGeometryGenerator::Update(TaskOrganizer& task_organizer)
+{
+	vertex_memory_allocator_.EnsureInitialized(task_organizer);
+	InitialFillBuffers(task_organizer);
+	ReadBackGeometryAllocationStats();
+
+	const WorldOffsetChunks new_world_offset= world_processor_.GetWorldOffset();
 	if(new_world_offset != world_offset_)
 	{
 		// World was shifted. Shift our chunk draw info matrix.
@@ -629,14 +997,29 @@ void WorldGeometryGenerator::Update(TaskOrganizer& task_organizer)
 		};
 
 		ShiftChunkDrawInfo(task_organizer, shift);
+		ShiftChunksEvictedFlags(shift);
 		world_offset_= new_world_offset;
 	}
 
+	UpdateChunksEviction();
+	EvictChunks(task_organizer);
+
 	BuildChunksToUpdateList();
+	UploadChunksToUpdateList(task_organizer);
 	PrepareGeometrySizeCalculation(task_organizer);
-	CalculateGeometrySize(task_organizer);
-	AllocateMemoryForGeometry(task_organizer);
-	GenGeometry(task_organizer);
+
+	// Process chunks in batches, since scratch memory is limited.
+	for(uint32_t offset= 0; offset < uint32_t(chunks_to_update_.size()); offset+= c_max_chunks_in_geometry_gen_batch)
+	{
+		const uint32_t num_chunks=
+			std::min(c_max_chunks_in_geometry_gen_batch, uint32_t(chunks_to_update_.size()) - offset);
+
+		GenGeometry(task_organizer, offset, num_chunks);
+		AllocateMemoryForGeometry(task_organizer, offset, num_chunks);
+		CopyGeometry(task_organizer, offset, num_chunks);
+	}
+
+	CopyGeometryAllocationStatsForReadBack(task_organizer);
 
 	++frame_counter_;
 }
@@ -656,6 +1039,30 @@ vk::DeviceSize WorldGeometryGenerator::GetChunkDrawInfoBufferSize() const
 	return chunk_draw_info_buffer_.GetSize();
 }
 
+WorldGeometryGenerator::VertexMemoryStats WorldGeometryGenerator::GetVertexMemoryStats() const
+{
+	VertexMemoryStats stats;
+	stats.total_units= GetTotalVertexBufferUnits(world_size_, vertex_memory_quads_per_chunk_);
+	if(last_geometry_allocation_stats_ != std::nullopt)
+	{
+		stats.used_units= last_geometry_allocation_stats_->num_used_units;
+		stats.num_failed_allocations= last_geometry_allocation_stats_->num_failed_allocations;
+	}
+	stats.num_evicted_chunks= num_evicted_chunks_;
+
+	return stats;
+}
+
+void WorldGeometryGenerator::EnableAllChunksUpdateInEachFrame()
+{
+	update_all_chunks_in_each_frame_= true;
+}
+
+uint32_t WorldGeometryGenerator::GetNumChunksUpdatedInLastFrame() const
+{
+	return uint32_t(chunks_to_update_.size());
+}
+
 void WorldGeometryGenerator::InitialFillBuffers(TaskOrganizer& task_organizer)
 {
 	if(buffers_initially_filled_)
@@ -663,9 +1070,12 @@ void WorldGeometryGenerator::InitialFillBuffers(TaskOrganizer& task_organizer)
 	buffers_initially_filled_= true;
 
 	TaskOrganizer::TransferTaskParams task;
+	task.name= "geometry_initial_fill_buffers";
 
 	task.output_buffers.push_back(vertex_buffer_.GetBuffer());
 	task.output_buffers.push_back(chunk_draw_info_buffer_.GetBuffer());
+	task.output_buffers.push_back(geometry_allocation_stats_buffer_.GetBuffer());
+	task.output_buffers.push_back(geometry_allocation_stats_read_back_buffer_.GetBuffer());
 
 	const auto task_func=
 		[this](const vk::CommandBuffer command_buffer)
@@ -676,6 +1086,12 @@ void WorldGeometryGenerator::InitialFillBuffers(TaskOrganizer& task_organizer)
 
 			// Fill initially chunk draw info buffer with zeros.
 			command_buffer.fillBuffer(chunk_draw_info_buffer_.GetBuffer(), 0, chunk_draw_info_buffer_.GetSize(), 0);
+
+			// Nothing is allocated initially.
+			command_buffer.fillBuffer(
+				geometry_allocation_stats_buffer_.GetBuffer(), 0, geometry_allocation_stats_buffer_.GetSize(), 0);
+			command_buffer.fillBuffer(
+				geometry_allocation_stats_read_back_buffer_.GetBuffer(), 0, geometry_allocation_stats_read_back_buffer_.GetSize(), 0);
 		};
 
 	task_organizer.ExecuteTask(task, task_func);
@@ -686,6 +1102,7 @@ void WorldGeometryGenerator::ShiftChunkDrawInfo(
 	const std::array<int32_t, 2> shift)
 {
 	TaskOrganizer::ComputeTaskParams shift_task;
+	shift_task.name= "chunk_draw_info_shift";
 	shift_task.input_storage_buffers.push_back(chunk_draw_info_buffer_.GetBuffer());
 	shift_task.output_storage_buffers.push_back(chunk_draw_info_buffer_temp_.GetBuffer());
 
@@ -725,6 +1142,7 @@ void WorldGeometryGenerator::ShiftChunkDrawInfo(
 	// Copy temp buffer back to chunk draw info buffer.
 
 	TaskOrganizer::TransferTaskParams copy_back_task;
+	copy_back_task.name= "chunk_draw_info_copy_back";
 	copy_back_task.input_buffers.push_back(chunk_draw_info_buffer_temp_.GetBuffer());
 	copy_back_task.output_buffers.push_back(chunk_draw_info_buffer_.GetBuffer());
 
@@ -744,16 +1162,213 @@ void WorldGeometryGenerator::ShiftChunkDrawInfo(
 	task_organizer.ExecuteTask(copy_back_task, copy_back_task_func);
 }
 
+void WorldGeometryGenerator::ShiftChunksEvictedFlags(const std::array<int32_t, 2> shift)
+{
+	// Perform the same shift with wrapping as chunk draw info shift shader does.
+	const int32_t chunks_shift[]
+	{
+		EuclidianRemainder(shift[0], int32_t(world_size_[0])),
+		EuclidianRemainder(shift[1], int32_t(world_size_[1])),
+	};
+
+	std::vector<bool> chunks_evicted_shifted(chunks_evicted_.size(), false);
+	for(uint32_t y= 0; y < world_size_[1]; ++y)
+	for(uint32_t x= 0; x < world_size_[0]; ++x)
+	{
+		const uint32_t src_x= (x + uint32_t(chunks_shift[0])) % world_size_[0];
+		const uint32_t src_y= (y + uint32_t(chunks_shift[1])) % world_size_[1];
+		chunks_evicted_shifted[x + y * world_size_[0]]= chunks_evicted_[src_x + src_y * world_size_[0]];
+	}
+
+	chunks_evicted_= std::move(chunks_evicted_shifted);
+
+	// Restoring chunk may be shifted out of the area.
+	chunk_to_restore_= std::nullopt;
+}
+
+void WorldGeometryGenerator::ReadBackGeometryAllocationStats()
+{
+	// Assuming that writes into this buffer are finished in "geometry_allocation_stats_read_back_buffer_num_frames_" frames.
+
+	if(frame_counter_ < geometry_allocation_stats_read_back_buffer_num_frames_)
+		return;
+
+	const uint32_t current_slot= frame_counter_ % geometry_allocation_stats_read_back_buffer_num_frames_;
+
+	last_geometry_allocation_stats_.emplace();
+
+	std::memcpy(
+		&last_geometry_allocation_stats_.value(),
+		static_cast<const uint8_t*>(geometry_allocation_stats_read_back_buffer_mapped_) + current_slot * sizeof(GeometryAllocationStats),
+		sizeof(GeometryAllocationStats));
+}
+
+std::array<uint32_t, 2> WorldGeometryGenerator::GetCenterChunk() const
+{
+	uint32_t center_x= world_size_[0] / 2;
+	uint32_t center_y= world_size_[1] / 2;
+
+	if(const auto player_state= world_processor_.GetLastKnownPlayerState())
+	{
+		// If player position is available, calculate center chunk based on player position.
+		const int32_t chunk_global_coord[]
+		{
+			int32_t(std::floor(player_state->pos[0] / c_space_scale_x)) >> int32_t(c_chunk_width_log2),
+			int32_t(std::floor(player_state->pos[1])) >> int32_t(c_chunk_width_log2),
+		};
+		center_x= uint32_t(std::max(0, chunk_global_coord[0] - world_offset_[0]));
+		center_y= uint32_t(std::max(0, chunk_global_coord[1] - world_offset_[1]));
+	}
+
+	return {center_x, center_y};
+}
+
+void WorldGeometryGenerator::UpdateChunksEviction()
+{
+	chunks_to_evict_.clear();
+
+	if(last_geometry_allocation_stats_ == std::nullopt)
+		return;
+
+	const uint32_t num_failed_allocations= last_geometry_allocation_stats_->num_failed_allocations;
+	const bool has_new_failures= num_failed_allocations != num_failed_allocations_handled_;
+	num_failed_allocations_handled_= num_failed_allocations;
+
+	// Stats are read back with some delay.
+	// So, ignore failures which happened before results of previous eviction become visible, in order to avoid evicting too much.
+	if(num_evicted_chunks_ > 0 &&
+		frame_counter_ < last_eviction_frame_ + geometry_allocation_stats_read_back_buffer_num_frames_)
+		return;
+
+	const std::array<uint32_t, 2> center_chunk= GetCenterChunk();
+	const auto get_square_distance_to_center=
+		[&](const std::array<uint32_t, 2>& chunk)
+		{
+			const int32_t dx= int32_t(chunk[0]) - int32_t(center_chunk[0]);
+			const int32_t dy= int32_t(chunk[1]) - int32_t(center_chunk[1]);
+			return dx * dx + dy * dy;
+		};
+
+	if(has_new_failures)
+	{
+		// Some chunks have no enough memory for their geometry. Evict geometry of the most far chunks.
+		std::vector<std::array<uint32_t, 2>> candidates;
+		for(uint32_t y= 0; y < world_size_[1]; ++y)
+		for(uint32_t x= 0; x < world_size_[0]; ++x)
+		{
+			if(!chunks_evicted_[x + y * world_size_[0]])
+				candidates.push_back({x, y});
+		}
+
+		const size_t num_chunks_to_evict= std::min(size_t(c_max_chunks_to_evict_per_frame), candidates.size());
+		std::partial_sort(
+			candidates.begin(),
+			candidates.begin() + std::ptrdiff_t(num_chunks_to_evict),
+			candidates.end(),
+			[&](const std::array<uint32_t, 2>& l, const std::array<uint32_t, 2>& r)
+			{
+				return get_square_distance_to_center(l) > get_square_distance_to_center(r);
+			});
+
+		for(size_t i= 0; i < num_chunks_to_evict; ++i)
+		{
+			const std::array<uint32_t, 2>& chunk= candidates[i];
+			chunks_evicted_[chunk[0] + chunk[1] * world_size_[0]]= true;
+			chunks_to_evict_.push_back(chunk);
+		}
+
+		num_evicted_chunks_+= uint32_t(num_chunks_to_evict);
+		last_eviction_frame_= frame_counter_;
+		chunk_to_restore_= std::nullopt;
+	}
+	else if(num_evicted_chunks_ > 0)
+	{
+		// Restore the closest evicted chunk if there is enough free memory.
+		// Restore chunks one by one, in order to avoid evicting them again.
+		const uint32_t total_units= GetTotalVertexBufferUnits(world_size_, vertex_memory_quads_per_chunk_);
+		if(last_geometry_allocation_stats_->num_used_units >= total_units / 4 * 3)
+			return;
+
+		std::optional<std::array<uint32_t, 2>> closest_chunk;
+		for(uint32_t y= 0; y < world_size_[1]; ++y)
+		for(uint32_t x= 0; x < world_size_[0]; ++x)
+		{
+			if(chunks_evicted_[x + y * world_size_[0]] &&
+				(closest_chunk == std::nullopt ||
+				get_square_distance_to_center({x, y}) < get_square_distance_to_center(*closest_chunk)))
+				closest_chunk= {x, y};
+		}
+
+		if(closest_chunk != std::nullopt)
+		{
+			chunks_evicted_[(*closest_chunk)[0] + (*closest_chunk)[1] * world_size_[0]]= false;
+			--num_evicted_chunks_;
+			chunk_to_restore_= closest_chunk;
+		}
+	}
+}
+
+void WorldGeometryGenerator::EvictChunks(TaskOrganizer& task_organizer)
+{
+	if(chunks_to_evict_.empty())
+		return;
+
+	HEX_ASSERT(chunks_to_evict_.size() <= c_max_chunks_to_evict);
+
+	TaskOrganizer::ComputeTaskParams task;
+	task.name= "geometry_eviction";
+	task.input_output_storage_buffers.push_back(chunk_draw_info_buffer_.GetBuffer());
+	task.input_output_storage_buffers.push_back(geometry_allocation_stats_buffer_.GetBuffer());
+	task.input_output_storage_buffers.push_back(vertex_memory_allocator_.GetAllocatorDataBuffer());
+
+	const auto task_func=
+		[this](const vk::CommandBuffer command_buffer)
+		{
+			command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, *geometry_evict_pipeline_.pipeline);
+
+			command_buffer.bindDescriptorSets(
+				vk::PipelineBindPoint::eCompute,
+				*geometry_evict_pipeline_.pipeline_layout,
+				0u,
+				{geometry_evict_descriptor_set_},
+				{});
+
+			GeometryEvictUniforms uniforms;
+			uniforms.num_chunks_to_evict= uint32_t(chunks_to_evict_.size());
+			for(uint32_t i= 0; i < uniforms.num_chunks_to_evict; ++i)
+			{
+				const auto& chunk_to_evict= chunks_to_evict_[i];
+				const uint32_t chunk_index= chunk_to_evict[0] + chunk_to_evict[1] * world_size_[0];
+				uniforms.chunks_to_evict_list[i]= uint16_t(chunk_index);
+			}
+
+			command_buffer.pushConstants(
+				*geometry_evict_pipeline_.pipeline_layout,
+				vk::ShaderStageFlagBits::eCompute,
+				0,
+				sizeof(GeometryEvictUniforms), static_cast<const void*>(&uniforms));
+
+			// Use single workgroup for eviction - one thread for each chunk.
+			command_buffer.dispatch(1, 1 , 1);
+		};
+
+	task_organizer.ExecuteTask(task, task_func);
+}
+
 void WorldGeometryGenerator::BuildChunksToUpdateList()
 {
 	chunks_to_update_.clear();
 
-	if(frame_counter_ == 0)
+	if(frame_counter_ == 0 || update_all_chunks_in_each_frame_)
 	{
-		// On first frame update all chunks.
+		// On first frame (or in each frame, if requested) update all chunks.
+		// Skip evicted chunks - they should have no geometry.
 		for(uint32_t y= 0; y < world_size_[1]; ++y)
 		for(uint32_t x= 0; x < world_size_[0]; ++x)
-			chunks_to_update_.push_back({x, y});
+		{
+			if(!chunks_evicted_[x + y * world_size_[0]])
+				chunks_to_update_.push_back({x, y});
+		}
 	}
 	else
 	{
@@ -762,20 +1377,9 @@ void WorldGeometryGenerator::BuildChunksToUpdateList()
 		const uint32_t update_period= 64;
 		const uint32_t update_period_fast= 4;
 
-		uint32_t center_x= world_size_[0] / 2;
-		uint32_t center_y= world_size_[1] / 2;
-
-		if(const auto player_state= world_processor_.GetLastKnownPlayerState())
-		{
-			// If player position is available, calculate center chunk based on player position.
-			const int32_t chunk_global_coord[]
-			{
-				int32_t(std::floor(player_state->pos[0] / c_space_scale_x)) >> int32_t(c_chunk_width_log2),
-				int32_t(std::floor(player_state->pos[1])) >> int32_t(c_chunk_width_log2),
-			};
-			center_x= uint32_t(std::max(0, chunk_global_coord[0] - world_offset_[0]));
-			center_y= uint32_t(std::max(0, chunk_global_coord[1] - world_offset_[1]));
-		}
+		const std::array<uint32_t, 2> center_chunk= GetCenterChunk();
+		const uint32_t center_x= center_chunk[0];
+		const uint32_t center_y= center_chunk[1];
 
 		const uint32_t center_radius= 1;
 
@@ -800,12 +1404,74 @@ void WorldGeometryGenerator::BuildChunksToUpdateList()
 					chunks_to_update_.push_back({x, y});
 			}
 		}
+
+		// Remove evicted chunks - they should have no geometry.
+		chunks_to_update_.erase(
+			std::remove_if(
+				chunks_to_update_.begin(),
+				chunks_to_update_.end(),
+				[&](const std::array<uint32_t, 2>& chunk)
+				{
+					return chunks_evicted_[chunk[0] + chunk[1] * world_size_[0]];
+				}),
+			chunks_to_update_.end());
+
+		// Generate geometry of restored chunk immediately.
+		if(chunk_to_restore_ != std::nullopt &&
+			std::find(chunks_to_update_.begin(), chunks_to_update_.end(), *chunk_to_restore_) == chunks_to_update_.end())
+			chunks_to_update_.push_back(*chunk_to_restore_);
 	}
+
+	chunk_to_restore_= std::nullopt;
+}
+
+void WorldGeometryGenerator::UploadChunksToUpdateList(TaskOrganizer& task_organizer)
+{
+	// Upload list of chunks for geometry generation and geometry copy.
+	// Both use the same list and process chunks of a batch via single dispatch.
+
+	if(chunks_to_update_.empty())
+		return;
+
+	std::vector<ChunkToUpdate> chunks_to_update;
+	chunks_to_update.reserve(chunks_to_update_.size());
+
+	for(const auto& chunk_to_update : chunks_to_update_)
+	{
+		ChunkToUpdate out_chunk;
+		out_chunk.chunk_position[0]= int32_t(chunk_to_update[0]);
+		out_chunk.chunk_position[1]= int32_t(chunk_to_update[1]);
+		out_chunk.chunk_global_position[0]= world_offset_[0] + int32_t(chunk_to_update[0]);
+		out_chunk.chunk_global_position[1]= world_offset_[1] + int32_t(chunk_to_update[1]);
+		chunks_to_update.push_back(out_chunk);
+	}
+
+	const vk::DeviceSize data_size= sizeof(ChunkToUpdate) * chunks_to_update.size();
+	// This is a limit of "vkCmdUpdateBuffer".
+	// It isn't reached even with maximum world size.
+	HEX_ASSERT(data_size <= 65536);
+
+	TaskOrganizer::TransferTaskParams task;
+	task.name= "geometry_chunks_to_update_list_upload";
+	task.output_buffers.push_back(TaskOrganizer::BufferRange(chunks_to_update_list_buffer_.GetBuffer(), 0, data_size));
+
+	const auto task_func=
+		[this, &chunks_to_update, data_size](const vk::CommandBuffer command_buffer)
+		{
+			command_buffer.updateBuffer(
+				chunks_to_update_list_buffer_.GetBuffer(),
+				0,
+				data_size,
+				chunks_to_update.data());
+		};
+
+	task_organizer.ExecuteTask(task, task_func);
 }
 
 void WorldGeometryGenerator::PrepareGeometrySizeCalculation(TaskOrganizer& task_organizer)
 {
 	TaskOrganizer::ComputeTaskParams task;
+	task.name= "geometry_size_calculation_prepare";
 	task.input_output_storage_buffers.push_back(chunk_draw_info_buffer_.GetBuffer());
 
 	const auto task_func=
@@ -837,155 +1503,211 @@ void WorldGeometryGenerator::PrepareGeometrySizeCalculation(TaskOrganizer& task_
 	task_organizer.ExecuteTask(task, task_func);
 }
 
-void WorldGeometryGenerator::CalculateGeometrySize(TaskOrganizer& task_organizer)
+void WorldGeometryGenerator::GenGeometry(
+	TaskOrganizer& task_organizer,
+	const uint32_t chunks_list_offset,
+	const uint32_t num_chunks)
 {
+	HEX_ASSERT(num_chunks <= c_max_chunks_in_geometry_gen_batch);
+
+	{
+		// Reset scratch quads counters of the batch.
+		TaskOrganizer::TransferTaskParams task;
+		task.name= "geometry_scratch_reset";
+		task.output_buffers.push_back(geometry_scratch_num_quads_buffer_.GetBuffer());
+
+		const auto task_func=
+			[this](const vk::CommandBuffer command_buffer)
+			{
+				command_buffer.fillBuffer(
+					geometry_scratch_num_quads_buffer_.GetBuffer(),
+					0,
+					geometry_scratch_num_quads_buffer_.GetSize(),
+					0);
+			};
+
+		task_organizer.ExecuteTask(task, task_func);
+	}
+
 	const uint32_t actual_buffers_index= world_processor_.GetActualBuffersIndex();
 
 	TaskOrganizer::ComputeTaskParams task;
+	task.name= "geometry_gen";
 	task.input_storage_buffers.push_back(world_processor_.GetChunkDataBuffer(actual_buffers_index));
+	task.input_storage_buffers.push_back(world_processor_.GetChunkAuxiliarDataBuffer(actual_buffers_index));
+	task.input_storage_buffers.push_back(world_processor_.GetLightDataBuffer(actual_buffers_index));
+	task.input_storage_buffers.push_back(
+		TaskOrganizer::BufferRange(
+			chunks_to_update_list_buffer_.GetBuffer(),
+			sizeof(ChunkToUpdate) * chunks_list_offset,
+			sizeof(ChunkToUpdate) * num_chunks));
 	task.input_output_storage_buffers.push_back(chunk_draw_info_buffer_.GetBuffer());
+	task.input_output_storage_buffers.push_back(geometry_scratch_num_quads_buffer_.GetBuffer());
+	task.output_storage_buffers.push_back(geometry_scratch_quads_buffer_.GetBuffer());
+	task.output_storage_buffers.push_back(geometry_scratch_quad_kinds_buffer_.GetBuffer());
 
 	const auto task_func=
-		[this, actual_buffers_index](const vk::CommandBuffer command_buffer)
+		[this, actual_buffers_index, chunks_list_offset, num_chunks](const vk::CommandBuffer command_buffer)
 		{
-			command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, *geometry_size_calculate_pipeline_.pipeline);
+			// Generate geometry into scratch memory, count number of quads.
+
+			command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, *geometry_gen_pipeline_.pipeline);
 
 			command_buffer.bindDescriptorSets(
 				vk::PipelineBindPoint::eCompute,
-				*geometry_size_calculate_pipeline_.pipeline_layout,
+				*geometry_gen_pipeline_.pipeline_layout,
 				0u,
-				{geometry_size_calculate_descriptor_sets_[actual_buffers_index]},
+				{geometry_gen_descriptor_sets_[actual_buffers_index]},
 				{});
 
-			for(const auto& chunk_to_update : chunks_to_update_)
-			{
-				ChunkPositionUniforms chunk_position_uniforms;
-				chunk_position_uniforms.world_size_chunks[0]= int32_t(world_size_[0]);
-				chunk_position_uniforms.world_size_chunks[1]= int32_t(world_size_[1]);
-				chunk_position_uniforms.chunk_position[0]= int32_t(chunk_to_update[0]);
-				chunk_position_uniforms.chunk_position[1]= int32_t(chunk_to_update[1]);
-				chunk_position_uniforms.chunk_global_position[0]= world_offset_[0] + int32_t(chunk_to_update[0]);
-				chunk_position_uniforms.chunk_global_position[1]= world_offset_[1] + int32_t(chunk_to_update[1]);
-
-				command_buffer.pushConstants(
-					*geometry_size_calculate_pipeline_.pipeline_layout,
-					vk::ShaderStageFlagBits::eCompute,
-					0,
-					sizeof(ChunkPositionUniforms), static_cast<const void*>(&chunk_position_uniforms));
-
-				// This constant should match workgroup size in shader!
-				constexpr uint32_t c_workgroup_size[]{4, 4, 8};
-				static_assert(c_chunk_width % c_workgroup_size[0] == 0, "Wrong workgroup size!");
-				static_assert(c_chunk_width % c_workgroup_size[1] == 0, "Wrong workgroup size!");
-				static_assert(c_chunk_height % c_workgroup_size[2] == 0, "Wrong workgroup size!");
-
-				command_buffer.dispatch(
-					c_chunk_width / c_workgroup_size[0],
-					c_chunk_width / c_workgroup_size[1],
-					c_chunk_height / c_workgroup_size[2]);
-			}
+			GeometryGenUniforms uniforms;
+			uniforms.world_size_chunks[0]= int32_t(world_size_[0]);
+			uniforms.world_size_chunks[1]= int32_t(world_size_[1]);
+			uniforms.chunks_list_offset= chunks_list_offset;
+
+			command_buffer.pushConstants(
+				*geometry_gen_pipeline_.pipeline_layout,
+				vk::ShaderStageFlagBits::eCompute,
+				0,
+				sizeof(GeometryGenUniforms), static_cast<const void*>(&uniforms));
+
+			// Process all chunks of the batch via single dispatch.
+			// Chunk is determined in shader based on workgroup index along Z axis.
+			command_buffer.dispatch(
+				c_chunk_width / c_geometry_gen_workgroup_size[0],
+				c_chunk_width / c_geometry_gen_workgroup_size[1],
+				c_chunk_height / c_geometry_gen_workgroup_size[2] * num_chunks);
 		};
 
 	task_organizer.ExecuteTask(task, task_func);
 }
 
-void WorldGeometryGenerator::AllocateMemoryForGeometry(TaskOrganizer& task_organizer)
+void WorldGeometryGenerator::AllocateMemoryForGeometry(
+	TaskOrganizer& task_organizer,
+	const uint32_t chunks_list_offset,
+	const uint32_t num_chunks)
 {
-	// We have limited uniform size for chunks to update list.
-	// So, perform several updates if necessary.
-	for(size_t offset= 0; offset < chunks_to_update_.size(); offset+= c_max_chunks_to_allocate)
-	{
-		TaskOrganizer::ComputeTaskParams task;
-		task.input_output_storage_buffers.push_back(chunk_draw_info_buffer_.GetBuffer());
-		task.input_output_storage_buffers.push_back(vertex_memory_allocator_.GetAllocatorDataBuffer());
+	// Whole batch fits into limited uniform size for chunks to allocate list.
+	HEX_ASSERT(num_chunks <= c_max_chunks_to_allocate);
 
-		const auto task_func=
-			[this, offset](const vk::CommandBuffer command_buffer)
-			{
-				command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, *geometry_allocate_pipeline_.pipeline);
+	TaskOrganizer::ComputeTaskParams task;
+	task.name= "geometry_allocation";
+	task.input_output_storage_buffers.push_back(chunk_draw_info_buffer_.GetBuffer());
+	task.input_output_storage_buffers.push_back(geometry_allocation_stats_buffer_.GetBuffer());
+	task.input_output_storage_buffers.push_back(vertex_memory_allocator_.GetAllocatorDataBuffer());
 
-				command_buffer.bindDescriptorSets(
-					vk::PipelineBindPoint::eCompute,
-					*geometry_allocate_pipeline_.pipeline_layout,
-					0u,
-					{geometry_allocate_descriptor_set_},
-					{});
+	const auto task_func=
+		[this, chunks_list_offset, num_chunks](const vk::CommandBuffer command_buffer)
+		{
+			command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, *geometry_allocate_pipeline_.pipeline);
 
-				GeometryAllocateUniforms uniforms;
-				uniforms.num_chunks_to_allocate= uint32_t(std::min(size_t(c_max_chunks_to_allocate), chunks_to_update_.size() - offset));
-				for(uint32_t i= 0; i < uniforms.num_chunks_to_allocate; ++i)
-				{
-					const auto& chunk_to_update= chunks_to_update_[uint32_t(offset) + i];
-					const uint32_t chunk_index= chunk_to_update[0] + chunk_to_update[1] * world_size_[0];
-					uniforms.chunks_to_allocate_list[i]= uint16_t(chunk_index);
-				}
-
-				command_buffer.pushConstants(
-					*geometry_allocate_pipeline_.pipeline_layout,
-					vk::ShaderStageFlagBits::eCompute,
-					0,
-					sizeof(GeometryAllocateUniforms), static_cast<const void*>(&uniforms));
+			command_buffer.bindDescriptorSets(
+				vk::PipelineBindPoint::eCompute,
+				*geometry_allocate_pipeline_.pipeline_layout,
+				0u,
+				{geometry_allocate_descriptor_set_},
+				{});
 
-				// Use single thread for allocation.
-				command_buffer.dispatch(1, 1 , 1);
-			};
+			GeometryAllocateUniforms uniforms;
+			uniforms.num_chunks_to_allocate= num_chunks;
+			for(uint32_t i= 0; i < num_chunks; ++i)
+			{
+				const auto& chunk_to_update= chunks_to_update_[chunks_list_offset + i];
+				const uint32_t chunk_index= chunk_to_update[0] + chunk_to_update[1] * world_size_[0];
+				uniforms.chunks_to_allocate_list[i]= uint16_t(chunk_index);
+			}
 
-		task_organizer.ExecuteTask(task, task_func);
-	};
+			command_buffer.pushConstants(
+				*geometry_allocate_pipeline_.pipeline_layout,
+				vk::ShaderStageFlagBits::eCompute,
+				0,
+				sizeof(GeometryAllocateUniforms), static_cast<const void*>(&uniforms));
+
+			// Use single workgroup for allocation - one thread for each chunk.
+			command_buffer.dispatch(1, 1 , 1);
+		};
+
+	task_organizer.ExecuteTask(task, task_func);
 }
 
-void WorldGeometryGenerator::GenGeometry(TaskOrganizer& task_organizer)
+void WorldGeometryGenerator::CopyGeometry(
+	TaskOrganizer& task_organizer,
+	const uint32_t chunks_list_offset,
+	const uint32_t num_chunks)
 {
-	const uint32_t actual_buffers_index= world_processor_.GetActualBuffersIndex();
+	HEX_ASSERT(num_chunks <= c_max_chunks_in_geometry_gen_batch);
 
 	TaskOrganizer::ComputeTaskParams task;
-	task.input_storage_buffers.push_back(world_processor_.GetChunkDataBuffer(actual_buffers_index));
-	task.input_storage_buffers.push_back(world_processor_.GetChunkAuxiliarDataBuffer(actual_buffers_index));
-	task.input_storage_buffers.push_back(world_processor_.GetLightDataBuffer(actual_buffers_index));
+	task.name= "geometry_copy";
+	task.input_storage_buffers.push_back(geometry_scratch_quads_buffer_.GetBuffer());
+	task.input_storage_buffers.push_back(geometry_scratch_quad_kinds_buffer_.GetBuffer());
+	task.input_storage_buffers.push_back(geometry_scratch_num_quads_buffer_.GetBuffer());
+	task.input_storage_buffers.push_back(
+		TaskOrganizer::BufferRange(
+			chunks_to_update_list_buffer_.GetBuffer(),
+			sizeof(ChunkToUpdate) * chunks_list_offset,
+			sizeof(ChunkToUpdate) * num_chunks));
 	task.input_output_storage_buffers.push_back(chunk_draw_info_buffer_.GetBuffer());
 	task.output_storage_buffers.push_back(vertex_buffer_.GetBuffer());
 
 	const auto task_func=
-		[this, actual_buffers_index](const vk::CommandBuffer command_buffer)
+		[this, chunks_list_offset, num_chunks](const vk::CommandBuffer command_buffer)
 		{
-			// Update geometry, count number of quads.
+			// Copy quads from scratch memory into allocated memory, count number of quads of each kind.
 
-			command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, *geometry_gen_pipeline_.pipeline);
+			command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, *geometry_copy_pipeline_.pipeline);
 
 			command_buffer.bindDescriptorSets(
 				vk::PipelineBindPoint::eCompute,
-				*geometry_gen_pipeline_.pipeline_layout,
+				*geometry_copy_pipeline_.pipeline_layout,
 				0u,
-				{geometry_gen_descriptor_sets_[actual_buffers_index]},
+				{geometry_copy_descriptor_set_},
 				{});
 
-			for(const auto& chunk_to_update : chunks_to_update_)
-			{
-				ChunkPositionUniforms chunk_position_uniforms;
-				chunk_position_uniforms.world_size_chunks[0]= int32_t(world_size_[0]);
-				chunk_position_uniforms.world_size_chunks[1]= int32_t(world_size_[1]);
-				chunk_position_uniforms.chunk_position[0]= int32_t(chunk_to_update[0]);
-				chunk_position_uniforms.chunk_position[1]= int32_t(chunk_to_update[1]);
-				chunk_position_uniforms.chunk_global_position[0]= world_offset_[0] + int32_t(chunk_to_update[0]);
-				chunk_position_uniforms.chunk_global_position[1]= world_offset_[1] + int32_t(chunk_to_update[1]);
-
-				command_buffer.pushConstants(
-					*geometry_gen_pipeline_.pipeline_layout,
-					vk::ShaderStageFlagBits::eCompute,
-					0,
-					sizeof(ChunkPositionUniforms), static_cast<const void*>(&chunk_position_uniforms));
-
-				// This constant should match workgroup size in shader!
-				constexpr uint32_t c_workgroup_size[]{4, 4, 8};
-				static_assert(c_chunk_width % c_workgroup_size[0] == 0, "Wrong workgroup size!");
-				static_assert(c_chunk_width % c_workgroup_size[1] == 0, "Wrong workgroup size!");
-				static_assert(c_chunk_height % c_workgroup_size[2] == 0, "Wrong workgroup size!");
-
-				command_buffer.dispatch(
-					c_chunk_width / c_workgroup_size[0],
-					c_chunk_width / c_workgroup_size[1],
-					c_chunk_height / c_workgroup_size[2]);
-			}
+			GeometryGenUniforms uniforms;
+			uniforms.world_size_chunks[0]= int32_t(world_size_[0]);
+			uniforms.world_size_chunks[1]= int32_t(world_size_[1]);
+			uniforms.chunks_list_offset= chunks_list_offset;
+
+			command_buffer.pushConstants(
+				*geometry_copy_pipeline_.pipeline_layout,
+				vk::ShaderStageFlagBits::eCompute,
+				0,
+				sizeof(GeometryGenUniforms), static_cast<const void*>(&uniforms));
+
+			// Dispatch enough workgroups to cover whole scratch memory region of each chunk.
+			// Workgroups beyond actual number of quads of the chunk exit immediately.
+			command_buffer.dispatch(
+				c_geometry_scratch_chunk_capacity_quads / c_geometry_copy_workgroup_size,
+				num_chunks,
+				1);
+		};
+
+	task_organizer.ExecuteTask(task, task_func);
+}
+
+void WorldGeometryGenerator::CopyGeometryAllocationStatsForReadBack(TaskOrganizer& task_organizer)
+{
+	TaskOrganizer::TransferTaskParams task;
+	task.name= "geometry_allocation_stats_read_back";
+	task.input_buffers.push_back(geometry_allocation_stats_buffer_.GetBuffer());
+	task.output_buffers.push_back(geometry_allocation_stats_read_back_buffer_.GetBuffer());
+
+	const auto task_func=
+		[this](const vk::CommandBuffer command_buffer)
+		{
+			// Copy stats into readback buffer.
+			// Use slot in the destination buffer for this frame.
+			command_buffer.copyBuffer(
+				geometry_allocation_stats_buffer_.GetBuffer(),
+				geometry_allocation_stats_read_back_buffer_.GetBuffer(),
+				{
+					{
+						0,
+						sizeof(GeometryAllocationStats) * (frame_counter_ % geometry_allocation_stats_read_back_buffer_num_frames_),
+						sizeof(GeometryAllocationStats)
+					}
+				});
 		};
 
 	task_organizer.ExecuteTask(task, task_func);
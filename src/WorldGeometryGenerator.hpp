@@ -7,13 +7,18 @@
 namespace HexGPU
 {
 
+// Packed world vertex. See "world_vertex.glsl" for details.
+// If this changed, the same struct in GLSL code must be changed too!
 struct WorldVertex
 {
-	// Use 16 bit for position in order to make this struct more compact (relative to floats).
-	int16_t pos[4];
-	int16_t tex_coord[4]; // component 3 - light
+	// Position within chunk (x, y), reduced texture coordinates, texture index.
+	uint32_t pos_xy_tex_coord;
+	uint16_t pos_z;
+	uint16_t light; // Or fire power.
 };
 
+static_assert(sizeof(WorldVertex) == 8, "Invalid size!");
+
 using QuadVertices= std::array<WorldVertex, 4>;
 
 class WorldGeometryGenerator
@@ -38,11 +43,21 @@ public:
 		uint32_t num_memory_units= 0;
 	};
 
+	// Statistics of vertex memory usage. Values are read back from the GPU with some delay.
+	struct VertexMemoryStats
+	{
+		uint32_t total_units= 0;
+		uint32_t used_units= 0;
+		uint32_t num_failed_allocations= 0;
+		uint32_t num_evicted_chunks= 0;
+	};
+
 public:
 	WorldGeometryGenerator(
 		WindowVulkan& window_vulkan,
 		const WorldProcessor& world_processor,
-		vk::DescriptorPool global_descriptor_pool);
+		vk::DescriptorPool global_descriptor_pool,
+		Settings& settings);
 	~WorldGeometryGenerator();
 
 	void Update(TaskOrganizer& task_organizer);
@@ -52,19 +67,50 @@ public:
 	vk::Buffer GetChunkDrawInfoBuffer() const;
 	vk::DeviceSize GetChunkDrawInfoBufferSize() const;
 
+	VertexMemoryStats GetVertexMemoryStats() const;
+
+	// Generate geometry of all chunks in each frame. Used for meshing benchmarking.
+	void EnableAllChunksUpdateInEachFrame();
+	uint32_t GetNumChunksUpdatedInLastFrame() const;
+
+private:
+	// If this changed, the same struct in GLSL code must be changed too!
+	struct GeometryAllocationStats
+	{
+		uint32_t num_used_units= 0;
+		uint32_t num_failed_allocations= 0;
+	};
+
+	// Entry of the list of chunks for batched geometry generation and geometry copy.
+	// If this changed, the same struct in GLSL code must be changed too!
+	struct ChunkToUpdate
+	{
+		int32_t chunk_position[2]{}; // Position relative current loaded region.
+		int32_t chunk_global_position[2]{}; // Global position.
+	};
+
 private:
 	void InitialFillBuffers(TaskOrganizer& task_organizer);
 	void ShiftChunkDrawInfo(TaskOrganizer& task_organizer, std::array<int32_t, 2> shift);
+	void ShiftChunksEvictedFlags(std::array<int32_t, 2> shift);
+	void ReadBackGeometryAllocationStats();
+	std::array<uint32_t, 2> GetCenterChunk() const;
+	void UpdateChunksEviction();
+	void EvictChunks(TaskOrganizer& task_organizer);
 	void BuildChunksToUpdateList();
+	void UploadChunksToUpdateList(TaskOrganizer& task_organizer);
 	void PrepareGeometrySizeCalculation(TaskOrganizer& task_organizer);
-	void CalculateGeometrySize(TaskOrganizer& task_organizer);
-	void AllocateMemoryForGeometry(TaskOrganizer& task_organizer);
-	void GenGeometry(TaskOrganizer& task_organizer);
+	// Process batch of chunks from chunks to update list.
+	void GenGeometry(TaskOrganizer& task_organizer, uint32_t chunks_list_offset, uint32_t num_chunks);
+	void AllocateMemoryForGeometry(TaskOrganizer& task_organizer, uint32_t chunks_list_offset, uint32_t num_chunks);
+	void CopyGeometry(TaskOrganizer& task_organizer, uint32_t chunks_list_offset, uint32_t num_chunks);
+	void CopyGeometryAllocationStatsForReadBack(TaskOrganizer& task_organizer);
 
 private:
 	const vk::Device vk_device_;
 	const WorldProcessor& world_processor_;
 	const WorldSizeChunks world_size_;
+	const uint32_t vertex_memory_quads_per_chunk_;
 
 	bool buffers_initially_filled_= false;
 
@@ -73,27 +119,54 @@ private:
 
 	const Buffer vertex_buffer_;
 
+	const Buffer chunks_to_update_list_buffer_;
+
+	// Geometry of a batch of chunks is generated into these buffers and then copied into the vertex buffer.
+	const Buffer geometry_scratch_quads_buffer_;
+	const Buffer geometry_scratch_quad_kinds_buffer_;
+	const Buffer geometry_scratch_num_quads_buffer_;
+
 	GPUAllocator vertex_memory_allocator_;
 
+	const Buffer geometry_allocation_stats_buffer_;
+	const uint32_t geometry_allocation_stats_read_back_buffer_num_frames_;
+	const Buffer geometry_allocation_stats_read_back_buffer_;
+	void* const geometry_allocation_stats_read_back_buffer_mapped_;
+
 	const ComputePipeline chunk_draw_info_shift_pipeline_;
 	const vk::DescriptorSet chunk_draw_info_shift_descriptor_set_;
 
 	const ComputePipeline geometry_size_calculate_prepare_pipeline_;
 	const vk::DescriptorSet geometry_size_calculate_prepare_descriptor_set_;
 
-	const ComputePipeline geometry_size_calculate_pipeline_;
-	const std::array<vk::DescriptorSet, 2> geometry_size_calculate_descriptor_sets_;
-
 	const ComputePipeline geometry_allocate_pipeline_;
 	const vk::DescriptorSet geometry_allocate_descriptor_set_;
 
 	const ComputePipeline geometry_gen_pipeline_;
 	const std::array<vk::DescriptorSet, 2> geometry_gen_descriptor_sets_;
 
+	const ComputePipeline geometry_copy_pipeline_;
+	const vk::DescriptorSet geometry_copy_descriptor_set_;
+
+	const ComputePipeline geometry_evict_pipeline_;
+	const vk::DescriptorSet geometry_evict_descriptor_set_;
+
 	WorldOffsetChunks world_offset_;
 
 	uint32_t frame_counter_= 0;
+	bool update_all_chunks_in_each_frame_= false;
 	std::vector<std::array<uint32_t, 2>> chunks_to_update_;
+
+	// Geometry of evicted chunks is freed in order to free memory for closer chunks.
+	// Such chunks aren't updated until they are restored.
+	std::vector<bool> chunks_evicted_;
+	uint32_t num_evicted_chunks_= 0;
+	std::vector<std::array<uint32_t, 2>> chunks_to_evict_;
+	std::optional<std::array<uint32_t, 2>> chunk_to_restore_;
+	uint32_t last_eviction_frame_= 0;
+
+	std::optional<GeometryAllocationStats> last_geometry_allocation_stats_;
+	uint32_t num_failed_allocations_handled_= 0;
 };
 
 } // namespace HexGPU
@@ -2,9 +2,12 @@
 #include "Assert.hpp"
 #include "Constants.hpp"
 #include "GlobalDescriptorPool.hpp"
+#include "LightUpdateCPU.hpp"
 #include "Log.hpp"
+#include "Math.hpp"
 #include "ShaderList.hpp"
 #include "VulkanUtils.hpp"
+#include <cmath>
 
 namespace HexGPU
 {
@@ -26,6 +29,7 @@ namespace WorldGenShaderBindings
 	const ShaderBindingIndex structure_descriptions_buffer= 2;
 	const ShaderBindingIndex structures_data_buffer= 3;
 	const ShaderBindingIndex chunk_auxiliar_data_buffer= 4;
+	const ShaderBindingIndex chunks_modified_flags_buffer= 5;
 }
 
 namespace InitialLightFillShaderBindings
@@ -42,6 +46,9 @@ namespace WorldBlocksUpdateShaderBindings
 	const ShaderBindingIndex chunk_auxiliar_data_output_buffer= 3;
 	const ShaderBindingIndex chunks_light_data_buffer= 4;
 	const ShaderBindingIndex world_global_state_buffer= 5;
+	const ShaderBindingIndex chunks_modified_flags_buffer= 6;
+	const ShaderBindingIndex chunks_to_update_list_buffer= 7;
+	const ShaderBindingIndex chunks_changed_flags_buffer= 8;
 }
 
 namespace LightUpdateShaderBindings
@@ -49,6 +56,8 @@ namespace LightUpdateShaderBindings
 	const ShaderBindingIndex chunk_data_buffer= 0;
 	const ShaderBindingIndex chunk_input_light_buffer= 1;
 	const ShaderBindingIndex chunk_output_light_buffer= 2;
+	const ShaderBindingIndex chunks_to_update_list_buffer= 3;
+	const ShaderBindingIndex chunks_changed_flags_buffer= 4;
 }
 
 namespace PlayerWorldWindowBuildShaderBindings
@@ -72,6 +81,8 @@ namespace WorldBlocksExternalUpdateQueueFlushShaderBindigns
 	const ShaderBindingIndex chunk_data_buffer= 0;
 	const ShaderBindingIndex world_blocks_external_update_queue_buffer= 1;
 	const ShaderBindingIndex chunk_auxiliar_data_buffer= 2;
+	const ShaderBindingIndex chunks_modified_flags_buffer= 3;
+	const ShaderBindingIndex chunks_changed_flags_buffer= 4;
 }
 
 namespace WorldGlobalStateUpdateBindings
@@ -99,6 +110,7 @@ struct WorldGenUniforms
 	int32_t chunk_position[2]{};
 	int32_t chunk_global_position[2]{};
 	int32_t seed= 0;
+	uint32_t chunk_modified_flag_index= 0;
 };
 
 // This constant should match workgroup size in shader!
@@ -113,22 +125,34 @@ struct InitialLightFillUniforms
 	int32_t chunk_position[2]{};
 };
 
+// This constant should match workgroup size in shader!
+// Same size is used for world blocks update and light update.
+constexpr uint32_t c_world_update_workgroup_size[]{4, 4, 8};
+static_assert(c_chunk_width % c_world_update_workgroup_size[0] == 0, "Wrong workgroup size!");
+static_assert(c_chunk_width % c_world_update_workgroup_size[1] == 0, "Wrong workgroup size!");
+static_assert(c_chunk_height % c_world_update_workgroup_size[2] == 0, "Wrong workgroup size!");
+
 struct WorldBlocksUpdateUniforms
 {
 	int32_t world_size_chunks[2]{};
-	int32_t in_chunk_position[2]{};
-	int32_t out_chunk_position[2]{};
+	int32_t in_chunk_shift[2]{};
 	uint32_t current_tick= 0;
-	uint32_t reserved= 0;
+	uint32_t inactive_chunks_update_period= 1;
 };
 
 struct LightUpdateUniforms
 {
 	int32_t world_size_chunks[2]{};
-	int32_t in_chunk_position[2]{};
-	int32_t out_chunk_position[2]{};
+	int32_t in_chunk_shift[2]{};
+	uint32_t current_tick= 0;
+	uint32_t inactive_chunks_update_period= 1;
 };
 
+// These constants must match GLSL code!
+constexpr uint32_t c_chunks_changed_flags_kind_blocks= 0;
+constexpr uint32_t c_chunks_changed_flags_kind_light= 1;
+constexpr uint32_t c_chunks_changed_flags_num_kinds= 2;
+
 struct PlayerWorldWindowBuildUniforms
 {
 	int32_t world_size_chunks[2]{};
@@ -150,6 +174,8 @@ struct WorldBlocksExternalUpdateQueueFlushUniforms
 {
 	int32_t world_size_chunks[2]{0, 0};
 	int32_t world_offset_chunks[2]{0, 0};
+	int32_t world_offset_chunks_wrapped[2]{0, 0};
+	uint32_t current_tick= 0;
 };
 
 struct WorldGlobalStateUpdateUniforms
@@ -160,6 +186,44 @@ struct WorldGlobalStateUpdateUniforms
 	int32_t snow_z_level= 128;
 };
 
+uint32_t ReadNumWorkerThreads(Settings& settings)
+{
+	// Zero means automatic selection.
+	const int32_t num_threads= std::max(0, std::min(int32_t(settings.GetOrSetInt("g_worker_threads", 0)), 32));
+	settings.SetInt("g_worker_threads", num_threads);
+
+	return uint32_t(num_threads);
+}
+
+uint32_t ReadInactiveChunksUpdatePeriod(Settings& settings)
+{
+	// 1 means updating all chunks in each tick.
+	const int32_t period= std::max(1, std::min(int32_t(settings.GetOrSetInt("g_inactive_chunks_update_period", 16)), 256));
+	settings.SetInt("g_inactive_chunks_update_period", period);
+
+	return uint32_t(period);
+}
+
+bool ReadChunkLightPrecompute(Settings& settings)
+{
+	// Disabled by default, since it makes chunks decompression much slower.
+	const bool enabled= settings.GetOrSetInt("g_chunk_light_precompute", 0) != 0;
+	settings.SetInt("g_chunk_light_precompute", enabled ? 1 : 0);
+
+	return enabled;
+}
+
+ChunkCodec ReadChunkCodec(Settings& settings)
+{
+	const std::string_view codec_name= settings.GetOrSetString("g_chunk_codec", ChunkCodecToString(ChunkCodec::Snappy));
+	if(const auto codec= StringToChunkCodec(codec_name))
+		return *codec;
+
+	Log::Warning("Unknown chunk codec \"", codec_name, "\"");
+	settings.SetString("g_chunk_codec", ChunkCodecToString(ChunkCodec::Snappy));
+	return ChunkCodec::Snappy;
+}
+
 WorldSizeChunks ReadWorldSize(Settings& settings)
 {
 	// Round world size up to next even number.
@@ -174,6 +238,27 @@ WorldSizeChunks ReadWorldSize(Settings& settings)
 	return WorldSizeChunks{uint32_t(world_size_x), uint32_t(world_size_y)};
 }
 
+ChunkDataCompresed CompressChunkData(
+	const ChunkCodec codec,
+	const BlockType* const blocks_data,
+	const uint8_t* const blocks_auxiliar_data,
+	const ZstdDictionary* const zstd_dictionary)
+{
+	// Compressor isn't thread-safe, so, use separate compressor for each thread.
+	thread_local ChunkDataCompressor compressor;
+	return compressor.Compress(codec, blocks_data, blocks_auxiliar_data, zstd_dictionary);
+}
+
+bool DecompressChunkData(
+	const ChunkDataCompresedView& data_compressed,
+	BlockType* const blocks_data,
+	uint8_t* const blocks_auxiliar_data,
+	const ZstdDictionary* const zstd_dictionary)
+{
+	thread_local ChunkDataCompressor compressor;
+	return compressor.Decompress(data_compressed, blocks_data, blocks_auxiliar_data, zstd_dictionary);
+}
+
 ComputePipeline CreateChunkGenPreparePipeline(const vk::Device vk_device)
 {
 	ComputePipeline pipeline;
@@ -269,6 +354,13 @@ ComputePipeline CreateWorldGenPipeline(const vk::Device vk_device)
 			vk::ShaderStageFlagBits::eCompute,
 			nullptr,
 		},
+		{
+			WorldGenShaderBindings::chunks_modified_flags_buffer,
+			vk::DescriptorType::eStorageBuffer,
+			1u,
+			vk::ShaderStageFlagBits::eCompute,
+			nullptr,
+		},
 	};
 
 	pipeline.descriptor_set_layout= vk_device.createDescriptorSetLayoutUnique(
@@ -337,11 +429,14 @@ ComputePipeline CreateInitialLightFillPipeline(const vk::Device vk_device)
 	return pipeline;
 }
 
-ComputePipeline CreateWorldBlocksUpdatePipeline(const vk::Device vk_device)
+ComputePipeline CreateWorldBlocksUpdatePipeline(const vk::Device vk_device, const bool use_shared_memory_tile)
 {
 	ComputePipeline pipeline;
 
-	pipeline.shader= CreateShader(vk_device, ShaderNames::world_blocks_update_comp);
+	// Both shader variants have identical interface and produce identical results.
+	pipeline.shader= CreateShader(
+		vk_device,
+		use_shared_memory_tile ? ShaderNames::world_blocks_update_tiled_comp : ShaderNames::world_blocks_update_comp);
 
 	const vk::DescriptorSetLayoutBinding descriptor_set_layout_bindings[]
 	{
@@ -387,6 +482,27 @@ ComputePipeline CreateWorldBlocksUpdatePipeline(const vk::Device vk_device)
 			vk::ShaderStageFlagBits::eCompute,
 			nullptr,
 		},
+		{
+			WorldBlocksUpdateShaderBindings::chunks_modified_flags_buffer,
+			vk::DescriptorType::eStorageBuffer,
+			1u,
+			vk::ShaderStageFlagBits::eCompute,
+			nullptr,
+		},
+		{
+			WorldBlocksUpdateShaderBindings::chunks_to_update_list_buffer,
+			vk::DescriptorType::eStorageBuffer,
+			1u,
+			vk::ShaderStageFlagBits::eCompute,
+			nullptr,
+		},
+		{
+			WorldBlocksUpdateShaderBindings::chunks_changed_flags_buffer,
+			vk::DescriptorType::eStorageBuffer,
+			1u,
+			vk::ShaderStageFlagBits::eCompute,
+			nullptr,
+		},
 	};
 
 	pipeline.descriptor_set_layout= vk_device.createDescriptorSetLayoutUnique(
@@ -439,6 +555,20 @@ ComputePipeline CreateLightUpdatePipeline(const vk::Device vk_device)
 			vk::ShaderStageFlagBits::eCompute,
 			nullptr,
 		},
+		{
+			LightUpdateShaderBindings::chunks_to_update_list_buffer,
+			vk::DescriptorType::eStorageBuffer,
+			1u,
+			vk::ShaderStageFlagBits::eCompute,
+			nullptr,
+		},
+		{
+			LightUpdateShaderBindings::chunks_changed_flags_buffer,
+			vk::DescriptorType::eStorageBuffer,
+			1u,
+			vk::ShaderStageFlagBits::eCompute,
+			nullptr,
+		},
 	};
 
 	pipeline.descriptor_set_layout= vk_device.createDescriptorSetLayoutUnique(
@@ -609,6 +739,20 @@ ComputePipeline CreateWorldBlocksExternalUpdateQueueFlushPipeline(const vk::Devi
 			vk::ShaderStageFlagBits::eCompute,
 			nullptr,
 		},
+		{
+			WorldBlocksExternalUpdateQueueFlushShaderBindigns::chunks_modified_flags_buffer,
+			vk::DescriptorType::eStorageBuffer,
+			1u,
+			vk::ShaderStageFlagBits::eCompute,
+			nullptr,
+		},
+		{
+			WorldBlocksExternalUpdateQueueFlushShaderBindigns::chunks_changed_flags_buffer,
+			vk::DescriptorType::eStorageBuffer,
+			1u,
+			vk::ShaderStageFlagBits::eCompute,
+			nullptr,
+		},
 	};
 
 	pipeline.descriptor_set_layout= vk_device.createDescriptorSetLayoutUnique(
@@ -686,6 +830,32 @@ Buffer CreateLightBuffer(WindowVulkan& window_vulkan, const WorldSizeChunks& wor
 		vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst);
 }
 
+Buffer CreateChunksModifiedFlagsBuffer(WindowVulkan& window_vulkan, const WorldSizeChunks& world_size)
+{
+	return Buffer(
+		window_vulkan,
+		sizeof(uint32_t) * world_size[0] * world_size[1],
+		vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eTransferSrc);
+}
+
+Buffer CreateChunksChangedFlagsBuffer(WindowVulkan& window_vulkan, const WorldSizeChunks& world_size)
+{
+	// Two sets of flags of all kinds - for previous and current ticks.
+	return Buffer(
+		window_vulkan,
+		sizeof(uint32_t) * world_size[0] * world_size[1] * c_chunks_changed_flags_num_kinds * 2,
+		vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eTransferSrc);
+}
+
+Buffer CreateChunksModifiedFlagsDownloadBuffer(WindowVulkan& window_vulkan, const WorldSizeChunks& world_size)
+{
+	return Buffer(
+		window_vulkan,
+		sizeof(uint32_t) * world_size[0] * world_size[1],
+		vk::BufferUsageFlagBits::eTransferDst,
+		vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCached);
+}
+
 Buffer CreateChunkDataLoadBuffer(WindowVulkan& window_vulkan, const WorldSizeChunks& world_size)
 {
 	return Buffer(
@@ -698,6 +868,30 @@ Buffer CreateChunkDataLoadBuffer(WindowVulkan& window_vulkan, const WorldSizeChu
 		vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCached);
 }
 
+// Range of given chunk in chunk data, auxiliar data or light buffer.
+TaskOrganizer::BufferRange GetChunkBufferRange(const vk::Buffer buffer, const uint32_t chunk_index)
+{
+	return TaskOrganizer::BufferRange(buffer, vk::DeviceSize(chunk_index) * c_chunk_volume, c_chunk_volume);
+}
+
+TaskOrganizer::BufferRange GetChunkModifiedFlagBufferRange(const vk::Buffer buffer, const uint32_t flag_index)
+{
+	return TaskOrganizer::BufferRange(buffer, vk::DeviceSize(flag_index) * sizeof(uint32_t), sizeof(uint32_t));
+}
+
+// Range of chunks changed flags of given tick of given kind (or all kinds, if kind isn't specified).
+TaskOrganizer::BufferRange GetChunksChangedFlagsBufferRange(
+	const vk::Buffer buffer,
+	const WorldSizeChunks& world_size,
+	const uint32_t tick,
+	const std::optional<uint32_t> kind= std::nullopt)
+{
+	const vk::DeviceSize num_chunks= world_size[0] * world_size[1];
+	const vk::DeviceSize offset= ((tick & 1) * c_chunks_changed_flags_num_kinds + kind.value_or(0)) * num_chunks;
+	const vk::DeviceSize size= kind == std::nullopt ? num_chunks * c_chunks_changed_flags_num_kinds : num_chunks;
+	return TaskOrganizer::BufferRange(buffer, offset * sizeof(uint32_t), size * sizeof(uint32_t));
+}
+
 } // namespace
 
 WorldProcessor::WorldProcessor(
@@ -710,6 +904,10 @@ WorldProcessor::WorldProcessor(
 	, queue_(window_vulkan.GetQueue())
 	, world_size_(ReadWorldSize(settings))
 	, world_seed_(int32_t(settings.GetOrSetInt("g_world_seed")))
+	, chunk_codec_(ReadChunkCodec(settings))
+	, inactive_chunks_update_period_(ReadInactiveChunksUpdatePeriod(settings))
+	, world_blocks_update_use_shared_memory_tile_(settings.GetOrSetInt("g_world_blocks_update_shared_memory_tile", 0) != 0)
+	, chunk_light_precompute_(ReadChunkLightPrecompute(settings))
 	, structures_buffer_(window_vulkan, gpu_data_uploader, GenStructures())
 	, tree_map_buffer_(
 		window_vulkan,
@@ -729,6 +927,9 @@ WorldProcessor::WorldProcessor(
 	, chunk_data_load_buffer_mapped_(chunk_data_load_buffer_.Map(vk_device_))
 	, chunk_auxiliar_data_load_buffer_(CreateChunkDataLoadBuffer(window_vulkan, world_size_))
 	, chunk_auxiliar_data_load_buffer_mapped_(chunk_auxiliar_data_load_buffer_.Map(vk_device_))
+	, chunks_modified_flags_buffer_(CreateChunksModifiedFlagsBuffer(window_vulkan, world_size_))
+	, chunks_modified_flags_download_buffer_(CreateChunksModifiedFlagsDownloadBuffer(window_vulkan, world_size_))
+	, chunks_modified_flags_download_buffer_mapped_(chunks_modified_flags_download_buffer_.Map(vk_device_))
 	, light_buffers_{
 		CreateLightBuffer(window_vulkan, world_size_),
 		CreateLightBuffer(window_vulkan, world_size_)}
@@ -736,6 +937,11 @@ WorldProcessor::WorldProcessor(
 		window_vulkan,
 		sizeof(WorldGlobalState),
 		vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst)
+	, chunks_to_update_list_buffer_(
+		window_vulkan,
+		sizeof(ChunkToUpdate) * world_size_[0] * world_size_[1],
+		vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst)
+	, chunks_changed_flags_buffer_(CreateChunksChangedFlagsBuffer(window_vulkan, world_size_))
 	, player_state_buffer_(
 		window_vulkan,
 		sizeof(PlayerState),
@@ -748,7 +954,8 @@ WorldProcessor::WorldProcessor(
 		window_vulkan,
 		sizeof(PlayerWorldWindow),
 		vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst)
-	, player_state_read_back_buffer_num_frames_(uint32_t(window_vulkan.GetNumCommandBuffers()))
+	, num_frames_in_flight_(uint32_t(window_vulkan.GetNumCommandBuffers()))
+	, player_state_read_back_buffer_num_frames_(num_frames_in_flight_)
 	, player_state_read_back_buffer_(
 		window_vulkan,
 		sizeof(PlayerState) * player_state_read_back_buffer_num_frames_,
@@ -766,7 +973,7 @@ WorldProcessor::WorldProcessor(
 	, initial_light_fill_descriptor_sets_{
 		CreateDescriptorSet(vk_device_, global_descriptor_pool, *initial_light_fill_pipeline_.descriptor_set_layout),
 		CreateDescriptorSet(vk_device_, global_descriptor_pool, *initial_light_fill_pipeline_.descriptor_set_layout)}
-	, world_blocks_update_pipeline_(CreateWorldBlocksUpdatePipeline(vk_device_))
+	, world_blocks_update_pipeline_(CreateWorldBlocksUpdatePipeline(vk_device_, world_blocks_update_use_shared_memory_tile_))
 	, world_blocks_update_descriptor_sets_{
 		CreateDescriptorSet(vk_device_, global_descriptor_pool, *world_blocks_update_pipeline_.descriptor_set_layout),
 		CreateDescriptorSet(vk_device_, global_descriptor_pool, *world_blocks_update_pipeline_.descriptor_set_layout)}
@@ -805,6 +1012,7 @@ WorldProcessor::WorldProcessor(
 			*world_global_state_update_pipeline_.descriptor_set_layout))
 	, chunk_data_download_event_(vk_device_.createEventUnique(vk::EventCreateInfo()))
 	, chunks_storage_(settings)
+	, chunks_processing_thread_pool_(ReadNumWorkerThreads(settings))
 	, world_offset_{-int32_t(world_size_[0] / 2u), -int32_t(world_size_[1] / 2u)}
 	, next_world_offset_(world_offset_)
 	, next_next_world_offset_(next_world_offset_)
@@ -812,9 +1020,22 @@ WorldProcessor::WorldProcessor(
 	HEX_ASSERT(player_state_read_back_buffer_num_frames_ > 0);
 
 	Log::Info("World seed: ", world_seed_);
+	Log::Info("Chunks processing threads: ", chunks_processing_thread_pool_.GetNumThreads());
+	Log::Info("Chunk codec: ", ChunkCodecToString(chunk_codec_));
+	Log::Info("Inactive chunks update period: ", inactive_chunks_update_period_);
+	if(world_blocks_update_use_shared_memory_tile_)
+		Log::Info("Use shared memory tile for world blocks update");
 
 	chunks_storage_.SetActiveArea(world_offset_, world_size_);
 
+	if(chunk_light_precompute_)
+	{
+		Log::Info("Chunks light precomputation is enabled");
+
+		chunk_light_load_buffer_.emplace(CreateChunkDataLoadBuffer(window_vulkan, world_size_));
+		chunk_light_load_buffer_mapped_= chunk_light_load_buffer_->Map(vk_device_);
+	}
+
 	// Update chunk gen prepare descriptor set.
 	{
 		const vk::DescriptorBufferInfo descriptor_chunk_gen_info_buffer(
@@ -896,6 +1117,11 @@ WorldProcessor::WorldProcessor(
 			0u,
 			chunk_auxiliar_data_buffers_[i].GetSize());
 
+		const vk::DescriptorBufferInfo descriptor_chunks_modified_flags_buffer_info(
+			chunks_modified_flags_buffer_.GetBuffer(),
+			0u,
+			chunks_modified_flags_buffer_.GetSize());
+
 		vk_device_.updateDescriptorSets(
 			{
 				{
@@ -948,6 +1174,16 @@ WorldProcessor::WorldProcessor(
 					&descriptor_chunk_auxiliar_data_buffer_info,
 					nullptr
 				},
+				{
+					world_gen_descriptor_sets_[i],
+					WorldGenShaderBindings::chunks_modified_flags_buffer,
+					0u,
+					1u,
+					vk::DescriptorType::eStorageBuffer,
+					nullptr,
+					&descriptor_chunks_modified_flags_buffer_info,
+					nullptr
+				},
 			},
 			{});
 	}
@@ -1024,6 +1260,21 @@ WorldProcessor::WorldProcessor(
 			0u,
 			world_global_state_buffer_.GetSize());
 
+		const vk::DescriptorBufferInfo descriptor_chunks_modified_flags_buffer_info(
+			chunks_modified_flags_buffer_.GetBuffer(),
+			0u,
+			chunks_modified_flags_buffer_.GetSize());
+
+		const vk::DescriptorBufferInfo descriptor_chunks_to_update_list_buffer_info(
+			chunks_to_update_list_buffer_.GetBuffer(),
+			0u,
+			chunks_to_update_list_buffer_.GetSize());
+
+		const vk::DescriptorBufferInfo descriptor_chunks_changed_flags_buffer_info(
+			chunks_changed_flags_buffer_.GetBuffer(),
+			0u,
+			chunks_changed_flags_buffer_.GetSize());
+
 		vk_device_.updateDescriptorSets(
 			{
 				{
@@ -1086,6 +1337,36 @@ WorldProcessor::WorldProcessor(
 					&world_global_state_buffer_info,
 					nullptr
 				},
+				{
+					world_blocks_update_descriptor_sets_[i],
+					WorldBlocksUpdateShaderBindings::chunks_modified_flags_buffer,
+					0u,
+					1u,
+					vk::DescriptorType::eStorageBuffer,
+					nullptr,
+					&descriptor_chunks_modified_flags_buffer_info,
+					nullptr
+				},
+				{
+					world_blocks_update_descriptor_sets_[i],
+					WorldBlocksUpdateShaderBindings::chunks_to_update_list_buffer,
+					0u,
+					1u,
+					vk::DescriptorType::eStorageBuffer,
+					nullptr,
+					&descriptor_chunks_to_update_list_buffer_info,
+					nullptr
+				},
+				{
+					world_blocks_update_descriptor_sets_[i],
+					WorldBlocksUpdateShaderBindings::chunks_changed_flags_buffer,
+					0u,
+					1u,
+					vk::DescriptorType::eStorageBuffer,
+					nullptr,
+					&descriptor_chunks_changed_flags_buffer_info,
+					nullptr
+				},
 			},
 			{});
 	}
@@ -1108,6 +1389,16 @@ WorldProcessor::WorldProcessor(
 			0u,
 			light_buffers_[i ^ 1].GetSize());
 
+		const vk::DescriptorBufferInfo descriptor_chunks_to_update_list_buffer_info(
+			chunks_to_update_list_buffer_.GetBuffer(),
+			0u,
+			chunks_to_update_list_buffer_.GetSize());
+
+		const vk::DescriptorBufferInfo descriptor_chunks_changed_flags_buffer_info(
+			chunks_changed_flags_buffer_.GetBuffer(),
+			0u,
+			chunks_changed_flags_buffer_.GetSize());
+
 		vk_device_.updateDescriptorSets(
 			{
 				{
@@ -1140,6 +1431,26 @@ WorldProcessor::WorldProcessor(
 					&descriptor_output_light_data_buffer_info,
 					nullptr
 				},
+				{
+					light_update_descriptor_sets_[i],
+					LightUpdateShaderBindings::chunks_to_update_list_buffer,
+					0u,
+					1u,
+					vk::DescriptorType::eStorageBuffer,
+					nullptr,
+					&descriptor_chunks_to_update_list_buffer_info,
+					nullptr
+				},
+				{
+					light_update_descriptor_sets_[i],
+					LightUpdateShaderBindings::chunks_changed_flags_buffer,
+					0u,
+					1u,
+					vk::DescriptorType::eStorageBuffer,
+					nullptr,
+					&descriptor_chunks_changed_flags_buffer_info,
+					nullptr
+				},
 			},
 			{});
 	}
@@ -1299,6 +1610,16 @@ WorldProcessor::WorldProcessor(
 			0u,
 			chunk_auxiliar_data_buffers_[i].GetSize());
 
+		const vk::DescriptorBufferInfo descriptor_chunks_modified_flags_buffer_info(
+			chunks_modified_flags_buffer_.GetBuffer(),
+			0u,
+			chunks_modified_flags_buffer_.GetSize());
+
+		const vk::DescriptorBufferInfo descriptor_chunks_changed_flags_buffer_info(
+			chunks_changed_flags_buffer_.GetBuffer(),
+			0u,
+			chunks_changed_flags_buffer_.GetSize());
+
 		vk_device_.updateDescriptorSets(
 			{
 				{
@@ -1331,6 +1652,26 @@ WorldProcessor::WorldProcessor(
 					&descriptor_chunk_auxiliar_data_buffer_info,
 					nullptr
 				},
+				{
+					world_blocks_external_update_queue_flush_descriptor_sets_[i],
+					WorldBlocksExternalUpdateQueueFlushShaderBindigns::chunks_modified_flags_buffer,
+					0u,
+					1u,
+					vk::DescriptorType::eStorageBuffer,
+					nullptr,
+					&descriptor_chunks_modified_flags_buffer_info,
+					nullptr
+				},
+				{
+					world_blocks_external_update_queue_flush_descriptor_sets_[i],
+					WorldBlocksExternalUpdateQueueFlushShaderBindigns::chunks_changed_flags_buffer,
+					0u,
+					1u,
+					vk::DescriptorType::eStorageBuffer,
+					nullptr,
+					&descriptor_chunks_changed_flags_buffer_info,
+					nullptr
+				},
 			},
 			{});
 	}
@@ -1364,6 +1705,12 @@ WorldProcessor::~WorldProcessor()
 	// Wait for all commands to be finished.
 	vk_device_.waitIdle();
 
+	// Finish background compression/decompression before overwriting the load buffer.
+	EnsureChunksCompressionFinished();
+	for(const std::future<bool>& task : chunks_decompression_tasks_)
+		task.wait();
+	chunks_decompression_tasks_.clear();
+
 	// Download all chunk data in order to save it.
 
 	// Create one-time command buffer. TODO - avoid this?
@@ -1388,6 +1735,11 @@ WorldProcessor::~WorldProcessor()
 		chunk_auxiliar_data_load_buffer_.GetBuffer(),
 		{{0, 0, chunk_auxiliar_data_load_buffer_.GetSize()}});
 
+	command_buffer->copyBuffer(
+		chunks_modified_flags_buffer_.GetBuffer(),
+		chunks_modified_flags_download_buffer_.GetBuffer(),
+		{{0, 0, chunks_modified_flags_download_buffer_.GetSize()}});
+
 	command_buffer->end();
 
 	const vk::PipelineStageFlags wait_dst_stage_mask= vk::PipelineStageFlagBits::eTransfer;
@@ -1407,35 +1759,59 @@ WorldProcessor::~WorldProcessor()
 	{
 		{chunk_data_load_buffer_.GetMemory(), 0, chunk_data_load_buffer_.GetSize()},
 		{chunk_auxiliar_data_load_buffer_.GetMemory(), 0, chunk_auxiliar_data_load_buffer_.GetSize()},
+		{chunks_modified_flags_download_buffer_.GetMemory(), 0, chunks_modified_flags_download_buffer_.GetSize()},
 	};
 	vk_device_.invalidateMappedMemoryRanges(uint32_t(std::size(mapped_memory_ranges)), mapped_memory_ranges);
 
-	// Compress and store chunks data.
+	const auto modified_flags= static_cast<const uint32_t*>(chunks_modified_flags_download_buffer_mapped_);
+
+	// Compress chunks data in parallel. Skip chunks which are identical to their stored versions.
 	for(uint32_t y= 0; y < world_size_[1]; ++y)
 	for(uint32_t x= 0; x < world_size_[0]; ++x)
 	{
+		const ChunksStorage::ChunkCoord chunk_coord{int32_t(x) + world_offset_[0], int32_t(y) + world_offset_[1]};
+		if(modified_flags[GetChunkModifiedFlagIndex(chunk_coord)] == 0)
+			continue;
+
 		const uint32_t chunk_index= x + y * world_size_[0];
 		const uint32_t offset= chunk_index * c_chunk_volume;
 
-		chunks_storage_.SetChunk(
-			{
-				int32_t(x) + world_offset_[0],
-				int32_t(y) + world_offset_[1]
-			},
-			chunk_data_compressor_.Compress(
-				static_cast<const BlockType*>(chunk_data_load_buffer_mapped_) + offset,
-				static_cast<const uint8_t*>(chunk_auxiliar_data_load_buffer_mapped_) + offset));
+		ChunkCompressionTask task;
+		task.chunk_coord= chunk_coord;
+		task.chunk_index= chunk_index;
+		task.future=
+			chunks_processing_thread_pool_.Submit(
+				[
+					codec= chunk_codec_,
+					zstd_dictionary= chunks_storage_.GetZstdDictionary(),
+					blocks_data= static_cast<const BlockType*>(chunk_data_load_buffer_mapped_) + offset,
+					blocks_auxiliar_data= static_cast<const uint8_t*>(chunk_auxiliar_data_load_buffer_mapped_) + offset
+				]
+				{
+					return CompressChunkData(codec, blocks_data, blocks_auxiliar_data, zstd_dictionary.get());
+				});
+
+		chunks_compression_tasks_.push_back(std::move(task));
 	}
 
+	// Store chunks data.
+	EnsureChunksCompressionFinished();
+
 	// Unmap remaining buffers.
 	chunk_data_load_buffer_.Unmap(vk_device_);
 	chunk_auxiliar_data_load_buffer_.Unmap(vk_device_);
+	chunks_modified_flags_download_buffer_.Unmap(vk_device_);
+	if(chunk_light_load_buffer_ != std::nullopt)
+		chunk_light_load_buffer_->Unmap(vk_device_);
+	if(tick_data_read_back_buffer_ != std::nullopt)
+		tick_data_read_back_buffer_->Unmap(vk_device_);
 
 	player_state_read_back_buffer_.Unmap(vk_device_);
 }
 
 void WorldProcessor::Update(
 	TaskOrganizer& task_organizer,
+	TaskOrganizer& simulation_task_organizer,
 	const float time_delta_s,
 	const KeyboardState keyboard_state,
 	const MouseState mouse_state,
@@ -1446,6 +1822,8 @@ void WorldProcessor::Update(
 {
 	InitialFillBuffers(task_organizer);
 
+	TakeFinishedChunksCompressionResults();
+
 	ReadBackAndProcessPlayerState();
 
 	const RelativeWorldShiftChunks relative_shift
@@ -1477,9 +1855,14 @@ void WorldProcessor::Update(
 		const float cur_offset_within_tick= std::min(1.0f, cur_tick_fractional - float(current_tick_));
 		BuildCurrentFrameChunksToUpdateList(prev_offset_within_tick, cur_offset_within_tick);
 
-		UpdateWorldBlocks(task_organizer, relative_shift);
-		UpdateLight(task_organizer, relative_shift);
-		GenerateWorld(task_organizer, relative_shift);
+		// Record these tasks deferred in order to merge barriers of independent tasks,
+		// like generation of new chunks and update of other chunks.
+		simulation_task_organizer.BeginDeferredRecording();
+		UploadChunksToUpdateList(simulation_task_organizer, relative_shift);
+		UpdateWorldBlocks(simulation_task_organizer, relative_shift);
+		UpdateLight(simulation_task_organizer, relative_shift);
+		GenerateWorld(simulation_task_organizer, relative_shift);
+		simulation_task_organizer.EndDeferredRecording();
 		// No need to synchronize world blocks and lighting update here.
 		// Add a barier only at the beginning of next tick.
 	}
@@ -1490,11 +1873,21 @@ void WorldProcessor::Update(
 		!wait_for_chunks_data_download_;
 
 	// Switch to the next tick (if necessary).
-	if(current_tick_ == 0 || is_time_to_switch_to_next_tick)
+	new_tick_started_in_last_update_= current_tick_ == 0 || is_time_to_switch_to_next_tick;
+	if(new_tick_started_in_last_update_)
 	{
+		// Do this before world offset change and external blocks update.
+		if(current_tick_ > 0)
+			ScheduleTickDataReadBack(task_organizer, relative_shift);
+
 		world_offset_= next_world_offset_;
 		next_world_offset_= next_next_world_offset_;
 
+		// Make sure all chunks downloaded in previous tick are in the storage before regions saving/loading.
+		// Normally compression is already finished at this point, since it takes much less time than a tick.
+		// Also this is needed in order to free the load buffer before new downloading.
+		EnsureChunksCompressionFinished();
+
 		chunks_storage_.SetActiveArea(world_offset_, world_size_);
 
 		FlushWorldBlocksExternalUpdateQueue(task_organizer);
@@ -1502,6 +1895,8 @@ void WorldProcessor::Update(
 		++current_tick_;
 		current_tick_fractional_= float(current_tick_);
 
+		PrepareChunksActivityTracking(task_organizer);
+
 		BuildPlayerWorldWindow(task_organizer);
 
 		// Update world global state once in a tick.
@@ -1578,11 +1973,80 @@ uint32_t WorldProcessor::GetActualBuffersIndex() const
 	return GetSrcBufferIndex();
 }
 
+uint32_t WorldProcessor::GetCurrentTick() const
+{
+	return current_tick_;
+}
+
+bool WorldProcessor::IsNewTickStartedInLastUpdate() const
+{
+	return new_tick_started_in_last_update_;
+}
+
 const WorldProcessor::PlayerState* WorldProcessor::GetLastKnownPlayerState() const
 {
 	return last_known_player_state_ == std::nullopt ? nullptr : &*last_known_player_state_;
 }
 
+WorldProcessor::ChunksDecompressionStats WorldProcessor::GetChunksDecompressionStats() const
+{
+	ChunksDecompressionStats stats;
+	stats.num_queued= chunks_decompression_counters_.num_queued;
+	stats.num_in_progress= chunks_decompression_counters_.num_in_progress;
+	stats.num_completed= chunks_decompression_counters_.num_completed;
+
+	if(stats.num_completed > 0)
+	{
+		stats.average_time_ns= chunks_decompression_counters_.total_time_ns / stats.num_completed;
+		stats.average_light_time_ns= chunks_decompression_counters_.light_total_time_ns / stats.num_completed;
+	}
+
+	return stats;
+}
+
+void WorldProcessor::EnableTickDataReadBack(WindowVulkan& window_vulkan)
+{
+	if(tick_data_read_back_buffer_ != std::nullopt)
+		return;
+
+	// Read back input and output chunks data, input and output light, world global state and chunks changed flags.
+	tick_data_read_back_buffer_.emplace(
+		window_vulkan,
+		c_chunk_volume * world_size_[0] * world_size_[1] * 6 + sizeof(WorldGlobalState) + chunks_changed_flags_buffer_.GetSize(),
+		vk::BufferUsageFlagBits::eTransferDst,
+		vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+	tick_data_read_back_buffer_mapped_= tick_data_read_back_buffer_->Map(vk_device_);
+}
+
+std::optional<WorldBlocksUpdateValidationData> WorldProcessor::TakeTickDataReadBack()
+{
+	if(pending_tick_data_read_back_ == std::nullopt)
+		return std::nullopt;
+
+	// Frame counter is already incremented for the frame with copy commands.
+	// Its command buffer is reused (and thus is finished) in the frame "num_frames_in_flight_" frames later.
+	if(current_frame_ <= pending_tick_data_read_back_frame_ + num_frames_in_flight_)
+		return std::nullopt;
+
+	WorldBlocksUpdateValidationData data= std::move(*pending_tick_data_read_back_);
+	pending_tick_data_read_back_= std::nullopt;
+
+	const size_t world_volume= c_chunk_volume * world_size_[0] * world_size_[1];
+
+	WorldGlobalState world_global_state;
+	std::memcpy(
+		&world_global_state,
+		static_cast<const uint8_t*>(tick_data_read_back_buffer_mapped_) + world_volume * 6,
+		sizeof(WorldGlobalState));
+
+	data.sky_light_mask= world_global_state.sky_light_mask;
+	data.sky_light_based_wetness_mask= world_global_state.sky_light_based_wetness_mask;
+	data.snow_z_level= world_global_state.snow_z_level;
+	data.simulation_params_changed= world_global_state.simulation_params_changed != 0;
+
+	return data;
+}
+
 void WorldProcessor::InitialFillBuffers(TaskOrganizer& task_organizer)
 {
 	if(initial_buffers_filled_)
@@ -1590,6 +2054,7 @@ void WorldProcessor::InitialFillBuffers(TaskOrganizer& task_organizer)
 	initial_buffers_filled_= true;
 
 	TaskOrganizer::TransferTaskParams task;
+	task.name= "world_initial_fill_buffers";
 	task.output_buffers.push_back(tree_map_buffer_.GetBuffer());
 	task.output_buffers.push_back(chunk_gen_info_buffer_.GetBuffer());
 	task.output_buffers.push_back(chunk_data_buffers_[0].GetBuffer());
@@ -1603,10 +2068,14 @@ void WorldProcessor::InitialFillBuffers(TaskOrganizer& task_organizer)
 	task.output_buffers.push_back(player_world_window_buffer_.GetBuffer());
 	task.output_buffers.push_back(player_state_read_back_buffer_.GetBuffer());
 	task.output_buffers.push_back(world_global_state_buffer_.GetBuffer());
+	task.output_buffers.push_back(chunks_modified_flags_buffer_.GetBuffer());
+	task.output_buffers.push_back(chunks_changed_flags_buffer_.GetBuffer());
 
 	const auto task_func=
 		[this](const vk::CommandBuffer command_buffer)
 		{
+			command_buffer.fillBuffer(chunks_changed_flags_buffer_.GetBuffer(), 0, chunks_changed_flags_buffer_.GetSize(), 0);
+
 			{
 				const TreeMap tree_map= GenTreeMap(world_seed_);
 				command_buffer.updateBuffer(
@@ -1651,6 +2120,9 @@ void WorldProcessor::InitialFillBuffers(TaskOrganizer& task_organizer)
 
 			// Fill this buffer just to prevent some mistakes.
 			command_buffer.fillBuffer(world_global_state_buffer_.GetBuffer(), 0, world_global_state_buffer_.GetSize(), 0);
+
+			// Initially consider all chunks modified. Flags are reset for chunks uploaded from the storage.
+			command_buffer.fillBuffer(chunks_modified_flags_buffer_.GetBuffer(), 0, chunks_modified_flags_buffer_.GetSize(), 1);
 		};
 
 	task_organizer.ExecuteTask(task, task_func);
@@ -1711,7 +2183,7 @@ void WorldProcessor::InitialFillWorld(TaskOrganizer& task_organizer)
 	{
 		const uint32_t chunk_index= x + y * world_size_[0];
 
-		if(chunks_storage_.GetChunk({int32_t(x) + world_offset_[0], int32_t(y) + world_offset_[1]}) != nullptr)
+		if(GetStoredChunk({int32_t(x) + world_offset_[0], int32_t(y) + world_offset_[1]}) != std::nullopt)
 			chunks_upate_kind_[chunk_index]= ChunkUpdateKind::Upload;
 		else
 			chunks_upate_kind_[chunk_index]= ChunkUpdateKind::Generate;
@@ -1746,14 +2218,20 @@ void WorldProcessor::DetermineChunksUpdateKind(const RelativeWorldShiftChunks re
 			chunks_upate_kind_[chunk_index]= ChunkUpdateKind::Update;
 		else
 		{
-			if(chunks_storage_.GetChunk({
+			if(GetStoredChunk({
 				int32_t(x) + world_offset_[0] + int32_t(relative_world_shift[0]),
-				int32_t(y) + world_offset_[1] + int32_t(relative_world_shift[1])}) != nullptr)
+				int32_t(y) + world_offset_[1] + int32_t(relative_world_shift[1])}) != std::nullopt)
 				chunks_upate_kind_[chunk_index]= ChunkUpdateKind::Upload;
 			else
 				chunks_upate_kind_[chunk_index]= ChunkUpdateKind::Generate;
 		}
 	}
+
+	// Start decompression of chunks to upload as early as possible - while downloading is still in progress.
+	// But do this only if the GPU doesn't read the load buffer for the previous upload anymore.
+	if(wait_for_chunks_data_download_ &&
+		current_frame_ >= last_chunks_upload_frame_ + num_frames_in_flight_)
+		StartChunksDecompression();
 }
 
 void WorldProcessor::BuildCurrentFrameChunksToUpdateList(
@@ -1779,6 +2257,7 @@ void WorldProcessor::BuildCurrentFrameChunksToUpdateList(
 void WorldProcessor::UpdateWorldGlobalState(TaskOrganizer& task_organizer, const DebugParams& debug_params)
 {
 	TaskOrganizer::ComputeTaskParams task;
+	task.name= "world_global_state_update";
 	task.input_output_storage_buffers.push_back(world_global_state_buffer_.GetBuffer());
 
 	const auto task_func=
@@ -1812,25 +2291,204 @@ void WorldProcessor::UpdateWorldGlobalState(TaskOrganizer& task_organizer, const
 	task_organizer.ExecuteTask(task, task_func);
 }
 
-void WorldProcessor::UpdateWorldBlocks(
+void WorldProcessor::UploadChunksToUpdateList(
 	TaskOrganizer& task_organizer,
 	const RelativeWorldShiftChunks relative_world_shift)
 {
-	const uint32_t src_buffer_index= GetSrcBufferIndex();
-	const uint32_t dst_buffer_index= GetDstBufferIndex();
+	// Upload list of chunks for world blocks and light update.
+	// Both updates use the same list and process all its chunks via single dispatch.
 
-	TaskOrganizer::ComputeTaskParams task;
-	task.input_storage_buffers.push_back(chunk_data_buffers_[src_buffer_index].GetBuffer());
-	task.input_storage_buffers.push_back(chunk_auxiliar_data_buffers_[src_buffer_index].GetBuffer());
-	task.input_storage_buffers.push_back(light_buffers_[src_buffer_index].GetBuffer());
-	task.input_storage_buffers.push_back(world_global_state_buffer_.GetBuffer());
-	task.output_storage_buffers.push_back(chunk_data_buffers_[dst_buffer_index].GetBuffer());
-	task.output_storage_buffers.push_back(chunk_auxiliar_data_buffers_[dst_buffer_index].GetBuffer());
+	std::vector<ChunkToUpdate> chunks_to_update;
+	chunks_to_update.reserve(current_frame_chunks_to_update_list_.size());
+
+	for(const auto& chunk_to_update : current_frame_chunks_to_update_list_)
+	{
+		const uint32_t chunk_index= chunk_to_update[0] + chunk_to_update[1] * world_size_[0];
+		if(chunks_upate_kind_[chunk_index] != ChunkUpdateKind::Update)
+			continue;
+
+		HEX_ASSERT(int32_t(chunk_to_update[0]) + relative_world_shift[0] >= 0);
+		HEX_ASSERT(int32_t(chunk_to_update[0]) + relative_world_shift[0] < int32_t(world_size_[0]));
+		HEX_ASSERT(int32_t(chunk_to_update[1]) + relative_world_shift[1] >= 0);
+		HEX_ASSERT(int32_t(chunk_to_update[1]) + relative_world_shift[1] < int32_t(world_size_[1]));
+
+		ChunkToUpdate out_chunk;
+		out_chunk.out_chunk_position[0]= int32_t(chunk_to_update[0]);
+		out_chunk.out_chunk_position[1]= int32_t(chunk_to_update[1]);
+		out_chunk.chunk_modified_flag_index= GetChunkModifiedFlagIndex({
+			int32_t(chunk_to_update[0]) + next_world_offset_[0],
+			int32_t(chunk_to_update[1]) + next_world_offset_[1]});
+		chunks_to_update.push_back(out_chunk);
+	}
+
+	current_frame_num_chunks_to_update_= uint32_t(chunks_to_update.size());
+	if(chunks_to_update.empty())
+		return;
+
+	const vk::DeviceSize data_size= sizeof(ChunkToUpdate) * chunks_to_update.size();
+	// This is a limit of "vkCmdUpdateBuffer".
+	// It isn't reached even with maximum world size.
+	HEX_ASSERT(data_size <= 65536);
+
+	TaskOrganizer::TransferTaskParams task;
+	task.name= "chunks_to_update_list_upload";
+	task.output_buffers.push_back(TaskOrganizer::BufferRange(chunks_to_update_list_buffer_.GetBuffer(), 0, data_size));
 
+	// Capture the list by value, since this task may be recorded deferred.
 	const auto task_func=
-		[this, src_buffer_index, relative_world_shift](const vk::CommandBuffer command_buffer)
+		[this, chunks_to_update= std::move(chunks_to_update), data_size](const vk::CommandBuffer command_buffer)
 		{
-			command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, *world_blocks_update_pipeline_.pipeline);
+			command_buffer.updateBuffer(
+				chunks_to_update_list_buffer_.GetBuffer(),
+				0,
+				data_size,
+				chunks_to_update.data());
+		};
+
+	task_organizer.ExecuteTask(task, task_func);
+}
+
+void WorldProcessor::ScheduleTickDataReadBack(
+	TaskOrganizer& task_organizer,
+	const RelativeWorldShiftChunks relative_world_shift)
+{
+	// Do not overwrite data which isn't taken yet. Skip this tick instead.
+	if(tick_data_read_back_buffer_ == std::nullopt || pending_tick_data_read_back_ != std::nullopt)
+		return;
+
+	// At the end of the tick all source buffers still contain input data of this tick
+	// and destination buffers contain results of all updates of this tick.
+	// Flags of the previous tick (used for chunks activity check) aren't overwritten yet.
+
+	const uint32_t src_buffer_index= GetSrcBufferIndex();
+	const uint32_t dst_buffer_index= GetDstBufferIndex();
+
+	const vk::Buffer read_back_buffer= tick_data_read_back_buffer_->GetBuffer();
+
+	TaskOrganizer::TransferTaskParams task;
+	task.name= "tick_data_read_back";
+	task.input_buffers.push_back(chunk_data_buffers_[src_buffer_index].GetBuffer());
+	task.input_buffers.push_back(chunk_auxiliar_data_buffers_[src_buffer_index].GetBuffer());
+	task.input_buffers.push_back(light_buffers_[src_buffer_index].GetBuffer());
+	task.input_buffers.push_back(chunk_data_buffers_[dst_buffer_index].GetBuffer());
+	task.input_buffers.push_back(chunk_auxiliar_data_buffers_[dst_buffer_index].GetBuffer());
+	task.input_buffers.push_back(light_buffers_[dst_buffer_index].GetBuffer());
+	task.input_buffers.push_back(world_global_state_buffer_.GetBuffer());
+	task.input_buffers.push_back(chunks_changed_flags_buffer_.GetBuffer());
+	task.output_buffers.push_back(read_back_buffer);
+
+	const auto task_func=
+		[this, src_buffer_index, dst_buffer_index, read_back_buffer](const vk::CommandBuffer command_buffer)
+		{
+			const vk::DeviceSize world_volume= c_chunk_volume * world_size_[0] * world_size_[1];
+
+			const vk::Buffer world_volume_buffers[]
+			{
+				chunk_data_buffers_[src_buffer_index].GetBuffer(),
+				chunk_auxiliar_data_buffers_[src_buffer_index].GetBuffer(),
+				light_buffers_[src_buffer_index].GetBuffer(),
+				chunk_data_buffers_[dst_buffer_index].GetBuffer(),
+				chunk_auxiliar_data_buffers_[dst_buffer_index].GetBuffer(),
+				light_buffers_[dst_buffer_index].GetBuffer(),
+			};
+
+			for(size_t i= 0; i < std::size(world_volume_buffers); ++i)
+				command_buffer.copyBuffer(world_volume_buffers[i], read_back_buffer, {{0, world_volume * i, world_volume}});
+
+			command_buffer.copyBuffer(
+				world_global_state_buffer_.GetBuffer(),
+				read_back_buffer,
+				{{0, world_volume * std::size(world_volume_buffers), sizeof(WorldGlobalState)}});
+
+			command_buffer.copyBuffer(
+				chunks_changed_flags_buffer_.GetBuffer(),
+				read_back_buffer,
+				{{
+					0,
+					world_volume * std::size(world_volume_buffers) + sizeof(WorldGlobalState),
+					chunks_changed_flags_buffer_.GetSize()
+				}});
+		};
+
+	task_organizer.ExecuteTask(task, task_func);
+
+	const size_t world_volume= c_chunk_volume * world_size_[0] * world_size_[1];
+	const uint8_t* const data= static_cast<const uint8_t*>(tick_data_read_back_buffer_mapped_);
+
+	WorldBlocksUpdateValidationData request;
+	request.world_size_chunks= world_size_;
+	request.tick= current_tick_;
+	request.relative_world_shift= relative_world_shift;
+	request.inactive_chunks_update_period= current_tick_inactive_chunks_update_period_;
+	request.chunks_updated.resize(chunks_upate_kind_.size());
+	for(size_t i= 0; i < chunks_upate_kind_.size(); ++i)
+	{
+		request.chunks_updated[i]= chunks_upate_kind_[i] == ChunkUpdateKind::Update;
+		if(chunks_upate_kind_[i] == ChunkUpdateKind::Upload)
+			request.chunks_uploaded= true;
+	}
+	request.input_blocks= data + world_volume * 0;
+	request.input_auxiliar_data= data + world_volume * 1;
+	request.input_light= data + world_volume * 2;
+	request.output_blocks= data + world_volume * 3;
+	request.output_auxiliar_data= data + world_volume * 4;
+	request.output_light= data + world_volume * 5;
+	request.chunks_changed_flags= reinterpret_cast<const uint32_t*>(data + world_volume * 6 + sizeof(WorldGlobalState));
+
+	pending_tick_data_read_back_= std::move(request);
+	pending_tick_data_read_back_frame_= current_frame_;
+}
+
+void WorldProcessor::UpdateWorldBlocks(
+	TaskOrganizer& task_organizer,
+	const RelativeWorldShiftChunks relative_world_shift)
+{
+	if(current_frame_num_chunks_to_update_ == 0)
+		return;
+
+	const uint32_t src_buffer_index= GetSrcBufferIndex();
+	const uint32_t dst_buffer_index= GetDstBufferIndex();
+
+	TaskOrganizer::ComputeTaskParams task;
+	// Use different names for shader variants in order to distinguish them in GPU time statistics.
+	task.name= world_blocks_update_use_shared_memory_tile_ ? "world_blocks_update_tiled" : "world_blocks_update";
+	task.input_storage_buffers.push_back(chunk_data_buffers_[src_buffer_index].GetBuffer());
+	task.input_storage_buffers.push_back(chunk_auxiliar_data_buffers_[src_buffer_index].GetBuffer());
+	task.input_storage_buffers.push_back(light_buffers_[src_buffer_index].GetBuffer());
+	task.input_storage_buffers.push_back(world_global_state_buffer_.GetBuffer());
+	task.input_storage_buffers.push_back(
+		TaskOrganizer::BufferRange(
+			chunks_to_update_list_buffer_.GetBuffer(),
+			0,
+			sizeof(ChunkToUpdate) * current_frame_num_chunks_to_update_));
+	task.input_storage_buffers.push_back(
+		GetChunksChangedFlagsBufferRange(chunks_changed_flags_buffer_.GetBuffer(), world_size_, current_tick_ - 1));
+	task.output_storage_buffers.push_back(
+		GetChunksChangedFlagsBufferRange(
+			chunks_changed_flags_buffer_.GetBuffer(), world_size_, current_tick_, c_chunks_changed_flags_kind_blocks));
+
+	// Each chunk update writes only data of this chunk.
+	// Specify exact ranges in order to avoid synchronization with other tasks accessing other chunks.
+	for(const auto& chunk_to_update : current_frame_chunks_to_update_list_)
+	{
+		const uint32_t chunk_index= chunk_to_update[0] + chunk_to_update[1] * world_size_[0];
+		if(chunks_upate_kind_[chunk_index] != ChunkUpdateKind::Update)
+			continue;
+
+		task.output_storage_buffers.push_back(GetChunkBufferRange(chunk_data_buffers_[dst_buffer_index].GetBuffer(), chunk_index));
+		task.output_storage_buffers.push_back(GetChunkBufferRange(chunk_auxiliar_data_buffers_[dst_buffer_index].GetBuffer(), chunk_index));
+		task.output_storage_buffers.push_back(
+			GetChunkModifiedFlagBufferRange(
+				chunks_modified_flags_buffer_.GetBuffer(),
+				GetChunkModifiedFlagIndex({
+					int32_t(chunk_to_update[0]) + next_world_offset_[0],
+					int32_t(chunk_to_update[1]) + next_world_offset_[1]})));
+	}
+
+	const auto task_func=
+		[this, src_buffer_index, relative_world_shift](const vk::CommandBuffer command_buffer)
+		{
+			command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, *world_blocks_update_pipeline_.pipeline);
 
 			command_buffer.bindDescriptorSets(
 				vk::PipelineBindPoint::eCompute,
@@ -1839,43 +2497,26 @@ void WorldProcessor::UpdateWorldBlocks(
 				{world_blocks_update_descriptor_sets_[src_buffer_index]},
 				{});
 
-			for(const auto& chunk_to_update : current_frame_chunks_to_update_list_)
-			{
-				const uint32_t chunk_index= chunk_to_update[0] + chunk_to_update[1] * world_size_[0];
-				if(chunks_upate_kind_[chunk_index] != ChunkUpdateKind::Update)
-					continue;
-
-				WorldBlocksUpdateUniforms uniforms;
-				uniforms.world_size_chunks[0]= int32_t(world_size_[0]);
-				uniforms.world_size_chunks[1]= int32_t(world_size_[1]);
-				uniforms.in_chunk_position[0]= int32_t(chunk_to_update[0]) + relative_world_shift[0];
-				uniforms.in_chunk_position[1]= int32_t(chunk_to_update[1]) + relative_world_shift[1];
-				uniforms.out_chunk_position[0]= int32_t(chunk_to_update[0]);
-				uniforms.out_chunk_position[1]= int32_t(chunk_to_update[1]);
-				uniforms.current_tick= current_tick_;
-
-				HEX_ASSERT(uniforms.in_chunk_position[0] >= 0 && uniforms.in_chunk_position[0] < int32_t(world_size_[0]));
-				HEX_ASSERT(uniforms.in_chunk_position[1] >= 0 && uniforms.in_chunk_position[1] < int32_t(world_size_[1]));
-				HEX_ASSERT(uniforms.out_chunk_position[0] >= 0 && uniforms.out_chunk_position[0] < int32_t(world_size_[0]));
-				HEX_ASSERT(uniforms.out_chunk_position[1] >= 0 && uniforms.out_chunk_position[1] < int32_t(world_size_[1]));
-
-				command_buffer.pushConstants(
-					*world_blocks_update_pipeline_.pipeline_layout,
-					vk::ShaderStageFlagBits::eCompute,
-					0,
-					sizeof(WorldBlocksUpdateUniforms), static_cast<const void*>(&uniforms));
+			WorldBlocksUpdateUniforms uniforms;
+			uniforms.world_size_chunks[0]= int32_t(world_size_[0]);
+			uniforms.world_size_chunks[1]= int32_t(world_size_[1]);
+			uniforms.in_chunk_shift[0]= relative_world_shift[0];
+			uniforms.in_chunk_shift[1]= relative_world_shift[1];
+			uniforms.current_tick= current_tick_;
+			uniforms.inactive_chunks_update_period= current_tick_inactive_chunks_update_period_;
 
-				// This constant should match workgroup size in shader!
-				constexpr uint32_t c_workgroup_size[]{4, 4, 8};
-				static_assert(c_chunk_width % c_workgroup_size[0] == 0, "Wrong workgroup size!");
-				static_assert(c_chunk_width % c_workgroup_size[1] == 0, "Wrong workgroup size!");
-				static_assert(c_chunk_height % c_workgroup_size[2] == 0, "Wrong workgroup size!");
+			command_buffer.pushConstants(
+				*world_blocks_update_pipeline_.pipeline_layout,
+				vk::ShaderStageFlagBits::eCompute,
+				0,
+				sizeof(WorldBlocksUpdateUniforms), static_cast<const void*>(&uniforms));
 
-				command_buffer.dispatch(
-					c_chunk_width / c_workgroup_size[0],
-					c_chunk_width / c_workgroup_size[1],
-					c_chunk_height / c_workgroup_size[2]);
-			}
+			// Update all chunks via single dispatch.
+			// Chunk is determined in shader based on workgroup index along Z axis.
+			command_buffer.dispatch(
+				c_chunk_width / c_world_update_workgroup_size[0],
+				c_chunk_width / c_world_update_workgroup_size[1],
+				c_chunk_height / c_world_update_workgroup_size[2] * current_frame_num_chunks_to_update_);
 		};
 
 	task_organizer.ExecuteTask(task, task_func);
@@ -1885,13 +2526,33 @@ void WorldProcessor::UpdateLight(
 	TaskOrganizer& task_organizer,
 	const RelativeWorldShiftChunks relative_world_shift)
 {
+	if(current_frame_num_chunks_to_update_ == 0)
+		return;
+
 	const uint32_t src_buffer_index= GetSrcBufferIndex();
 	const uint32_t dst_buffer_index= GetDstBufferIndex();
 
 	TaskOrganizer::ComputeTaskParams task;
+	task.name= "light_update";
 	task.input_storage_buffers.push_back(chunk_data_buffers_[src_buffer_index].GetBuffer());
 	task.input_storage_buffers.push_back(light_buffers_[src_buffer_index].GetBuffer());
-	task.output_storage_buffers.push_back(light_buffers_[dst_buffer_index].GetBuffer());
+	task.input_storage_buffers.push_back(
+		TaskOrganizer::BufferRange(
+			chunks_to_update_list_buffer_.GetBuffer(),
+			0,
+			sizeof(ChunkToUpdate) * current_frame_num_chunks_to_update_));
+	task.input_storage_buffers.push_back(
+		GetChunksChangedFlagsBufferRange(chunks_changed_flags_buffer_.GetBuffer(), world_size_, current_tick_ - 1));
+	task.output_storage_buffers.push_back(
+		GetChunksChangedFlagsBufferRange(
+			chunks_changed_flags_buffer_.GetBuffer(), world_size_, current_tick_, c_chunks_changed_flags_kind_light));
+
+	for(const auto& chunk_to_update : current_frame_chunks_to_update_list_)
+	{
+		const uint32_t chunk_index= chunk_to_update[0] + chunk_to_update[1] * world_size_[0];
+		if(chunks_upate_kind_[chunk_index] == ChunkUpdateKind::Update)
+			task.output_storage_buffers.push_back(GetChunkBufferRange(light_buffers_[dst_buffer_index].GetBuffer(), chunk_index));
+	}
 
 	const auto task_func=
 		[this, src_buffer_index, relative_world_shift](const vk::CommandBuffer command_buffer)
@@ -1905,42 +2566,26 @@ void WorldProcessor::UpdateLight(
 				{light_update_descriptor_sets_[src_buffer_index]},
 				{});
 
-			for(const auto& chunk_to_update : current_frame_chunks_to_update_list_)
-			{
-				const uint32_t chunk_index= chunk_to_update[0] + chunk_to_update[1] * world_size_[0];
-				if(chunks_upate_kind_[chunk_index] != ChunkUpdateKind::Update)
-					continue;
-
-				LightUpdateUniforms uniforms;
-				uniforms.world_size_chunks[0]= int32_t(world_size_[0]);
-				uniforms.world_size_chunks[1]= int32_t(world_size_[1]);
-				uniforms.in_chunk_position[0]= int32_t(chunk_to_update[0]) + relative_world_shift[0];
-				uniforms.in_chunk_position[1]= int32_t(chunk_to_update[1]) + relative_world_shift[1];
-				uniforms.out_chunk_position[0]= int32_t(chunk_to_update[0]);
-				uniforms.out_chunk_position[1]= int32_t(chunk_to_update[1]);
-
-				HEX_ASSERT(uniforms.in_chunk_position[0] >= 0 && uniforms.in_chunk_position[0] < int32_t(world_size_[0]));
-				HEX_ASSERT(uniforms.in_chunk_position[1] >= 0 && uniforms.in_chunk_position[1] < int32_t(world_size_[1]));
-				HEX_ASSERT(uniforms.out_chunk_position[0] >= 0 && uniforms.out_chunk_position[0] < int32_t(world_size_[0]));
-				HEX_ASSERT(uniforms.out_chunk_position[1] >= 0 && uniforms.out_chunk_position[1] < int32_t(world_size_[1]));
-
-				command_buffer.pushConstants(
-					*light_update_pipeline_.pipeline_layout,
-					vk::ShaderStageFlagBits::eCompute,
-					0,
-					sizeof(LightUpdateUniforms), static_cast<const void*>(&uniforms));
+			LightUpdateUniforms uniforms;
+			uniforms.world_size_chunks[0]= int32_t(world_size_[0]);
+			uniforms.world_size_chunks[1]= int32_t(world_size_[1]);
+			uniforms.in_chunk_shift[0]= relative_world_shift[0];
+			uniforms.in_chunk_shift[1]= relative_world_shift[1];
+			uniforms.current_tick= current_tick_;
+			uniforms.inactive_chunks_update_period= current_tick_inactive_chunks_update_period_;
 
-				// This constant should match workgroup size in shader!
-				constexpr uint32_t c_workgroup_size[]{4, 4, 8};
-				static_assert(c_chunk_width % c_workgroup_size[0] == 0, "Wrong workgroup size!");
-				static_assert(c_chunk_width % c_workgroup_size[1] == 0, "Wrong workgroup size!");
-				static_assert(c_chunk_height % c_workgroup_size[2] == 0, "Wrong workgroup size!");
+			command_buffer.pushConstants(
+				*light_update_pipeline_.pipeline_layout,
+				vk::ShaderStageFlagBits::eCompute,
+				0,
+				sizeof(LightUpdateUniforms), static_cast<const void*>(&uniforms));
 
-				command_buffer.dispatch(
-					c_chunk_width / c_workgroup_size[0],
-					c_chunk_width / c_workgroup_size[1],
-					c_chunk_height / c_workgroup_size[2]);
-			}
+			// Update all chunks via single dispatch.
+			// Chunk is determined in shader based on workgroup index along Z axis.
+			command_buffer.dispatch(
+				c_chunk_width / c_world_update_workgroup_size[0],
+				c_chunk_width / c_world_update_workgroup_size[1],
+				c_chunk_height / c_world_update_workgroup_size[2] * current_frame_num_chunks_to_update_);
 		};
 
 	task_organizer.ExecuteTask(task, task_func);
@@ -1951,6 +2596,7 @@ void WorldProcessor::GenerateWorld(
 	const RelativeWorldShiftChunks relative_world_shift)
 {
 	TaskOrganizer::ComputeTaskParams chunk_gen_prepare_task;
+	chunk_gen_prepare_task.name= "chunk_gen_prepare";
 	chunk_gen_prepare_task.input_storage_buffers.push_back(structures_buffer_.GetDescriptionsBuffer());
 	chunk_gen_prepare_task.input_storage_buffers.push_back(tree_map_buffer_.GetBuffer());
 	chunk_gen_prepare_task.output_storage_buffers.push_back(chunk_gen_info_buffer_.GetBuffer());
@@ -1998,11 +2644,34 @@ void WorldProcessor::GenerateWorld(
 	const uint32_t dst_buffer_index= GetDstBufferIndex();
 
 	TaskOrganizer::ComputeTaskParams world_gen_task;
+	world_gen_task.name= "world_gen";
 	world_gen_task.input_storage_buffers.push_back(chunk_gen_info_buffer_.GetBuffer());
 	world_gen_task.input_storage_buffers.push_back(structures_buffer_.GetDescriptionsBuffer());
 	world_gen_task.input_storage_buffers.push_back(structures_buffer_.GetDataBuffer());
-	world_gen_task.output_storage_buffers.push_back(chunk_data_buffers_[dst_buffer_index].GetBuffer());
-	world_gen_task.output_storage_buffers.push_back(chunk_auxiliar_data_buffers_[dst_buffer_index].GetBuffer());
+
+	TaskOrganizer::ComputeTaskParams initial_light_fill_task;
+	initial_light_fill_task.name= "initial_light_fill";
+
+	for(const auto& chunk_to_update : current_frame_chunks_to_update_list_)
+	{
+		const uint32_t chunk_index= chunk_to_update[0] + chunk_to_update[1] * world_size_[0];
+		if(chunks_upate_kind_[chunk_index] != ChunkUpdateKind::Generate)
+			continue;
+
+		const ChunksStorage::ChunkCoord chunk_global_position
+		{
+			world_offset_[0] + int32_t(chunk_to_update[0]) + relative_world_shift[0],
+			world_offset_[1] + int32_t(chunk_to_update[1]) + relative_world_shift[1],
+		};
+
+		world_gen_task.output_storage_buffers.push_back(GetChunkBufferRange(chunk_data_buffers_[dst_buffer_index].GetBuffer(), chunk_index));
+		world_gen_task.output_storage_buffers.push_back(GetChunkBufferRange(chunk_auxiliar_data_buffers_[dst_buffer_index].GetBuffer(), chunk_index));
+		world_gen_task.output_storage_buffers.push_back(
+			GetChunkModifiedFlagBufferRange(chunks_modified_flags_buffer_.GetBuffer(), GetChunkModifiedFlagIndex(chunk_global_position)));
+
+		initial_light_fill_task.input_storage_buffers.push_back(GetChunkBufferRange(chunk_data_buffers_[dst_buffer_index].GetBuffer(), chunk_index));
+		initial_light_fill_task.output_storage_buffers.push_back(GetChunkBufferRange(light_buffers_[dst_buffer_index].GetBuffer(), chunk_index));
+	}
 
 	const auto world_gen_task_func=
 		[this, dst_buffer_index, relative_world_shift](const vk::CommandBuffer command_buffer)
@@ -2030,6 +2699,8 @@ void WorldProcessor::GenerateWorld(
 				uniforms.chunk_global_position[0]= world_offset_[0] + int32_t(chunk_to_update[0]) + relative_world_shift[0];
 				uniforms.chunk_global_position[1]= world_offset_[1] + int32_t(chunk_to_update[1]) + relative_world_shift[1];
 				uniforms.seed= world_seed_;
+				uniforms.chunk_modified_flag_index= GetChunkModifiedFlagIndex(
+					{uniforms.chunk_global_position[0], uniforms.chunk_global_position[1]});
 
 				command_buffer.pushConstants(
 					*world_gen_pipeline_.pipeline_layout,
@@ -2047,10 +2718,6 @@ void WorldProcessor::GenerateWorld(
 
 	task_organizer.ExecuteTask(world_gen_task, world_gen_task_func);
 
-	TaskOrganizer::ComputeTaskParams initial_light_fill_task;
-	initial_light_fill_task.input_storage_buffers.push_back(chunk_data_buffers_[dst_buffer_index].GetBuffer());
-	initial_light_fill_task.output_storage_buffers.push_back(light_buffers_[dst_buffer_index].GetBuffer());
-
 	const auto initial_light_fill_task_func=
 		[this, dst_buffer_index](const vk::CommandBuffer command_buffer)
 		{
@@ -2097,54 +2764,23 @@ void WorldProcessor::DownloadChunks(TaskOrganizer& task_organizer)
 	if(world_offset_ == next_world_offset_)
 		return;
 
-	const RelativeWorldShiftChunks relative_shift
-	{
-		next_world_offset_[0] - world_offset_[0],
-		next_world_offset_[1] - world_offset_[1],
-	};
-
-	const uint32_t src_buffer_index= GetSrcBufferIndex();
+	// Download only modification flags first.
+	// Chunks data is downloaded later and only for modified chunks.
 
 	TaskOrganizer::TransferTaskParams task;
-	task.input_buffers.push_back(chunk_data_buffers_[src_buffer_index].GetBuffer());
-	task.input_buffers.push_back(chunk_auxiliar_data_buffers_[src_buffer_index].GetBuffer());
-	task.output_buffers.push_back(chunk_data_load_buffer_.GetBuffer());
-	task.output_buffers.push_back(chunk_auxiliar_data_load_buffer_.GetBuffer());
+	task.name= "chunks_modified_flags_download";
+	task.input_buffers.push_back(chunks_modified_flags_buffer_.GetBuffer());
+	task.output_buffers.push_back(chunks_modified_flags_download_buffer_.GetBuffer());
 
 	const auto task_func=
-		[this, relative_shift, src_buffer_index](const vk::CommandBuffer command_buffer)
+		[this](const vk::CommandBuffer command_buffer)
 		{
-			for(uint32_t y= 0; y < world_size_[1]; ++y)
-			for(uint32_t x= 0; x < world_size_[0]; ++x)
-			{
-				const int32_t old_pos[2]
-				{
-					int32_t(x) - relative_shift[0],
-					int32_t(y) - relative_shift[1],
-				};
-
-				if( old_pos[0] < 0 || old_pos[0] >= int32_t(world_size_[0]) ||
-					old_pos[1] < 0 || old_pos[1] >= int32_t(world_size_[1]))
-				{
-					// Need to download this chunk.
-					const uint32_t chunk_index= x + y * world_size_[0];
-					const uint32_t offset= chunk_index * c_chunk_volume;
-
-					command_buffer.copyBuffer(
-						chunk_data_buffers_[src_buffer_index].GetBuffer(),
-						chunk_data_load_buffer_.GetBuffer(),
-						{ { offset, offset, c_chunk_volume }});
-
-					command_buffer.copyBuffer(
-						chunk_auxiliar_data_buffers_[src_buffer_index].GetBuffer(),
-						chunk_auxiliar_data_load_buffer_.GetBuffer(),
-						{ { offset, offset, c_chunk_volume }});
-				}
-			}
+			command_buffer.copyBuffer(
+				chunks_modified_flags_buffer_.GetBuffer(),
+				chunks_modified_flags_download_buffer_.GetBuffer(),
+				{ { 0, 0, chunks_modified_flags_buffer_.GetSize() }});
 
 			// Set the event at the end of transfer commands, to tell host that data is available.
-			// TODO - make sure this works properly
-			// and all data written into the buffer may be accessed by the host after this event is signaled.
 			command_buffer.setEvent(*chunk_data_download_event_, vk::PipelineStageFlagBits::eTransfer);
 			wait_for_chunks_data_download_= true;
 		};
@@ -2157,21 +2793,64 @@ void WorldProcessor::FinishChunksDownloading(TaskOrganizer& task_organizer)
 	if(!wait_for_chunks_data_download_)
 		return;
 
-	if(vk_device_.getEventStatus(*chunk_data_download_event_) != vk::Result::eEventSet)
-		return; // Not finished yet.
+	if(!chunks_modified_flags_download_finished_)
+	{
+		if(vk_device_.getEventStatus(*chunk_data_download_event_) != vk::Result::eEventSet)
+			return; // Not finished yet.
+
+		// GPU-side flags copying is finished - reset the event and start downloading of modified chunks.
+		vk_device_.resetEvent(*chunk_data_download_event_);
+		chunks_modified_flags_download_finished_= true;
+
+		DownloadModifiedChunks(task_organizer);
+	}
+
+	if(!chunks_data_download_finished_)
+	{
+		// If there is no modified chunks, there is nothing to wait for.
+		if(!chunks_to_download_.empty())
+		{
+			if(vk_device_.getEventStatus(*chunk_data_download_event_) != vk::Result::eEventSet)
+				return; // Not finished yet.
+
+			// GPU-side chunks data copying is finished - reset the event and process data obtained.
+			vk_device_.resetEvent(*chunk_data_download_event_);
+		}
+		chunks_data_download_finished_= true;
+
+		StartDownloadedChunksCompression();
+	}
+
+	// Normally decompression is already started, but start it if it isn't.
+	StartChunksDecompression();
+
+	// Do not wait for decompression, try to upload chunks in one of the next frames.
+	if(!IsChunksDecompressionFinished())
+		return;
 
-	// GPU-side chunks data copying is finished - reset the event and process data obtained.
-	vk_device_.resetEvent(*chunk_data_download_event_);
 	wait_for_chunks_data_download_= false;
+	chunks_modified_flags_download_finished_= false;
+	chunks_data_download_finished_= false;
+
+	// Now we can upload chunks.
+	UploadChunks(task_organizer);
+}
 
+void WorldProcessor::DownloadModifiedChunks(TaskOrganizer& task_organizer)
+{
 	const RelativeWorldShiftChunks relative_shift
 	{
 		next_world_offset_[0] - world_offset_[0],
 		next_world_offset_[1] - world_offset_[1],
 	};
 
-	// Invalidate host caches for buffers memory before writing. This is needed for non-coherent memory.
-	std::vector<vk::MappedMemoryRange> mapped_memory_ranges;
+	// Invalidate host caches for buffer memory before reading. This is needed for non-coherent memory.
+	vk_device_.invalidateMappedMemoryRanges(
+		{{chunks_modified_flags_download_buffer_.GetMemory(), 0, chunks_modified_flags_download_buffer_.GetSize()}});
+
+	const auto flags= static_cast<const uint32_t*>(chunks_modified_flags_download_buffer_mapped_);
+
+	chunks_to_download_.clear();
 	for(uint32_t y= 0; y < world_size_[1]; ++y)
 	for(uint32_t x= 0; x < world_size_[0]; ++x)
 	{
@@ -2184,54 +2863,118 @@ void WorldProcessor::FinishChunksDownloading(TaskOrganizer& task_organizer)
 		if( old_pos[0] < 0 || old_pos[0] >= int32_t(world_size_[0]) ||
 			old_pos[1] < 0 || old_pos[1] >= int32_t(world_size_[1]))
 		{
-			const uint32_t chunk_index= x + y * world_size_[0];
-			const uint32_t offset= chunk_index * c_chunk_volume;
-
-			mapped_memory_ranges.emplace_back(
-				chunk_data_load_buffer_.GetMemory(), offset, c_chunk_volume);
-
-			mapped_memory_ranges.emplace_back(
-				chunk_auxiliar_data_load_buffer_.GetMemory(), offset, c_chunk_volume);
+			// This chunk is leaving the world. Download it only if it differs from its stored version.
+			if(flags[GetChunkModifiedFlagIndex({int32_t(x) + world_offset_[0], int32_t(y) + world_offset_[1]})] != 0)
+				chunks_to_download_.push_back(x + y * world_size_[0]);
 		}
 	}
-	vk_device_.invalidateMappedMemoryRanges(mapped_memory_ranges);
 
-	// Compress and save downloaded chunks into the storage.
-	// TODO - make this in background thread?
-	for(uint32_t y= 0; y < world_size_[1]; ++y)
-	for(uint32_t x= 0; x < world_size_[0]; ++x)
+	if(chunks_to_download_.empty())
+		return;
+
+	// Source buffer isn't changed until the next tick, which can't start before downloading is finished.
+	const uint32_t src_buffer_index= GetSrcBufferIndex();
+
+	TaskOrganizer::TransferTaskParams task;
+	task.name= "chunks_download";
+	for(const uint32_t chunk_index : chunks_to_download_)
 	{
-		const int32_t old_pos[2]
+		task.input_buffers.push_back(GetChunkBufferRange(chunk_data_buffers_[src_buffer_index].GetBuffer(), chunk_index));
+		task.input_buffers.push_back(GetChunkBufferRange(chunk_auxiliar_data_buffers_[src_buffer_index].GetBuffer(), chunk_index));
+		task.output_buffers.push_back(GetChunkBufferRange(chunk_data_load_buffer_.GetBuffer(), chunk_index));
+		task.output_buffers.push_back(GetChunkBufferRange(chunk_auxiliar_data_load_buffer_.GetBuffer(), chunk_index));
+	}
+
+	const auto task_func=
+		[this, src_buffer_index](const vk::CommandBuffer command_buffer)
 		{
-			int32_t(x) - relative_shift[0],
-			int32_t(y) - relative_shift[1],
+			for(const uint32_t chunk_index : chunks_to_download_)
+			{
+				const uint32_t offset= chunk_index * c_chunk_volume;
+
+				command_buffer.copyBuffer(
+					chunk_data_buffers_[src_buffer_index].GetBuffer(),
+					chunk_data_load_buffer_.GetBuffer(),
+					{ { offset, offset, c_chunk_volume }});
+
+				command_buffer.copyBuffer(
+					chunk_auxiliar_data_buffers_[src_buffer_index].GetBuffer(),
+					chunk_auxiliar_data_load_buffer_.GetBuffer(),
+					{ { offset, offset, c_chunk_volume }});
+			}
+
+			// Set the event at the end of transfer commands, to tell host that data is available.
+			// TODO - make sure this works properly
+			// and all data written into the buffer may be accessed by the host after this event is signaled.
+			command_buffer.setEvent(*chunk_data_download_event_, vk::PipelineStageFlagBits::eTransfer);
 		};
 
-		if( old_pos[0] < 0 || old_pos[0] >= int32_t(world_size_[0]) ||
-			old_pos[1] < 0 || old_pos[1] >= int32_t(world_size_[1]))
-		{
-			const uint32_t chunk_index= x + y * world_size_[0];
-			const uint32_t offset= chunk_index * c_chunk_volume;
+	task_organizer.ExecuteTask(task, task_func);
+}
 
-			chunks_storage_.SetChunk(
-				{
-					int32_t(x) + world_offset_[0],
-					int32_t(y) + world_offset_[1]
-				},
-				chunk_data_compressor_.Compress(
-					static_cast<const BlockType*>(chunk_data_load_buffer_mapped_) + offset,
-					static_cast<const uint8_t*>(chunk_auxiliar_data_load_buffer_mapped_) + offset));
-		}
+void WorldProcessor::StartDownloadedChunksCompression()
+{
+	if(chunks_to_download_.empty())
+		return;
+
+	// Invalidate host caches for buffers memory before writing. This is needed for non-coherent memory.
+	std::vector<vk::MappedMemoryRange> mapped_memory_ranges;
+	for(const uint32_t chunk_index : chunks_to_download_)
+	{
+		const uint32_t offset= chunk_index * c_chunk_volume;
+
+		mapped_memory_ranges.emplace_back(
+			chunk_data_load_buffer_.GetMemory(), offset, c_chunk_volume);
+
+		mapped_memory_ranges.emplace_back(
+			chunk_auxiliar_data_load_buffer_.GetMemory(), offset, c_chunk_volume);
 	}
+	vk_device_.invalidateMappedMemoryRanges(mapped_memory_ranges);
 
-	// Now we can upload chunks.
-	UploadChunks(task_organizer);
+	// Compress downloaded chunks in background threads.
+	// Results are put into the storage later, when they are ready.
+	// Data of these chunks in the load buffer remains untouched until compression is finished.
+	// Unmodified chunks aren't compressed at all - their data in the storage remains actual.
+	for(const uint32_t chunk_index : chunks_to_download_)
+	{
+		const uint32_t x= chunk_index % world_size_[0];
+		const uint32_t y= chunk_index / world_size_[0];
+		const uint32_t offset= chunk_index * c_chunk_volume;
+
+		ChunkCompressionTask task;
+		task.chunk_coord= {int32_t(x) + world_offset_[0], int32_t(y) + world_offset_[1]};
+		task.chunk_index= chunk_index;
+		task.future=
+			chunks_processing_thread_pool_.Submit(
+				[
+					codec= chunk_codec_,
+					zstd_dictionary= chunks_storage_.GetZstdDictionary(),
+					blocks_data= static_cast<const BlockType*>(chunk_data_load_buffer_mapped_) + offset,
+					blocks_auxiliar_data= static_cast<const uint8_t*>(chunk_auxiliar_data_load_buffer_mapped_) + offset
+				]
+				{
+					return CompressChunkData(codec, blocks_data, blocks_auxiliar_data, zstd_dictionary.get());
+				});
+
+		chunks_compression_tasks_.push_back(std::move(task));
+	}
 }
 
 void WorldProcessor::UploadChunks(TaskOrganizer& task_organizer)
 {
 	// Decompress chunks first.
-	// TODO - make this in background thread?
+	// Normally decompression is already started in background threads and is finished at this point.
+	StartChunksDecompression();
+	for(std::future<bool>& task : chunks_decompression_tasks_)
+	{
+		if(!task.get())
+			Log::Warning("Failed to decompress chunk data");
+	}
+	chunks_decompression_tasks_.clear();
+	chunks_decompression_started_= false;
+
+	last_chunks_upload_frame_= current_frame_;
+
 	std::vector<vk::MappedMemoryRange> written_mapped_memory_ranges;
 	for(uint32_t y= 0; y < world_size_[1]; ++y)
 	for(uint32_t x= 0; x < world_size_[0]; ++x)
@@ -2241,23 +2984,15 @@ void WorldProcessor::UploadChunks(TaskOrganizer& task_organizer)
 		{
 			const uint32_t offset= chunk_index * c_chunk_volume;
 
-			const ChunkDataCompresed* const chunk_data_compressed= chunks_storage_.GetChunk(
-				{
-					int32_t(x) + next_world_offset_[0],
-					int32_t(y) + next_world_offset_[1]
-				});
-
-			HEX_ASSERT(chunk_data_compressed != nullptr);
-			chunk_data_compressor_.Decompress(
-				*chunk_data_compressed,
-				static_cast<BlockType*>(chunk_data_load_buffer_mapped_) + offset,
-				static_cast<uint8_t*>(chunk_auxiliar_data_load_buffer_mapped_) + offset);
-
 			written_mapped_memory_ranges.emplace_back(
 				chunk_data_load_buffer_.GetMemory(), offset, c_chunk_volume);
 
 			written_mapped_memory_ranges.emplace_back(
 				chunk_auxiliar_data_load_buffer_.GetMemory(), offset, c_chunk_volume);
+
+			if(chunk_light_load_buffer_ != std::nullopt)
+				written_mapped_memory_ranges.emplace_back(
+					chunk_light_load_buffer_->GetMemory(), offset, c_chunk_volume);
 		}
 	}
 
@@ -2272,10 +3007,36 @@ void WorldProcessor::UploadChunks(TaskOrganizer& task_organizer)
 	const uint32_t dst_buffer_index= GetDstBufferIndex();
 
 	TaskOrganizer::TransferTaskParams task;
-	task.input_buffers.push_back(chunk_data_load_buffer_.GetBuffer());
-	task.input_buffers.push_back(chunk_auxiliar_data_load_buffer_.GetBuffer());
-	task.output_buffers.push_back(chunk_data_buffers_[dst_buffer_index].GetBuffer());
-	task.output_buffers.push_back(chunk_auxiliar_data_buffers_[dst_buffer_index].GetBuffer());
+	task.name= "chunks_upload";
+
+	TaskOrganizer::ComputeTaskParams initial_light_fill_task;
+	initial_light_fill_task.name= "initial_light_fill";
+
+	for(uint32_t y= 0; y < world_size_[1]; ++y)
+	for(uint32_t x= 0; x < world_size_[0]; ++x)
+	{
+		const uint32_t chunk_index= x + y * world_size_[0];
+		if(chunks_upate_kind_[chunk_index] != ChunkUpdateKind::Upload)
+			continue;
+
+		task.input_buffers.push_back(GetChunkBufferRange(chunk_data_load_buffer_.GetBuffer(), chunk_index));
+		task.input_buffers.push_back(GetChunkBufferRange(chunk_auxiliar_data_load_buffer_.GetBuffer(), chunk_index));
+		task.output_buffers.push_back(GetChunkBufferRange(chunk_data_buffers_[dst_buffer_index].GetBuffer(), chunk_index));
+		task.output_buffers.push_back(GetChunkBufferRange(chunk_auxiliar_data_buffers_[dst_buffer_index].GetBuffer(), chunk_index));
+		task.output_buffers.push_back(
+			GetChunkModifiedFlagBufferRange(
+				chunks_modified_flags_buffer_.GetBuffer(),
+				GetChunkModifiedFlagIndex({int32_t(x) + next_world_offset_[0], int32_t(y) + next_world_offset_[1]})));
+
+		if(chunk_light_load_buffer_ != std::nullopt)
+		{
+			task.input_buffers.push_back(GetChunkBufferRange(chunk_light_load_buffer_->GetBuffer(), chunk_index));
+			task.output_buffers.push_back(GetChunkBufferRange(light_buffers_[dst_buffer_index].GetBuffer(), chunk_index));
+		}
+
+		initial_light_fill_task.input_storage_buffers.push_back(GetChunkBufferRange(chunk_data_buffers_[dst_buffer_index].GetBuffer(), chunk_index));
+		initial_light_fill_task.output_storage_buffers.push_back(GetChunkBufferRange(light_buffers_[dst_buffer_index].GetBuffer(), chunk_index));
+	}
 
 	const auto task_func=
 		[this, dst_buffer_index](const vk::CommandBuffer command_buffer)
@@ -2297,16 +3058,31 @@ void WorldProcessor::UploadChunks(TaskOrganizer& task_organizer)
 						chunk_auxiliar_data_load_buffer_.GetBuffer(),
 						chunk_auxiliar_data_buffers_[dst_buffer_index].GetBuffer(),
 						{ { offset, offset, c_chunk_volume }});
+
+					if(chunk_light_load_buffer_ != std::nullopt)
+						command_buffer.copyBuffer(
+							chunk_light_load_buffer_->GetBuffer(),
+							light_buffers_[dst_buffer_index].GetBuffer(),
+							{ { offset, offset, c_chunk_volume }});
+
+					// Uploaded chunk is identical to its stored version - reset its modified flag.
+					const uint32_t flag_index=
+						GetChunkModifiedFlagIndex({int32_t(x) + next_world_offset_[0], int32_t(y) + next_world_offset_[1]});
+					command_buffer.fillBuffer(
+						chunks_modified_flags_buffer_.GetBuffer(),
+						flag_index * sizeof(uint32_t),
+						sizeof(uint32_t),
+						0);
 				}
 			}
 		};
 
 	task_organizer.ExecuteTask(task, task_func);
 
+	if(chunk_light_load_buffer_ != std::nullopt)
+		return; // Light was calculated on the CPU and is already uploaded.
+
 	// Perform initial light fill for loaded chunks.
-	TaskOrganizer::ComputeTaskParams initial_light_fill_task;
-	initial_light_fill_task.input_storage_buffers.push_back(chunk_data_buffers_[dst_buffer_index].GetBuffer());
-	initial_light_fill_task.output_storage_buffers.push_back(light_buffers_[dst_buffer_index].GetBuffer());
 
 	const auto initial_light_fill_task_func=
 		[this, dst_buffer_index](const vk::CommandBuffer command_buffer)
@@ -2350,11 +3126,151 @@ void WorldProcessor::UploadChunks(TaskOrganizer& task_organizer)
 	task_organizer.ExecuteTask(initial_light_fill_task, initial_light_fill_task_func);
 }
 
+void WorldProcessor::StartChunksDecompression()
+{
+	if(chunks_decompression_started_)
+		return;
+	chunks_decompression_started_= true;
+
+	HEX_ASSERT(chunks_decompression_tasks_.empty());
+
+	for(uint32_t y= 0; y < world_size_[1]; ++y)
+	for(uint32_t x= 0; x < world_size_[0]; ++x)
+	{
+		const uint32_t chunk_index= x + y * world_size_[0];
+		if(chunks_upate_kind_[chunk_index] != ChunkUpdateKind::Upload)
+			continue;
+
+		const uint32_t offset= chunk_index * c_chunk_volume;
+
+		// Normally chunks for uploading and downloading are located at opposite world sides.
+		// But make sure we do not overwrite data of a chunk which is compressed right now.
+		EnsureLoadBufferChunkCompressionFinished(chunk_index);
+
+		const std::optional<ChunkDataCompresedView> chunk_data_compressed= GetStoredChunk(
+			{
+				int32_t(x) + next_world_offset_[0],
+				int32_t(y) + next_world_offset_[1]
+			});
+		HEX_ASSERT(chunk_data_compressed != std::nullopt);
+
+		++chunks_decompression_counters_.num_queued;
+
+		// Pass compressed data without copying - it's read directly from the storage (or mapped region file) in the task.
+		// This is safe, since the view remains valid until the next active area change or modification of this chunk.
+		// Active area is changed only at tick start, which can't happen until all uploaded chunks are decompressed.
+		// Only chunks leaving the world are modified during decompression and they can't be uploaded.
+		chunks_decompression_tasks_.push_back(
+			chunks_processing_thread_pool_.Submit(
+				[
+					this,
+					data_compressed= *chunk_data_compressed,
+					zstd_dictionary= chunks_storage_.GetZstdDictionary(),
+					blocks_data= static_cast<BlockType*>(chunk_data_load_buffer_mapped_) + offset,
+					blocks_auxiliar_data= static_cast<uint8_t*>(chunk_auxiliar_data_load_buffer_mapped_) + offset,
+					light_data=
+						chunk_light_load_buffer_mapped_ == nullptr
+							? nullptr
+							: static_cast<uint8_t*>(chunk_light_load_buffer_mapped_) + offset
+				]
+				{
+					--chunks_decompression_counters_.num_queued;
+					++chunks_decompression_counters_.num_in_progress;
+
+					const auto start_time= std::chrono::steady_clock::now();
+					const bool result= DecompressChunkData(data_compressed, blocks_data, blocks_auxiliar_data, zstd_dictionary.get());
+					const auto decompression_end_time= std::chrono::steady_clock::now();
+
+					// Calculate light of the chunk, in order to avoid many ticks of light propagation after uploading.
+					if(light_data != nullptr)
+						CalculateIsolatedChunkLightCPU(reinterpret_cast<const uint8_t*>(blocks_data), light_data);
+					const auto end_time= std::chrono::steady_clock::now();
+
+					chunks_decompression_counters_.total_time_ns+=
+						uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count());
+					chunks_decompression_counters_.light_total_time_ns+=
+						uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - decompression_end_time).count());
+					++chunks_decompression_counters_.num_completed;
+					--chunks_decompression_counters_.num_in_progress;
+
+					return result;
+				}));
+	}
+}
+
+bool WorldProcessor::IsChunksDecompressionFinished() const
+{
+	for(const std::future<bool>& task : chunks_decompression_tasks_)
+	{
+		if(task.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready)
+			return false;
+	}
+
+	return true;
+}
+
+void WorldProcessor::TakeFinishedChunksCompressionResults()
+{
+	for(auto it= chunks_compression_tasks_.begin(); it != chunks_compression_tasks_.end();)
+	{
+		if(it->future.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready)
+		{
+			chunks_storage_.SetChunk(it->chunk_coord, it->future.get());
+			it= chunks_compression_tasks_.erase(it);
+		}
+		else
+			++it;
+	}
+}
+
+void WorldProcessor::EnsureChunksCompressionFinished()
+{
+	for(ChunkCompressionTask& task : chunks_compression_tasks_)
+		chunks_storage_.SetChunk(task.chunk_coord, task.future.get());
+
+	chunks_compression_tasks_.clear();
+}
+
+void WorldProcessor::EnsureChunkCompressionFinished(const ChunksStorage::ChunkCoord chunk_coord)
+{
+	for(auto it= chunks_compression_tasks_.begin(); it != chunks_compression_tasks_.end();)
+	{
+		if(it->chunk_coord == chunk_coord)
+		{
+			chunks_storage_.SetChunk(it->chunk_coord, it->future.get());
+			it= chunks_compression_tasks_.erase(it);
+		}
+		else
+			++it;
+	}
+}
+
+void WorldProcessor::EnsureLoadBufferChunkCompressionFinished(const uint32_t chunk_index)
+{
+	for(auto it= chunks_compression_tasks_.begin(); it != chunks_compression_tasks_.end();)
+	{
+		if(it->chunk_index == chunk_index)
+		{
+			chunks_storage_.SetChunk(it->chunk_coord, it->future.get());
+			it= chunks_compression_tasks_.erase(it);
+		}
+		else
+			++it;
+	}
+}
+
+std::optional<ChunkDataCompresedView> WorldProcessor::GetStoredChunk(const ChunksStorage::ChunkCoord chunk_coord)
+{
+	EnsureChunkCompressionFinished(chunk_coord);
+	return chunks_storage_.GetChunk(chunk_coord);
+}
+
 void WorldProcessor::BuildPlayerWorldWindow(TaskOrganizer& task_organizer)
 {
 	const uint32_t src_buffer_index= GetSrcBufferIndex();
 
 	TaskOrganizer::ComputeTaskParams task;
+	task.name= "player_world_window_build";
 	task.input_storage_buffers.push_back(player_state_buffer_.GetBuffer());
 	task.input_storage_buffers.push_back(chunk_data_buffers_[src_buffer_index].GetBuffer());
 	task.input_storage_buffers.push_back(light_buffers_[src_buffer_index].GetBuffer());
@@ -2427,6 +3343,7 @@ void WorldProcessor::UpdatePlayer(
 			float(std::max(2u, world_size_[1] / 2 - 1)) * float(c_chunk_width));
 
 	TaskOrganizer::ComputeTaskParams player_update_task;
+	player_update_task.name= "player_update";
 	player_update_task.input_storage_buffers.push_back(world_global_state_buffer_.GetBuffer());
 	player_update_task.input_output_storage_buffers.push_back(player_state_buffer_.GetBuffer());
 	player_update_task.input_output_storage_buffers.push_back(world_blocks_external_update_queue_buffer_.GetBuffer());
@@ -2457,6 +3374,7 @@ void WorldProcessor::UpdatePlayer(
 	task_organizer.ExecuteTask(player_update_task, player_update_task_func);
 
 	TaskOrganizer::TransferTaskParams player_state_read_back_task;
+	player_state_read_back_task.name= "player_state_read_back";
 	player_state_read_back_task.input_buffers.push_back(player_state_buffer_.GetBuffer());
 	player_state_read_back_task.output_buffers.push_back(player_state_read_back_buffer_.GetBuffer());
 
@@ -2486,9 +3404,14 @@ void WorldProcessor::FlushWorldBlocksExternalUpdateQueue(TaskOrganizer& task_org
 	const uint32_t dst_buffer_index= GetDstBufferIndex();
 
 	TaskOrganizer::ComputeTaskParams task;
+	task.name= "world_blocks_external_update_queue_flush";
 	task.input_output_storage_buffers.push_back(world_blocks_external_update_queue_buffer_.GetBuffer());
 	task.input_output_storage_buffers.push_back(chunk_data_buffers_[dst_buffer_index].GetBuffer());
 	task.input_output_storage_buffers.push_back(chunk_auxiliar_data_buffers_[dst_buffer_index].GetBuffer());
+	task.output_storage_buffers.push_back(chunks_modified_flags_buffer_.GetBuffer());
+	task.output_storage_buffers.push_back(
+		GetChunksChangedFlagsBufferRange(
+			chunks_changed_flags_buffer_.GetBuffer(), world_size_, current_tick_, c_chunks_changed_flags_kind_blocks));
 
 	const auto task_func=
 		[this, dst_buffer_index](const vk::CommandBuffer command_buffer)
@@ -2510,6 +3433,9 @@ void WorldProcessor::FlushWorldBlocksExternalUpdateQueue(TaskOrganizer& task_org
 			uniforms.world_size_chunks[1]= int32_t(world_size_[1]);
 			uniforms.world_offset_chunks[0]= world_offset_[0];
 			uniforms.world_offset_chunks[1]= world_offset_[1];
+			uniforms.world_offset_chunks_wrapped[0]= EuclidianRemainder(world_offset_[0], int32_t(world_size_[0]));
+			uniforms.world_offset_chunks_wrapped[1]= EuclidianRemainder(world_offset_[1], int32_t(world_size_[1]));
+			uniforms.current_tick= current_tick_;
 
 			command_buffer.pushConstants(
 				*world_blocks_external_update_queue_flush_pipeline_.pipeline_layout,
@@ -2524,6 +3450,47 @@ void WorldProcessor::FlushWorldBlocksExternalUpdateQueue(TaskOrganizer& task_org
 	task_organizer.ExecuteTask(task, task_func);
 }
 
+void WorldProcessor::PrepareChunksActivityTracking(TaskOrganizer& task_organizer)
+{
+	// After world shift chunks data in two world buffers is different.
+	// Update all chunks in the shift tick and in the next one, in order to make it identical again.
+	// The same is needed for chunks generated or uploaded in the shift tick.
+	if(next_world_offset_ != world_offset_)
+		num_ticks_with_all_chunks_active_= 2;
+
+	if(num_ticks_with_all_chunks_active_ > 0)
+	{
+		current_tick_inactive_chunks_update_period_= 1;
+		--num_ticks_with_all_chunks_active_;
+	}
+	else
+		current_tick_inactive_chunks_update_period_= inactive_chunks_update_period_;
+
+	// Clear flags, which are written in this tick.
+	// Flags of previous tick are read in this tick and flags of the tick before previous aren't needed anymore.
+	const TaskOrganizer::BufferRange range=
+		GetChunksChangedFlagsBufferRange(chunks_changed_flags_buffer_.GetBuffer(), world_size_, current_tick_);
+
+	TaskOrganizer::TransferTaskParams task;
+	task.name= "chunks_changed_flags_clear";
+	task.output_buffers.push_back(range);
+
+	const auto task_func=
+		[range](const vk::CommandBuffer command_buffer)
+		{
+			command_buffer.fillBuffer(range.buffer, range.offset, range.size, 0);
+		};
+
+	task_organizer.ExecuteTask(task, task_func);
+}
+
+uint32_t WorldProcessor::GetChunkModifiedFlagIndex(const ChunksStorage::ChunkCoord chunk_coord) const
+{
+	return
+		uint32_t(EuclidianRemainder(chunk_coord[0], int32_t(world_size_[0]))) +
+		uint32_t(EuclidianRemainder(chunk_coord[1], int32_t(world_size_[1]))) * world_size_[0];
+}
+
 uint32_t WorldProcessor::GetSrcBufferIndex() const
 {
 	return current_tick_ & 1;
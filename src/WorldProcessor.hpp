@@ -8,7 +8,10 @@
 #include "Pipeline.hpp"
 #include "StructuresBuffer.hpp"
 #include "TaskOrganizer.hpp"
+#include "ThreadPool.hpp"
 #include "TreesDistribution.hpp"
+#include "WorldBlocksUpdateValidator.hpp"
+#include <atomic>
 
 namespace HexGPU
 {
@@ -37,6 +40,16 @@ public:
 		BlockType build_block_type= BlockType::Air;
 	};
 
+	// Statistics of background chunks decompression.
+	struct ChunksDecompressionStats
+	{
+		uint32_t num_queued= 0;
+		uint32_t num_in_progress= 0;
+		uint64_t num_completed= 0;
+		uint64_t average_time_ns= 0; // Per chunk.
+		uint64_t average_light_time_ns= 0; // Per chunk, included into total time.
+	};
+
 	// This struct must be identical to the same struct in GLSL code!
 	struct WorldGlobalState
 	{
@@ -50,6 +63,7 @@ public:
 		int32_t sky_light_mask= 0;
 		int32_t sky_light_based_wetness_mask= 0;
 		int32_t snow_z_level= 0;
+		int32_t simulation_params_changed= 0;
 	};
 
 public:
@@ -60,8 +74,13 @@ public:
 		Settings& settings);
 	~WorldProcessor();
 
+	// World simulation tasks (blocks update, light update, world generation) are executed via separate task organizer.
+	// It may be the same as the main task organizer or an organizer for async compute queue.
+	// Simulation tasks write only into the destination buffers of the current tick,
+	// so main tasks don't need to wait for them, unless a new tick is started.
 	void Update(
 		TaskOrganizer& task_organizer,
+		TaskOrganizer& simulation_task_organizer,
 		float time_delta_s,
 		KeyboardState keyboard_state,
 		MouseState mouse_state,
@@ -88,10 +107,28 @@ public:
 
 	uint32_t GetActualBuffersIndex() const;
 
+	// Returns current world tick number. It is incremented at each tick start.
+	uint32_t GetCurrentTick() const;
+
+	// Returns true if a new tick was started in the last update.
+	// In such case main tasks use results of simulation tasks of the same frame.
+	bool IsNewTickStartedInLastUpdate() const;
+
 	// Returns player state or null.
 	// Player state is read back from the GPU and is a couple of frames outdated.
 	const PlayerState* GetLastKnownPlayerState() const;
 
+	ChunksDecompressionStats GetChunksDecompressionStats() const;
+
+	// Enable reading back of input and output of world blocks and light update at tick ends, for debugging purposes.
+	// Requires a host-visible buffer of several world volumes.
+	void EnableTickDataReadBack(WindowVulkan& window_vulkan);
+
+	// Returns read back data of a finished tick, once the GPU has finished copying it (a couple of frames after the tick end).
+	// Data of a tick is read back only if there is no pending read back of a previous tick, so, some ticks are skipped.
+	// Result pointers remain valid until the next "Update" call.
+	std::optional<WorldBlocksUpdateValidationData> TakeTickDataReadBack();
+
 private:
 	// These constants must be the same in GLSL code!
 	static constexpr uint32_t c_player_world_window_size[3]{16, 16, 16};
@@ -138,6 +175,14 @@ private:
 		ChunkStructureDescription structures[c_max_chunk_structures];
 	};
 
+	// Entry of the list of chunks for batched world blocks and light update.
+	struct ChunkToUpdate
+	{
+		int32_t out_chunk_position[2]{};
+		uint32_t chunk_modified_flag_index= 0;
+		uint32_t reserved= 0;
+	};
+
 	using RelativeWorldShiftChunks= std::array<int32_t, 2>;
 
 	enum class ChunkUpdateKind : uint8_t
@@ -147,6 +192,23 @@ private:
 		Upload,
 	};
 
+	struct ChunkCompressionTask
+	{
+		ChunksStorage::ChunkCoord chunk_coord{};
+		uint32_t chunk_index= 0; // Index of the chunk slot in the load buffer.
+		std::future<ChunkDataCompresed> future;
+	};
+
+	// Counters are modified by worker threads.
+	struct ChunksDecompressionCounters
+	{
+		std::atomic<uint32_t> num_queued{0};
+		std::atomic<uint32_t> num_in_progress{0};
+		std::atomic<uint64_t> num_completed{0};
+		std::atomic<uint64_t> total_time_ns{0};
+		std::atomic<uint64_t> light_total_time_ns{0};
+	};
+
 private:
 	void InitialFillBuffers(TaskOrganizer& task_organizer);
 
@@ -158,14 +220,36 @@ private:
 	void BuildCurrentFrameChunksToUpdateList(float prev_offset_within_tick, float cur_offset_within_tick);
 
 	void UpdateWorldGlobalState(TaskOrganizer& task_organizer, const DebugParams& debug_params);
+	void UploadChunksToUpdateList(TaskOrganizer& task_organizer, RelativeWorldShiftChunks relative_world_shift);
+	void ScheduleTickDataReadBack(TaskOrganizer& task_organizer, RelativeWorldShiftChunks relative_world_shift);
 	void UpdateWorldBlocks(TaskOrganizer& task_organizer, RelativeWorldShiftChunks relative_world_shift);
 	void UpdateLight(TaskOrganizer& task_organizer, RelativeWorldShiftChunks relative_world_shift);
 	void GenerateWorld(TaskOrganizer& task_organizer, RelativeWorldShiftChunks relative_world_shift);
 	void DownloadChunks(TaskOrganizer& task_organizer);
 
 	void FinishChunksDownloading(TaskOrganizer& task_organizer);
+	// Schedule downloading of modified chunks, based on downloaded modification flags.
+	void DownloadModifiedChunks(TaskOrganizer& task_organizer);
+	void StartDownloadedChunksCompression();
 	void UploadChunks(TaskOrganizer& task_organizer);
 
+	// Start background decompression of chunks with "Upload" update kind directly into the load buffer.
+	// Does nothing if it's already started.
+	void StartChunksDecompression();
+	bool IsChunksDecompressionFinished() const;
+
+	// Put results of finished background compression tasks into the storage. Doesn't wait.
+	void TakeFinishedChunksCompressionResults();
+	// Wait for all background compression tasks and put results into the storage.
+	void EnsureChunksCompressionFinished();
+	// Wait for compression of the chunk with given global coordinates (if it's in progress).
+	void EnsureChunkCompressionFinished(ChunksStorage::ChunkCoord chunk_coord);
+	// Wait for compression of chunk data in given slot of the load buffer (if it's in progress).
+	void EnsureLoadBufferChunkCompressionFinished(uint32_t chunk_index);
+
+	// Returns chunk from the storage, taking into account chunks which are compressed right now.
+	std::optional<ChunkDataCompresedView> GetStoredChunk(ChunksStorage::ChunkCoord chunk_coord);
+
 	void BuildPlayerWorldWindow(TaskOrganizer& task_organizer);
 
 	void UpdatePlayer(
@@ -178,6 +262,11 @@ private:
 		float aspect);
 
 	void FlushWorldBlocksExternalUpdateQueue(TaskOrganizer& task_organizer);
+	// Should be called at the start of each tick.
+	void PrepareChunksActivityTracking(TaskOrganizer& task_organizer);
+
+	// Returns index of the chunk with given global coordinates in the chunks modified flags buffer.
+	uint32_t GetChunkModifiedFlagIndex(ChunksStorage::ChunkCoord chunk_coord) const;
 
 	uint32_t GetSrcBufferIndex() const;
 	uint32_t GetDstBufferIndex() const;
@@ -189,6 +278,14 @@ private:
 
 	const WorldSizeChunks world_size_;
 	const int32_t world_seed_;
+	// Codec used for compression of chunks, stored in the storage.
+	const ChunkCodec chunk_codec_;
+	// Chunks which aren't changed recently are updated only once in this number of ticks.
+	const uint32_t inactive_chunks_update_period_;
+	// Use world blocks update shader variant, which loads input blocks into shared memory first.
+	const bool world_blocks_update_use_shared_memory_tile_;
+	// Calculate light of uploaded chunks on the CPU, rather than only direct sky light.
+	const bool chunk_light_precompute_;
 
 	const StructuresBuffer structures_buffer_;
 
@@ -205,6 +302,18 @@ private:
 	void* const chunk_data_load_buffer_mapped_;
 	const Buffer chunk_auxiliar_data_load_buffer_;
 	void* const chunk_auxiliar_data_load_buffer_mapped_;
+	// Buffer for uploading of light, calculated on the CPU after decompression.
+	// Exists only if light precomputation is enabled.
+	std::optional<Buffer> chunk_light_load_buffer_;
+	void* chunk_light_load_buffer_mapped_= nullptr;
+
+	// Flag for each chunk, which is set if chunk data differs from data in the storage.
+	// Only modified chunks are downloaded and compressed.
+	// Flags are indexed by global chunk coordinates wrapped around world size,
+	// so a chunk leaving the world and a chunk replacing it share the same flag and no shifting is needed.
+	const Buffer chunks_modified_flags_buffer_;
+	const Buffer chunks_modified_flags_download_buffer_;
+	const void* const chunks_modified_flags_download_buffer_mapped_;
 
 	// Use double buffering for light update.
 	// On each step data is read from one of them and written into another.
@@ -212,10 +321,21 @@ private:
 
 	const Buffer world_global_state_buffer_;
 
+	// List of chunks for world blocks and light update in current frame.
+	// Is uploaded each frame, in order to update all these chunks via single dispatch.
+	const Buffer chunks_to_update_list_buffer_;
+
+	// Flags of chunks changed in a tick, used for skipping update of unchanged chunks.
+	// See "chunks_activity.glsl" for details.
+	const Buffer chunks_changed_flags_buffer_;
+
 	const Buffer player_state_buffer_;
 	const Buffer world_blocks_external_update_queue_buffer_;
 	const Buffer player_world_window_buffer_;
 
+	// Number of frames which may be executed by the GPU simultaneously (number of command buffers).
+	const uint32_t num_frames_in_flight_;
+
 	const uint32_t player_state_read_back_buffer_num_frames_;
 	const Buffer player_state_read_back_buffer_;
 	const void* const player_state_read_back_buffer_mapped_;
@@ -249,9 +369,23 @@ private:
 
 	const vk::UniqueEvent chunk_data_download_event_;
 
-	ChunkDataCompressor chunk_data_compressor_;
 	ChunksStorage chunks_storage_;
 
+	// Pool for background chunks data compression/decompression.
+	// It should be destroyed before the storage and the load buffers.
+	ThreadPool chunks_processing_thread_pool_;
+
+	// Compression tasks for chunks downloaded from the GPU. Their data is taken directly from the load buffer.
+	std::vector<ChunkCompressionTask> chunks_compression_tasks_;
+
+	// Decompression tasks for chunks to upload. Their data is written directly into the load buffer.
+	std::vector<std::future<bool>> chunks_decompression_tasks_;
+	bool chunks_decompression_started_= false;
+	ChunksDecompressionCounters chunks_decompression_counters_;
+
+	// Frame of the last chunks upload. Load buffer contents may be modified only after this frame is finished on the GPU.
+	uint32_t last_chunks_upload_frame_= 0;
+
 	WorldOffsetChunks world_offset_; // Current offset
 	WorldOffsetChunks next_world_offset_; // Offset which will be current at the start of the next tick
 	WorldOffsetChunks next_next_world_offset_; // Offset whic will be next at the start of the next tick
@@ -264,16 +398,40 @@ private:
 	// Tick number. Incrementing at new tick start only (not each frame).
 	uint32_t current_tick_= 0;
 	float current_tick_fractional_= 0.0f;
+	bool new_tick_started_in_last_update_= false;
 
 	// Update this list each frame. Includes both chunks for update and generation.
 	std::vector<std::array<uint32_t, 2>> current_frame_chunks_to_update_list_;
+	// Number of chunks with "Update" kind uploaded into the chunks to update list buffer in this frame.
+	uint32_t current_frame_num_chunks_to_update_= 0;
+
+	// Period of update of inactive chunks in current tick. 1 means updating all chunks.
+	uint32_t current_tick_inactive_chunks_update_period_= 1;
+	// Update all chunks in a couple of first ticks, since chunks changed flags aren't valid yet.
+	uint32_t num_ticks_with_all_chunks_active_= 2;
 
 	// Update kind for each chunk in this tick.
 	std::vector<ChunkUpdateKind> chunks_upate_kind_;
 
 	std::optional<PlayerState> last_known_player_state_;
 
+	// Set when download starts, reset when uploading of new chunks is performed.
 	bool wait_for_chunks_data_download_= false;
+	// Set when downloaded modified flags are available on the host side and downloading of modified chunks is started.
+	bool chunks_modified_flags_download_finished_= false;
+	// Set when downloaded data is available on the host side.
+	bool chunks_data_download_finished_= false;
+	// Indices of chunks leaving the world which are modified and thus are downloaded.
+	std::vector<uint32_t> chunks_to_download_;
+
+	// Buffer for reading back input and output of world blocks and light update.
+	// Exists only if read back is enabled.
+	std::optional<Buffer> tick_data_read_back_buffer_;
+	const void* tick_data_read_back_buffer_mapped_= nullptr;
+
+	// Set if data copying is recorded, but the data isn't taken yet. Pointers point to the read back buffer.
+	std::optional<WorldBlocksUpdateValidationData> pending_tick_data_read_back_;
+	uint32_t pending_tick_data_read_back_frame_= 0;
 };
 
 } // namespace HexGPU
@@ -175,11 +175,12 @@ WorldRenderer::WorldRenderer(
 	WorldRenderPass& world_render_pass,
 	GPUDataUploader& gpu_data_uploader,
 	const WorldProcessor& world_processor,
-	const vk::DescriptorPool global_descriptor_pool)
+	const vk::DescriptorPool global_descriptor_pool,
+	Settings& settings)
 	: vk_device_(window_vulkan.GetVulkanDevice())
 	, world_processor_(world_processor)
 	, world_size_(world_processor.GetWorldSize())
-	, geometry_generator_(window_vulkan, world_processor, global_descriptor_pool)
+	, geometry_generator_(window_vulkan, world_processor, global_descriptor_pool, settings)
 	, textures_generator_(window_vulkan, global_descriptor_pool)
 	, draw_indirect_buffer_(
 		window_vulkan,
@@ -552,6 +553,11 @@ void WorldRenderer::DrawTransparent(const vk::CommandBuffer command_buffer, cons
 	DrawFire(command_buffer, time_s);
 }
 
+WorldGeometryGenerator::VertexMemoryStats WorldRenderer::GetVertexMemoryStats() const
+{
+	return geometry_generator_.GetVertexMemoryStats();
+}
+
 void WorldRenderer::DrawWorld(const vk::CommandBuffer command_buffer)
 {
 	const vk::Buffer vertex_buffer= geometry_generator_.GetVertexBuffer();
@@ -741,8 +747,8 @@ GraphicsPipeline WorldRenderer::CreateWorldDrawPipeline(
 
 	const vk::VertexInputAttributeDescription vertex_input_attribute_description[]
 	{
-		{0u, 0u, vk::Format::eR16G16B16A16Sscaled, 0u},
-		{1u, 0u, vk::Format::eR16G16B16A16Sint, sizeof(int16_t) * 4},
+		{0u, 0u, vk::Format::eR32Uint, offsetof(WorldVertex, pos_xy_tex_coord)},
+		{1u, 0u, vk::Format::eR16G16Uint, offsetof(WorldVertex, pos_z)},
 	};
 
 	const vk::PipelineVertexInputStateCreateInfo pipiline_vertex_input_state_create_info(
@@ -893,8 +899,8 @@ GraphicsPipeline WorldRenderer::CreateWorldWaterDrawPipeline(
 
 	const vk::VertexInputAttributeDescription vertex_input_attribute_description[]
 	{
-		{0u, 0u, vk::Format::eR16G16B16A16Sscaled, 0u},
-		{1u, 0u, vk::Format::eR16G16B16A16Sint, sizeof(int16_t) * 4},
+		{0u, 0u, vk::Format::eR32Uint, offsetof(WorldVertex, pos_xy_tex_coord)},
+		{1u, 0u, vk::Format::eR16G16Uint, offsetof(WorldVertex, pos_z)},
 	};
 
 	const vk::PipelineVertexInputStateCreateInfo pipiline_vertex_input_state_create_info(
@@ -1052,8 +1058,8 @@ GraphicsPipeline WorldRenderer::CreateFireDrawPipeline(
 
 	const vk::VertexInputAttributeDescription vertex_input_attribute_description[]
 	{
-		{0u, 0u, vk::Format::eR16G16B16A16Sscaled, 0u},
-		{1u, 0u, vk::Format::eR16G16B16A16Sint, sizeof(int16_t) * 4},
+		{0u, 0u, vk::Format::eR32Uint, offsetof(WorldVertex, pos_xy_tex_coord)},
+		{1u, 0u, vk::Format::eR16G16Uint, offsetof(WorldVertex, pos_z)},
 	};
 
 	const vk::PipelineVertexInputStateCreateInfo pipiline_vertex_input_state_create_info(
@@ -1203,8 +1209,8 @@ GraphicsPipeline WorldRenderer::CreateGrassDrawPipeline(
 
 	const vk::VertexInputAttributeDescription vertex_input_attribute_description[]
 	{
-		{0u, 0u, vk::Format::eR16G16B16A16Sscaled,offsetof(WorldVertex, pos)},
-		{1u, 0u, vk::Format::eR16G16B16A16Sint, offsetof(WorldVertex, tex_coord)},
+		{0u, 0u, vk::Format::eR32Uint, offsetof(WorldVertex, pos_xy_tex_coord)},
+		{1u, 0u, vk::Format::eR16G16Uint, offsetof(WorldVertex, pos_z)},
 	};
 
 	const vk::PipelineVertexInputStateCreateInfo pipiline_vertex_input_state_create_info(
@@ -1288,6 +1294,7 @@ GraphicsPipeline WorldRenderer::CreateGrassDrawPipeline(
 void WorldRenderer::CopyViewParams(TaskOrganizer& task_organizer)
 {
 	TaskOrganizer::TransferTaskParams task;
+	task.name= "view_params_copy";
 	task.input_buffers.push_back(world_processor_.GetPlayerStateBuffer());
 	task.input_buffers.push_back(world_processor_.GetWorldGlobalStateBuffer());
 	task.output_buffers.push_back(uniform_buffer_.GetBuffer());
@@ -1336,6 +1343,7 @@ void WorldRenderer::CopyViewParams(TaskOrganizer& task_organizer)
 void WorldRenderer::BuildDrawIndirectBuffer(TaskOrganizer& task_organizer)
 {
 	TaskOrganizer::ComputeTaskParams task;
+	task.name= "draw_indirect_buffer_build";
 	task.input_storage_buffers.push_back(geometry_generator_.GetChunkDrawInfoBuffer());
 	task.input_storage_buffers.push_back(world_processor_.GetPlayerStateBuffer());
 	task.output_storage_buffers.push_back(draw_indirect_buffer_.GetBuffer());
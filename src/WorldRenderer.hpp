@@ -17,7 +17,8 @@ public:
 		WorldRenderPass& world_render_pass,
 		GPUDataUploader& gpu_data_uploader,
 		const WorldProcessor& world_processor,
-		vk::DescriptorPool global_descriptor_pool);
+		vk::DescriptorPool global_descriptor_pool,
+		Settings& settings);
 
 	~WorldRenderer();
 
@@ -26,6 +27,8 @@ public:
 	void DrawOpaque(vk::CommandBuffer command_buffer, float time_s);
 	void DrawTransparent(vk::CommandBuffer command_buffer, float time_s);
 
+	WorldGeometryGenerator::VertexMemoryStats GetVertexMemoryStats() const;
+
 private:
 	void DrawWorld(vk::CommandBuffer command_buffer);
 	void DrawWater(vk::CommandBuffer command_buffer, float time_s);
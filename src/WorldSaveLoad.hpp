@@ -18,9 +18,11 @@ struct ChunkHeader
 	uint32_t block_data_size= 0;
 	uint32_t auxiliar_data_offset= 0;
 	uint32_t auxiliar_data_size= 0;
+	uint16_t codec= 0; // ChunkCodec
+	uint16_t auxiliar_data_layout= 0; // AuxiliarDataLayout
 };
 
-static_assert(sizeof(ChunkHeader) == 16, "Invalid size!");
+static_assert(sizeof(ChunkHeader) == 20, "Invalid size!");
 
 struct FileHeader
 {
@@ -35,7 +37,34 @@ struct FileHeader
 static_assert(sizeof(FileHeader) == 16 + sizeof(ChunkHeader) * c_world_region_area, "Invalid size!");
 
 constexpr char c_expected_id[8]{'H', 'e', 'x', 'R', 'e', 'g', 'i', 'o'};
-constexpr uint64_t c_expected_version= 31; // Change this each time format is changed.
+constexpr uint64_t c_expected_version= 33; // Change this each time format is changed.
+
+// Previous format versions, which are still supported for reading.
+
+// Has the same layout as the current version, but all chunks have dense auxiliar data.
+constexpr uint64_t c_version_without_auxiliar_data_layout= 32;
+
+// Has no codec field in chunk header - all chunks are compressed using snappy and have dense auxiliar data.
+constexpr uint64_t c_version_without_codec= 31;
+
+struct LegacyChunkHeader
+{
+	uint32_t block_data_offset= 0;
+	uint32_t block_data_size= 0;
+	uint32_t auxiliar_data_offset= 0;
+	uint32_t auxiliar_data_size= 0;
+};
+
+static_assert(sizeof(LegacyChunkHeader) == 16, "Invalid size!");
+
+struct LegacyFileHeader
+{
+	char id[8]{};
+	uint64_t version= 0;
+	LegacyChunkHeader chunks[c_world_region_area];
+};
+
+static_assert(sizeof(LegacyFileHeader) == 16 + sizeof(LegacyChunkHeader) * c_world_region_area, "Invalid size!");
 
 } // namespace RegionFile
 
@@ -60,6 +60,7 @@ void WorldTexturesGenerator::PrepareFrame(TaskOrganizer& task_organizer)
 	textures_generated_= true;
 
 	TaskOrganizer::ComputeTaskParams task;
+	task.name= "world_textures_gen";
 	task.output_images.push_back(GetImageInfo());
 
 	const auto task_func=
@@ -0,0 +1,131 @@
+#include "Benchmarks.hpp"
+#include "ChunkDataCompressor.hpp"
+#include "Constants.hpp"
+#include "Log.hpp"
+#include "testing/SyntheticWorld.hpp"
+#include <chrono>
+#include <cstring>
+
+namespace HexGPU
+{
+
+namespace
+{
+
+constexpr uint32_t c_num_rounds= 4;
+
+struct LayoutResult
+{
+	uint64_t auxiliar_data_size= 0;
+	double compression_time_s= 1.0e9;
+	double decompression_time_s= 1.0e9;
+	bool round_trip_ok= true;
+};
+
+LayoutResult MeasureLayout(const SyntheticChunks& chunks, const ChunkCodec codec, const AuxiliarDataLayout layout)
+{
+	LayoutResult result;
+
+	const uint32_t num_chunks= chunks.size[0] * chunks.size[1];
+
+	ChunkDataCompressor compressor;
+	std::vector<ChunkDataCompresed> chunks_compressed(num_chunks);
+
+	std::vector<BlockType> blocks(c_chunk_volume);
+	std::vector<uint8_t> auxiliar_data(c_chunk_volume);
+
+	// Take best time of several rounds, first round warms up compressor buffers.
+	for(uint32_t round= 0; round < c_num_rounds; ++round)
+	{
+		const auto compression_start_time= std::chrono::steady_clock::now();
+		for(uint32_t i= 0; i < num_chunks; ++i)
+			chunks_compressed[i]=
+				compressor.Compress(
+					codec,
+					chunks.blocks.data() + i * c_chunk_volume,
+					chunks.auxiliar_data.data() + i * c_chunk_volume,
+					nullptr,
+					layout);
+		const auto compression_end_time= std::chrono::steady_clock::now();
+
+		bool ok= true;
+		for(uint32_t i= 0; i < num_chunks; ++i)
+			ok&= compressor.Decompress(chunks_compressed[i], blocks.data(), auxiliar_data.data());
+		const auto decompression_end_time= std::chrono::steady_clock::now();
+
+		result.compression_time_s=
+			std::min(result.compression_time_s, std::chrono::duration<double>(compression_end_time - compression_start_time).count());
+		result.decompression_time_s=
+			std::min(result.decompression_time_s, std::chrono::duration<double>(decompression_end_time - compression_end_time).count());
+		result.round_trip_ok&= ok;
+	}
+
+	result.auxiliar_data_size= 0;
+	for(uint32_t i= 0; i < num_chunks; ++i)
+	{
+		result.auxiliar_data_size+= chunks_compressed[i].auxiliar_data.size();
+
+		if(!compressor.Decompress(chunks_compressed[i], blocks.data(), auxiliar_data.data()) ||
+			std::memcmp(blocks.data(), chunks.blocks.data() + i * c_chunk_volume, c_chunk_volume) != 0 ||
+			std::memcmp(auxiliar_data.data(), chunks.auxiliar_data.data() + i * c_chunk_volume, c_chunk_volume) != 0)
+			result.round_trip_ok= false;
+	}
+
+	return result;
+}
+
+} // namespace
+
+int RunAuxiliarDataLayoutsBenchmark(const BenchmarkArgs& args)
+{
+	ChunkCodec codec= ChunkCodec::Snappy;
+	if(args.size() >= 1)
+	{
+		const std::optional<ChunkCodec> codec_parsed= StringToChunkCodec(args[0]);
+		if(codec_parsed == std::nullopt)
+		{
+			Log::Warning("Unknown codec \"", args[0], "\"");
+			return -1;
+		}
+		codec= *codec_parsed;
+	}
+
+	uint32_t num_chunks= 1024;
+	if(args.size() >= 2)
+		num_chunks= uint32_t(std::max(1, std::stoi(args[1])));
+
+	const uint32_t size_x= std::min(num_chunks, 32u);
+	const uint32_t size_y= (num_chunks + size_x - 1) / size_x;
+	const SyntheticChunks chunks= GenerateSyntheticChunks(0, 0, size_x, size_y, 0);
+	num_chunks= size_x * size_y;
+
+	Log::Info(
+		"Compress ", num_chunks, " synthetic chunks with codec \"", ChunkCodecToString(codec), "\".",
+		" Time includes blocks data compression, which is the same for both layouts.");
+
+	const double uncompressed_size_mb= double(num_chunks) * double(c_chunk_volume * 2) / double(1 << 20);
+
+	const std::pair<std::string_view, AuxiliarDataLayout> layouts[]
+	{
+		{ "dense", AuxiliarDataLayout::Dense },
+		{ "sparse columns", AuxiliarDataLayout::SparseColumns },
+	};
+
+	bool all_ok= true;
+	for(const auto& layout : layouts)
+	{
+		const LayoutResult result= MeasureLayout(chunks, codec, layout.second);
+		Log::Info(
+			layout.first,
+			": auxiliar data size ", double(result.auxiliar_data_size) / double(num_chunks), " bytes per chunk",
+			", compress ", uncompressed_size_mb / result.compression_time_s, " MB/s",
+			", decompress ", uncompressed_size_mb / result.decompression_time_s, " MB/s",
+			result.round_trip_ok ? "" : ", ROUND TRIP FAILED!");
+
+		all_ok&= result.round_trip_ok;
+	}
+
+	return all_ok ? 0 : -1;
+}
+
+} // namespace HexGPU
@@ -0,0 +1,98 @@
+#include "BenchmarkUtils.hpp"
+#include <cstring>
+#include <filesystem>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <fstream>
+#include <unistd.h>
+#endif
+
+namespace HexGPU
+{
+
+std::optional<size_t> GetProcessResidentMemorySize()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters{};
+	// Use the function from kernel32 in order to avoid linking against psapi.
+	if(!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return std::nullopt;
+
+	return size_t(counters.WorkingSetSize);
+#else
+	// Second value is number of resident pages.
+	std::ifstream file("/proc/self/statm");
+	size_t total_pages= 0, resident_pages= 0;
+	if(!(file >> total_pages >> resident_pages))
+		return std::nullopt;
+
+	return resident_pages * size_t(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+std::vector<std::string> ListRegionFiles(const std::string& world_dir, const size_t max_files)
+{
+	std::vector<std::string> files;
+
+	std::error_code error_code;
+	for(const auto& entry : std::filesystem::directory_iterator(world_dir, error_code))
+	{
+		if(entry.path().extension() == ".region")
+			files.push_back(entry.path().string());
+	}
+
+	// Directory iteration order is unspecified - sort files in order to get stable results.
+	std::sort(files.begin(), files.end());
+	if(files.size() > max_files)
+		files.resize(max_files);
+
+	return files;
+}
+
+std::optional<MappedRegionFile> LoadMappedRegionFile(const std::string& file_name)
+{
+	MappedRegionFile region_file;
+	region_file.file= MemoryMappedFile::Open(file_name);
+	if(region_file.file == nullptr || region_file.file->GetSize() < sizeof(RegionFile::FileHeader))
+		return std::nullopt;
+
+	std::memcpy(&region_file.header, region_file.file->GetData(), sizeof(RegionFile::FileHeader));
+	if(std::memcmp(region_file.header.id, RegionFile::c_expected_id, sizeof(RegionFile::c_expected_id)) != 0 ||
+		region_file.header.version != RegionFile::c_expected_version)
+		return std::nullopt;
+
+	const uint64_t file_size= region_file.file->GetSize();
+	for(const RegionFile::ChunkHeader& chunk_header : region_file.header.chunks)
+	{
+		if(uint64_t(chunk_header.block_data_offset) + uint64_t(chunk_header.block_data_size) > file_size ||
+			uint64_t(chunk_header.auxiliar_data_offset) + uint64_t(chunk_header.auxiliar_data_size) > file_size ||
+			chunk_header.codec >= c_num_chunk_codecs ||
+			chunk_header.auxiliar_data_layout >= c_num_auxiliar_data_layouts)
+			return std::nullopt;
+	}
+
+	return region_file;
+}
+
+std::optional<ChunkDataCompresedView> GetMappedRegionFileChunk(const MappedRegionFile& region_file, const uint32_t chunk_index)
+{
+	const RegionFile::ChunkHeader& chunk_header= region_file.header.chunks[chunk_index];
+	if(chunk_header.block_data_size == 0 || chunk_header.auxiliar_data_size == 0)
+		return std::nullopt;
+
+	const char* const data= region_file.file->GetData();
+	return
+		ChunkDataCompresedView
+		{
+			ChunkCodec(chunk_header.codec),
+			AuxiliarDataLayout(chunk_header.auxiliar_data_layout),
+			std::string_view(data + chunk_header.block_data_offset, chunk_header.block_data_size),
+			std::string_view(data + chunk_header.auxiliar_data_offset, chunk_header.auxiliar_data_size),
+		};
+}
+
+} // namespace HexGPU
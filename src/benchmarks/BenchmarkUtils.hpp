@@ -0,0 +1,51 @@
+#pragma once
+#include "ChunkDataCompressor.hpp"
+#include "MemoryMappedFile.hpp"
+#include "WorldSaveLoad.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace HexGPU
+{
+
+// Helpers, common for different benchmarks.
+
+inline double DurationToMs(const std::chrono::steady_clock::duration duration)
+{
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+// Percentile in range [0; 100]. Samples are sorted in-place.
+inline double CalculatePercentile(std::vector<double>& samples, const double percentile)
+{
+	if(samples.empty())
+		return 0.0;
+
+	std::sort(samples.begin(), samples.end());
+	const size_t index= std::min(samples.size() - 1, size_t(double(samples.size()) * percentile / 100.0));
+	return samples[index];
+}
+
+// Resident set size of current process in bytes. Returns empty result if it can't be determined.
+std::optional<size_t> GetProcessResidentMemorySize();
+
+// Returns paths of region files in given world directory.
+std::vector<std::string> ListRegionFiles(const std::string& world_dir, size_t max_files);
+
+// Region file of current format version, loaded via memory mapping - the way the chunks storage does this.
+struct MappedRegionFile
+{
+	std::unique_ptr<MemoryMappedFile> file;
+	RegionFile::FileHeader header;
+};
+
+// Returns empty result if file can't be loaded or isn't a valid region file.
+std::optional<MappedRegionFile> LoadMappedRegionFile(const std::string& file_name);
+
+// Returns empty result if there is no data for this chunk.
+std::optional<ChunkDataCompresedView> GetMappedRegionFileChunk(const MappedRegionFile& region_file, uint32_t chunk_index);
+
+} // namespace HexGPU
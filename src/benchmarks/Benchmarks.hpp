@@ -0,0 +1,46 @@
+#pragma once
+#include <string>
+#include <vector>
+
+namespace HexGPU
+{
+
+// Benchmarks of CPU parts of the engine. They don't require a GPU.
+// Each benchmark takes its own command line arguments (following the benchmark name), prints results into the log
+// and returns process exit code.
+
+using BenchmarkArgs= std::vector<std::string>;
+
+// Throughput of compression of synthetic chunks in a thread pool depending on number of threads.
+// Args: [codec] [number of chunks].
+int RunChunksCompressionBenchmark(const BenchmarkArgs& args);
+
+// Latency of chunks requests while moving active area over a synthetic world of 64x64 regions.
+// The world is created in given directory if it doesn't exist yet.
+// Args: [world dir] [number of steps] [interval between steps in milliseconds].
+int RunRegionsLoadingBenchmark(const BenchmarkArgs& args);
+
+// Load time and resident memory increase for reading of region files via memory mapping versus "std::ifstream".
+// Args: [world dir] [max number of regions] [percent of accessed chunks].
+int RunRegionFilesReadingBenchmark(const BenchmarkArgs& args);
+
+// Compression ratio, compression and decompression speed of each chunk codec on chunks of a saved world.
+// Synthetic chunks are used if the world has no chunks.
+// Args: [world dir] [max number of chunks].
+int RunChunkCodecsBenchmark(const BenchmarkArgs& args);
+
+// Size and speed of chunks compression with dense auxiliar data (whole array is compressed)
+// versus sparse columns of auxiliar data (only non-zero columns are compressed).
+// Args: [codec] [number of chunks].
+int RunAuxiliarDataLayoutsBenchmark(const BenchmarkArgs& args);
+
+// Single thread speed of the CPU world blocks update of synthetic chunks with and without skipping of static blocks.
+// Args: [world size in chunks] [number of ticks].
+int RunWorldBlocksUpdateBenchmark(const BenchmarkArgs& args);
+
+// Number of light update ticks needed for the light to become stable after chunks loading
+// with and without light precomputation on the CPU, and the cost of the precomputation.
+// Args: [world size in chunks].
+int RunChunkLightPrecomputeBenchmark(const BenchmarkArgs& args);
+
+} // namespace HexGPU
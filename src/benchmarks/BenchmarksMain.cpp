@@ -0,0 +1,68 @@
+#include "Benchmarks.hpp"
+#include "Log.hpp"
+#include <string_view>
+
+namespace HexGPU
+{
+
+namespace
+{
+
+struct BenchmarkDescription
+{
+	std::string_view name;
+	std::string_view args_description;
+	int (*func)(const BenchmarkArgs& args);
+};
+
+const BenchmarkDescription c_benchmarks[]
+{
+	{ "chunks_compression", "[codec] [num_chunks]", RunChunksCompressionBenchmark },
+	{ "regions_loading", "[world_dir] [num_steps] [step_interval_ms]", RunRegionsLoadingBenchmark },
+	{ "region_files_reading", "[world_dir] [max_regions] [accessed_chunks_percent]", RunRegionFilesReadingBenchmark },
+	{ "chunk_codecs", "[world_dir] [max_chunks]", RunChunkCodecsBenchmark },
+	{ "auxiliar_data_layouts", "[codec] [num_chunks]", RunAuxiliarDataLayoutsBenchmark },
+	{ "world_blocks_update", "[world_size] [num_ticks]", RunWorldBlocksUpdateBenchmark },
+	{ "chunk_light_precompute", "[world_size]", RunChunkLightPrecomputeBenchmark },
+};
+
+void PrintUsage()
+{
+	Log::Info("Usage: HexGPUBenchmarks <benchmark name> [benchmark args]");
+	Log::Info("Available benchmarks:");
+	for(const BenchmarkDescription& benchmark : c_benchmarks)
+		Log::Info("\t", benchmark.name, " ", benchmark.args_description);
+}
+
+} // namespace
+
+extern "C" int main(const int argc, char* argv[])
+{
+	try
+	{
+		if(argc < 2)
+		{
+			PrintUsage();
+			return -1;
+		}
+
+		const std::string_view name= argv[1];
+		const BenchmarkArgs args(argv + 2, argv + argc);
+
+		for(const BenchmarkDescription& benchmark : c_benchmarks)
+		{
+			if(benchmark.name == name)
+				return benchmark.func(args);
+		}
+
+		Log::Warning("Unknown benchmark \"", name, "\"");
+		PrintUsage();
+		return -1;
+	}
+	catch(const std::exception& ex)
+	{
+		Log::FatalError("Exception throwed: ", ex.what());
+	}
+}
+
+} // namespace HexGPU
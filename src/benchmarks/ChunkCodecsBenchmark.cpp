@@ -0,0 +1,200 @@
+#include "BenchmarkUtils.hpp"
+#include "Benchmarks.hpp"
+#include "ChunkDataCompressor.hpp"
+#include "Constants.hpp"
+#include "Log.hpp"
+#include "testing/SyntheticWorld.hpp"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace HexGPU
+{
+
+namespace
+{
+
+struct UncompressedChunk
+{
+	std::vector<BlockType> blocks;
+	std::vector<uint8_t> auxiliar_data;
+};
+
+std::shared_ptr<const ZstdDictionary> LoadWorldZstdDictionary(const std::string& world_dir)
+{
+	std::ifstream file(world_dir + "/chunks_zstd_dictionary.bin", std::ios::binary);
+	if(!file.is_open())
+		return nullptr;
+
+	return ZstdDictionary::Load(std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>()));
+}
+
+// Decompress chunks of saved world using codecs they were saved with.
+std::vector<UncompressedChunk> LoadWorldChunks(const std::string& world_dir, const size_t max_chunks)
+{
+	const std::shared_ptr<const ZstdDictionary> world_zstd_dictionary= LoadWorldZstdDictionary(world_dir);
+
+	ChunkDataCompressor compressor;
+	std::vector<UncompressedChunk> chunks;
+
+	for(const std::string& file_name : ListRegionFiles(world_dir, ~size_t(0)))
+	{
+		const std::optional<MappedRegionFile> region_file= LoadMappedRegionFile(file_name);
+		if(region_file == std::nullopt)
+		{
+			Log::Warning("Can't load region file \"", file_name, "\"");
+			continue;
+		}
+
+		for(uint32_t i= 0; i < c_world_region_area && chunks.size() < max_chunks; ++i)
+		{
+			const std::optional<ChunkDataCompresedView> chunk_data= GetMappedRegionFileChunk(*region_file, i);
+			if(chunk_data == std::nullopt)
+				continue;
+
+			UncompressedChunk chunk;
+			chunk.blocks.resize(c_chunk_volume);
+			chunk.auxiliar_data.resize(c_chunk_volume);
+			if(compressor.Decompress(*chunk_data, chunk.blocks.data(), chunk.auxiliar_data.data(), world_zstd_dictionary.get()))
+				chunks.push_back(std::move(chunk));
+		}
+	}
+
+	return chunks;
+}
+
+std::vector<UncompressedChunk> GenerateChunks(const size_t num_chunks)
+{
+	std::vector<UncompressedChunk> chunks(num_chunks);
+	for(size_t i= 0; i < num_chunks; ++i)
+	{
+		UncompressedChunk& chunk= chunks[i];
+		chunk.blocks.resize(c_chunk_volume);
+		chunk.auxiliar_data.resize(c_chunk_volume);
+		GenerateSyntheticChunk(int32_t(i % 32), int32_t(i / 32), 0, chunk.blocks.data(), chunk.auxiliar_data.data());
+	}
+
+	return chunks;
+}
+
+struct CodecResult
+{
+	uint64_t compressed_size= 0;
+	double compression_time_s= 0.0;
+	double decompression_time_s= 0.0;
+	bool round_trip_ok= true;
+};
+
+CodecResult MeasureCodec(
+	const std::vector<UncompressedChunk>& chunks,
+	const ChunkCodec codec,
+	const ZstdDictionary* const zstd_dictionary)
+{
+	CodecResult result;
+
+	ChunkDataCompressor compressor;
+
+	std::vector<ChunkDataCompresed> chunks_compressed;
+	chunks_compressed.reserve(chunks.size());
+
+	const auto compression_start_time= std::chrono::steady_clock::now();
+	for(const UncompressedChunk& chunk : chunks)
+		chunks_compressed.push_back(compressor.Compress(codec, chunk.blocks.data(), chunk.auxiliar_data.data(), zstd_dictionary));
+	const auto compression_end_time= std::chrono::steady_clock::now();
+
+	for(const ChunkDataCompresed& chunk_compressed : chunks_compressed)
+		result.compressed_size+= chunk_compressed.blocks.size() + chunk_compressed.auxiliar_data.size();
+
+	std::vector<BlockType> blocks(c_chunk_volume);
+	std::vector<uint8_t> auxiliar_data(c_chunk_volume);
+
+	double decompression_time_s= 0.0;
+	for(size_t i= 0; i < chunks.size(); ++i)
+	{
+		// Measure only decompression itself, not comparison.
+		const auto decompression_start_time= std::chrono::steady_clock::now();
+		const bool ok= compressor.Decompress(chunks_compressed[i], blocks.data(), auxiliar_data.data(), zstd_dictionary);
+		const auto decompression_end_time= std::chrono::steady_clock::now();
+		decompression_time_s+= std::chrono::duration<double>(decompression_end_time - decompression_start_time).count();
+
+		if(!ok ||
+			std::memcmp(blocks.data(), chunks[i].blocks.data(), c_chunk_volume) != 0 ||
+			std::memcmp(auxiliar_data.data(), chunks[i].auxiliar_data.data(), c_chunk_volume) != 0)
+			result.round_trip_ok= false;
+	}
+
+	result.compression_time_s= std::chrono::duration<double>(compression_end_time - compression_start_time).count();
+	result.decompression_time_s= decompression_time_s;
+
+	return result;
+}
+
+} // namespace
+
+int RunChunkCodecsBenchmark(const BenchmarkArgs& args)
+{
+	const std::string world_dir= args.size() >= 1 ? args[0] : "world";
+
+	size_t max_chunks= 4096;
+	if(args.size() >= 2)
+		max_chunks= size_t(std::max(1, std::stoi(args[1])));
+
+	std::vector<UncompressedChunk> chunks= LoadWorldChunks(world_dir, max_chunks);
+	if(chunks.empty())
+	{
+		Log::Warning("No chunks found in world \"", world_dir, "\", use synthetic chunks");
+		chunks= GenerateChunks(max_chunks);
+	}
+	else
+		Log::Info("Loaded ", chunks.size(), " chunks of world \"", world_dir, "\"");
+
+	// Train dictionary on each second chunk, like the chunks storage does this with first saved chunks.
+	std::vector<std::string> dictionary_samples;
+	for(size_t i= 0; i < chunks.size(); i+= 2)
+		dictionary_samples.emplace_back(reinterpret_cast<const char*>(chunks[i].blocks.data()), c_chunk_volume);
+
+	const std::shared_ptr<const ZstdDictionary> zstd_dictionary= ZstdDictionary::Train(dictionary_samples);
+	if(zstd_dictionary == nullptr)
+		Log::Warning("Can't train zstd dictionary");
+
+	struct CodecVariant
+	{
+		std::string_view name;
+		ChunkCodec codec;
+		bool use_zstd_dictionary;
+	};
+
+	const CodecVariant codec_variants[]
+	{
+		{ "snappy", ChunkCodec::Snappy, false },
+		{ "flat_rle", ChunkCodec::FlatRLE, false },
+		{ "rle", ChunkCodec::ColumnRLE, false },
+		{ "zstd", ChunkCodec::Zstd, false },
+		{ "zstd with dictionary", ChunkCodec::Zstd, true },
+	};
+
+	const double uncompressed_size= double(chunks.size()) * double(c_chunk_volume * 2);
+	const double uncompressed_size_mb= uncompressed_size / double(1 << 20);
+
+	bool all_ok= true;
+	for(const CodecVariant& codec_variant : codec_variants)
+	{
+		if(codec_variant.use_zstd_dictionary && zstd_dictionary == nullptr)
+			continue;
+
+		const CodecResult result=
+			MeasureCodec(chunks, codec_variant.codec, codec_variant.use_zstd_dictionary ? zstd_dictionary.get() : nullptr);
+		Log::Info(
+			codec_variant.name,
+			": ratio ", uncompressed_size / double(result.compressed_size),
+			", compress ", uncompressed_size_mb / result.compression_time_s, " MB/s",
+			", decompress ", uncompressed_size_mb / result.decompression_time_s, " MB/s",
+			result.round_trip_ok ? "" : ", ROUND TRIP FAILED!");
+
+		all_ok&= result.round_trip_ok;
+	}
+
+	return all_ok ? 0 : -1;
+}
+
+} // namespace HexGPU
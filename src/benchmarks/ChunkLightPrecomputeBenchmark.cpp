@@ -0,0 +1,102 @@
+#include "BenchmarkUtils.hpp"
+#include "Benchmarks.hpp"
+#include "Constants.hpp"
+#include "LightUpdateCPU.hpp"
+#include "Log.hpp"
+#include "ThreadPool.hpp"
+#include "testing/SyntheticWorld.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace HexGPU
+{
+
+namespace
+{
+
+// Light of loaded chunks - only direct sky light (like "initial_light_fill" shader) or light precomputed on the CPU.
+void FillLoadedChunksLight(
+	const uint32_t world_size,
+	const std::vector<uint8_t>& blocks,
+	std::vector<uint8_t>& light,
+	const std::vector<ChunkPositionCPU>& loaded_chunks,
+	const bool precompute)
+{
+	for(const ChunkPositionCPU& chunk_position : loaded_chunks)
+	{
+		if(precompute)
+		{
+			const size_t offset= (chunk_position[0] + chunk_position[1] * world_size) * c_chunk_volume;
+			CalculateIsolatedChunkLightCPU(blocks.data() + offset, light.data() + offset);
+		}
+		else
+			InitialFillChunkLightCPU({world_size, world_size}, blocks.data(), light.data(), chunk_position);
+	}
+}
+
+uint32_t CountTicksUntilLightIsStable(
+	const uint32_t world_size,
+	const std::vector<uint8_t>& blocks,
+	std::vector<uint8_t> light,
+	ThreadPool& thread_pool)
+{
+	// Each light update tick performs single propagation step, so, number of steps is number of ticks.
+	// The last step performed doesn't change anything.
+	return PropagateWorldLightCPU({world_size, world_size}, blocks.data(), light.data(), c_chunk_height * 2, thread_pool) - 1;
+}
+
+} // namespace
+
+int RunChunkLightPrecomputeBenchmark(const BenchmarkArgs& args)
+{
+	uint32_t world_size= 16;
+	if(args.size() >= 1)
+		world_size= uint32_t(std::max(2, std::stoi(args[0])));
+
+	const SyntheticChunks chunks= GenerateSyntheticChunks(0, 0, world_size, world_size, 0);
+	const size_t world_volume= size_t(world_size * world_size) * c_chunk_volume;
+
+	std::vector<uint8_t> blocks(world_volume);
+	for(size_t i= 0; i < world_volume; ++i)
+		blocks[i]= uint8_t(chunks.blocks[i]);
+
+	ThreadPool thread_pool;
+
+	// Loading of the whole world (game start) and loading of a row of chunks at the world border (world shift).
+	std::vector<ChunkPositionCPU> all_chunks;
+	std::vector<ChunkPositionCPU> border_chunks;
+	for(uint32_t y= 0; y < world_size; ++y)
+	for(uint32_t x= 0; x < world_size; ++x)
+	{
+		all_chunks.push_back({x, y});
+		if(y == 0)
+			border_chunks.push_back({x, y});
+	}
+
+	std::vector<uint8_t> stable_light(world_volume, 0);
+	FillLoadedChunksLight(world_size, blocks, stable_light, all_chunks, false);
+	PropagateWorldLightCPU({world_size, world_size}, blocks.data(), stable_light.data(), c_chunk_height * 2, thread_pool);
+
+	Log::Info("Ticks until light is stable after chunks loading, ", world_size, "x", world_size, " synthetic chunks");
+
+	for(const bool precompute : {false, true})
+	{
+		std::vector<uint8_t> world_loading_light(world_volume, 0);
+		const auto start_time= std::chrono::steady_clock::now();
+		FillLoadedChunksLight(world_size, blocks, world_loading_light, all_chunks, precompute);
+		const auto end_time= std::chrono::steady_clock::now();
+
+		std::vector<uint8_t> border_loading_light= stable_light;
+		FillLoadedChunksLight(world_size, blocks, border_loading_light, border_chunks, precompute);
+
+		Log::Info(
+			precompute ? "precompute: " : "direct sky light only: ",
+			CountTicksUntilLightIsStable(world_size, blocks, std::move(world_loading_light), thread_pool), " ticks for whole world, ",
+			CountTicksUntilLightIsStable(world_size, blocks, std::move(border_loading_light), thread_pool), " ticks for border row, ",
+			DurationToMs(end_time - start_time) * 1000.0 / double(all_chunks.size()), " us per chunk on the CPU");
+	}
+
+	return 0;
+}
+
+} // namespace HexGPU
@@ -0,0 +1,127 @@
+#include "Benchmarks.hpp"
+#include "ChunkDataCompressor.hpp"
+#include "Constants.hpp"
+#include "Log.hpp"
+#include "ThreadPool.hpp"
+#include "testing/SyntheticWorld.hpp"
+#include <algorithm>
+#include <chrono>
+#include <future>
+
+namespace HexGPU
+{
+
+namespace
+{
+
+constexpr uint32_t c_num_rounds= 4;
+
+// Compress all chunks in the thread pool in the same way the world processor does - one task per chunk.
+// Returns time in seconds.
+double CompressChunks(
+	const SyntheticChunks& chunks,
+	const ChunkCodec codec,
+	ThreadPool& thread_pool,
+	uint64_t& out_compressed_size)
+{
+	const uint32_t num_chunks= chunks.size[0] * chunks.size[1];
+
+	std::vector<std::future<ChunkDataCompresed>> tasks;
+	tasks.reserve(num_chunks);
+
+	const auto start_time= std::chrono::steady_clock::now();
+
+	for(uint32_t i= 0; i < num_chunks; ++i)
+	{
+		const BlockType* const blocks_data= chunks.blocks.data() + i * c_chunk_volume;
+		const uint8_t* const blocks_auxiliar_data= chunks.auxiliar_data.data() + i * c_chunk_volume;
+		tasks.push_back(
+			thread_pool.Submit(
+				[codec, blocks_data, blocks_auxiliar_data]
+				{
+					// Compressor isn't thread-safe, so, use separate compressor for each thread.
+					thread_local ChunkDataCompressor compressor;
+					return compressor.Compress(codec, blocks_data, blocks_auxiliar_data);
+				}));
+	}
+
+	out_compressed_size= 0;
+	for(std::future<ChunkDataCompresed>& task : tasks)
+	{
+		const ChunkDataCompresed data_compressed= task.get();
+		out_compressed_size+= data_compressed.blocks.size() + data_compressed.auxiliar_data.size();
+	}
+
+	const auto end_time= std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+} // namespace
+
+int RunChunksCompressionBenchmark(const BenchmarkArgs& args)
+{
+	ChunkCodec codec= ChunkCodec::Snappy;
+	if(args.size() >= 1)
+	{
+		const std::optional<ChunkCodec> codec_parsed= StringToChunkCodec(args[0]);
+		if(codec_parsed == std::nullopt)
+		{
+			Log::Warning("Unknown codec \"", args[0], "\"");
+			return -1;
+		}
+		codec= *codec_parsed;
+	}
+
+	uint32_t num_chunks= 1024;
+	if(args.size() >= 2)
+		num_chunks= uint32_t(std::max(1, std::stoi(args[1])));
+
+	// Generate a rectangular area of chunks with approximately requested number of chunks.
+	const uint32_t size_x= std::min(num_chunks, 32u);
+	const uint32_t size_y= (num_chunks + size_x - 1) / size_x;
+	const SyntheticChunks chunks= GenerateSyntheticChunks(0, 0, size_x, size_y, 0);
+	num_chunks= size_x * size_y;
+
+	// Check all powers of two up to number of CPU cores and the number of cores itself.
+	const uint32_t max_threads= std::max(1u, std::thread::hardware_concurrency());
+	std::vector<uint32_t> threads_counts;
+	for(uint32_t num_threads= 1; num_threads < max_threads; num_threads*= 2)
+		threads_counts.push_back(num_threads);
+	threads_counts.push_back(max_threads);
+
+	Log::Info(
+		"Compress ", num_chunks, " synthetic chunks (", c_chunk_width, "x", c_chunk_width, "x", c_chunk_height, ")",
+		" with codec \"", ChunkCodecToString(codec), "\"");
+
+	const double uncompressed_size_mb= double(num_chunks) * double(c_chunk_volume * 2) / double(1 << 20);
+
+	double single_thread_chunks_per_second= 0.0;
+	for(const uint32_t num_threads : threads_counts)
+	{
+		ThreadPool thread_pool(num_threads);
+
+		// Warm-up round to create thread-local compressors.
+		uint64_t compressed_size= 0;
+		CompressChunks(chunks, codec, thread_pool, compressed_size);
+
+		double best_time_s= 1.0e9;
+		for(uint32_t round= 0; round < c_num_rounds; ++round)
+			best_time_s= std::min(best_time_s, CompressChunks(chunks, codec, thread_pool, compressed_size));
+
+		const double chunks_per_second= double(num_chunks) / best_time_s;
+		if(num_threads == 1)
+			single_thread_chunks_per_second= chunks_per_second;
+
+		Log::Info(
+			"Threads: ", num_threads,
+			", chunks/s: ", uint64_t(chunks_per_second),
+			", MB/s: ", uint64_t(uncompressed_size_mb / best_time_s),
+			", speedup: ", chunks_per_second / single_thread_chunks_per_second,
+			", compression ratio: ", double(num_chunks) * double(c_chunk_volume * 2) / double(compressed_size));
+	}
+
+	return 0;
+}
+
+} // namespace HexGPU
@@ -0,0 +1,201 @@
+#include "BenchmarkUtils.hpp"
+#include "Benchmarks.hpp"
+#include "ChunkDataCompressor.hpp"
+#include "Log.hpp"
+#include <cstring>
+#include <fstream>
+
+namespace HexGPU
+{
+
+namespace
+{
+
+// Region fully read via "std::ifstream" - the way the chunks storage did this before memory mapping was used.
+struct ReadRegion
+{
+	ChunkDataCompresed chunks[c_world_region_area];
+};
+
+std::optional<ReadRegion> LoadRegionRead(const std::string& file_name)
+{
+	std::ifstream file(file_name, std::ios::binary);
+	if(!file.is_open())
+		return std::nullopt;
+
+	RegionFile::FileHeader header;
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if(file.fail() ||
+		std::memcmp(header.id, RegionFile::c_expected_id, sizeof(RegionFile::c_expected_id)) != 0 ||
+		header.version != RegionFile::c_expected_version)
+		return std::nullopt;
+
+	ReadRegion region;
+	for(uint32_t i= 0; i < c_world_region_area; ++i)
+	{
+		const RegionFile::ChunkHeader& chunk_header= header.chunks[i];
+		if(chunk_header.block_data_size != 0 && chunk_header.auxiliar_data_size != 0)
+		{
+			ChunkDataCompresed& chunk_data= region.chunks[i];
+
+			chunk_data.blocks.resize(chunk_header.block_data_size);
+			file.seekg(chunk_header.block_data_offset);
+			file.read(chunk_data.blocks.data(), chunk_header.block_data_size);
+
+			chunk_data.auxiliar_data.resize(chunk_header.auxiliar_data_size);
+			file.seekg(chunk_header.auxiliar_data_offset);
+			file.read(chunk_data.auxiliar_data.data(), chunk_header.auxiliar_data_size);
+		}
+	}
+
+	if(file.fail())
+		return std::nullopt;
+
+	return region;
+}
+
+// Read all bytes of given data, like decompression does.
+uint64_t CalculateChecksum(const std::string_view data)
+{
+	uint64_t result= 0;
+	for(const char c : data)
+		result= result * 31u + uint8_t(c);
+	return result;
+}
+
+// Chunks are accessed in the same pattern in both modes - each chunk with index within given fraction of region area.
+bool IsChunkAccessed(const uint32_t chunk_index, const uint32_t accessed_chunks_percent)
+{
+	return (chunk_index * 37u) % 100u < accessed_chunks_percent;
+}
+
+struct ReadingResult
+{
+	double load_time_ms= 0.0;
+	double access_time_ms= 0.0;
+	size_t rss_increase= 0;
+	uint64_t checksum= 0;
+};
+
+template<typename Region, typename LoadFunc, typename GetChunkFunc>
+ReadingResult MeasureRegionsReading(
+	const std::vector<std::string>& files,
+	const uint32_t accessed_chunks_percent,
+	const LoadFunc& load_func,
+	const GetChunkFunc& get_chunk_func)
+{
+	ReadingResult result;
+
+	const size_t initial_rss= GetProcessResidentMemorySize().value_or(0);
+
+	std::vector<Region> regions;
+	regions.reserve(files.size());
+
+	const auto load_start_time= std::chrono::steady_clock::now();
+	for(const std::string& file : files)
+	{
+		if(std::optional<Region> region= load_func(file))
+			regions.push_back(std::move(*region));
+	}
+	const auto load_end_time= std::chrono::steady_clock::now();
+
+	for(const Region& region : regions)
+	{
+		for(uint32_t i= 0; i < c_world_region_area; ++i)
+		{
+			if(!IsChunkAccessed(i, accessed_chunks_percent))
+				continue;
+
+			const std::pair<std::string_view, std::string_view> chunk_data= get_chunk_func(region, i);
+			result.checksum+= CalculateChecksum(chunk_data.first) + CalculateChecksum(chunk_data.second);
+		}
+	}
+	const auto access_end_time= std::chrono::steady_clock::now();
+
+	// Measure memory while regions are still alive.
+	const size_t final_rss= GetProcessResidentMemorySize().value_or(0);
+
+	result.load_time_ms= DurationToMs(load_end_time - load_start_time);
+	result.access_time_ms= DurationToMs(access_end_time - load_end_time);
+	result.rss_increase= final_rss > initial_rss ? final_rss - initial_rss : 0;
+
+	return result;
+}
+
+void PrintReadingResult(const std::string_view mode_name, const ReadingResult& result)
+{
+	Log::Info(
+		mode_name, ": load time ", result.load_time_ms, " ms",
+		", chunks access time ", result.access_time_ms, " ms",
+		", RSS increase ", result.rss_increase / 1024u, " KB",
+		", checksum ", result.checksum);
+}
+
+} // namespace
+
+int RunRegionFilesReadingBenchmark(const BenchmarkArgs& args)
+{
+	const std::string world_dir= args.size() >= 1 ? args[0] : "benchmark_world";
+
+	uint32_t max_regions= 64;
+	if(args.size() >= 2)
+		max_regions= uint32_t(std::max(1, std::stoi(args[1])));
+
+	// By default access approximately the fraction of loaded chunks used by the world processor.
+	uint32_t accessed_chunks_percent= 30;
+	if(args.size() >= 3)
+		accessed_chunks_percent= uint32_t(std::max(0, std::min(std::stoi(args[2]), 100)));
+
+	const std::vector<std::string> files= ListRegionFiles(world_dir, max_regions);
+
+	if(files.empty())
+	{
+		Log::Warning("No region files found in \"", world_dir, "\"");
+		return -1;
+	}
+
+	if(GetProcessResidentMemorySize() == std::nullopt)
+		Log::Warning("Can't determine resident memory size");
+
+	Log::Info(
+		"Read ", files.size(), " region files, access ", accessed_chunks_percent, "% of chunks.",
+		" Note that files are likely already in the OS cache.");
+
+	// Measure mapping first, since memory freed after reading may be not returned to the OS.
+	const ReadingResult mapped_result=
+		MeasureRegionsReading<MappedRegionFile>(
+			files,
+			accessed_chunks_percent,
+			LoadMappedRegionFile,
+			[](const MappedRegionFile& region_file, const uint32_t chunk_index)
+			{
+				const std::optional<ChunkDataCompresedView> chunk_data= GetMappedRegionFileChunk(region_file, chunk_index);
+				if(chunk_data == std::nullopt)
+					return std::make_pair(std::string_view(), std::string_view());
+				return std::make_pair(chunk_data->blocks, chunk_data->auxiliar_data);
+			});
+
+	const ReadingResult read_result=
+		MeasureRegionsReading<ReadRegion>(
+			files,
+			accessed_chunks_percent,
+			LoadRegionRead,
+			[](const ReadRegion& region, const uint32_t chunk_index)
+			{
+				const ChunkDataCompresed& chunk_data= region.chunks[chunk_index];
+				return std::make_pair(std::string_view(chunk_data.blocks), std::string_view(chunk_data.auxiliar_data));
+			});
+
+	PrintReadingResult("mmap", mapped_result);
+	PrintReadingResult("ifstream", read_result);
+
+	if(mapped_result.checksum != read_result.checksum)
+	{
+		Log::Warning("Checksum mismatch!");
+		return -1;
+	}
+
+	return 0;
+}
+
+} // namespace HexGPU
@@ -0,0 +1,166 @@
+#include "BenchmarkUtils.hpp"
+#include "Benchmarks.hpp"
+#include "ChunksStorage.hpp"
+#include "Constants.hpp"
+#include "Log.hpp"
+#include "testing/SyntheticWorld.hpp"
+#include <filesystem>
+#include <thread>
+
+namespace HexGPU
+{
+
+namespace
+{
+
+// Size of synthetic world in regions.
+constexpr uint32_t c_world_size_regions= 64;
+
+// Regions are hard links to a small number of distinct region files, in order to save time and disk space.
+constexpr uint32_t c_num_template_regions= 16;
+
+// Use maximum world size.
+constexpr std::array<uint32_t, 2> c_active_area_size{48, 48};
+
+std::string GetRegionFileName(const int32_t region_x, const int32_t region_y)
+{
+	return
+		"lon_" + std::to_string(region_x * int32_t(c_world_region_size[0])) +
+		"_lat_" + std::to_string(region_y * int32_t(c_world_region_size[1])) + ".region";
+}
+
+void CreateTemplateRegions(Settings& settings, const std::string& templates_dir)
+{
+	std::filesystem::create_directories(templates_dir);
+	settings.SetString("g_world_dir", templates_dir);
+
+	// Chunks storage saves all regions on destruction.
+	ChunksStorage chunks_storage(settings);
+
+	ChunkDataCompressor compressor;
+	std::vector<BlockType> blocks(c_chunk_volume);
+	std::vector<uint8_t> auxiliar_data(c_chunk_volume);
+
+	for(uint32_t i= 0; i < c_num_template_regions; ++i)
+	for(uint32_t y= 0; y < c_world_region_size[1]; ++y)
+	for(uint32_t x= 0; x < c_world_region_size[0]; ++x)
+	{
+		const ChunksStorage::ChunkCoord chunk_coord{int32_t(i * c_world_region_size[0] + x), int32_t(y)};
+		GenerateSyntheticChunk(chunk_coord[0], chunk_coord[1], 0, blocks.data(), auxiliar_data.data());
+		chunks_storage.SetChunk(chunk_coord, compressor.Compress(ChunkCodec::Snappy, blocks.data(), auxiliar_data.data()));
+	}
+}
+
+bool PrepareWorld(Settings& settings, const std::string& world_dir)
+{
+	const std::string last_region_path=
+		world_dir + "/" + GetRegionFileName(int32_t(c_world_size_regions) - 1, int32_t(c_world_size_regions) - 1);
+	if(std::filesystem::exists(last_region_path))
+	{
+		Log::Info("Use existing world in \"", world_dir, "\"");
+		return true;
+	}
+
+	Log::Info("Create synthetic world in \"", world_dir, "\"");
+
+	const std::string templates_dir= world_dir + "/templates";
+	CreateTemplateRegions(settings, templates_dir);
+
+	for(uint32_t y= 0; y < c_world_size_regions; ++y)
+	for(uint32_t x= 0; x < c_world_size_regions; ++x)
+	{
+		const std::string template_path=
+			templates_dir + "/" + GetRegionFileName(int32_t((x * 7 + y * 3) % c_num_template_regions), 0);
+		const std::string region_path= world_dir + "/" + GetRegionFileName(int32_t(x), int32_t(y));
+
+		std::error_code error_code;
+		std::filesystem::create_hard_link(template_path, region_path, error_code);
+		if(error_code)
+		{
+			// Hard links may be unsupported by the file system.
+			std::filesystem::copy_file(template_path, region_path, error_code);
+			if(error_code)
+			{
+				Log::Warning("Can't create file \"", region_path, "\": ", error_code.message());
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+} // namespace
+
+int RunRegionsLoadingBenchmark(const BenchmarkArgs& args)
+{
+	const std::string world_dir= args.size() >= 1 ? args[0] : "benchmark_world";
+
+	uint32_t num_steps= 512;
+	if(args.size() >= 2)
+		num_steps= uint32_t(std::max(1, std::stoi(args[1])));
+
+	uint32_t step_interval_ms= 10;
+	if(args.size() >= 3)
+		step_interval_ms= uint32_t(std::max(0, std::stoi(args[2])));
+
+	Settings settings("HexGPUBenchmarks.cfg");
+	if(!PrepareWorld(settings, world_dir))
+		return -1;
+
+	settings.SetString("g_world_dir", world_dir);
+	ChunksStorage chunks_storage(settings);
+
+	// Start near the world corner and move diagonally by one chunk each step, like a fast moving player.
+	// Only chunks entering the active area are requested, like the world processor does.
+	ChunksStorage::ChunkCoord start{int32_t(c_world_region_size[0] * 2), int32_t(c_world_region_size[1] * 2)};
+	const int32_t size_x= int32_t(c_active_area_size[0]);
+	const int32_t size_y= int32_t(c_active_area_size[1]);
+
+	const auto initial_load_start_time= std::chrono::steady_clock::now();
+	chunks_storage.SetActiveArea(start, c_active_area_size);
+	for(int32_t y= 0; y < size_y; ++y)
+	for(int32_t x= 0; x < size_x; ++x)
+		chunks_storage.GetChunk({start[0] + x, start[1] + y});
+	const auto initial_load_end_time= std::chrono::steady_clock::now();
+
+	Log::Info(
+		"Initial load of ", size_x, "x", size_y, " chunks: ",
+		DurationToMs(initial_load_end_time - initial_load_start_time), " ms");
+
+	const int32_t max_coord= int32_t(c_world_size_regions * std::min(c_world_region_size[0], c_world_region_size[1]));
+
+	std::vector<double> steps_time_ms;
+	steps_time_ms.reserve(num_steps);
+	for(uint32_t step= 0; step < num_steps; ++step)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(step_interval_ms));
+
+		// Stop at world borders.
+		if(start[0] + size_x * 2 >= max_coord || start[1] + size_y * 2 >= max_coord)
+			break;
+
+		++start[0];
+		++start[1];
+
+		const auto step_start_time= std::chrono::steady_clock::now();
+
+		chunks_storage.SetActiveArea(start, c_active_area_size);
+		for(int32_t y= 0; y < size_y; ++y)
+			chunks_storage.GetChunk({start[0] + size_x - 1, start[1] + y});
+		for(int32_t x= 0; x < size_x - 1; ++x)
+			chunks_storage.GetChunk({start[0] + x, start[1] + size_y - 1});
+
+		const auto step_end_time= std::chrono::steady_clock::now();
+		steps_time_ms.push_back(DurationToMs(step_end_time - step_start_time));
+	}
+
+	Log::Info("Steps: ", steps_time_ms.size(), ", interval: ", step_interval_ms, " ms");
+	Log::Info("Step latency p50: ", CalculatePercentile(steps_time_ms, 50.0), " ms");
+	Log::Info("Step latency p99: ", CalculatePercentile(steps_time_ms, 99.0), " ms");
+	Log::Info("Step latency max: ", CalculatePercentile(steps_time_ms, 100.0), " ms");
+
+	return 0;
+}
+
+} // namespace HexGPU
@@ -0,0 +1,123 @@
+#include "Benchmarks.hpp"
+#include "Constants.hpp"
+#include "CpuFeatures.hpp"
+#include "LightUpdateCPU.hpp"
+#include "Log.hpp"
+#include "ThreadPool.hpp"
+#include "WorldBlocksUpdateCPU.hpp"
+#include "testing/SyntheticWorld.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace HexGPU
+{
+
+namespace
+{
+
+struct WorldState
+{
+	std::vector<uint8_t> blocks;
+	std::vector<uint8_t> auxiliar_data;
+};
+
+struct UpdateResult
+{
+	double time_s= 0.0;
+	WorldState final_state;
+};
+
+// Light isn't updated, since only blocks update is measured.
+UpdateResult RunUpdate(
+	const uint32_t world_size,
+	const WorldState& initial_state,
+	const std::vector<uint8_t>& light,
+	const uint32_t num_ticks,
+	const bool skip_static_blocks,
+	ThreadPool& thread_pool)
+{
+	WorldState states[2]{ initial_state, initial_state };
+
+	WorldBlocksUpdateCPUParams params;
+	params.world_size_chunks= {world_size, world_size};
+	params.sky_light_mask= -1;
+	params.sky_light_based_wetness_mask= -1;
+	params.snow_z_level= int32_t(c_chunk_height);
+	params.skip_static_blocks= skip_static_blocks;
+
+	const auto start_time= std::chrono::steady_clock::now();
+	for(uint32_t tick= 0; tick < num_ticks; ++tick)
+	{
+		const WorldState& src= states[tick & 1];
+		WorldState& dst= states[(tick & 1) ^ 1];
+
+		WorldBlocksUpdateCPUData data;
+		data.chunks_input_data= src.blocks.data();
+		data.chunks_auxiliar_input_data= src.auxiliar_data.data();
+		data.light_data= light.data();
+		data.chunks_output_data= dst.blocks.data();
+		data.chunks_auxiliar_output_data= dst.auxiliar_data.data();
+
+		params.current_tick= tick;
+		UpdateWorldBlocksCPU(params, data, thread_pool);
+	}
+	const auto end_time= std::chrono::steady_clock::now();
+
+	UpdateResult result;
+	result.time_s= std::chrono::duration<double>(end_time - start_time).count();
+	result.final_state= std::move(states[num_ticks & 1]);
+	return result;
+}
+
+} // namespace
+
+int RunWorldBlocksUpdateBenchmark(const BenchmarkArgs& args)
+{
+	uint32_t world_size= 8;
+	if(args.size() >= 1)
+		world_size= uint32_t(std::max(1, std::stoi(args[0])));
+
+	uint32_t num_ticks= 64;
+	if(args.size() >= 2)
+		num_ticks= uint32_t(std::max(1, std::stoi(args[1])));
+
+	const SyntheticChunks chunks= GenerateSyntheticChunks(0, 0, world_size, world_size, 0);
+	const size_t world_volume= size_t(world_size * world_size) * c_chunk_volume;
+
+	WorldState initial_state;
+	initial_state.blocks.resize(world_volume);
+	initial_state.auxiliar_data= chunks.auxiliar_data;
+	for(size_t i= 0; i < world_volume; ++i)
+		initial_state.blocks[i]= uint8_t(chunks.blocks[i]);
+
+	// Measure single thread performance.
+	ThreadPool thread_pool(1);
+
+	std::vector<uint8_t> light(world_volume);
+	for(uint32_t y= 0; y < world_size; ++y)
+	for(uint32_t x= 0; x < world_size; ++x)
+		InitialFillChunkLightCPU({world_size, world_size}, initial_state.blocks.data(), light.data(), {x, y});
+	PropagateWorldLightCPU({world_size, world_size}, initial_state.blocks.data(), light.data(), c_chunk_height * 2, thread_pool);
+
+	Log::Info(
+		"Update ", world_size, "x", world_size, " synthetic chunks for ", num_ticks, " ticks in single thread.",
+		" AVX2 is ", CpuSupportsAVX2() ? "supported" : "not supported");
+
+	const UpdateResult all_blocks_result= RunUpdate(world_size, initial_state, light, num_ticks, false, thread_pool);
+	const UpdateResult skip_static_blocks_result= RunUpdate(world_size, initial_state, light, num_ticks, true, thread_pool);
+
+	const double num_blocks_processed= double(world_volume) * double(num_ticks);
+	Log::Info("all blocks: ", num_blocks_processed / all_blocks_result.time_s / 1.0e6, " Mblocks/s");
+	Log::Info("skip static blocks: ", num_blocks_processed / skip_static_blocks_result.time_s / 1.0e6, " Mblocks/s");
+
+	if( all_blocks_result.final_state.blocks != skip_static_blocks_result.final_state.blocks ||
+		all_blocks_result.final_state.auxiliar_data != skip_static_blocks_result.final_state.auxiliar_data)
+	{
+		Log::Warning("Results are different!");
+		return -1;
+	}
+
+	return 0;
+}
+
+} // namespace HexGPU
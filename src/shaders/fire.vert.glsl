@@ -7,14 +7,15 @@
 #include "inc/constants.glsl"
 #include "inc/world_rendering_constants.glsl"
 #include "inc/world_shader_uniforms.glsl"
+#include "inc/world_vertex.glsl"
 
 layout(binding= 0) uniform uniforms_block
 {
 	WorldShaderUniforms uniforms;
 };
 
-layout(location=0) in vec3 pos;
-layout(location=1) in i16vec4 tex_coord;
+layout(location=0) in uint pos_xy_tex_coord;
+layout(location=1) in uvec2 pos_z_light;
 
 layout(location= 0) out vec2 f_tex_coord;
 layout(location= 1) out flat float f_fire_power;
@@ -22,12 +23,15 @@ layout(location= 2) out vec3 f_fog_coord;
 
 void main()
 {
-	f_tex_coord= vec2(tex_coord.xy) * c_tex_coord_scale;
+	ivec2 chunk_global_coord= UnpackChunkGlobalCoordFromInstanceIndex(gl_InstanceIndex);
+	ivec3 pos= UnpackWorldVertexPos(pos_xy_tex_coord, pos_z_light.x, chunk_global_coord);
+
+	f_tex_coord= vec2(UnpackWorldVertexTexCoord(pos_xy_tex_coord)) * c_tex_coord_scale;
 
 	// TODO - maybe use greater factor to show fire growing slower?
-	f_fire_power= min(1.0, float(tex_coord.w) * (1.0 / float(c_min_fire_power_for_fire_to_spread)));
+	f_fire_power= min(1.0, float(pos_z_light.y) * (1.0 / float(c_min_fire_power_for_fire_to_spread)));
 
-	vec4 pos4= vec4(pos, 1.0);
+	vec4 pos4= vec4(vec3(pos), 1.0);
 
 	f_fog_coord= (uniforms.fog_matrix * pos4).xyz;
 
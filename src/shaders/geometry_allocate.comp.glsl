@@ -6,6 +6,10 @@
 
 #include "inc/allocator.glsl"
 #include "inc/chunk_draw_info.glsl"
+#include "inc/geometry_allocation_stats.glsl"
+
+// If this is changed, corresponding C++ code must be changed too!
+layout(local_size_x= 64, local_size_y = 1, local_size_z= 1) in;
 
 layout(push_constant) uniform uniforms_block
 {
@@ -18,20 +22,19 @@ layout(binding= 0, std430) buffer chunk_draw_info_buffer
 	ChunkDrawInfo chunk_draw_info[];
 };
 
-// Max number of quads is 65536 / 4 (uint16_t index limit).
-// Min number should be 32 times less because of allocator limitations.
-const uint c_allocation_unut_size_quads= 512;
+layout(binding= 1, std430) buffer geometry_allocation_stats_buffer
+{
+	GeometryAllocationStats geometry_allocation_stats;
+};
 
 void main()
 {
-	// Perform updates for all chunks in single thread.
-	for(uint i= 0; i < num_chunks_to_allocate; ++i)
+	// Each invocation performs allocation for its own chunk.
+	// Allocator is lock-free, so allocations of different chunks may happen in parallel.
+	uint i= gl_GlobalInvocationID.x;
+	if(i < num_chunks_to_allocate)
 	{
 		uint chunk_index= uint(chunks_to_allocate_list[i]);
-		chunk_draw_info[chunk_index].num_quads= 0;
-		chunk_draw_info[chunk_index].num_water_quads= 0;
-		chunk_draw_info[chunk_index].num_fire_quads= 0;
-		chunk_draw_info[chunk_index].num_grass_quads= 0;
 
 		uint total_quads=
 			chunk_draw_info[chunk_index].new_num_quads +
@@ -43,7 +46,8 @@ void main()
 		uint num_memory_units_required=
 			(total_quads + (c_allocation_unut_size_quads - 1)) / c_allocation_unut_size_quads;
 
-		if(num_memory_units_required != chunk_draw_info[chunk_index].num_memory_units)
+		uint num_memory_units_current= chunk_draw_info[chunk_index].num_memory_units;
+		if(num_memory_units_required != num_memory_units_current)
 		{
 			// Perform allocation in both cases if have not enough memory and if have too much memory.
 			// Doing so allows us to free excessive memory if it is no longer needed.
@@ -51,19 +55,36 @@ void main()
 			if(new_unit != c_allocator_fail_result)
 			{
 				// Free previous buffer.
-				AllocatorFree(chunk_draw_info[chunk_index].first_memory_unit, chunk_draw_info[chunk_index].num_memory_units);
+				AllocatorFree(chunk_draw_info[chunk_index].first_memory_unit, num_memory_units_current);
 
 				// Save allocated memory.
 				chunk_draw_info[chunk_index].first_memory_unit= new_unit;
 				chunk_draw_info[chunk_index].num_memory_units= num_memory_units_required;
+
+				// Unsigned overflow is fine here.
+				atomicAdd(geometry_allocation_stats.num_used_units, num_memory_units_required - num_memory_units_current);
+			}
+			else if(num_memory_units_required > num_memory_units_current)
+			{
+				// Not enough memory for new geometry.
+				// Keep old geometry - don't change quads counters and offsets.
+				// Geometry copy shader skips chunks with not enough memory.
+				// Count only failures which may be fixed by freeing some memory.
+				if(num_memory_units_required <= 32)
+					atomicAdd(geometry_allocation_stats.num_failed_allocations, 1u);
+				return;
 			}
 			else
 			{
-				// Do nothing here.
-				// TODO - avoid rebuilding chunk geometry if allocation fails.
+				// Allocation of less memory failed - continue using previous memory.
 			}
 		}
 
+		chunk_draw_info[chunk_index].num_quads= 0;
+		chunk_draw_info[chunk_index].num_water_quads= 0;
+		chunk_draw_info[chunk_index].num_fire_quads= 0;
+		chunk_draw_info[chunk_index].num_grass_quads= 0;
+
 		uint quads_offset= chunk_draw_info[chunk_index].first_memory_unit * c_allocation_unut_size_quads;
 		chunk_draw_info[chunk_index].first_quad= quads_offset;
 		quads_offset+= chunk_draw_info[chunk_index].new_num_quads;
@@ -0,0 +1,127 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive : require
+#extension GL_EXT_shader_explicit_arithmetic_types_int8 : require
+#extension GL_EXT_shader_explicit_arithmetic_types_int16 : require
+
+#include "inc/chunk_draw_info.glsl"
+#include "inc/geometry_chunks_to_update_list.glsl"
+#include "inc/geometry_gen_scratch.glsl"
+#include "inc/world_quad.glsl"
+
+// If this is changed, corresponding C++ code must be changed too!
+layout(local_size_x= 64, local_size_y = 1, local_size_z= 1) in;
+
+layout(binding= 0, std430) writeonly buffer vertices_buffer
+{
+	Quad quads[];
+};
+
+layout(binding= 1, std430) readonly buffer scratch_quads_buffer
+{
+	Quad scratch_quads[];
+};
+
+layout(binding= 2, std430) readonly buffer scratch_quad_kinds_buffer
+{
+	uint8_t scratch_quad_kinds[];
+};
+
+layout(binding= 3, std430) readonly buffer scratch_num_quads_buffer
+{
+	uint scratch_num_quads[];
+};
+
+layout(binding= 4, std430) buffer chunk_draw_info_buffer
+{
+	ChunkDrawInfo chunk_draw_info[];
+};
+
+layout(binding= 5, std430) readonly buffer chunks_to_update_list_buffer
+{
+	ChunkToUpdate chunks_to_update_list[];
+};
+
+layout(push_constant) uniform uniforms_block
+{
+	ivec2 world_size_chunks;
+	uint chunks_list_offset; // Index of the first chunk of this batch in chunks to update list.
+};
+
+// Number of quads of each kind in this workgroup and offset of workgroup quads of each kind in chunk memory.
+shared uint workgroup_num_quads[c_num_quad_kinds];
+shared uint workgroup_quads_offset[c_num_quad_kinds];
+
+void main()
+{
+	// Each invocation copies one quad from scratch memory into memory allocated for the chunk.
+	// Each chunk of the batch is processed by its own row of workgroups along Y axis.
+
+	uint batch_chunk_index= gl_WorkGroupID.y;
+	ChunkToUpdate chunk_to_update= chunks_to_update_list[chunks_list_offset + batch_chunk_index];
+	int chunk_index= chunk_to_update.chunk_position.x + chunk_to_update.chunk_position.y * world_size_chunks.x;
+
+	// Early exits here are uniform for the whole workgroup.
+
+	uint num_quads= min(scratch_num_quads[batch_chunk_index], c_geometry_scratch_chunk_capacity_quads);
+	if(gl_WorkGroupID.x * gl_WorkGroupSize.x >= num_quads)
+		return;
+
+	// Do not write anything if allocation failed, in order to avoid overwriting memory of other chunks.
+	// Such chunk keeps its old geometry, since its counters of quads weren't reset during allocation.
+	uint total_new_quads=
+		chunk_draw_info[chunk_index].new_num_quads +
+		chunk_draw_info[chunk_index].new_water_num_quads +
+		chunk_draw_info[chunk_index].new_fire_num_quads +
+		chunk_draw_info[chunk_index].new_grass_num_quads;
+	if(total_new_quads > chunk_draw_info[chunk_index].num_memory_units * c_allocation_unut_size_quads)
+		return;
+
+	if(gl_LocalInvocationIndex < c_num_quad_kinds)
+		workgroup_num_quads[gl_LocalInvocationIndex]= 0u;
+
+	memoryBarrierShared();
+	barrier();
+
+	// Calculate offset of this quad among workgroup quads of the same kind.
+	uint index_in_chunk= gl_GlobalInvocationID.x;
+	uint scratch_index= batch_chunk_index * c_geometry_scratch_chunk_capacity_quads + index_in_chunk;
+
+	bool has_quad= index_in_chunk < num_quads;
+	uint kind= 0u;
+	uint offset_within_workgroup= 0u;
+	if(has_quad)
+	{
+		kind= uint(scratch_quad_kinds[scratch_index]);
+		offset_within_workgroup= atomicAdd(workgroup_num_quads[kind], 1u);
+	}
+
+	memoryBarrierShared();
+	barrier();
+
+	// Reserve space for quads of this workgroup - one atomic per kind instead of one per quad.
+	if(gl_LocalInvocationIndex < c_num_quad_kinds)
+	{
+		uint k= gl_LocalInvocationIndex;
+		uint n= workgroup_num_quads[k];
+		uint offset= 0u;
+		if(n > 0u)
+		{
+			if(k == c_quad_kind_regular)
+				offset= chunk_draw_info[chunk_index].first_quad + atomicAdd(chunk_draw_info[chunk_index].num_quads, n);
+			else if(k == c_quad_kind_water)
+				offset= chunk_draw_info[chunk_index].first_water_quad + atomicAdd(chunk_draw_info[chunk_index].num_water_quads, n);
+			else if(k == c_quad_kind_fire)
+				offset= chunk_draw_info[chunk_index].first_fire_quad + atomicAdd(chunk_draw_info[chunk_index].num_fire_quads, n);
+			else
+				offset= chunk_draw_info[chunk_index].first_grass_quad + atomicAdd(chunk_draw_info[chunk_index].num_grass_quads, n);
+		}
+		workgroup_quads_offset[k]= offset;
+	}
+
+	memoryBarrierShared();
+	barrier();
+
+	if(has_quad)
+		quads[workgroup_quads_offset[kind] + offset_within_workgroup]= scratch_quads[scratch_index];
+}
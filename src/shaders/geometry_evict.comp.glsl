@@ -0,0 +1,50 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive : require
+#extension GL_EXT_shader_explicit_arithmetic_types_int16 : require
+
+#include "inc/allocator.glsl"
+#include "inc/chunk_draw_info.glsl"
+#include "inc/geometry_allocation_stats.glsl"
+
+// If this is changed, corresponding C++ code must be changed too!
+layout(local_size_x= 64, local_size_y = 1, local_size_z= 1) in;
+
+layout(push_constant) uniform uniforms_block
+{
+	uint num_chunks_to_evict;
+	uint16_t chunks_to_evict_list[62];
+};
+
+layout(binding= 0, std430) buffer chunk_draw_info_buffer
+{
+	ChunkDrawInfo chunk_draw_info[];
+};
+
+layout(binding= 1, std430) buffer geometry_allocation_stats_buffer
+{
+	GeometryAllocationStats geometry_allocation_stats;
+};
+
+void main()
+{
+	// Free memory of given chunks, so that it may be used by other chunks.
+	// Evicted chunks have no geometry and thus aren't drawn.
+
+	uint i= gl_GlobalInvocationID.x;
+	if(i < num_chunks_to_evict)
+	{
+		uint chunk_index= uint(chunks_to_evict_list[i]);
+
+		uint num_memory_units= chunk_draw_info[chunk_index].num_memory_units;
+		AllocatorFree(chunk_draw_info[chunk_index].first_memory_unit, num_memory_units);
+		atomicAdd(geometry_allocation_stats.num_used_units, -num_memory_units);
+
+		chunk_draw_info[chunk_index].num_quads= 0;
+		chunk_draw_info[chunk_index].num_water_quads= 0;
+		chunk_draw_info[chunk_index].num_fire_quads= 0;
+		chunk_draw_info[chunk_index].num_grass_quads= 0;
+		chunk_draw_info[chunk_index].first_memory_unit= 0;
+		chunk_draw_info[chunk_index].num_memory_units= 0;
+	}
+}
@@ -6,28 +6,31 @@
 
 #include "inc/block_type.glsl"
 #include "inc/chunk_draw_info.glsl"
+#include "inc/geometry_chunks_to_update_list.glsl"
+#include "inc/geometry_gen_scratch.glsl"
 #include "inc/hex_funcs.glsl"
+#include "inc/world_quad.glsl"
 
-// maxComputeWorkGroupInvocations is at least 128.
-// If this is changed, corresponding C++ code must be changed too!
-layout(local_size_x= 4, local_size_y = 4, local_size_z= 8) in;
-
-// If this changed, vertex attributes specification in C++ code must be chaned too!
-struct WorldVertex
+// Vertex and quad used during generation. They are packed before writing into scratch memory.
+struct WorldVertexUnpacked
 {
 	i16vec4 pos;
 	i16vec4 tex_coord; // Also stores texture index and light
 };
 
-struct Quad
+struct QuadUnpacked
 {
-	WorldVertex vertices[4];
+	WorldVertexUnpacked vertices[4];
 };
 
-layout(binding= 0, std430) writeonly buffer vertices_buffer
+// maxComputeWorkGroupInvocations is at least 128.
+// If this is changed, corresponding C++ code must be changed too!
+layout(local_size_x= 4, local_size_y = 4, local_size_z= 8) in;
+
+layout(binding= 0, std430) writeonly buffer scratch_quads_buffer
 {
 	// Populate here quads list.
-	Quad quads[];
+	Quad scratch_quads[];
 };
 
 layout(binding= 1, std430) readonly buffer chunks_data_buffer
@@ -50,13 +53,99 @@ layout(binding= 4, std430) readonly buffer chunks_auxiliar_data_buffer
 	uint8_t chunks_auxiliar_data[];
 };
 
+layout(binding= 5, std430) readonly buffer chunks_to_update_list_buffer
+{
+	ChunkToUpdate chunks_to_update_list[];
+};
+
+layout(binding= 6, std430) writeonly buffer scratch_quad_kinds_buffer
+{
+	uint8_t scratch_quad_kinds[];
+};
+
+// Number of quads written into scratch memory region of each chunk of the batch.
+layout(binding= 7, std430) buffer scratch_num_quads_buffer
+{
+	uint scratch_num_quads[];
+};
+
 layout(push_constant) uniform uniforms_block
 {
 	ivec2 world_size_chunks;
-	ivec2 chunk_position;
-	ivec2 chunk_global_position;
+	uint chunks_list_offset; // Index of the first chunk of this batch in chunks to update list.
 };
 
+// Index of the chunk in the batch. Also index of its scratch memory region.
+uint batch_chunk_index;
+// Index of the chunk in the world.
+int chunk_index;
+// Global coordinates of the chunk. Vertex positions are stored relative to the chunk.
+ivec2 chunk_global_position;
+
+// Number of new quads of each kind in this workgroup. All invocations of a workgroup belong to the same chunk.
+shared uint workgroup_num_new_quads[c_num_quad_kinds];
+
+// Reserve space for given number of quads of given kind in scratch memory of the current chunk.
+// Returns index of the first reserved quad.
+uint AllocateScratchQuads(uint kind, uint num)
+{
+	// Count new quads of each kind in order to allocate memory later.
+	// Count quads even if they don't fit into scratch memory - in such case allocation will fail.
+	atomicAdd(workgroup_num_new_quads[kind], num);
+
+	uint index_in_chunk= atomicAdd(scratch_num_quads[batch_chunk_index], num);
+	uint index= batch_chunk_index * c_geometry_scratch_chunk_capacity_quads + index_in_chunk;
+
+	for(uint i= 0u; i < num; ++i)
+	{
+		if(index_in_chunk + i < c_geometry_scratch_chunk_capacity_quads)
+			scratch_quad_kinds[index + i]= uint8_t(kind);
+	}
+
+	return index;
+}
+
+// Result is in range [0; y) for negative x too.
+ivec2 EuclidianRemainder(ivec2 x, ivec2 y)
+{
+	ivec2 r= x - (x / y) * y;
+	return r + ivec2(lessThan(r, ivec2(0))) * y;
+}
+
+void WriteScratchQuad(uint index, QuadUnpacked quad)
+{
+	if(index >= (batch_chunk_index + 1u) * c_geometry_scratch_chunk_capacity_quads)
+		return;
+
+	// Textures are repeated, so reduce texture coordinates of the quad using texture period.
+	// Texture coordinates of quads starting within [0; period) range aren't changed - fire shader relies on this.
+	ivec2 tex_coord_min= ivec2(quad.vertices[0].tex_coord.xy);
+	for(int i= 1; i < 4; ++i)
+		tex_coord_min= min(tex_coord_min, ivec2(quad.vertices[i].tex_coord.xy));
+
+	ivec2 tex_coord_period= ivec2(c_world_vertex_tex_coord_period_x, c_world_vertex_tex_coord_period_y);
+	ivec2 tex_coord_shift= tex_coord_min - EuclidianRemainder(tex_coord_min, tex_coord_period);
+
+	ivec3 chunk_pos_shift= ivec3(
+		chunk_global_position.x * c_world_vertex_chunk_size_x,
+		chunk_global_position.y * c_world_vertex_chunk_size_y,
+		0);
+
+	Quad quad_packed;
+	for(int i= 0; i < 4; ++i)
+	{
+		WorldVertexUnpacked v= quad.vertices[i];
+		quad_packed.vertices[i]=
+			PackWorldVertex(
+				ivec3(v.pos.xyz) - chunk_pos_shift,
+				ivec2(v.tex_coord.xy) - tex_coord_shift,
+				int(v.tex_coord.z),
+				int(v.tex_coord.w));
+	}
+
+	scratch_quads[index]= quad_packed;
+}
+
 // Use scale slightly less or equal to 272.
 // Use slightly different scale for different block sides in order to make lightling less flat.
 int16_t RepackAndScaleLight(uint8_t light_packed, int scale)
@@ -75,16 +164,20 @@ int16_t RepackAndScaleLight(uint8_t light_packed, int scale)
 const int z_shift= 8;
 const int z_one= 1 << z_shift;
 
-void main()
+void GenerateQuads()
 {
-	// Generate quads geoemtry.
-	// This code must mutch code in geometry size calculation code!
 
-	int chunk_index= chunk_position.x + chunk_position.y * world_size_chunks.x;
+	// Chunks of a batch are processed in a single dispatch - each chunk by its own slice of workgroups along Z axis.
+	batch_chunk_index= gl_WorkGroupID.z / (uint(c_chunk_height) / gl_WorkGroupSize.z);
+	ChunkToUpdate chunk_to_update= chunks_to_update_list[chunks_list_offset + batch_chunk_index];
+
+	ivec2 chunk_position= chunk_to_update.chunk_position;
+	chunk_global_position= chunk_to_update.chunk_global_position;
 
-	const uint quads_offset= chunk_draw_info[chunk_index].first_quad;
+	chunk_index= chunk_position.x + chunk_position.y * world_size_chunks.x;
 
 	uvec3 invocation= gl_GlobalInvocationID;
+	invocation.z-= batch_chunk_index * uint(c_chunk_height);
 
 	int block_x= (chunk_position.x << c_chunk_width_log2) + int(invocation.x);
 	int block_y= (chunk_position.y << c_chunk_width_log2) + int(invocation.y);
@@ -128,7 +221,7 @@ void main()
 		// Add two hexagon quads.
 
 		// Calculate hexagon vertices.
-		WorldVertex v[6];
+		WorldVertexUnpacked v[6];
 
 		v[0].pos= i16vec4(int16_t(base_x + 1), int16_t(base_y + 0), int16_t(base_z + z_one), 0);
 		v[1].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 0), int16_t(base_z + z_one), 0);
@@ -154,7 +247,7 @@ void main()
 		v[5].tex_coord= i16vec4(int16_t(tc_base.x + 1), int16_t(tc_base.y + 2), tex_index, light);
 
 		// Create quads from hexagon vertices. Two vertices are shared.
-		Quad quad_south, quad_north;
+		QuadUnpacked quad_south, quad_north;
 		quad_south.vertices[1]= v[1];
 		quad_south.vertices[3]= v[3];
 		quad_north.vertices[1]= v[2];
@@ -174,15 +267,15 @@ void main()
 			quad_north.vertices[2]= v[3];
 		}
 
-		uint quad_index= quads_offset + atomicAdd(chunk_draw_info[chunk_index].num_quads, 2);
-		quads[quad_index]= quad_south;
-		quads[quad_index + 1]= quad_north;
+		uint quad_index= AllocateScratchQuads(c_quad_kind_regular, 2);
+		WriteScratchQuad(quad_index, quad_south);
+		WriteScratchQuad(quad_index + 1, quad_north);
 	}
 
 	if(optical_density != optical_density_north)
 	{
 		// Add north quad.
-		WorldVertex v[4];
+		WorldVertexUnpacked v[4];
 
 		v[0].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 2), int16_t(base_z + 0), 0);
 		v[1].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 2), int16_t(base_z + z_one), 0);
@@ -200,7 +293,7 @@ void main()
 		v[2].tex_coord= i16vec4(int16_t(tc_base.x + 0), int16_t(tc_base.y + 2), tex_index, light);
 		v[3].tex_coord= i16vec4(int16_t(tc_base.x + 0), int16_t(tc_base.y + 0), tex_index, light);
 
-		Quad quad;
+		QuadUnpacked quad;
 		quad.vertices[1]= v[1];
 		quad.vertices[3]= v[3];
 		if(optical_density < optical_density_north)
@@ -214,14 +307,14 @@ void main()
 			quad.vertices[2]= v[2];
 		}
 
-		uint quad_index= quads_offset + atomicAdd(chunk_draw_info[chunk_index].num_quads, 1);
-		quads[quad_index]= quad;
+		uint quad_index= AllocateScratchQuads(c_quad_kind_regular, 1);
+		WriteScratchQuad(quad_index, quad);
 	}
 
 	if(optical_density != optical_density_north_east)
 	{
 		// Add north-east quad.
-		WorldVertex v[4];
+		WorldVertexUnpacked v[4];
 
 		v[0].pos= i16vec4(int16_t(base_x + 4), int16_t(base_y + 1), int16_t(base_z + 0), 0);
 		v[1].pos= i16vec4(int16_t(base_x + 4), int16_t(base_y + 1), int16_t(base_z + z_one), 0);
@@ -239,7 +332,7 @@ void main()
 		v[2].tex_coord= i16vec4(int16_t(tc_base.x + 2), int16_t(tc_base.y + 2), tex_index, light);
 		v[3].tex_coord= i16vec4(int16_t(tc_base.x + 2), int16_t(tc_base.y + 0), tex_index, light);
 
-		Quad quad;
+		QuadUnpacked quad;
 		quad.vertices[1]= v[1];
 		quad.vertices[3]= v[3];
 		if(optical_density < optical_density_north_east)
@@ -253,13 +346,13 @@ void main()
 			quad.vertices[2]= v[2];
 		}
 
-		uint quad_index= quads_offset + atomicAdd(chunk_draw_info[chunk_index].num_quads, 1);
-		quads[quad_index]= quad;
+		uint quad_index= AllocateScratchQuads(c_quad_kind_regular, 1);
+		WriteScratchQuad(quad_index, quad);
 	}
 
 	if(optical_density != optical_density_south_east)
 	{
-		WorldVertex v[4];
+		WorldVertexUnpacked v[4];
 
 		v[0].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 0), int16_t(base_z + 0), 0);
 		v[1].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 0), int16_t(base_z + z_one), 0);
@@ -277,7 +370,7 @@ void main()
 		v[2].tex_coord= i16vec4(int16_t(tc_base.x + 4), int16_t(tc_base.y + 2), tex_index, light);
 		v[3].tex_coord= i16vec4(int16_t(tc_base.x + 4), int16_t(tc_base.y + 0), tex_index, light);
 
-		Quad quad;
+		QuadUnpacked quad;
 		quad.vertices[1]= v[1];
 		quad.vertices[3]= v[3];
 		if(optical_density < optical_density_south_east)
@@ -292,8 +385,8 @@ void main()
 		}
 
 		// Add south-east quad.
-		uint quad_index= quads_offset + atomicAdd(chunk_draw_info[chunk_index].num_quads, 1);
-		quads[quad_index]= quad;
+		uint quad_index= AllocateScratchQuads(c_quad_kind_regular, 1);
+		WriteScratchQuad(quad_index, quad);
 	}
 
 	if(block_value == c_block_type_grass || block_value == c_block_type_grass_yellow)
@@ -323,7 +416,7 @@ void main()
 
 			if(quads_vec.x)
 			{
-				Quad quad;
+				QuadUnpacked quad;
 
 				quad.vertices[0].pos= i16vec4(int16_t(base_x + 0), int16_t(base_y + 1), int16_t(base_z + z_one), 0);
 				quad.vertices[1].pos= i16vec4(int16_t(base_x + 0), int16_t(base_y + 1), int16_t(base_z + z_one + z_one / 2), 0);
@@ -334,12 +427,12 @@ void main()
 				quad.vertices[2].tex_coord= i16vec4(int16_t(base_tc_x + 4), int16_t(2), tex_index, light);
 				quad.vertices[3].tex_coord= i16vec4(int16_t(base_tc_x + 4), int16_t(1), tex_index, light);
 
-				uint quad_index= chunk_draw_info[chunk_index].first_grass_quad + atomicAdd(chunk_draw_info[chunk_index].num_grass_quads, 1);
-				quads[quad_index]= quad;
+				uint quad_index= AllocateScratchQuads(c_quad_kind_grass, 1);
+				WriteScratchQuad(quad_index, quad);
 			}
 			if(quads_vec.y)
 			{
-				Quad quad;
+				QuadUnpacked quad;
 
 				quad.vertices[0].pos= i16vec4(int16_t(base_x + 1), int16_t(base_y + 0), int16_t(base_z + z_one), 0);
 				quad.vertices[1].pos= i16vec4(int16_t(base_x + 1), int16_t(base_y + 0), int16_t(base_z + z_one + z_one / 2), 0);
@@ -350,12 +443,12 @@ void main()
 				quad.vertices[2].tex_coord= i16vec4(int16_t(base_tc_x + 4), int16_t(2), tex_index, light);
 				quad.vertices[3].tex_coord= i16vec4(int16_t(base_tc_x + 4), int16_t(1), tex_index, light);
 
-				uint quad_index= chunk_draw_info[chunk_index].first_grass_quad + atomicAdd(chunk_draw_info[chunk_index].num_grass_quads, 1);
-				quads[quad_index]= quad;
+				uint quad_index= AllocateScratchQuads(c_quad_kind_grass, 1);
+				WriteScratchQuad(quad_index, quad);
 			}
 			if(quads_vec.z)
 			{
-				Quad quad;
+				QuadUnpacked quad;
 
 				quad.vertices[0].pos= i16vec4(int16_t(base_x + 1), int16_t(base_y + 2), int16_t(base_z + z_one), 0);
 				quad.vertices[1].pos= i16vec4(int16_t(base_x + 1), int16_t(base_y + 2), int16_t(base_z + z_one + z_one / 2), 0);
@@ -366,8 +459,8 @@ void main()
 				quad.vertices[2].tex_coord= i16vec4(int16_t(base_tc_x + 4), int16_t(2), tex_index, light);
 				quad.vertices[3].tex_coord= i16vec4(int16_t(base_tc_x + 4), int16_t(1), tex_index, light);
 
-				uint quad_index= chunk_draw_info[chunk_index].first_grass_quad + atomicAdd(chunk_draw_info[chunk_index].num_grass_quads, 1);
-				quads[quad_index]= quad;
+				uint quad_index= AllocateScratchQuads(c_quad_kind_grass, 1);
+				WriteScratchQuad(quad_index, quad);
 			}
 		}
 	}
@@ -416,7 +509,7 @@ void main()
 			}
 
 			// Calculate hexagon vertices.
-			WorldVertex v[6];
+			WorldVertexUnpacked v[6];
 
 			v[0].pos= i16vec4(int16_t(base_x + 1), int16_t(base_y + 0), int16_t(vertex_snow_level[4]), 0);
 			v[1].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 0), int16_t(vertex_snow_level[3]), 0);
@@ -437,21 +530,21 @@ void main()
 			v[5].tex_coord= i16vec4(int16_t(tc_base.x + 1), int16_t(tc_base.y + 2), tex_index, light);
 
 			// Create quads from hexagon vertices. Two vertices are shared.
-			Quad quad_south;
+			QuadUnpacked quad_south;
 			quad_south.vertices[0]= v[0];
 			quad_south.vertices[1]= v[1];
 			quad_south.vertices[2]= v[2];
 			quad_south.vertices[3]= v[3];
 
-			Quad quad_north;
+			QuadUnpacked quad_north;
 			quad_north.vertices[0]= v[3];
 			quad_north.vertices[1]= v[2];
 			quad_north.vertices[2]= v[4];
 			quad_north.vertices[3]= v[5];
 
-			uint quad_index= quads_offset + atomicAdd(chunk_draw_info[chunk_index].num_quads, 2);
-			quads[quad_index]= quad_south;
-			quads[quad_index + 1]= quad_north;
+			uint quad_index= AllocateScratchQuads(c_quad_kind_regular, 2);
+			WriteScratchQuad(quad_index, quad_south);
+			WriteScratchQuad(quad_index + 1, quad_north);
 		}
 
 		if(z > 0 && c_block_optical_density_table[uint(chunks_data[block_address - 1])] != c_optical_density_solid)
@@ -459,7 +552,7 @@ void main()
 			// Add two lower snow quads.
 
 			// Calculate hexagon vertices.
-			WorldVertex v[6];
+			WorldVertexUnpacked v[6];
 			v[0].pos= i16vec4(int16_t(base_x + 1), int16_t(base_y + 0), int16_t(base_z), 0);
 			v[1].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 0), int16_t(base_z), 0);
 			v[2].pos= i16vec4(int16_t(base_x + 4), int16_t(base_y + 1), int16_t(base_z), 0);
@@ -480,7 +573,7 @@ void main()
 			v[5].tex_coord= i16vec4(int16_t(tc_base.x + 1), int16_t(tc_base.y + 2), tex_index, light);
 
 			// Create quads from hexagon vertices. Two vertices are shared.
-			Quad quad_south, quad_north;
+			QuadUnpacked quad_south, quad_north;
 
 			quad_south.vertices[0]= v[2];
 			quad_south.vertices[1]= v[1];
@@ -492,9 +585,9 @@ void main()
 			quad_north.vertices[2]= v[3];
 			quad_north.vertices[3]= v[5];
 
-			uint quad_index= quads_offset + atomicAdd(chunk_draw_info[chunk_index].num_quads, 2);
-			quads[quad_index]= quad_south;
-			quads[quad_index + 1]= quad_north;
+			uint quad_index= AllocateScratchQuads(c_quad_kind_regular, 2);
+			WriteScratchQuad(quad_index, quad_south);
+			WriteScratchQuad(quad_index + 1, quad_north);
 		}
 	}
 	else if(block_value == c_block_type_water)
@@ -587,7 +680,7 @@ void main()
 			// Add two water hexagon quads.
 
 			// Calculate hexagon vertices.
-			WorldVertex v[6];
+			WorldVertexUnpacked v[6];
 			v[0].pos= i16vec4(int16_t(base_x + 1), int16_t(base_y + 0), int16_t(vertex_water_level[4]), 0);
 			v[1].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 0), int16_t(vertex_water_level[3]), 0);
 			v[2].pos= i16vec4(int16_t(base_x + 4), int16_t(base_y + 1), int16_t(vertex_water_level[2]), 0);
@@ -608,7 +701,7 @@ void main()
 			v[5].tex_coord= i16vec4(int16_t(tc_base.x + 1), int16_t(tc_base.y + 2), tex_index, light);
 
 			// Create quads from hexagon vertices. Two vertices are shared.
-			Quad quad_south, quad_north;
+			QuadUnpacked quad_south, quad_north;
 
 			quad_south.vertices[0]= v[0];
 			quad_south.vertices[1]= v[1];
@@ -620,9 +713,9 @@ void main()
 			quad_north.vertices[2]= v[4];
 			quad_north.vertices[3]= v[5];
 
-			uint quad_index= chunk_draw_info[chunk_index].first_water_quad + atomicAdd(chunk_draw_info[chunk_index].num_water_quads, 2);
-			quads[quad_index]= quad_south;
-			quads[quad_index + 1]= quad_north;
+			uint quad_index= AllocateScratchQuads(c_quad_kind_water, 2);
+			WriteScratchQuad(quad_index, quad_south);
+			WriteScratchQuad(quad_index + 1, quad_north);
 		}
 
 		if(z > 0)
@@ -633,7 +726,7 @@ void main()
 				// Add two water bottom quads.
 
 				// Calculate hexagon vertices.
-				WorldVertex v[6];
+				WorldVertexUnpacked v[6];
 				v[0].pos= i16vec4(int16_t(base_x + 1), int16_t(base_y + 0), int16_t(base_z), 0);
 				v[1].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 0), int16_t(base_z), 0);
 				v[2].pos= i16vec4(int16_t(base_x + 4), int16_t(base_y + 1), int16_t(base_z), 0);
@@ -654,7 +747,7 @@ void main()
 				v[5].tex_coord= i16vec4(int16_t(tc_base.x + 1), int16_t(tc_base.y + 2), tex_index, light);
 
 				// Create quads from hexagon vertices. Two vertices are shared.
-				Quad quad_south, quad_north;
+				QuadUnpacked quad_south, quad_north;
 
 				quad_south.vertices[0]= v[2];
 				quad_south.vertices[1]= v[1];
@@ -666,9 +759,9 @@ void main()
 				quad_north.vertices[2]= v[3];
 				quad_north.vertices[3]= v[5];
 
-				uint quad_index= quads_offset + atomicAdd(chunk_draw_info[chunk_index].num_quads, 2);
-				quads[quad_index]= quad_south;
-				quads[quad_index + 1]= quad_north;
+				uint quad_index= AllocateScratchQuads(c_quad_kind_regular, 2);
+				WriteScratchQuad(quad_index, quad_south);
+				WriteScratchQuad(quad_index + 1, quad_north);
 			}
 		}
 
@@ -677,7 +770,7 @@ void main()
 		if(block_value_north != c_block_type_water && optical_density_north != c_optical_density_solid)
 		{
 			// Add north water side quad.
-			Quad quad;
+			QuadUnpacked quad;
 
 			quad.vertices[0].pos= i16vec4(int16_t(base_x + 1), int16_t(base_y + 2), int16_t(vertex_water_level[0]), 0);
 			quad.vertices[1].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 2), int16_t(vertex_water_level[1]), 0);
@@ -691,14 +784,14 @@ void main()
 			quad.vertices[2].tex_coord= i16vec4(int16_t(tc_base.x + 2), int16_t(tc_base.y + 0), tex_index, light);
 			quad.vertices[3].tex_coord= i16vec4(int16_t(tc_base.x + 0), int16_t(tc_base.y + 0), tex_index, light);
 
-			uint quad_index= quads_offset + atomicAdd(chunk_draw_info[chunk_index].num_quads, 1);
-			quads[quad_index]= quad;
+			uint quad_index= AllocateScratchQuads(c_quad_kind_regular, 1);
+			WriteScratchQuad(quad_index, quad);
 		}
 
 		if(block_value_north_east != c_block_type_water && optical_density_north_east != c_optical_density_solid)
 		{
 			// Add north-east water side quad.
-			Quad quad;
+			QuadUnpacked quad;
 
 			quad.vertices[0].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 2), int16_t(vertex_water_level[1]), 0);
 			quad.vertices[1].pos= i16vec4(int16_t(base_x + 4), int16_t(base_y + 1), int16_t(vertex_water_level[2]), 0);
@@ -712,14 +805,14 @@ void main()
 			quad.vertices[2].tex_coord= i16vec4(int16_t(tc_base.x + 4), int16_t(tc_base.y + 0), tex_index, light);
 			quad.vertices[3].tex_coord= i16vec4(int16_t(tc_base.x + 2), int16_t(tc_base.y + 0), tex_index, light);
 
-			uint quad_index= quads_offset + atomicAdd(chunk_draw_info[chunk_index].num_quads, 1);
-			quads[quad_index]= quad;
+			uint quad_index= AllocateScratchQuads(c_quad_kind_regular, 1);
+			WriteScratchQuad(quad_index, quad);
 		}
 
 		if(block_value_south_east != c_block_type_water && optical_density_south_east != c_optical_density_solid)
 		{
 			// Add south-east water side quad.
-			Quad quad;
+			QuadUnpacked quad;
 
 			quad.vertices[0].pos= i16vec4(int16_t(base_x + 4), int16_t(base_y + 1), int16_t(vertex_water_level[2]), 0);
 			quad.vertices[1].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 0), int16_t(vertex_water_level[3]), 0);
@@ -733,15 +826,15 @@ void main()
 			quad.vertices[2].tex_coord= i16vec4(int16_t(tc_base.x + 2), int16_t(tc_base.y + 0), tex_index, light);
 			quad.vertices[3].tex_coord= i16vec4(int16_t(tc_base.x + 4), int16_t(tc_base.y + 0), tex_index, light);
 
-			uint quad_index= quads_offset + atomicAdd(chunk_draw_info[chunk_index].num_quads, 1);
-			quads[quad_index]= quad;
+			uint quad_index= AllocateScratchQuads(c_quad_kind_regular, 1);
+			WriteScratchQuad(quad_index, quad);
 		}
 
 		uint8_t block_value_south= chunks_data[south_block_address];
 		if(block_value_south != c_block_type_water && c_block_optical_density_table[uint(block_value_south)] != c_optical_density_solid)
 		{
 			// Add south water side quad.
-			Quad quad;
+			QuadUnpacked quad;
 
 			quad.vertices[0].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 0), int16_t(base_z), 0);
 			quad.vertices[1].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 0), int16_t(vertex_water_level[3]), 0);
@@ -755,15 +848,15 @@ void main()
 			quad.vertices[2].tex_coord= i16vec4(int16_t(tc_base.x + 0), int16_t(tc_base.y + 2), tex_index, light);
 			quad.vertices[3].tex_coord= i16vec4(int16_t(tc_base.x + 0), int16_t(tc_base.y + 0), tex_index, light);
 
-			uint quad_index= quads_offset + atomicAdd(chunk_draw_info[chunk_index].num_quads, 1);
-			quads[quad_index]= quad;
+			uint quad_index= AllocateScratchQuads(c_quad_kind_regular, 1);
+			WriteScratchQuad(quad_index, quad);
 		}
 
 		uint8_t block_value_south_west= chunks_data[south_west_block_address];
 		if(block_value_south_west != c_block_type_water && c_block_optical_density_table[uint(block_value_south_west)] != c_optical_density_solid)
 		{
 			// Add south-west water side quad.
-			Quad quad;
+			QuadUnpacked quad;
 
 			quad.vertices[0].pos= i16vec4(int16_t(base_x + 1), int16_t(base_y + 0), int16_t(base_z), 0);
 			quad.vertices[1].pos= i16vec4(int16_t(base_x + 1), int16_t(base_y + 0), int16_t(vertex_water_level[4]), 0);
@@ -777,15 +870,15 @@ void main()
 			quad.vertices[2].tex_coord= i16vec4(int16_t(tc_base.x - 1), int16_t(tc_base.y + 2), tex_index, light);
 			quad.vertices[3].tex_coord= i16vec4(int16_t(tc_base.x - 1), int16_t(tc_base.y + 0), tex_index, light);
 
-			uint quad_index= quads_offset + atomicAdd(chunk_draw_info[chunk_index].num_quads, 1);
-			quads[quad_index]= quad;
+			uint quad_index= AllocateScratchQuads(c_quad_kind_regular, 1);
+			WriteScratchQuad(quad_index, quad);
 		}
 
 		uint8_t block_value_north_west= chunks_data[north_west_block_address];
 		if(block_value_north_west != c_block_type_water && c_block_optical_density_table[uint(block_value_north_west)] != c_optical_density_solid)
 		{
 			// Add north-west water side quad.
-			Quad quad;
+			QuadUnpacked quad;
 
 			quad.vertices[0].pos= i16vec4(int16_t(base_x + 0), int16_t(base_y + 1), int16_t(vertex_water_level[5]), 0);
 			quad.vertices[1].pos= i16vec4(int16_t(base_x + 1), int16_t(base_y + 2), int16_t(vertex_water_level[0]), 0);
@@ -799,8 +892,8 @@ void main()
 			quad.vertices[2].tex_coord= i16vec4(int16_t(tc_base.x + 1), int16_t(tc_base.y + 0), tex_index, light);
 			quad.vertices[3].tex_coord= i16vec4(int16_t(tc_base.x - 1), int16_t(tc_base.y + 0), tex_index, light);
 
-			uint quad_index= quads_offset + atomicAdd(chunk_draw_info[chunk_index].num_quads, 1);
-			quads[quad_index]= quad;
+			uint quad_index= AllocateScratchQuads(c_quad_kind_regular, 1);
+			WriteScratchQuad(quad_index, quad);
 		}
 	}
 	else if(block_value == c_block_type_fire)
@@ -814,16 +907,16 @@ void main()
 		// Lower quads.
 		if(z > 0 && c_block_flammability_table[uint(chunks_data[block_address - 1])] != uint8_t(0))
 		{
-			uint quad_index= chunk_draw_info[chunk_index].first_fire_quad + atomicAdd(chunk_draw_info[chunk_index].num_fire_quads, 3);
+			uint quad_index= AllocateScratchQuads(c_quad_kind_fire, 3);
 
-			WorldVertex center_vertices[2];
+			WorldVertexUnpacked center_vertices[2];
 			center_vertices[0].pos= i16vec4(int16_t(base_x + 2), int16_t(base_y + 1), int16_t(base_z + 0), 0);
 			center_vertices[1].pos= i16vec4(int16_t(base_x + 2), int16_t(base_y + 1), int16_t(base_z + z_one), 0);
 			center_vertices[0].tex_coord= i16vec4(int16_t(base_tc_x + 0), int16_t(0), tex_index, int16_t(fire_power));
 			center_vertices[1].tex_coord= i16vec4(int16_t(base_tc_x + 0), int16_t(2), tex_index, int16_t(fire_power));
 
 			{
-				Quad quad;
+				QuadUnpacked quad;
 
 				quad.vertices[0].pos= i16vec4(int16_t(base_x), int16_t(base_y + 1), int16_t(base_z + z_one), 0);
 				quad.vertices[1].pos= i16vec4(int16_t(base_x), int16_t(base_y + 1), int16_t(base_z + 0), 0);
@@ -833,10 +926,10 @@ void main()
 				quad.vertices[2]= center_vertices[0];
 				quad.vertices[3]= center_vertices[1];
 
-				quads[quad_index + 0]= quad;
+				WriteScratchQuad(quad_index + 0, quad);
 			}
 			{
-				Quad quad;
+				QuadUnpacked quad;
 
 				quad.vertices[0].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 2), int16_t(base_z + z_one), 0);
 				quad.vertices[1].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 2), int16_t(base_z + 0), 0);
@@ -846,10 +939,10 @@ void main()
 				quad.vertices[2]= center_vertices[0];
 				quad.vertices[3]= center_vertices[1];
 
-				quads[quad_index + 1]= quad;
+				WriteScratchQuad(quad_index + 1, quad);
 			}
 			{
-				Quad quad;
+				QuadUnpacked quad;
 
 				quad.vertices[0].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y ), int16_t(base_z + z_one), 0);
 				quad.vertices[1].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y ), int16_t(base_z + 0), 0);
@@ -859,14 +952,14 @@ void main()
 				quad.vertices[2]= center_vertices[0];
 				quad.vertices[3]= center_vertices[1];
 
-				quads[quad_index + 2]= quad;
+				WriteScratchQuad(quad_index + 2, quad);
 			}
 		}
 
 		// North quad.
 		if(c_block_flammability_table[uint(block_value_north)] != uint8_t(0))
 		{
-			Quad quad;
+			QuadUnpacked quad;
 			quad.vertices[0].pos= i16vec4(int16_t(base_x + 1), int16_t(base_y + 2), int16_t(base_z + 0), 0);
 			quad.vertices[1].pos= i16vec4(int16_t(base_x + 1), int16_t(base_y + 2), int16_t(base_z + z_one), 0);
 			quad.vertices[2].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 2), int16_t(base_z + z_one), 0);
@@ -876,14 +969,14 @@ void main()
 			quad.vertices[2].tex_coord= i16vec4(int16_t(base_tc_x + 2), int16_t(2), tex_index, int16_t(fire_power));
 			quad.vertices[3].tex_coord= i16vec4(int16_t(base_tc_x + 2), int16_t(0), tex_index, int16_t(fire_power));
 
-			uint quad_index= chunk_draw_info[chunk_index].first_fire_quad + atomicAdd(chunk_draw_info[chunk_index].num_fire_quads, 1);
-			quads[quad_index]= quad;
+			uint quad_index= AllocateScratchQuads(c_quad_kind_fire, 1);
+			WriteScratchQuad(quad_index, quad);
 		}
 
 		// North-east quad.
 		if(c_block_flammability_table[uint(block_value_north_east)] != uint8_t(0))
 		{
-			Quad quad;
+			QuadUnpacked quad;
 			quad.vertices[0].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 2), int16_t(base_z + 0), 0);
 			quad.vertices[1].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 2), int16_t(base_z + z_one), 0);
 			quad.vertices[2].pos= i16vec4(int16_t(base_x + 4), int16_t(base_y + 1), int16_t(base_z + z_one), 0);
@@ -893,14 +986,14 @@ void main()
 			quad.vertices[2].tex_coord= i16vec4(int16_t(base_tc_x + 4), int16_t(2), tex_index, int16_t(fire_power));
 			quad.vertices[3].tex_coord= i16vec4(int16_t(base_tc_x + 4), int16_t(0), tex_index, int16_t(fire_power));
 
-			uint quad_index= chunk_draw_info[chunk_index].first_fire_quad + atomicAdd(chunk_draw_info[chunk_index].num_fire_quads, 1);
-			quads[quad_index]= quad;
+			uint quad_index= AllocateScratchQuads(c_quad_kind_fire, 1);
+			WriteScratchQuad(quad_index, quad);
 		}
 
 		// South-east quad.
 		if(c_block_flammability_table[uint(block_value_south_east)] != uint8_t(0))
 		{
-			Quad quad;
+			QuadUnpacked quad;
 			quad.vertices[0].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 0), int16_t(base_z + 0), 0);
 			quad.vertices[1].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 0), int16_t(base_z + z_one), 0);
 			quad.vertices[2].pos= i16vec4(int16_t(base_x + 4), int16_t(base_y + 1), int16_t(base_z + z_one), 0);
@@ -910,15 +1003,15 @@ void main()
 			quad.vertices[2].tex_coord= i16vec4(int16_t(base_tc_x + 4), int16_t(2), tex_index, int16_t(fire_power));
 			quad.vertices[3].tex_coord= i16vec4(int16_t(base_tc_x + 4), int16_t(0), tex_index, int16_t(fire_power));
 
-			uint quad_index= chunk_draw_info[chunk_index].first_fire_quad + atomicAdd(chunk_draw_info[chunk_index].num_fire_quads, 1);
-			quads[quad_index]= quad;
+			uint quad_index= AllocateScratchQuads(c_quad_kind_fire, 1);
+			WriteScratchQuad(quad_index, quad);
 		}
 
 		// South quad.
 		int south_block_address= GetBlockFullAddress(ivec3(block_x, max(block_y - 1, 0), z), world_size_chunks);
 		if(c_block_flammability_table[uint(chunks_data[south_block_address])] != uint8_t(0))
 		{
-			Quad quad;
+			QuadUnpacked quad;
 			quad.vertices[0].pos= i16vec4(int16_t(base_x + 1), int16_t(base_y), int16_t(base_z + 0), 0);
 			quad.vertices[1].pos= i16vec4(int16_t(base_x + 1), int16_t(base_y), int16_t(base_z + z_one), 0);
 			quad.vertices[2].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y), int16_t(base_z + z_one), 0);
@@ -928,8 +1021,8 @@ void main()
 			quad.vertices[2].tex_coord= i16vec4(int16_t(base_tc_x + 2), int16_t(2), tex_index, int16_t(fire_power));
 			quad.vertices[3].tex_coord= i16vec4(int16_t(base_tc_x + 2), int16_t(0), tex_index, int16_t(fire_power));
 
-			uint quad_index= chunk_draw_info[chunk_index].first_fire_quad + atomicAdd(chunk_draw_info[chunk_index].num_fire_quads, 1);
-			quads[quad_index]= quad;
+			uint quad_index= AllocateScratchQuads(c_quad_kind_fire, 1);
+			WriteScratchQuad(quad_index, quad);
 		}
 
 		int side_y_base= block_y + ((block_x + 1) & 1);
@@ -939,7 +1032,7 @@ void main()
 		int south_west_block_address= GetBlockFullAddress(ivec3(west_x_clamped, max(0, min(side_y_base - 1, max_world_coord.y)), z), world_size_chunks);
 		if(c_block_flammability_table[uint(chunks_data[south_west_block_address])] != uint8_t(0))
 		{
-			Quad quad;
+			QuadUnpacked quad;
 			quad.vertices[0].pos= i16vec4(int16_t(base_x + 0), int16_t(base_y + 1), int16_t(base_z + 0), 0);
 			quad.vertices[1].pos= i16vec4(int16_t(base_x + 0), int16_t(base_y + 1), int16_t(base_z + z_one), 0);
 			quad.vertices[2].pos= i16vec4(int16_t(base_x + 1), int16_t(base_y + 0), int16_t(base_z + z_one), 0);
@@ -949,15 +1042,15 @@ void main()
 			quad.vertices[2].tex_coord= i16vec4(int16_t(base_tc_x + 0), int16_t(2), tex_index, int16_t(fire_power));
 			quad.vertices[3].tex_coord= i16vec4(int16_t(base_tc_x + 0), int16_t(0), tex_index, int16_t(fire_power));
 
-			uint quad_index= chunk_draw_info[chunk_index].first_fire_quad + atomicAdd(chunk_draw_info[chunk_index].num_fire_quads, 1);
-			quads[quad_index]= quad;
+			uint quad_index= AllocateScratchQuads(c_quad_kind_fire, 1);
+			WriteScratchQuad(quad_index, quad);
 		}
 
 		// North-west quad.
 		int north_west_block_address= GetBlockFullAddress(ivec3(west_x_clamped, max(0, min(side_y_base - 0, max_world_coord.y)), z), world_size_chunks);
 		if(c_block_flammability_table[uint(chunks_data[north_west_block_address])] != uint8_t(0))
 		{
-			Quad quad;
+			QuadUnpacked quad;
 			quad.vertices[0].pos= i16vec4(int16_t(base_x + 0), int16_t(base_y + 1), int16_t(base_z + 0), 0);
 			quad.vertices[1].pos= i16vec4(int16_t(base_x + 0), int16_t(base_y + 1), int16_t(base_z + z_one), 0);
 			quad.vertices[2].pos= i16vec4(int16_t(base_x + 1), int16_t(base_y + 2), int16_t(base_z + z_one), 0);
@@ -967,19 +1060,19 @@ void main()
 			quad.vertices[2].tex_coord= i16vec4(int16_t(base_tc_x + 0), int16_t(2), tex_index, int16_t(fire_power));
 			quad.vertices[3].tex_coord= i16vec4(int16_t(base_tc_x + 0), int16_t(0), tex_index, int16_t(fire_power));
 
-			uint quad_index= chunk_draw_info[chunk_index].first_fire_quad + atomicAdd(chunk_draw_info[chunk_index].num_fire_quads, 1);
-			quads[quad_index]= quad;
+			uint quad_index= AllocateScratchQuads(c_quad_kind_fire, 1);
+			WriteScratchQuad(quad_index, quad);
 		}
 
 		// Upper quads.
 		if(c_block_flammability_table[uint(block_value_up)] != uint8_t(0))
 		{
-			uint quad_index= chunk_draw_info[chunk_index].first_fire_quad + atomicAdd(chunk_draw_info[chunk_index].num_fire_quads, 3);
+			uint quad_index= AllocateScratchQuads(c_quad_kind_fire, 3);
 
 			int upper_quads_z= base_z + z_one;
 
 			{
-				Quad quad;
+				QuadUnpacked quad;
 				quad.vertices[0].pos= i16vec4(int16_t(base_x + 2), int16_t(base_y + 1), int16_t(upper_quads_z), 0);
 				quad.vertices[1].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 0), int16_t(upper_quads_z), 0);
 				quad.vertices[2].pos= i16vec4(int16_t(base_x + 4), int16_t(base_y + 1), int16_t(upper_quads_z), 0);
@@ -989,10 +1082,10 @@ void main()
 				quad.vertices[2].tex_coord= i16vec4(int16_t(1), int16_t(2), tex_index, int16_t(fire_power));
 				quad.vertices[3].tex_coord= i16vec4(int16_t(3), int16_t(2), tex_index, int16_t(fire_power));
 
-				quads[quad_index + 0]= quad;
+				WriteScratchQuad(quad_index + 0, quad);
 			}
 			{
-				Quad quad;
+				QuadUnpacked quad;
 				quad.vertices[0].pos= i16vec4(int16_t(base_x + 2), int16_t(base_y + 1), int16_t(upper_quads_z), 0);
 				quad.vertices[1].pos= i16vec4(int16_t(base_x + 0), int16_t(base_y + 1), int16_t(upper_quads_z), 0);
 				quad.vertices[2].pos= i16vec4(int16_t(base_x + 1), int16_t(base_y + 0), int16_t(upper_quads_z), 0);
@@ -1002,10 +1095,10 @@ void main()
 				quad.vertices[2].tex_coord= i16vec4(int16_t(4), int16_t(2), tex_index, int16_t(fire_power));
 				quad.vertices[3].tex_coord= i16vec4(int16_t(6), int16_t(2), tex_index, int16_t(fire_power));
 
-				quads[quad_index + 1]= quad;
+				WriteScratchQuad(quad_index + 1, quad);
 			}
 			{
-				Quad quad;
+				QuadUnpacked quad;
 				quad.vertices[0].pos= i16vec4(int16_t(base_x + 2), int16_t(base_y + 1), int16_t(upper_quads_z), 0);
 				quad.vertices[1].pos= i16vec4(int16_t(base_x + 3), int16_t(base_y + 2), int16_t(upper_quads_z), 0);
 				quad.vertices[2].pos= i16vec4(int16_t(base_x + 1), int16_t(base_y + 2), int16_t(upper_quads_z), 0);
@@ -1015,8 +1108,43 @@ void main()
 				quad.vertices[2].tex_coord= i16vec4(int16_t(7), int16_t(2), tex_index, int16_t(fire_power));
 				quad.vertices[3].tex_coord= i16vec4(int16_t(9), int16_t(2), tex_index, int16_t(fire_power));
 
-				quads[quad_index + 2]= quad;
+				WriteScratchQuad(quad_index + 2, quad);
 			}
 		}
 	}
 }
+
+void main()
+{
+	// Generate quads geoemtry.
+	// Write quads into scratch memory and count them - memory for them will be allocated later.
+
+	if(gl_LocalInvocationIndex < c_num_quad_kinds)
+		workgroup_num_new_quads[gl_LocalInvocationIndex]= 0u;
+
+	memoryBarrierShared();
+	barrier();
+
+	GenerateQuads();
+
+	memoryBarrierShared();
+	barrier();
+
+	// Add counters of this workgroup to counters of the chunk - one atomic per kind instead of one per allocation.
+	if(gl_LocalInvocationIndex < c_num_quad_kinds)
+	{
+		uint k= gl_LocalInvocationIndex;
+		uint n= workgroup_num_new_quads[k];
+		if(n > 0u)
+		{
+			if(k == c_quad_kind_regular)
+				atomicAdd(chunk_draw_info[chunk_index].new_num_quads, n);
+			else if(k == c_quad_kind_water)
+				atomicAdd(chunk_draw_info[chunk_index].new_water_num_quads, n);
+			else if(k == c_quad_kind_fire)
+				atomicAdd(chunk_draw_info[chunk_index].new_fire_num_quads, n);
+			else
+				atomicAdd(chunk_draw_info[chunk_index].new_grass_num_quads, n);
+		}
+	}
+}
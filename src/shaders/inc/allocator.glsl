@@ -1,23 +1,68 @@
 // This allocator manages some memory and allows to allocate ranges from 1 to 32 units in size.
-// It's dumb, has a lot of limitations but is relatively simpe, which allows to avoid possible bugs.
-// it's important to keep overall number of units pretty small - a couple of thousands, because allocation complexity is linear.
-// It's also good to avoid unnecessary allocations, but still free unused memory, because fragmentation may be a problem.
+// Each allocation happens within one of 32-unit blocks.
+// Allocator data has two levels - used units bits for each block and summary bits for each 32 blocks.
+// Summary bit is set if corresponding block is full, which allows to skip full blocks without reading them.
+// Allocation and free are lock-free - they may be performed in parallel by different invocations.
+// It's still good to avoid unnecessary allocations, but free unused memory, because fragmentation may be a problem.
+// CPU implementation in "GPUAllocatorCPU.cpp" mirrors this code. If this code is changed, CPU code must be changed too!
 
 const int c_allocator_buffer_binding= 3333;
 
-layout(binding= c_allocator_buffer_binding, std430) buffer allocator_buffer
+layout(binding= c_allocator_buffer_binding, std430) coherent buffer allocator_buffer
 {
 	uint allocator_total_number_of_units;
-	uint allocator_used_units_bits[]; // Size is "allocator_total_number_of_units" / 32 (rounded up).
+	// Used units bits of all blocks - "allocator_total_number_of_units" / 32 (rounded up),
+	// followed by summary bits - number of blocks / 32 (rounded up).
+	// Bits of units/blocks beyond the end are initially set, in order to never allocate them.
+	uint allocator_data[];
 };
 
 const uint c_allocator_fail_result= 0xFFFFFFFF;
 
+uint AllocatorGetNumBlocks()
+{
+	return (allocator_total_number_of_units + 31) >> 5;
+}
+
+uint AllocatorGetUnitsMask(uint size_units)
+{
+	// Contains number of one bits equal to size.
+	return size_units == 32 ? 0xFFFFFFFF : ((1u << size_units) - 1u);
+}
+
+// Returns mask with bits set for each start position of continuous span of "size_units" zero bits.
+uint AllocatorFindFreeRanges(uint block_bits, uint size_units)
+{
+	// Shift free bits mask in order to combine it with itself.
+	// Doubling span length each step gives logarithmic complexity.
+	uint result= ~block_bits;
+	uint span_length= 1;
+	while(span_length < size_units && result != 0)
+	{
+		uint shift= min(span_length, size_units - span_length);
+		result&= result >> shift;
+		span_length+= shift;
+	}
+
+	return result;
+}
+
+void AllocatorMarkBlockFull(uint block_index)
+{
+	uint summary_word_index= AllocatorGetNumBlocks() + (block_index >> 5);
+	uint summary_bit= 1u << (block_index & 31);
+	atomicOr(allocator_data[summary_word_index], summary_bit);
+
+	// Some units of this block may be freed concurrently before the summary bit was set.
+	// Reset the bit in such case, since full block is never checked again.
+	if(atomicOr(allocator_data[block_index], 0u) != 0xFFFFFFFF)
+		atomicAnd(allocator_data[summary_word_index], ~summary_bit);
+}
+
 // Allocates given number of units.
 // Size should be no more than 32!
 // Returns index of unit.
 // Returns "c_allocator_fail_result" in case of fail.
-// Complexity is linear.
 uint AllocatorAllocate(uint size_units)
 {
 	if(size_units == 0)
@@ -25,33 +70,46 @@ uint AllocatorAllocate(uint size_units)
 	if(size_units > 32)
 		return c_allocator_fail_result;
 
-	// Each allocation happens in one of 32-bit blocks.
-	// If allocation is less than 32 units, free units withing a block may be used for another allocation.
+	uint mask= AllocatorGetUnitsMask(size_units);
 
-	// Contains number of one bits equal to size.
-	uint mask= size_units == 32 ? 0xFFFFFFFF : ((1 << size_units) - 1);
-
-	uint num_blocks= allocator_total_number_of_units >> 5;
-	for(uint i= 0; i < num_blocks; ++i)
+	uint num_blocks= AllocatorGetNumBlocks();
+	uint num_summary_words= (num_blocks + 31) >> 5;
+	for(uint summary_word_index= 0; summary_word_index < num_summary_words; ++summary_word_index)
 	{
-		// use bitCount to fast skip blocks with overall number of free units less than needed.
-		uint block_bits= allocator_used_units_bits[i];
-		uint number_of_used_units_in_block= bitCount(block_bits);
-		uint number_of_free_units_in_block= 32 - number_of_used_units_in_block;
-		if(number_of_free_units_in_block < size_units)
-			continue; // Amount of free units in this 32bit block is less than required, skip this block.
-
-		// Perform search of passing range in the block.
-		// We require continuous span of "size_units" size.
-		uint num_shifts= 33 - size_units;
-		for(uint shift= 0; shift < num_shifts; ++shift)
+		uint not_full_blocks_bits= ~atomicOr(allocator_data[num_blocks + summary_word_index], 0u);
+		while(not_full_blocks_bits != 0)
 		{
-			uint mask_shifted= mask << shift;
-			if((block_bits & mask_shifted) == 0)
+			int bit= findLSB(not_full_blocks_bits);
+			not_full_blocks_bits&= ~(1u << bit);
+
+			uint block_index= (summary_word_index << 5) + uint(bit);
+			uint block_bits= atomicOr(allocator_data[block_index], 0u);
+			while(true)
 			{
-				// This range of units is free. Allocate it.
-				allocator_used_units_bits[i]= block_bits | mask_shifted;
-				return (i << 5) + shift;
+				// Use bitCount to fast skip blocks with overall number of free units less than needed.
+				if(32 - bitCount(block_bits) < size_units)
+					break;
+
+				// We require continuous span of "size_units" size.
+				uint free_ranges= AllocatorFindFreeRanges(block_bits, size_units);
+				if(free_ranges == 0)
+					break;
+
+				uint shift= uint(findLSB(free_ranges));
+				uint new_block_bits= block_bits | (mask << shift);
+
+				// Other invocation may modify the same block concurrently.
+				// Mark units as used only if the block wasn't changed, else retry with actual bits.
+				uint prev_block_bits= atomicCompSwap(allocator_data[block_index], block_bits, new_block_bits);
+				if(prev_block_bits == block_bits)
+				{
+					if(new_block_bits == 0xFFFFFFFF)
+						AllocatorMarkBlockFull(block_index);
+
+					return (block_index << 5) + shift;
+				}
+
+				block_bits= prev_block_bits;
 			}
 		}
 	}
@@ -66,12 +124,14 @@ void AllocatorFree(uint start_unit, uint size_units)
 	if(size_units == 0)
 		return;
 
-	// Contains number ones equal to size.
-	uint mask= size_units == 32 ? 0xFFFFFFFF : ((1 << size_units) - 1);
+	uint mask= AllocatorGetUnitsMask(size_units);
 
-	uint block= start_unit >> 5;
+	uint block_index= start_unit >> 5;
 	uint offset_within_block= start_unit & 31;
 
 	// Mark given units of this block as free.
-	allocator_used_units_bits[block] &= ~(mask << offset_within_block);
+	atomicAnd(allocator_data[block_index], ~(mask << offset_within_block));
+
+	// Block isn't full anymore.
+	atomicAnd(allocator_data[AllocatorGetNumBlocks() + (block_index >> 5)], ~(1u << (block_index & 31)));
 }
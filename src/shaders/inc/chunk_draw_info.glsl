@@ -20,3 +20,8 @@ struct ChunkDrawInfo
 	uint first_memory_unit;
 	uint num_memory_units;
 };
+
+// Chunk memory is allocated in units of this size.
+// Max number of quads is 65536 / 4 (uint16_t index limit).
+// Min number should be 32 times less because of allocator limitations.
+const uint c_allocation_unut_size_quads= 512;
@@ -0,0 +1,51 @@
+// Chunks activity tracking for world blocks update and light update.
+// Chunk is updated in a tick only if it or one of its adjacent chunks was changed in the previous tick,
+// or if it's its turn for periodic update (needed for random events, like grass growth).
+// Skipping a chunk is possible, because both world buffers contain identical data for a chunk which wasn't changed.
+// This file is also included in C++ code (see "ChunksActivityCPU.hpp"), so, use only GLSL features supported there.
+
+// Separate flags for blocks and light, in order to allow blocks update and light update to run in parallel.
+const uint c_chunks_changed_flags_kind_blocks= 0u;
+const uint c_chunks_changed_flags_kind_light= 1u;
+const uint c_chunks_changed_flags_num_kinds= 2u;
+
+// Flags are double-buffered - flags of previous tick are read, flags of current tick are written.
+int GetChunksChangedFlagsOffset(uint tick, uint kind, ivec2 world_size_chunks)
+{
+	return int((tick & 1u) * c_chunks_changed_flags_num_kinds + kind) * (world_size_chunks.x * world_size_chunks.y);
+}
+
+bool IsPeriodicChunkUpdateTick(int chunk_index, uint current_tick, uint inactive_chunks_update_period)
+{
+	return (uint(chunk_index) + current_tick) % inactive_chunks_update_period == 0u;
+}
+
+#ifdef CHUNKS_ACTIVITY_CHECK
+
+// Define CHUNKS_ACTIVITY_CHECK before including this file in order to use this function.
+// It requires "world_size_chunks", "current_tick", "inactive_chunks_update_period" uniforms
+// and "chunks_changed_flags" buffer to be declared before including this file.
+// Chunk position here is output chunk position.
+bool IsChunkActive(ivec2 chunk_position)
+{
+	int chunk_index= chunk_position.x + chunk_position.y * world_size_chunks.x;
+	if(IsPeriodicChunkUpdateTick(chunk_index, current_tick, inactive_chunks_update_period))
+		return true;
+
+	// Check flags of previous tick for this chunk and its neighbors.
+	uint prev_tick= current_tick - 1u;
+	int blocks_flags_offset= GetChunksChangedFlagsOffset(prev_tick, c_chunks_changed_flags_kind_blocks, world_size_chunks);
+	int light_flags_offset= GetChunksChangedFlagsOffset(prev_tick, c_chunks_changed_flags_kind_light, world_size_chunks);
+
+	for(int y= max(chunk_position.y - 1, 0); y <= min(chunk_position.y + 1, world_size_chunks.y - 1); ++y)
+	for(int x= max(chunk_position.x - 1, 0); x <= min(chunk_position.x + 1, world_size_chunks.x - 1); ++x)
+	{
+		int index= x + y * world_size_chunks.x;
+		if(chunks_changed_flags[blocks_flags_offset + index] != 0u || chunks_changed_flags[light_flags_offset + index] != 0u)
+			return true;
+	}
+
+	return false;
+}
+
+#endif
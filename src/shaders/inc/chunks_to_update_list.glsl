@@ -0,0 +1,10 @@
+// List of chunks processed by a single batched dispatch of world blocks update or light update.
+// Each chunk is processed by a slice of workgroups along Z axis.
+
+// This struct must match the same struct in C++ code!
+struct ChunkToUpdate
+{
+	ivec2 out_chunk_position;
+	uint chunk_modified_flag_index; // Index of the output chunk in the chunks modified flags buffer.
+	uint reserved;
+};
@@ -0,0 +1,9 @@
+// Statistics of vertex memory allocation, read back by the CPU.
+// If this is changed, the same struct in C++ code must be changed too!
+struct GeometryAllocationStats
+{
+	// Total size of memory allocated for all chunks.
+	uint num_used_units;
+	// Total number of failed allocations. It's never reset - the CPU code checks its changes.
+	uint num_failed_allocations;
+};
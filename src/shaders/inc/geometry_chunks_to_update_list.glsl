@@ -0,0 +1,9 @@
+// List of chunks processed by a single batched dispatch of geometry size calculation or geometry generation.
+// Each chunk is processed by a slice of workgroups along Z axis.
+
+// This struct must match the same struct in C++ code!
+struct ChunkToUpdate
+{
+	ivec2 chunk_position; // Position relative current loaded region.
+	ivec2 chunk_global_position; // Global position.
+};
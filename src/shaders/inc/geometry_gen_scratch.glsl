@@ -0,0 +1,15 @@
+// Geometry is generated in two steps.
+// First, quads of a batch of chunks are written into scratch memory - one fixed-size region per chunk.
+// After that memory is allocated for each chunk and its quads are copied from the scratch memory into the allocated memory.
+
+// Capacity of scratch memory region of a single chunk.
+// It's equal to maximum allocation size (32 units), since larger geometry can't be allocated anyway.
+// This must match C++ code!
+const uint c_geometry_scratch_chunk_capacity_quads= 32u * c_allocation_unut_size_quads;
+
+// Quad kinds. Quads of different kinds are placed into different ranges of chunk memory.
+const uint c_quad_kind_regular= 0u;
+const uint c_quad_kind_water= 1u;
+const uint c_quad_kind_fire= 2u;
+const uint c_quad_kind_grass= 3u;
+const uint c_num_quad_kinds= 4u;
@@ -11,4 +11,5 @@ struct WorldGlobalState
 	int sky_light_mask; // zero at night, all ones at day
 	int sky_light_based_wetness_mask; // zero at drought, all ones otherwise
 	int snow_z_level; // Snow may form on blocks equal to this level or above. Should be greater than 0.
+	int simulation_params_changed; // Non-zero if values above affecting world blocks update were changed in this tick.
 };
@@ -0,0 +1,6 @@
+#include "inc/world_vertex.glsl"
+
+struct Quad
+{
+	WorldVertex vertices[4];
+};
@@ -0,0 +1,70 @@
+// If this changed, "WorldVertex" struct and vertex attributes specification in C++ code must be chaned too!
+#ifndef WORLD_VERTEX_GLSL_HEADER
+#define WORLD_VERTEX_GLSL_HEADER
+
+#include "inc/constants.glsl"
+
+// Packed world vertex - 8 bytes.
+// Position is stored relative to the chunk, global coordinates of the chunk are passed via instance index.
+// Texture coordinates are reduced to the range near zero (textures are repeated) - only differences within a quad matter.
+struct WorldVertex
+{
+	// Bits 0-5 - x, bits 6-11 - y, bits 12-16 - texture coordinate x, bits 17-21 - texture coordinate y,
+	// bits 22-29 - texture index.
+	uint pos_xy_tex_coord;
+	// Bits 0-15 - z, bits 16-31 - light (or fire power).
+	uint pos_z_light;
+};
+
+// Size of chunk in vertex position units.
+const int c_world_vertex_chunk_size_x= 3 << c_chunk_width_log2;
+const int c_world_vertex_chunk_size_y= 2 << c_chunk_width_log2;
+
+// Period of textures in texture coordinate units. This should match "c_tex_coord_scale".
+const int c_world_vertex_tex_coord_period_x= 12;
+const int c_world_vertex_tex_coord_period_y= 8;
+
+WorldVertex PackWorldVertex(ivec3 pos_in_chunk, ivec2 tex_coord_reduced, int tex_index, int light)
+{
+	WorldVertex v;
+	v.pos_xy_tex_coord=
+		(uint(pos_in_chunk.x) & 63u) |
+		((uint(pos_in_chunk.y) & 63u) << 6) |
+		((uint(tex_coord_reduced.x) & 31u) << 12) |
+		((uint(tex_coord_reduced.y) & 31u) << 17) |
+		((uint(tex_index) & 255u) << 22);
+	v.pos_z_light= (uint(pos_in_chunk.z) & 0xFFFFu) | ((uint(light) & 0xFFFFu) << 16);
+	return v;
+}
+
+// Chunk global coordinates are passed via "firstInstance" of draw command as two 16-bit signed values.
+uint PackChunkGlobalCoordForInstanceIndex(ivec2 chunk_global_coord)
+{
+	return uint(chunk_global_coord.x & 0xFFFF) | (uint(chunk_global_coord.y & 0xFFFF) << 16);
+}
+
+ivec2 UnpackChunkGlobalCoordFromInstanceIndex(int instance_index)
+{
+	return ivec2(bitfieldExtract(instance_index, 0, 16), bitfieldExtract(instance_index, 16, 16));
+}
+
+// Returns global position.
+ivec3 UnpackWorldVertexPos(uint pos_xy_tex_coord, uint pos_z, ivec2 chunk_global_coord)
+{
+	return ivec3(
+		int(pos_xy_tex_coord & 63u) + chunk_global_coord.x * c_world_vertex_chunk_size_x,
+		int((pos_xy_tex_coord >> 6) & 63u) + chunk_global_coord.y * c_world_vertex_chunk_size_y,
+		int(pos_z));
+}
+
+ivec2 UnpackWorldVertexTexCoord(uint pos_xy_tex_coord)
+{
+	return ivec2((pos_xy_tex_coord >> 12) & 31u, (pos_xy_tex_coord >> 17) & 31u);
+}
+
+int UnpackWorldVertexTexIndex(uint pos_xy_tex_coord)
+{
+	return int((pos_xy_tex_coord >> 22) & 255u);
+}
+
+#endif // WORLD_VERTEX_GLSL_HEADER
@@ -5,6 +5,7 @@
 #extension GL_EXT_shader_explicit_arithmetic_types_int16 : require
 
 #include "inc/block_type.glsl"
+#include "inc/chunks_to_update_list.glsl"
 #include "inc/hex_funcs.glsl"
 
 // maxComputeWorkGroupInvocations is at least 128.
@@ -14,8 +15,9 @@ layout(local_size_x= 4, local_size_y = 4, local_size_z= 8) in;
 layout(push_constant) uniform uniforms_block
 {
 	ivec2 world_size_chunks;
-	ivec2 in_chunk_position;
-	ivec2 out_chunk_position;
+	ivec2 in_chunk_shift; // Relative shift of input chunks (in case of world shift).
+	uint current_tick;
+	uint inactive_chunks_update_period; // 1 means updating all chunks in each tick.
 };
 
 layout(binding= 0, std430) readonly buffer chunks_data_buffer
@@ -33,13 +35,38 @@ layout(binding= 2, std430) writeonly buffer chunk_output_light_buffer
 	uint8_t output_light[];
 };
 
+layout(binding= 3, std430) readonly buffer chunks_to_update_list_buffer
+{
+	ChunkToUpdate chunks_to_update_list[];
+};
+
+// Only flags of previous tick are read and only flags of current tick are written.
+layout(binding= 4, std430) buffer chunks_changed_flags_buffer
+{
+	uint chunks_changed_flags[];
+};
+
+#define CHUNKS_ACTIVITY_CHECK
+#include "inc/chunks_activity.glsl"
+
 void main()
 {
 	// Each thread of this shader calculates light for one block.
 	// Input light buffer is used - for light fetches of adjacent blocks.
 	// Output light buffer is written only for this block.
 
+	// All chunks are processed in a single dispatch - each chunk by its own slice of workgroups along Z axis.
+	uint chunk_list_index= gl_WorkGroupID.z / (uint(c_chunk_height) / gl_WorkGroupSize.z);
+
+	ivec2 out_chunk_position= chunks_to_update_list[chunk_list_index].out_chunk_position;
+	ivec2 in_chunk_position= out_chunk_position + in_chunk_shift;
+
+	// Whole workgroup belongs to the same chunk, so this early exit is uniform.
+	if(!IsChunkActive(out_chunk_position))
+		return;
+
 	ivec3 invocation= ivec3(gl_GlobalInvocationID);
+	invocation.z-= int(chunk_list_index) * c_chunk_height;
 
 	int block_x= (in_chunk_position.x << c_chunk_width_log2) + invocation.x;
 	int block_y= (in_chunk_position.y << c_chunk_width_log2) + invocation.y;
@@ -133,4 +160,8 @@ void main()
 	int chunk_index= out_chunk_position.x + out_chunk_position.y * world_size_chunks.x;
 	int chunk_data_offset= chunk_index * c_chunk_volume;
 	output_light[chunk_data_offset + ChunkBlockAddress(invocation)]= result_light;
+
+	// Many invocations may write the same value here, so no atomics are needed.
+	if(result_light != input_light[block_address])
+		chunks_changed_flags[GetChunksChangedFlagsOffset(current_tick, c_chunks_changed_flags_kind_light, world_size_chunks) + chunk_index]= 1u;
 }
@@ -5,6 +5,7 @@
 #extension GL_EXT_shader_explicit_arithmetic_types_int16 : require
 
 #include "inc/block_type.glsl"
+#include "inc/chunks_activity.glsl"
 #include "inc/hex_funcs.glsl"
 #include "inc/world_blocks_external_update_queue.glsl"
 
@@ -12,6 +13,9 @@ layout(push_constant) uniform uniforms_block
 {
 	ivec2 world_size_chunks;
 	ivec2 world_offset_chunks;
+	// World offset wrapped around world size. Used for chunks modified flags indexing.
+	ivec2 world_offset_chunks_wrapped;
+	uint current_tick;
 };
 
 layout(binding= 0, std430) buffer chunks_data_buffer
@@ -29,6 +33,16 @@ layout(binding= 2, std430) buffer chunks_auxiliar_data_buffer
 	uint8_t chunks_auxiliar_data[];
 };
 
+layout(binding= 3, std430) writeonly buffer chunks_modified_flags_buffer
+{
+	uint chunks_modified_flags[];
+};
+
+layout(binding= 4, std430) writeonly buffer chunks_changed_flags_buffer
+{
+	uint chunks_changed_flags[];
+};
+
 void main()
 {
 	for(uint i= 0; i < min(world_blocks_external_update_queue.num_updates, c_max_world_blocks_external_updates); ++i)
@@ -50,6 +64,18 @@ void main()
 					chunks_auxiliar_data[address]= uint8_t(c_initial_fire_power);
 				else
 					chunks_auxiliar_data[address]= uint8_t(0);
+
+				// Flags are indexed by global chunk coordinates wrapped around world size.
+				// Use only non-negative values here, since modulo of negative values is undefined.
+				ivec2 chunk_position= (position_in_world.xy >> c_chunk_width_log2) + world_offset_chunks_wrapped;
+				ivec2 chunk_position_wrapped= chunk_position % world_size_chunks;
+				chunks_modified_flags[chunk_position_wrapped.x + chunk_position_wrapped.y * world_size_chunks.x]= 1;
+
+				// Mark the chunk as changed in this tick, in order to update it and its neighbors in the next tick.
+				ivec2 chunk_position_in_world= position_in_world.xy >> c_chunk_width_log2;
+				chunks_changed_flags[
+					GetChunksChangedFlagsOffset(current_tick, c_chunks_changed_flags_kind_blocks, world_size_chunks) +
+					chunk_position_in_world.x + chunk_position_in_world.y * world_size_chunks.x]= 1u;
 			}
 			else
 			{
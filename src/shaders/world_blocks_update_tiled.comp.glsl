@@ -0,0 +1,6 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive : require
+
+#define USE_SHARED_MEMORY_TILE 1
+#include "inc/world_blocks_update_base.comp.glsl"
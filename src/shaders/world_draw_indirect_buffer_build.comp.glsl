@@ -7,6 +7,7 @@
 #include "inc/constants.glsl"
 #include "inc/player_state.glsl"
 #include "inc/vulkan_structs.glsl"
+#include "inc/world_vertex.glsl"
 
 layout(push_constant) uniform uniforms_block
 {
@@ -93,6 +94,9 @@ void main()
 
 	bool visible= IsChunkVisible(chunk_global_coord);
 
+	// Vertex positions are relative to the chunk - pass chunk coordinates to vertex shaders via instance index.
+	uint first_instance= PackChunkGlobalCoordForInstanceIndex(chunk_global_coord);
+
 	{
 		uint num_quads= visible ? chunk_draw_info[chunk_index].num_quads : 0;
 		uint first_quad= visible ? chunk_draw_info[chunk_index].first_quad : 0;
@@ -102,7 +106,7 @@ void main()
 		draw_command.instanceCount= 1;
 		draw_command.firstIndex= 0;
 		draw_command.vertexOffset= int(first_quad) * 4;
-		draw_command.firstInstance= 0;
+		draw_command.firstInstance= first_instance;
 
 		draw_commands[chunk_index]= draw_command;
 	}
@@ -116,7 +120,7 @@ void main()
 		draw_command.instanceCount= 1;
 		draw_command.firstIndex= 0;
 		draw_command.vertexOffset= int(first_quad) * 4;
-		draw_command.firstInstance= 0;
+		draw_command.firstInstance= first_instance;
 
 		water_draw_commands[chunk_index]= draw_command;
 	}
@@ -130,7 +134,7 @@ void main()
 		draw_command.instanceCount= 1;
 		draw_command.firstIndex= 0;
 		draw_command.vertexOffset= int(first_quad) * 4;
-		draw_command.firstInstance= 0;
+		draw_command.firstInstance= first_instance;
 
 		fire_draw_commands[chunk_index]= draw_command;
 	}
@@ -161,7 +165,7 @@ void main()
 		draw_command.instanceCount= 1;
 		draw_command.firstIndex= 0;
 		draw_command.vertexOffset= int(first_quad) * 4;
-		draw_command.firstInstance= 0;
+		draw_command.firstInstance= first_instance;
 
 		grass_draw_commands[chunk_index]= draw_command;
 	}
@@ -20,6 +20,7 @@ layout(push_constant) uniform uniforms_block
 	ivec2 chunk_position;
 	ivec2 chunk_global_position;
 	int seed;
+	int chunk_modified_flag_index;
 };
 
 layout(binding= 0, std430) buffer chunks_data_buffer
@@ -47,6 +48,11 @@ layout(binding= 4, std430) writeonly buffer chunks_auxiliar_data_buffer
 	uint8_t chunks_auxiliar_data[];
 };
 
+layout(binding= 5, std430) writeonly buffer chunks_modified_flags_buffer
+{
+	uint chunks_modified_flags[];
+};
+
 void main()
 {
 	int chunk_index= chunk_position.x + chunk_position.y * world_size_chunks.x;
@@ -61,6 +67,10 @@ void main()
 
 	int column_offset= chunk_data_offset + ChunkBlockAddress(ivec3(local_x, local_y, 0));
 
+	// Generated chunks are not in the storage yet, so they should be always saved.
+	if(local_x == 0 && local_y == 0)
+		chunks_modified_flags[chunk_modified_flag_index]= 1;
+
 	// Zero level - place single block of special type.
 	chunks_data[column_offset]= c_block_type_spherical_block;
 
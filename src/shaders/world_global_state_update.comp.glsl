@@ -62,9 +62,20 @@ void main()
 	world_global_state.stars_matrix= MakeRotationYMatrix(-sun_phase);
 
 	// Assuming sky light is zero at night.
-	world_global_state.sky_light_mask= daynight_k >= 1.0 ? 0xFFFFFFFF : 0x0;
+	int sky_light_mask= daynight_k >= 1.0 ? 0xFFFFFFFF : 0x0;
 
-	world_global_state.sky_light_based_wetness_mask= drought_intensity > 0.0 ? 0x0 : 0xFFFFFFFF;
+	int sky_light_based_wetness_mask= drought_intensity > 0.0 ? 0x0 : 0xFFFFFFFF;
+
+	// Chunks skipped as inactive would keep results calculated with outdated values, so all chunks are updated if they are changed.
+	// A single tick is enough - chunks changed due to new values set their changed flags as usual.
+	world_global_state.simulation_params_changed=
+		(sky_light_mask != world_global_state.sky_light_mask ||
+		sky_light_based_wetness_mask != world_global_state.sky_light_based_wetness_mask ||
+		snow_z_level != world_global_state.snow_z_level) ? 1 : 0;
+
+	world_global_state.sky_light_mask= sky_light_mask;
+
+	world_global_state.sky_light_based_wetness_mask= sky_light_based_wetness_mask;
 
 	world_global_state.snow_z_level= snow_z_level;
 }
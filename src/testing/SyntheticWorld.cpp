@@ -0,0 +1,173 @@
+#include "SyntheticWorld.hpp"
+#include "Constants.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace HexGPU
+{
+
+namespace
+{
+
+constexpr int32_t c_water_level= 32;
+constexpr int32_t c_tree_height= 7;
+constexpr int32_t c_tree_crown_radius= 2;
+
+uint32_t Hash(const int32_t x, const int32_t y, const uint32_t seed)
+{
+	uint32_t h= uint32_t(x) * 0x8DA6B343u ^ uint32_t(y) * 0xD8163841u ^ seed * 0xCB1AB31Fu;
+	h^= h >> 15;
+	h*= 0x2C1B3C6Du;
+	h^= h >> 12;
+	h*= 0x297A2D39u;
+	h^= h >> 15;
+	return h;
+}
+
+// Bilinearly-interpolated value noise in range [0; 256 * 256).
+int32_t ValueNoise(const int32_t x, const int32_t y, const uint32_t seed, const int32_t cell_size_log2)
+{
+	const int32_t cell_x= x >> cell_size_log2;
+	const int32_t cell_y= y >> cell_size_log2;
+	const int32_t cell_size= 1 << cell_size_log2;
+	const int32_t dx= (x & (cell_size - 1)) * 256 / cell_size;
+	const int32_t dy= (y & (cell_size - 1)) * 256 / cell_size;
+
+	const int32_t v00= int32_t(Hash(cell_x + 0, cell_y + 0, seed) & 255u);
+	const int32_t v10= int32_t(Hash(cell_x + 1, cell_y + 0, seed) & 255u);
+	const int32_t v01= int32_t(Hash(cell_x + 0, cell_y + 1, seed) & 255u);
+	const int32_t v11= int32_t(Hash(cell_x + 1, cell_y + 1, seed) & 255u);
+
+	const int32_t v0= v00 * (256 - dx) + v10 * dx;
+	const int32_t v1= v01 * (256 - dx) + v11 * dx;
+	return (v0 * (256 - dy) + v1 * dy) >> 8;
+}
+
+int32_t GetGroundLevel(const int32_t global_x, const int32_t global_y, const uint32_t seed)
+{
+	const int32_t noise=
+		ValueNoise(global_x, global_y, seed + 0, 6) +
+		(ValueNoise(global_x, global_y, seed + 1, 4) >> 1) +
+		(ValueNoise(global_x, global_y, seed + 2, 2) >> 3);
+
+	// Produce levels both below and above water level, leave space for trees.
+	return std::max(3, std::min(16 + (noise >> 10), int32_t(c_chunk_height) - 2 - c_tree_height - c_tree_crown_radius * 2));
+}
+
+bool HasTree(const int32_t global_x, const int32_t global_y, const uint32_t seed)
+{
+	return (Hash(global_x, global_y, seed ^ 0x7EE5u) & 127u) == 0u;
+}
+
+} // namespace
+
+void GenerateSyntheticChunk(
+	const int32_t chunk_x,
+	const int32_t chunk_y,
+	const uint32_t seed,
+	BlockType* const blocks_data,
+	uint8_t* const blocks_auxiliar_data)
+{
+	std::memset(blocks_data, 0, c_chunk_volume);
+	std::memset(blocks_auxiliar_data, 0, c_chunk_volume);
+
+	const int32_t chunk_width= int32_t(c_chunk_width);
+	for(int32_t x= 0; x < chunk_width; ++x)
+	for(int32_t y= 0; y < chunk_width; ++y)
+	{
+		const int32_t global_x= chunk_x * chunk_width + x;
+		const int32_t global_y= chunk_y * chunk_width + y;
+		const uint32_t column_offset= uint32_t(x * chunk_width + y) * c_chunk_height;
+		BlockType* const column= blocks_data + column_offset;
+		uint8_t* const column_auxiliar_data= blocks_auxiliar_data + column_offset;
+
+		const int32_t ground_z= GetGroundLevel(global_x, global_y, seed);
+
+		column[0]= BlockType::SphericalBlock;
+		for(int32_t z= 1; z < ground_z - 2; ++z)
+			column[z]= BlockType::Stone;
+
+		const bool under_water= ground_z <= c_water_level;
+		column[ground_z - 2]= under_water ? BlockType::Stone : BlockType::Soil;
+		column[ground_z - 1]= under_water ? BlockType::Sand : BlockType::Soil;
+		column[ground_z]= under_water ? BlockType::Sand : BlockType::Grass;
+
+		for(int32_t z= ground_z + 1; z <= c_water_level; ++z)
+		{
+			column[z]= BlockType::Water;
+			column_auxiliar_data[z]= uint8_t(c_max_water_level);
+		}
+
+		if(under_water)
+			continue;
+
+		// Trees are placed within single column - trunk with crown of foliage above it.
+		// This isn't how real trees look, but it's enough to produce similar data.
+		if(HasTree(global_x, global_y, seed))
+		{
+			for(int32_t z= ground_z + 1; z <= ground_z + c_tree_height; ++z)
+				column[z]= BlockType::Wood;
+			for(int32_t z= ground_z + c_tree_height + 1; z <= ground_z + c_tree_height + c_tree_crown_radius * 2; ++z)
+			{
+				column[z]= BlockType::Foliage;
+				column_auxiliar_data[z]= uint8_t(c_max_foliage_factor);
+			}
+		}
+		else
+		{
+			// Foliage near trees.
+			for(int32_t dx= -c_tree_crown_radius; dx <= c_tree_crown_radius; ++dx)
+			for(int32_t dy= -c_tree_crown_radius; dy <= c_tree_crown_radius; ++dy)
+			{
+				if(!HasTree(global_x + dx, global_y + dy, seed))
+					continue;
+
+				const int32_t tree_ground_z= GetGroundLevel(global_x + dx, global_y + dy, seed);
+				if(tree_ground_z <= c_water_level)
+					continue;
+
+				const int32_t crown_center_z= tree_ground_z + c_tree_height + c_tree_crown_radius;
+				const int32_t crown_half_height= c_tree_crown_radius - std::max(std::abs(dx), std::abs(dy)) / 2;
+				for(int32_t z= crown_center_z - crown_half_height; z <= crown_center_z + crown_half_height; ++z)
+				{
+					if(z > ground_z && column[z] == BlockType::Air)
+					{
+						column[z]= BlockType::Foliage;
+						column_auxiliar_data[z]= uint8_t(c_max_foliage_factor);
+					}
+				}
+			}
+		}
+	}
+}
+
+SyntheticChunks GenerateSyntheticChunks(
+	const int32_t start_x,
+	const int32_t start_y,
+	const uint32_t size_x,
+	const uint32_t size_y,
+	const uint32_t seed)
+{
+	SyntheticChunks chunks;
+	chunks.size[0]= size_x;
+	chunks.size[1]= size_y;
+	chunks.blocks.resize(size_x * size_y * c_chunk_volume);
+	chunks.auxiliar_data.resize(size_x * size_y * c_chunk_volume);
+
+	for(uint32_t y= 0; y < size_y; ++y)
+	for(uint32_t x= 0; x < size_x; ++x)
+	{
+		const uint32_t offset= (x + y * size_x) * c_chunk_volume;
+		GenerateSyntheticChunk(
+			start_x + int32_t(x),
+			start_y + int32_t(y),
+			seed,
+			chunks.blocks.data() + offset,
+			chunks.auxiliar_data.data() + offset);
+	}
+
+	return chunks;
+}
+
+} // namespace HexGPU
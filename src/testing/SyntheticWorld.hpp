@@ -0,0 +1,32 @@
+#pragma once
+#include "BlockType.hpp"
+#include <vector>
+
+namespace HexGPU
+{
+
+// Generator of synthetic chunks data for tests and benchmarks. No GPU is required.
+// It roughly mimics the world generator shader - stone, soil and grass or sand on top of it, water below water level,
+// some trees with foliage (which uses auxiliar data).
+// Result depends only on chunk coordinates and seed.
+
+// Output arrays are both of "c_chunk_volume" size.
+void GenerateSyntheticChunk(
+	int32_t chunk_x,
+	int32_t chunk_y,
+	uint32_t seed,
+	BlockType* blocks_data,
+	uint8_t* blocks_auxiliar_data);
+
+// Data of several chunks in the same layout as GPU chunks data buffers - "c_chunk_volume" bytes for each chunk.
+struct SyntheticChunks
+{
+	uint32_t size[2]{};
+	std::vector<BlockType> blocks;
+	std::vector<uint8_t> auxiliar_data;
+};
+
+// Generate rectangular area of chunks with given start coordinates.
+SyntheticChunks GenerateSyntheticChunks(int32_t start_x, int32_t start_y, uint32_t size_x, uint32_t size_y, uint32_t seed);
+
+} // namespace HexGPU
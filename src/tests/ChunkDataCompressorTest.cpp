@@ -0,0 +1,218 @@
+#include "ChunkDataCompressor.hpp"
+#include "Constants.hpp"
+#include "testing/SyntheticWorld.hpp"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <random>
+
+namespace HexGPU
+{
+
+namespace
+{
+
+struct Chunk
+{
+	std::vector<BlockType> blocks= std::vector<BlockType>(c_chunk_volume);
+	std::vector<uint8_t> auxiliar_data= std::vector<uint8_t>(c_chunk_volume);
+};
+
+enum class ChunkKind
+{
+	Zero,
+	Synthetic,
+	RandomRuns,
+	RandomNoise,
+	RepeatedColumns,
+	NumKinds,
+};
+
+// Produce data with different properties - long runs, short runs, equal columns, sparse auxiliar data, etc.
+Chunk GenerateChunk(const ChunkKind kind, std::mt19937& rng)
+{
+	Chunk chunk;
+
+	const auto random_byte= [&]{ return uint8_t(rng() & 255u); };
+
+	switch(kind)
+	{
+	case ChunkKind::Zero:
+		break;
+
+	case ChunkKind::Synthetic:
+		GenerateSyntheticChunk(int32_t(rng() % 64u), int32_t(rng() % 64u), uint32_t(rng()), chunk.blocks.data(), chunk.auxiliar_data.data());
+		break;
+
+	case ChunkKind::RandomRuns:
+		{
+			const uint32_t average_run_length= 1u + uint32_t(rng() % 64u);
+			uint8_t block_value= 0;
+			uint8_t auxiliar_value= 0;
+			for(uint32_t i= 0; i < c_chunk_volume; ++i)
+			{
+				if(rng() % average_run_length == 0)
+					block_value= random_byte();
+				if(rng() % (average_run_length * 4) == 0)
+					auxiliar_value= rng() % 2 == 0 ? 0 : random_byte();
+				chunk.blocks[i]= BlockType(block_value);
+				chunk.auxiliar_data[i]= auxiliar_value;
+			}
+		}
+		break;
+
+	case ChunkKind::RandomNoise:
+		for(uint32_t i= 0; i < c_chunk_volume; ++i)
+		{
+			chunk.blocks[i]= BlockType(random_byte());
+			chunk.auxiliar_data[i]= random_byte();
+		}
+		break;
+
+	case ChunkKind::RepeatedColumns:
+		{
+			// Few distinct columns, repeated in random order.
+			std::vector<uint8_t> columns(4 * c_chunk_height);
+			for(uint8_t& value : columns)
+				value= rng() % 4u == 0 ? random_byte() : 0;
+
+			for(uint32_t column= 0; column < c_chunk_width * c_chunk_width; ++column)
+			{
+				const uint8_t* const src= columns.data() + (rng() % 4u) * c_chunk_height;
+				std::memcpy(chunk.blocks.data() + column * c_chunk_height, src, c_chunk_height);
+				if(rng() % 8u == 0)
+					std::memcpy(chunk.auxiliar_data.data() + column * c_chunk_height, src, c_chunk_height);
+			}
+		}
+		break;
+
+	case ChunkKind::NumKinds:
+		break;
+	};
+
+	return chunk;
+}
+
+struct CodecVariant
+{
+	ChunkCodec codec;
+	bool use_zstd_dictionary;
+};
+
+std::vector<CodecVariant> GetCodecVariants()
+{
+	std::vector<CodecVariant> result;
+	for(uint32_t i= 0; i < c_num_chunk_codecs; ++i)
+		result.push_back({ChunkCodec(i), false});
+	result.push_back({ChunkCodec::Zstd, true});
+	return result;
+}
+
+std::shared_ptr<const ZstdDictionary> TrainDictionary(std::mt19937& rng)
+{
+	std::vector<std::string> samples;
+	for(uint32_t i= 0; i < 64; ++i)
+	{
+		const Chunk chunk= GenerateChunk(ChunkKind::Synthetic, rng);
+		samples.emplace_back(reinterpret_cast<const char*>(chunk.blocks.data()), c_chunk_volume);
+	}
+
+	return ZstdDictionary::Train(samples);
+}
+
+} // namespace
+
+TEST(ChunkDataCompressorTest, RoundTrip)
+{
+	std::mt19937 rng(0);
+	const std::shared_ptr<const ZstdDictionary> zstd_dictionary= TrainDictionary(rng);
+	ASSERT_NE(zstd_dictionary, nullptr);
+
+	ChunkDataCompressor compressor;
+	Chunk chunk_decompressed;
+
+	for(uint32_t iteration= 0; iteration < 64; ++iteration)
+	for(uint32_t kind= 0; kind < uint32_t(ChunkKind::NumKinds); ++kind)
+	{
+		const Chunk chunk= GenerateChunk(ChunkKind(kind), rng);
+
+		for(const CodecVariant& codec_variant : GetCodecVariants())
+		for(const AuxiliarDataLayout layout : {AuxiliarDataLayout::Dense, AuxiliarDataLayout::SparseColumns})
+		{
+			const ZstdDictionary* const dictionary= codec_variant.use_zstd_dictionary ? zstd_dictionary.get() : nullptr;
+
+			const ChunkDataCompresed data_compressed=
+				compressor.Compress(codec_variant.codec, chunk.blocks.data(), chunk.auxiliar_data.data(), dictionary, layout);
+			ASSERT_EQ(data_compressed.codec, codec_variant.codec);
+			ASSERT_EQ(data_compressed.auxiliar_data_layout, layout);
+
+			ASSERT_TRUE(
+				compressor.Decompress(
+					data_compressed,
+					chunk_decompressed.blocks.data(),
+					chunk_decompressed.auxiliar_data.data(),
+					dictionary))
+				<< "codec " << ChunkCodecToString(codec_variant.codec) << ", kind " << kind;
+
+			ASSERT_EQ(chunk_decompressed.blocks, chunk.blocks)
+				<< "codec " << ChunkCodecToString(codec_variant.codec) << ", kind " << kind;
+			ASSERT_EQ(chunk_decompressed.auxiliar_data, chunk.auxiliar_data)
+				<< "codec " << ChunkCodecToString(codec_variant.codec) << ", kind " << kind;
+		}
+	}
+}
+
+TEST(ChunkDataCompressorTest, ZstdDictionaryIsRequired)
+{
+	std::mt19937 rng(1);
+	const std::shared_ptr<const ZstdDictionary> zstd_dictionary= TrainDictionary(rng);
+	ASSERT_NE(zstd_dictionary, nullptr);
+
+	ChunkDataCompressor compressor;
+	const Chunk chunk= GenerateChunk(ChunkKind::Synthetic, rng);
+	Chunk chunk_decompressed;
+
+	const ChunkDataCompresed data_compressed=
+		compressor.Compress(ChunkCodec::Zstd, chunk.blocks.data(), chunk.auxiliar_data.data(), zstd_dictionary.get());
+
+	EXPECT_FALSE(compressor.Decompress(data_compressed, chunk_decompressed.blocks.data(), chunk_decompressed.auxiliar_data.data()));
+}
+
+TEST(ChunkDataCompressorTest, CorruptedDataIsHandled)
+{
+	std::mt19937 rng(2);
+
+	ChunkDataCompressor compressor;
+	Chunk chunk_decompressed;
+
+	for(uint32_t iteration= 0; iteration < 256; ++iteration)
+	{
+		const Chunk chunk= GenerateChunk(ChunkKind(iteration % uint32_t(ChunkKind::NumKinds)), rng);
+
+		for(const CodecVariant& codec_variant : GetCodecVariants())
+		{
+			if(codec_variant.use_zstd_dictionary)
+				continue;
+
+			ChunkDataCompresed data_compressed=
+				compressor.Compress(codec_variant.codec, chunk.blocks.data(), chunk.auxiliar_data.data());
+
+			// Flip random bytes or truncate data. Decompression may succeed or fail, but must not crash.
+			std::string& data= rng() % 2 == 0 ? data_compressed.blocks : data_compressed.auxiliar_data;
+			if(data.empty())
+				continue;
+
+			if(rng() % 4 == 0)
+				data.resize(rng() % data.size());
+			else
+			{
+				const uint32_t num_flips= 1u + uint32_t(rng() % 4u);
+				for(uint32_t i= 0; i < num_flips; ++i)
+					data[rng() % data.size()]^= char(1 + rng() % 255);
+			}
+
+			compressor.Decompress(data_compressed, chunk_decompressed.blocks.data(), chunk_decompressed.auxiliar_data.data());
+		}
+	}
+}
+
+} // namespace HexGPU
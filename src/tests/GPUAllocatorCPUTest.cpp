@@ -0,0 +1,175 @@
+#include "GPUAllocatorCPU.hpp"
+#include "ThreadPool.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <future>
+#include <random>
+
+namespace HexGPU
+{
+
+namespace
+{
+
+struct StressTestParams
+{
+	uint32_t total_memory_units= 0;
+	// Each owner (like a chunk) has no more than one allocation.
+	uint32_t num_owners= 0;
+	// Number of owners reallocating their memory in parallel each iteration.
+	uint32_t batch_size= 0;
+	uint32_t num_iterations= 0;
+	uint32_t seed= 0;
+};
+
+struct StressTestResult
+{
+	// False if overlapping allocations or inconsistent allocator state were found.
+	bool ok= true;
+	uint32_t num_allocations= 0;
+	uint32_t num_failed_allocations= 0;
+	// Sum of sizes of all allocations at the end.
+	uint32_t num_allocated_units= 0;
+	GPUAllocatorCPU::Stats final_stats;
+};
+
+// Perform random reallocations in parallel batches, like geometry allocation shader does.
+// Allocator state is validated after each batch.
+StressTestResult RunStressTest(const StressTestParams& params, ThreadPool& thread_pool)
+{
+	struct Allocation
+	{
+		uint32_t first_unit= 0;
+		uint32_t num_units= 0;
+	};
+
+	StressTestResult result;
+
+	GPUAllocatorCPU allocator(params.total_memory_units);
+	std::vector<Allocation> allocations(params.num_owners);
+
+	std::mt19937 random_generator(params.seed);
+
+	// Prefer small allocations, like in real world - most chunks have relatively simple geometry.
+	std::geometric_distribution<uint32_t> size_distribution(0.25);
+	std::vector<uint32_t> owners(params.num_owners);
+	for(uint32_t i= 0; i < params.num_owners; ++i)
+		owners[i]= i;
+
+	const uint32_t batch_size= std::min(params.batch_size, params.num_owners);
+
+	std::vector<uint32_t> unit_owners;
+	for(uint32_t iteration= 0; iteration < params.num_iterations && result.ok; ++iteration)
+	{
+		// Choose distinct owners for this batch and their new sizes.
+		std::shuffle(owners.begin(), owners.end(), random_generator);
+
+		std::vector<uint32_t> new_sizes(batch_size);
+		for(uint32_t& size : new_sizes)
+			size= std::min(size_distribution(random_generator), GPUAllocatorCPU::c_max_allocation_size_units);
+
+		// Reallocate in parallel - first allocate new memory, then free old memory, if allocation was successful.
+		std::vector<std::future<bool>> tasks;
+		tasks.reserve(batch_size);
+		for(uint32_t i= 0; i < batch_size; ++i)
+		{
+			tasks.push_back(
+				thread_pool.Submit(
+					[&allocator, &allocation= allocations[owners[i]], new_size= new_sizes[i]]
+					{
+						if(new_size == allocation.num_units)
+							return true;
+
+						const uint32_t new_unit= allocator.Allocate(new_size);
+						if(new_unit == GPUAllocatorCPU::c_fail_result)
+							return false;
+
+						allocator.Free(allocation.first_unit, allocation.num_units);
+						allocation.first_unit= new_unit;
+						allocation.num_units= new_size;
+						return true;
+					}));
+		}
+
+		for(std::future<bool>& task : tasks)
+		{
+			++result.num_allocations;
+			if(!task.get())
+				++result.num_failed_allocations;
+		}
+
+		// Check that allocations don't overlap and that allocator state matches allocations.
+		unit_owners.assign(params.total_memory_units, GPUAllocatorCPU::c_fail_result);
+		for(uint32_t owner= 0; owner < params.num_owners && result.ok; ++owner)
+		{
+			const Allocation& allocation= allocations[owner];
+			if(allocation.num_units > 0 && (allocation.first_unit & 31) + allocation.num_units > 32)
+				result.ok= false;
+
+			for(uint32_t unit= allocation.first_unit; unit < allocation.first_unit + allocation.num_units && result.ok; ++unit)
+			{
+				if(unit >= params.total_memory_units || unit_owners[unit] != GPUAllocatorCPU::c_fail_result)
+					result.ok= false;
+				else
+					unit_owners[unit]= owner;
+			}
+		}
+
+		for(uint32_t unit= 0; unit < params.total_memory_units && result.ok; ++unit)
+		{
+			if(allocator.IsUnitUsed(unit) != (unit_owners[unit] != GPUAllocatorCPU::c_fail_result))
+				result.ok= false;
+		}
+
+		if(!allocator.IsConsistent())
+			result.ok= false;
+	}
+
+	for(const Allocation& allocation : allocations)
+		result.num_allocated_units+= allocation.num_units;
+
+	result.final_stats= allocator.CalculateStats();
+
+	return result;
+}
+
+} // namespace
+
+TEST(GPUAllocatorCPUTest, ParallelReallocationsKeepStateValid)
+{
+	// Use parameters close to geometry allocation for maximum world size.
+	StressTestParams params;
+	params.num_owners= 48 * 48;
+	params.total_memory_units= params.num_owners * 12;
+	params.batch_size= 62;
+	params.num_iterations= 256;
+	params.seed= 0;
+
+	ThreadPool thread_pool;
+	const StressTestResult result= RunStressTest(params, thread_pool);
+
+	EXPECT_TRUE(result.ok);
+	EXPECT_EQ(result.num_allocations, params.batch_size * params.num_iterations);
+	EXPECT_EQ(result.final_stats.total_units, params.total_memory_units);
+	EXPECT_EQ(result.final_stats.used_units, result.num_allocated_units);
+}
+
+// Allocations should fail when there is no free memory, but allocator state should remain valid.
+TEST(GPUAllocatorCPUTest, ParallelReallocationsKeepStateValidWhenMemoryIsLow)
+{
+	StressTestParams params;
+	params.num_owners= 1024;
+	params.total_memory_units= params.num_owners * 2;
+	params.batch_size= 62;
+	params.num_iterations= 256;
+	params.seed= 1;
+
+	ThreadPool thread_pool;
+	const StressTestResult result= RunStressTest(params, thread_pool);
+
+	EXPECT_TRUE(result.ok);
+	EXPECT_GT(result.num_failed_allocations, 0u);
+	EXPECT_EQ(result.final_stats.used_units, result.num_allocated_units);
+}
+
+} // namespace HexGPU
@@ -0,0 +1,59 @@
+#include "Constants.hpp"
+#include "LightUpdateCPU.hpp"
+#include "ThreadPool.hpp"
+#include "testing/SyntheticWorld.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace HexGPU
+{
+
+TEST(LightUpdateCPUTest, AllKernelsGiveSameResult)
+{
+	constexpr uint32_t c_world_size= 4;
+	constexpr size_t c_world_volume= c_world_size * c_world_size * c_chunk_volume;
+
+	std::mt19937 rng(0);
+	ThreadPool thread_pool(1);
+
+	// Use synthetic chunks with random blocks (including light sources) and random light, in order to check all cases.
+	const SyntheticChunks chunks= GenerateSyntheticChunks(0, 0, c_world_size, c_world_size, 0);
+	std::vector<uint8_t> blocks(c_world_volume);
+	for(size_t i= 0; i < c_world_volume; ++i)
+		blocks[i]= uint8_t(chunks.blocks[i]);
+	for(uint32_t i= 0; i < c_world_volume / 32; ++i)
+		blocks[rng() % c_world_volume]= uint8_t(rng() % (uint32_t(BlockType::NumBlockTypes) + 2));
+
+	std::vector<uint8_t> input_light(c_world_volume);
+	for(uint8_t& light : input_light)
+		light= uint8_t(rng() & 255u);
+
+	std::vector<ChunkPositionCPU> chunk_positions;
+	for(uint32_t y= 0; y < c_world_size; ++y)
+	for(uint32_t x= 0; x < c_world_size; ++x)
+		chunk_positions.push_back({x, y});
+
+	std::vector<uint8_t> reference_light;
+	for(const LightUpdateCPUKernel kernel : GetSupportedLightUpdateCPUKernels())
+	{
+		LightUpdateCPUParams params;
+		params.world_size_chunks= {c_world_size, c_world_size};
+		params.kernel= kernel;
+
+		std::vector<uint8_t> output_light(c_world_volume);
+
+		LightUpdateCPUData data;
+		data.chunks_data= blocks.data();
+		data.input_light= input_light.data();
+		data.output_light= output_light.data();
+
+		UpdateChunksLightCPU(params, data, chunk_positions, thread_pool);
+
+		if(kernel == LightUpdateCPUKernel::Scalar)
+			reference_light= std::move(output_light);
+		else
+			EXPECT_EQ(output_light, reference_light) << LightUpdateCPUKernelToString(kernel);
+	}
+}
+
+} // namespace HexGPU
@@ -0,0 +1,313 @@
+#include "TaskBarriersTracker.hpp"
+#include <gtest/gtest.h>
+#include <cstring>
+
+namespace HexGPU
+{
+
+namespace
+{
+
+using BufferUsage= TaskBarriersTracker::BufferUsage;
+using ImageUsage= TaskBarriersTracker::ImageUsage;
+using TaskUsages= TaskBarriersTracker::TaskUsages;
+using BarriersBatch= TaskBarriersTracker::BarriersBatch;
+using BufferRange= TaskBarriersTracker::BufferRange;
+
+constexpr uint32_t c_queue_family_index= 0;
+
+// Barriers are only calculated, so fake handles may be used.
+vk::Buffer MakeBuffer(const uint64_t id)
+{
+	VkBuffer buffer;
+	static_assert(sizeof(buffer) <= sizeof(id), "Unexpected handle size");
+	std::memcpy(&buffer, &id, sizeof(buffer));
+	return vk::Buffer(buffer);
+}
+
+vk::Image MakeImage(const uint64_t id)
+{
+	VkImage image;
+	static_assert(sizeof(image) <= sizeof(id), "Unexpected handle size");
+	std::memcpy(&image, &id, sizeof(image));
+	return vk::Image(image);
+}
+
+TaskBarriersTracker::ImageInfo MakeImageInfo(const vk::Image image)
+{
+	return TaskBarriersTracker::ImageInfo{image, vk::ImageAspectFlagBits::eColor, 1, 1};
+}
+
+TaskUsages BufferTask(const BufferRange& range, const BufferUsage usage)
+{
+	TaskUsages usages;
+	usages.buffers.emplace_back(range, usage);
+	return usages;
+}
+
+TaskUsages ImageTask(const vk::Image image, const ImageUsage usage)
+{
+	TaskUsages usages;
+	usages.images.emplace_back(MakeImageInfo(image), usage);
+	return usages;
+}
+
+// Add scripted sequence of tasks and merge their barriers, like TaskOrganizer does in deferred mode.
+std::vector<BarriersBatch> AddTasksDeferred(const std::vector<TaskUsages>& tasks_usages)
+{
+	TaskBarriersTracker tracker(c_queue_family_index);
+
+	std::vector<BarriersBatch> tasks_barriers;
+	for(const TaskUsages& usages : tasks_usages)
+		tasks_barriers.push_back(tracker.AddTask(usages));
+
+	TaskBarriersTracker::MergeTasksBarriers(tasks_usages, tasks_barriers);
+	return tasks_barriers;
+}
+
+TEST(TaskBarriersTrackerTest, ReadAfterWriteIsSynchronizedOncePerReadKind)
+{
+	TaskBarriersTracker tracker(c_queue_family_index);
+	const vk::Buffer buffer= MakeBuffer(1);
+
+	EXPECT_TRUE(tracker.AddTask(BufferTask(buffer, BufferUsage::ComputeShaderDst)).IsEmpty());
+
+	const BarriersBatch read_barriers= tracker.AddTask(BufferTask(buffer, BufferUsage::ComputeShaderSrc));
+	ASSERT_EQ(read_barriers.buffer_barriers.size(), 1u);
+	EXPECT_TRUE(read_barriers.image_barriers.empty());
+	EXPECT_EQ(read_barriers.buffer_barriers[0].buffer, buffer);
+	EXPECT_EQ(read_barriers.buffer_barriers[0].srcAccessMask, vk::AccessFlags(vk::AccessFlagBits::eShaderWrite));
+	EXPECT_EQ(read_barriers.buffer_barriers[0].dstAccessMask, vk::AccessFlags(vk::AccessFlagBits::eShaderRead));
+	EXPECT_EQ(read_barriers.src_pipeline_stage_flags, vk::PipelineStageFlags(vk::PipelineStageFlagBits::eComputeShader));
+	EXPECT_EQ(read_barriers.dst_pipeline_stage_flags, vk::PipelineStageFlags(vk::PipelineStageFlagBits::eComputeShader));
+
+	// Results are already visible for this kind of reads.
+	EXPECT_TRUE(tracker.AddTask(BufferTask(buffer, BufferUsage::ComputeShaderSrc)).IsEmpty());
+
+	// But not for other kinds.
+	const BarriersBatch transfer_read_barriers= tracker.AddTask(BufferTask(buffer, BufferUsage::TransferSrc));
+	ASSERT_EQ(transfer_read_barriers.buffer_barriers.size(), 1u);
+	EXPECT_EQ(transfer_read_barriers.buffer_barriers[0].dstAccessMask, vk::AccessFlags(vk::AccessFlagBits::eTransferRead));
+	EXPECT_EQ(transfer_read_barriers.dst_pipeline_stage_flags, vk::PipelineStageFlags(vk::PipelineStageFlagBits::eTransfer));
+}
+
+TEST(TaskBarriersTrackerTest, WriteAfterReadNeedsOnlyExecutionBarrier)
+{
+	TaskBarriersTracker tracker(c_queue_family_index);
+	const vk::Buffer buffer= MakeBuffer(1);
+
+	tracker.AddTask(BufferTask(buffer, BufferUsage::TransferDst));
+	tracker.AddTask(BufferTask(buffer, BufferUsage::ComputeShaderSrc));
+
+	const BarriersBatch write_barriers= tracker.AddTask(BufferTask(buffer, BufferUsage::ComputeShaderDst));
+	EXPECT_TRUE(write_barriers.buffer_barriers.empty());
+	EXPECT_TRUE(write_barriers.require_execution_barrier);
+	EXPECT_EQ(write_barriers.src_pipeline_stage_flags, vk::PipelineStageFlags(vk::PipelineStageFlagBits::eComputeShader));
+	EXPECT_EQ(write_barriers.dst_pipeline_stage_flags, vk::PipelineStageFlags(vk::PipelineStageFlagBits::eComputeShader));
+}
+
+TEST(TaskBarriersTrackerTest, WriteAfterWriteNeedsMemoryBarrier)
+{
+	TaskBarriersTracker tracker(c_queue_family_index);
+	const vk::Buffer buffer= MakeBuffer(1);
+
+	tracker.AddTask(BufferTask(buffer, BufferUsage::TransferDst));
+
+	const BarriersBatch write_barriers= tracker.AddTask(BufferTask(buffer, BufferUsage::ComputeShaderDst));
+	ASSERT_EQ(write_barriers.buffer_barriers.size(), 1u);
+	EXPECT_FALSE(write_barriers.require_execution_barrier);
+	EXPECT_EQ(write_barriers.buffer_barriers[0].srcAccessMask, vk::AccessFlags(vk::AccessFlagBits::eTransferWrite));
+	EXPECT_EQ(write_barriers.buffer_barriers[0].dstAccessMask, vk::AccessFlags(vk::AccessFlagBits::eShaderWrite));
+	EXPECT_EQ(write_barriers.src_pipeline_stage_flags, vk::PipelineStageFlags(vk::PipelineStageFlagBits::eTransfer));
+}
+
+TEST(TaskBarriersTrackerTest, DisjointRangesAreNotSynchronized)
+{
+	TaskBarriersTracker tracker(c_queue_family_index);
+	const vk::Buffer buffer= MakeBuffer(1);
+
+	tracker.AddTask(BufferTask(BufferRange(buffer, 0, 64), BufferUsage::ComputeShaderDst));
+
+	EXPECT_TRUE(tracker.AddTask(BufferTask(BufferRange(buffer, 64, 64), BufferUsage::ComputeShaderSrc)).IsEmpty());
+	EXPECT_TRUE(tracker.AddTask(BufferTask(BufferRange(buffer, 128, 64), BufferUsage::ComputeShaderDst)).IsEmpty());
+
+	// Barrier is created only for the range of the reading task.
+	const BarriersBatch read_barriers= tracker.AddTask(BufferTask(BufferRange(buffer, 32, 64), BufferUsage::ComputeShaderSrc));
+	ASSERT_EQ(read_barriers.buffer_barriers.size(), 1u);
+	EXPECT_EQ(read_barriers.buffer_barriers[0].offset, 32u);
+	EXPECT_EQ(read_barriers.buffer_barriers[0].size, 64u);
+}
+
+TEST(TaskBarriersTrackerTest, BarriersForSameBufferAreMerged)
+{
+	TaskBarriersTracker tracker(c_queue_family_index);
+	const vk::Buffer buffer= MakeBuffer(1);
+
+	tracker.AddTask(BufferTask(buffer, BufferUsage::ComputeShaderDst));
+
+	TaskUsages usages;
+	usages.buffers.emplace_back(BufferRange(buffer, 16, 16), BufferUsage::ComputeShaderSrc);
+	usages.buffers.emplace_back(BufferRange(buffer, 64, 32), BufferUsage::ComputeShaderSrc);
+	const BarriersBatch read_barriers= tracker.AddTask(usages);
+	ASSERT_EQ(read_barriers.buffer_barriers.size(), 1u);
+	EXPECT_EQ(read_barriers.buffer_barriers[0].offset, 16u);
+	EXPECT_EQ(read_barriers.buffer_barriers[0].size, 80u);
+}
+
+TEST(TaskBarriersTrackerTest, ImageLayoutTransitions)
+{
+	TaskBarriersTracker tracker(c_queue_family_index);
+	const vk::Image image= MakeImage(1);
+
+	const BarriersBatch upload_barriers= tracker.AddTask(ImageTask(image, ImageUsage::TransferDst));
+	ASSERT_EQ(upload_barriers.image_barriers.size(), 1u);
+	EXPECT_EQ(upload_barriers.image_barriers[0].oldLayout, vk::ImageLayout::eUndefined);
+	EXPECT_EQ(upload_barriers.image_barriers[0].newLayout, vk::ImageLayout::eTransferDstOptimal);
+
+	const BarriersBatch draw_barriers= tracker.AddTask(ImageTask(image, ImageUsage::GraphicsSrc));
+	ASSERT_EQ(draw_barriers.image_barriers.size(), 1u);
+	EXPECT_EQ(draw_barriers.image_barriers[0].oldLayout, vk::ImageLayout::eTransferDstOptimal);
+	EXPECT_EQ(draw_barriers.image_barriers[0].newLayout, vk::ImageLayout::eShaderReadOnlyOptimal);
+	EXPECT_EQ(draw_barriers.src_pipeline_stage_flags, vk::PipelineStageFlags(vk::PipelineStageFlagBits::eTransfer));
+	EXPECT_EQ(draw_barriers.dst_pipeline_stage_flags, vk::PipelineStageFlags(vk::PipelineStageFlagBits::eVertexShader));
+
+	EXPECT_TRUE(tracker.AddTask(ImageTask(image, ImageUsage::GraphicsSrc)).IsEmpty());
+}
+
+TEST(TaskBarriersTrackerTest, BarriersOfIndependentTasksAreMerged)
+{
+	const vk::Buffer buffer0= MakeBuffer(1);
+	const vk::Buffer buffer1= MakeBuffer(2);
+
+	const std::vector<BarriersBatch> tasks_barriers=
+		AddTasksDeferred({
+			BufferTask(buffer0, BufferUsage::ComputeShaderDst),
+			BufferTask(buffer1, BufferUsage::ComputeShaderDst),
+			BufferTask(buffer0, BufferUsage::ComputeShaderSrc),
+			BufferTask(buffer1, BufferUsage::ComputeShaderSrc),
+		});
+
+	ASSERT_EQ(tasks_barriers.size(), 4u);
+	EXPECT_TRUE(tasks_barriers[0].IsEmpty());
+	EXPECT_TRUE(tasks_barriers[1].IsEmpty());
+	ASSERT_EQ(tasks_barriers[2].buffer_barriers.size(), 2u);
+	EXPECT_EQ(tasks_barriers[2].buffer_barriers[0].buffer, buffer0);
+	EXPECT_EQ(tasks_barriers[2].buffer_barriers[1].buffer, buffer1);
+	EXPECT_TRUE(tasks_barriers[3].IsEmpty());
+}
+
+TEST(TaskBarriersTrackerTest, BarriersOfDisjointRangesAreMerged)
+{
+	// Like per-chunk updates of the same buffer.
+	const vk::Buffer buffer= MakeBuffer(1);
+	const vk::Buffer list_buffer= MakeBuffer(2);
+
+	const std::vector<BarriersBatch> tasks_barriers=
+		AddTasksDeferred({
+			BufferTask(list_buffer, BufferUsage::TransferDst),
+			BufferTask(BufferRange(buffer, 0, 64), BufferUsage::ComputeShaderDst),
+			BufferTask(list_buffer, BufferUsage::TransferSrc),
+			BufferTask(BufferRange(buffer, 64, 64), BufferUsage::ComputeShaderDst),
+			BufferTask(BufferRange(buffer, 0, 64), BufferUsage::ComputeShaderSrc),
+		});
+
+	ASSERT_EQ(tasks_barriers.size(), 5u);
+	// Write of other range needs no barrier.
+	// Transfer read has transfer to transfer barrier, compute read can't be merged with it.
+	EXPECT_EQ(tasks_barriers[2].buffer_barriers.size(), 1u);
+	EXPECT_TRUE(tasks_barriers[3].IsEmpty());
+	EXPECT_EQ(tasks_barriers[4].buffer_barriers.size(), 1u);
+}
+
+TEST(TaskBarriersTrackerTest, BarrierIsNotMovedPastConflictingTask)
+{
+	const vk::Buffer buffer0= MakeBuffer(1);
+	const vk::Buffer buffer1= MakeBuffer(2);
+
+	const std::vector<BarriersBatch> tasks_barriers=
+		AddTasksDeferred({
+			BufferTask(buffer0, BufferUsage::ComputeShaderDst),
+			BufferTask(buffer0, BufferUsage::ComputeShaderSrc),
+			BufferTask(buffer1, BufferUsage::ComputeShaderDst),
+			// Can't be moved before the task writing this buffer.
+			BufferTask(buffer1, BufferUsage::ComputeShaderSrc),
+		});
+
+	ASSERT_EQ(tasks_barriers.size(), 4u);
+	ASSERT_EQ(tasks_barriers[1].buffer_barriers.size(), 1u);
+	EXPECT_EQ(tasks_barriers[1].buffer_barriers[0].buffer, buffer0);
+	EXPECT_TRUE(tasks_barriers[2].IsEmpty());
+	ASSERT_EQ(tasks_barriers[3].buffer_barriers.size(), 1u);
+	EXPECT_EQ(tasks_barriers[3].buffer_barriers[0].buffer, buffer1);
+}
+
+TEST(TaskBarriersTrackerTest, BarrierIsMergedWithExecutionBarrier)
+{
+	const vk::Buffer buffer0= MakeBuffer(1);
+	const vk::Buffer buffer1= MakeBuffer(2);
+
+	TaskUsages write_both;
+	write_both.buffers.emplace_back(buffer0, BufferUsage::ComputeShaderDst);
+	write_both.buffers.emplace_back(buffer1, BufferUsage::ComputeShaderDst);
+
+	const std::vector<BarriersBatch> tasks_barriers=
+		AddTasksDeferred({
+			write_both,
+			BufferTask(buffer0, BufferUsage::ComputeShaderSrc),
+			// Write after read of the previous task - can't be moved before it.
+			BufferTask(buffer0, BufferUsage::ComputeShaderDst),
+			BufferTask(buffer1, BufferUsage::ComputeShaderSrc),
+		});
+
+	ASSERT_EQ(tasks_barriers.size(), 4u);
+	EXPECT_EQ(tasks_barriers[1].buffer_barriers.size(), 1u);
+	EXPECT_FALSE(tasks_barriers[1].require_execution_barrier);
+	EXPECT_TRUE(tasks_barriers[2].require_execution_barrier);
+	ASSERT_EQ(tasks_barriers[2].buffer_barriers.size(), 1u);
+	EXPECT_EQ(tasks_barriers[2].buffer_barriers[0].buffer, buffer1);
+	EXPECT_TRUE(tasks_barriers[3].IsEmpty());
+}
+
+TEST(TaskBarriersTrackerTest, BarrierWithOtherStagesIsNotMerged)
+{
+	const vk::Buffer buffer0= MakeBuffer(1);
+	const vk::Buffer buffer1= MakeBuffer(2);
+
+	const std::vector<BarriersBatch> tasks_barriers=
+		AddTasksDeferred({
+			BufferTask(buffer0, BufferUsage::ComputeShaderDst),
+			BufferTask(buffer1, BufferUsage::TransferDst),
+			BufferTask(buffer0, BufferUsage::ComputeShaderSrc),
+			BufferTask(buffer1, BufferUsage::TransferSrc),
+		});
+
+	ASSERT_EQ(tasks_barriers.size(), 4u);
+	EXPECT_EQ(tasks_barriers[2].buffer_barriers.size(), 1u);
+	EXPECT_EQ(tasks_barriers[3].buffer_barriers.size(), 1u);
+}
+
+TEST(TaskBarriersTrackerTest, ImageBarrierIsNotMovedPastTaskUsingImage)
+{
+	const vk::Image image= MakeImage(1);
+	const vk::Buffer buffer= MakeBuffer(1);
+
+	const std::vector<BarriersBatch> tasks_barriers=
+		AddTasksDeferred({
+			BufferTask(buffer, BufferUsage::TransferDst),
+			BufferTask(buffer, BufferUsage::TransferSrc),
+			ImageTask(image, ImageUsage::TransferDst),
+			// Has the same stages as the buffer barrier, but can't be moved before the previous layout transition.
+			ImageTask(image, ImageUsage::TransferSrc),
+		});
+
+	ASSERT_EQ(tasks_barriers.size(), 4u);
+	EXPECT_EQ(tasks_barriers[1].buffer_barriers.size(), 1u);
+	EXPECT_TRUE(tasks_barriers[1].image_barriers.empty());
+	EXPECT_EQ(tasks_barriers[2].image_barriers.size(), 1u);
+	ASSERT_EQ(tasks_barriers[3].image_barriers.size(), 1u);
+	EXPECT_EQ(tasks_barriers[3].image_barriers[0].oldLayout, vk::ImageLayout::eTransferDstOptimal);
+}
+
+} // namespace
+
+} // namespace HexGPU
@@ -0,0 +1,105 @@
+#include "Constants.hpp"
+#include "LightUpdateCPU.hpp"
+#include "ThreadPool.hpp"
+#include "WorldBlocksUpdateCPU.hpp"
+#include "testing/SyntheticWorld.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace HexGPU
+{
+
+namespace
+{
+
+constexpr uint32_t c_world_size= 4;
+constexpr size_t c_world_volume= c_world_size * c_world_size * c_chunk_volume;
+
+struct World
+{
+	std::vector<uint8_t> blocks;
+	std::vector<uint8_t> auxiliar_data;
+	std::vector<uint8_t> light;
+};
+
+// Synthetic chunks with random blocks of all types scattered over them, in order to trigger all update rules.
+World GenerateWorld(std::mt19937& rng)
+{
+	const SyntheticChunks chunks= GenerateSyntheticChunks(0, 0, c_world_size, c_world_size, 0);
+
+	World world;
+	world.blocks.resize(c_world_volume);
+	world.auxiliar_data= chunks.auxiliar_data;
+	for(size_t i= 0; i < c_world_volume; ++i)
+		world.blocks[i]= uint8_t(chunks.blocks[i]);
+
+	for(uint32_t i= 0; i < c_world_volume / 64; ++i)
+	{
+		const size_t address= rng() % c_world_volume;
+		world.blocks[address]= uint8_t(rng() % uint32_t(BlockType::NumBlockTypes));
+		world.auxiliar_data[address]= uint8_t(rng() & 255u);
+	}
+
+	// Also add some air blocks with non-zero auxiliar data, which should be reset in water side flow ticks.
+	for(uint32_t i= 0; i < c_world_volume / 64; ++i)
+	{
+		const size_t address= rng() % c_world_volume;
+		if(world.blocks[address] == uint8_t(BlockType::Air))
+			world.auxiliar_data[address]= uint8_t(rng() & 255u);
+	}
+
+	world.light.resize(c_world_volume);
+	for(uint32_t y= 0; y < c_world_size; ++y)
+	for(uint32_t x= 0; x < c_world_size; ++x)
+		InitialFillChunkLightCPU({c_world_size, c_world_size}, world.blocks.data(), world.light.data(), {x, y});
+
+	return world;
+}
+
+} // namespace
+
+TEST(WorldBlocksUpdateCPUTest, SkippingStaticBlocksGivesSameResult)
+{
+	std::mt19937 rng(0);
+	ThreadPool thread_pool(1);
+
+	World world= GenerateWorld(rng);
+	PropagateWorldLightCPU({c_world_size, c_world_size}, world.blocks.data(), world.light.data(), c_chunk_height * 2, thread_pool);
+
+	for(uint32_t tick= 0; tick < 32; ++tick)
+	{
+		WorldBlocksUpdateCPUParams params;
+		params.world_size_chunks= {c_world_size, c_world_size};
+		params.current_tick= tick;
+		params.sky_light_mask= (tick & 2) == 0 ? -1 : 0;
+		params.sky_light_based_wetness_mask= (tick & 4) == 0 ? -1 : 0;
+		params.snow_z_level= int32_t(rng() % c_chunk_height);
+
+		World results[2];
+		std::vector<bool> modified_flags[2];
+		for(uint32_t i= 0; i < 2; ++i)
+		{
+			results[i].blocks.resize(c_world_volume);
+			results[i].auxiliar_data.resize(c_world_volume);
+
+			WorldBlocksUpdateCPUData data;
+			data.chunks_input_data= world.blocks.data();
+			data.chunks_auxiliar_input_data= world.auxiliar_data.data();
+			data.light_data= world.light.data();
+			data.chunks_output_data= results[i].blocks.data();
+			data.chunks_auxiliar_output_data= results[i].auxiliar_data.data();
+
+			params.skip_static_blocks= i == 1;
+			modified_flags[i]= UpdateWorldBlocksCPU(params, data, thread_pool);
+		}
+
+		ASSERT_EQ(results[0].blocks, results[1].blocks) << "tick " << tick;
+		ASSERT_EQ(results[0].auxiliar_data, results[1].auxiliar_data) << "tick " << tick;
+		ASSERT_EQ(modified_flags[0], modified_flags[1]) << "tick " << tick;
+
+		world.blocks= std::move(results[1].blocks);
+		world.auxiliar_data= std::move(results[1].auxiliar_data);
+	}
+}
+
+} // namespace HexGPU
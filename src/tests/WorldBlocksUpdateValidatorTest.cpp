@@ -0,0 +1,198 @@
+#include "ChunksActivityCPU.hpp"
+#include "Constants.hpp"
+#include "LightUpdateCPU.hpp"
+#include "ThreadPool.hpp"
+#include "WorldBlocksUpdateCPU.hpp"
+#include "WorldBlocksUpdateValidator.hpp"
+#include "testing/SyntheticWorld.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+
+namespace HexGPU
+{
+
+namespace
+{
+
+constexpr uint32_t c_world_size= 4;
+constexpr uint32_t c_num_chunks= c_world_size * c_world_size;
+constexpr size_t c_world_volume= c_num_chunks * c_chunk_volume;
+
+// Tick data with output calculated by the CPU implementation, as if the GPU produced exactly the same result.
+struct TickData
+{
+	std::vector<uint8_t> input_blocks;
+	std::vector<uint8_t> input_auxiliar_data;
+	std::vector<uint8_t> input_light;
+	std::vector<uint8_t> output_blocks;
+	std::vector<uint8_t> output_auxiliar_data;
+	std::vector<uint8_t> output_light;
+	std::vector<uint32_t> chunks_changed_flags;
+};
+
+TickData GenerateTickData(const uint32_t tick)
+{
+	const SyntheticChunks chunks= GenerateSyntheticChunks(0, 0, c_world_size, c_world_size, 0);
+
+	TickData tick_data;
+	tick_data.input_blocks.resize(c_world_volume);
+	for(size_t i= 0; i < c_world_volume; ++i)
+		tick_data.input_blocks[i]= uint8_t(chunks.blocks[i]);
+	tick_data.input_auxiliar_data= chunks.auxiliar_data;
+
+	tick_data.input_light.resize(c_world_volume);
+	for(uint32_t y= 0; y < c_world_size; ++y)
+	for(uint32_t x= 0; x < c_world_size; ++x)
+		InitialFillChunkLightCPU({c_world_size, c_world_size}, tick_data.input_blocks.data(), tick_data.input_light.data(), {x, y});
+
+	ThreadPool thread_pool(1);
+
+	tick_data.output_blocks.resize(c_world_volume);
+	tick_data.output_auxiliar_data.resize(c_world_volume);
+
+	WorldBlocksUpdateCPUParams params;
+	params.world_size_chunks= {c_world_size, c_world_size};
+	params.current_tick= tick;
+
+	WorldBlocksUpdateCPUData data;
+	data.chunks_input_data= tick_data.input_blocks.data();
+	data.chunks_auxiliar_input_data= tick_data.input_auxiliar_data.data();
+	data.light_data= tick_data.input_light.data();
+	data.chunks_output_data= tick_data.output_blocks.data();
+	data.chunks_auxiliar_output_data= tick_data.output_auxiliar_data.data();
+	UpdateWorldBlocksCPU(params, data, thread_pool);
+
+	tick_data.output_light.resize(c_world_volume);
+
+	LightUpdateCPUParams light_params;
+	light_params.world_size_chunks= {c_world_size, c_world_size};
+
+	LightUpdateCPUData light_data;
+	light_data.chunks_data= tick_data.input_blocks.data();
+	light_data.input_light= tick_data.input_light.data();
+	light_data.output_light= tick_data.output_light.data();
+
+	std::vector<ChunkPositionCPU> all_chunks;
+	for(uint32_t y= 0; y < c_world_size; ++y)
+	for(uint32_t x= 0; x < c_world_size; ++x)
+		all_chunks.push_back({x, y});
+	UpdateChunksLightCPU(light_params, light_data, all_chunks, thread_pool);
+
+	// Mark all chunks as changed in the previous tick.
+	tick_data.chunks_changed_flags.resize(c_num_chunks * 2 * 2, 1);
+
+	return tick_data;
+}
+
+WorldBlocksUpdateValidationData GetValidationData(const TickData& tick_data, const uint32_t tick)
+{
+	WorldBlocksUpdateValidationData data;
+	data.world_size_chunks= {c_world_size, c_world_size};
+	data.tick= tick;
+	data.chunks_updated.resize(c_num_chunks, true);
+	data.input_blocks= tick_data.input_blocks.data();
+	data.input_auxiliar_data= tick_data.input_auxiliar_data.data();
+	data.input_light= tick_data.input_light.data();
+	data.output_blocks= tick_data.output_blocks.data();
+	data.output_auxiliar_data= tick_data.output_auxiliar_data.data();
+	data.output_light= tick_data.output_light.data();
+	data.chunks_changed_flags= tick_data.chunks_changed_flags.data();
+	return data;
+}
+
+} // namespace
+
+TEST(WorldBlocksUpdateValidatorTest, IdenticalResultsHaveNoMismatches)
+{
+	const uint32_t tick= 5;
+	const TickData tick_data= GenerateTickData(tick);
+
+	WorldBlocksUpdateValidator validator;
+	EXPECT_EQ(validator.Validate(GetValidationData(tick_data, tick)), 0u);
+}
+
+TEST(WorldBlocksUpdateValidatorTest, MismatchesAreCountedPerChunk)
+{
+	const uint32_t tick= 5;
+	TickData tick_data= GenerateTickData(tick);
+
+	// Corrupt blocks of one chunk and light of another chunk.
+	tick_data.output_blocks[c_chunk_volume * 1 + 17]^= 1;
+	tick_data.output_blocks[c_chunk_volume * 1 + 18]^= 1;
+	tick_data.output_light[c_chunk_volume * 6 + 100]^= 1;
+
+	WorldBlocksUpdateValidator validator;
+	EXPECT_EQ(validator.Validate(GetValidationData(tick_data, tick)), 2u);
+}
+
+TEST(WorldBlocksUpdateValidatorTest, InactiveChunksAreSkipped)
+{
+	const uint32_t tick= 5;
+	TickData tick_data= GenerateTickData(tick);
+
+	// No chunks were changed in the previous tick, so, only chunks with periodic update are active.
+	std::fill(tick_data.chunks_changed_flags.begin(), tick_data.chunks_changed_flags.end(), 0u);
+
+	WorldBlocksUpdateValidationData data= GetValidationData(tick_data, tick);
+	data.inactive_chunks_update_period= 4;
+
+	ChunksActivityCPU::Checker checker;
+	checker.world_size_chunks= {int32_t(c_world_size), int32_t(c_world_size)};
+	checker.current_tick= tick;
+	checker.inactive_chunks_update_period= data.inactive_chunks_update_period;
+	checker.chunks_changed_flags= tick_data.chunks_changed_flags.data();
+
+	uint32_t num_active_chunks= 0;
+	for(uint32_t chunk_index= 0; chunk_index < c_num_chunks; ++chunk_index)
+	{
+		const bool active= checker.IsChunkActive({int32_t(chunk_index % c_world_size), int32_t(chunk_index / c_world_size)});
+		EXPECT_EQ(active, (chunk_index + tick) % data.inactive_chunks_update_period == 0);
+		num_active_chunks+= active ? 1 : 0;
+	}
+	EXPECT_EQ(num_active_chunks, c_num_chunks / data.inactive_chunks_update_period);
+
+	// Corrupt an inactive chunk - it isn't validated.
+	tick_data.output_blocks[c_chunk_volume * 0 + 17]^= 1;
+	EXPECT_FALSE(checker.IsChunkActive({0, 0}));
+
+	WorldBlocksUpdateValidator validator;
+	EXPECT_EQ(validator.Validate(data), 0u);
+
+	// Changed flag of a chunk activates it and its neighbors.
+	tick_data.chunks_changed_flags[((tick - 1) & 1) * 2 * c_num_chunks + 1]= 1;
+	EXPECT_TRUE(checker.IsChunkActive({0, 0}));
+	EXPECT_TRUE(checker.IsChunkActive({2, 1}));
+	EXPECT_EQ(validator.Validate(data), 1u);
+}
+
+TEST(WorldBlocksUpdateValidatorTest, SimulationParamsChangeValidatesBlocksOfInactiveChunks)
+{
+	const uint32_t tick= 5;
+	TickData tick_data= GenerateTickData(tick);
+
+	// No chunks were changed in the previous tick, but blocks of all chunks are updated, since simulation params were changed.
+	std::fill(tick_data.chunks_changed_flags.begin(), tick_data.chunks_changed_flags.end(), 0u);
+
+	// Light of inactive chunks isn't updated, so it's the same as input.
+	for(uint32_t chunk_index= 0; chunk_index < c_num_chunks; ++chunk_index)
+	{
+		if((chunk_index + tick) % 4 != 0)
+			std::copy_n(
+				tick_data.input_light.data() + chunk_index * c_chunk_volume,
+				c_chunk_volume,
+				tick_data.output_light.data() + chunk_index * c_chunk_volume);
+	}
+
+	WorldBlocksUpdateValidationData data= GetValidationData(tick_data, tick);
+	data.inactive_chunks_update_period= 4;
+	data.simulation_params_changed= true;
+
+	WorldBlocksUpdateValidator validator;
+	EXPECT_EQ(validator.Validate(data), 0u);
+
+	// Corrupt blocks of an inactive chunk - it's validated.
+	tick_data.output_blocks[c_chunk_volume * 0 + 17]^= 1;
+	EXPECT_EQ(validator.Validate(data), 1u);
+}
+
+} // namespace HexGPU